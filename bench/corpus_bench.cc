@@ -0,0 +1,42 @@
+#include "corpus.h"
+#include "status.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    constexpr size_t RECORDS = 4096;
+
+    // Records of SGTIN-96 of each representation, and of every scheme with
+    // alphanumeric serials and re-reads.
+    void BM_CorpusGenerate(benchmark::State &state) {
+        CorpusConfig config;
+        CorpusFormat format = static_cast<CorpusFormat>(state.range(0));
+        if (state.range(1) != 0) {
+            config.schemes_ = {
+                {0x30, 1}, {0x36, 1}, {0x31, 1}, {0x32, 1}, {0x39, 1},
+                {0x33, 1}, {0x37, 1}, {0x34, 1}, {0x38, 1},
+            };
+            config.serial_mode_ = SerialMode::kAlphanumeric;
+            config.repeat_rate_ = 0.5;
+        }
+        CorpusGenerator generator = CorpusGenerator::create(config).second;
+        std::string buffer;
+        std::vector<size_t> offsets(RECORDS + 1);
+        uint64_t first = 0;
+        for (auto _ : state) {
+            generator.generate(first, RECORDS, format, buffer,
+                               offsets.data());
+            benchmark::DoNotOptimize(buffer.data());
+            first += RECORDS;
+        }
+        state.SetItemsProcessed(state.iterations() * RECORDS);
+    }
+    BENCHMARK(BM_CorpusGenerate)->ArgsProduct({{0, 1, 2, 3}, {0, 1}});
+}
@@ -0,0 +1,120 @@
+#include "encode.h"
+#include "status.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace epc;
+
+namespace {
+    const char SERIAL_CHARACTERS[] = "A1b2C3d4E5f6G7h8I9j0K1l2";
+
+    // Fields of bits of every partition and scheme, from the filter value
+    // to the extension of SGLN-96.
+    void field_bits(benchmark::internal::Benchmark *b) {
+        for (int bits : {3, 20, 24, 27, 30, 34, 37, 38, 40, 41}) b->Arg(bits);
+    }
+
+    // Strings of the serials of the longer schemes and of the asset
+    // reference of GIAI-202 of each partition.
+    void string_bits(benchmark::internal::Benchmark *b) {
+        for (int bits : {112, 140, 148, 168}) b->Arg(bits);
+    }
+
+    // Binaries of each bit length, padded to whole hex digits.
+    void binary_bits(benchmark::internal::Benchmark *b) {
+        for (int bits : {96, 172, 196, 208}) b->Arg(bits);
+    }
+
+    std::string make_binary(int bits) {
+        std::string bin;
+        for (int i = 0; i < bits; i++) bin += "0110100111"[i % 10];
+        return bin;
+    }
+
+    void BM_EncodeInteger(benchmark::State &state) {
+        unsigned int bits = static_cast<unsigned int>(state.range(0));
+        uint64_t value = (1ULL << bits) - 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(encode_integer(value, bits));
+        }
+    }
+    BENCHMARK(BM_EncodeInteger)->Apply(field_bits);
+
+    void BM_DecodeInteger(benchmark::State &state) {
+        std::string bin(static_cast<size_t>(state.range(0)), '1');
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(decode_integer(bin));
+        }
+    }
+    BENCHMARK(BM_DecodeInteger)->Apply(field_bits);
+
+    void BM_EncodeString(benchmark::State &state) {
+        unsigned int bits = static_cast<unsigned int>(state.range(0));
+        std::string s(SERIAL_CHARACTERS, bits / 7);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(encode_string(s, bits));
+        }
+    }
+    BENCHMARK(BM_EncodeString)->Apply(string_bits);
+
+    void BM_DecodeString(benchmark::State &state) {
+        unsigned int bits = static_cast<unsigned int>(state.range(0));
+        std::string bin = encode_string(
+            std::string(SERIAL_CHARACTERS, bits / 7), bits);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(decode_string(bin));
+        }
+    }
+    BENCHMARK(BM_DecodeString)->Apply(string_bits);
+
+    void BM_ConvertBinToHex(benchmark::State &state) {
+        std::string bin = make_binary(static_cast<int>(state.range(0)));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(convert_bin_to_hex(bin));
+        }
+    }
+    BENCHMARK(BM_ConvertBinToHex)->Apply(binary_bits);
+
+    void BM_ConvertHexToBin(benchmark::State &state) {
+        std::string hex = convert_bin_to_hex(
+            make_binary(static_cast<int>(state.range(0)))).second;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(convert_hex_to_bin(hex));
+        }
+    }
+    BENCHMARK(BM_ConvertHexToBin)->Apply(binary_bits);
+
+    void BM_URIEncode(benchmark::State &state, const char *s) {
+        std::string decoded = s;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(uri_encode(decoded));
+        }
+    }
+    BENCHMARK_CAPTURE(BM_URIEncode, numeric, "12345678901");
+    BENCHMARK_CAPTURE(BM_URIEncode, plain, "A1b2C3d4E5f6G7h8I9j0");
+    BENCHMARK_CAPTURE(BM_URIEncode, escaped, "A1/2C3?4E5%6G7<8I9>0");
+
+    void BM_URIDecode(benchmark::State &state, const char *s) {
+        std::string encoded = uri_encode(s);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(uri_decode(encoded));
+        }
+    }
+    BENCHMARK_CAPTURE(BM_URIDecode, numeric, "12345678901");
+    BENCHMARK_CAPTURE(BM_URIDecode, plain, "A1b2C3d4E5f6G7h8I9j0");
+    BENCHMARK_CAPTURE(BM_URIDecode, escaped, "A1/2C3?4E5%6G7<8I9>0");
+
+    // Padding company prefixes of each partition.
+    void BM_Lpad(benchmark::State &state) {
+        size_t digits = static_cast<size_t>(state.range(0));
+        for (auto _ : state) {
+            std::string s = "614141";
+            lpad(s, digits, '0');
+            benchmark::DoNotOptimize(s);
+        }
+    }
+    BENCHMARK(BM_Lpad)->DenseRange(6, 12);
+}
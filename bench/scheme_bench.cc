@@ -0,0 +1,195 @@
+#include "giai.h"
+#include "grai.h"
+#include "sgln.h"
+#include "sgtin.h"
+#include "sscc.h"
+#include "status.h"
+#include "tag.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+using namespace epc;
+
+namespace {
+    // An EPC of a scheme and partition in every representation.
+    using Sample = struct SampleStruct {
+        std::string company_prefix_;
+        std::string reference_;
+        /** The serial, or empty for SSCC and GIAI */
+        std::string serial_;
+        std::string uri_;
+        std::string tag_uri_;
+        std::string hex_;
+    };
+
+    const char DIGITS[] = "06141418123456789012";
+
+    // Returns whether the sample is made, i.e. the EPC is taken by the
+    // scheme.
+    bool make_sample(const std::string &scheme, unsigned int bits,
+                     unsigned int partition, Sample &sample) {
+        unsigned int length = 12 - partition;
+        sample.company_prefix_.assign(DIGITS, length);
+        bool is96 = bits == 96;
+        if (scheme == "sgtin") {
+            sample.reference_.assign(DIGITS + 4, 13 - length);
+            sample.serial_ = is96 ? "12345678901" : "A1b2C3d4E5f6G7h8I9j0";
+        } else if (scheme == "sscc") {
+            sample.reference_.assign(DIGITS + 4, 17 - length);
+        } else if (scheme == "sgln" || scheme == "grai") {
+            sample.reference_.assign(DIGITS + 4, 12 - length);
+            sample.serial_ = is96 ? "12345678901"
+                : scheme == "sgln" ? "A1b2C3d4E5f6G7h8I9j0"
+                : "A1b2C3d4E5f6G7h8";
+        } else {
+            // Fits in the asset reference of every partition.
+            sample.reference_ = is96 ? "123456789012"
+                : "A1b2C3d4E5f6G7h8I9j0K";
+        }
+        sample.tag_uri_ = "urn:epc:tag:" + scheme + "-" + std::to_string(bits)
+            + ":3." + sample.company_prefix_ + "." + sample.reference_;
+        if (!sample.serial_.empty()) sample.tag_uri_ += "." + sample.serial_;
+
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromTagURI(sample.tag_uri_);
+        if (status != Status::kOk) return false;
+        sample.uri_ = tag.getURI();
+        std::tie(status, sample.hex_) = tag.getBinary();
+        return status == Status::kOk;
+    }
+
+    template <class T>
+    std::pair<Status, T> create(const Sample &sample);
+
+    template <>
+    std::pair<Status, SGTIN> create<SGTIN>(const Sample &sample) {
+        return SGTIN::create(sample.company_prefix_, sample.reference_,
+                             sample.serial_);
+    }
+
+    template <>
+    std::pair<Status, SSCC> create<SSCC>(const Sample &sample) {
+        return SSCC::create(sample.company_prefix_, sample.reference_);
+    }
+
+    template <>
+    std::pair<Status, SGLN> create<SGLN>(const Sample &sample) {
+        return SGLN::create(sample.company_prefix_, sample.reference_,
+                            sample.serial_);
+    }
+
+    template <>
+    std::pair<Status, GRAI> create<GRAI>(const Sample &sample) {
+        return GRAI::create(sample.company_prefix_, sample.reference_,
+                            sample.serial_);
+    }
+
+    template <>
+    std::pair<Status, GIAI> create<GIAI>(const Sample &sample) {
+        return GIAI::create(sample.company_prefix_, sample.reference_);
+    }
+
+    // Returns false if a sample of a partition can't be made, so that a
+    // regression fails the run instead of dropping its benchmarks.
+    template <class T>
+    bool register_scheme(const std::string &scheme, unsigned int bits) {
+        for (unsigned int partition = 0; partition <= 6; partition++) {
+            // The reference of partition 0 of SGLN and GRAI has no digits.
+            if (partition == 0 && (scheme == "sgln" || scheme == "grai")) {
+                continue;
+            }
+            Sample sample;
+            if (!make_sample(scheme, bits, partition, sample)) {
+                std::fprintf(stderr,
+                             "scheme_bench: can't make a sample of %s-%u "
+                             "of partition %u\n",
+                             scheme.c_str(), bits, partition);
+                return false;
+            }
+            std::string name = scheme + "-" + std::to_string(bits) + "/";
+            std::string suffix = "/" + std::to_string(partition);
+            T epc = T::createFromTagURI(sample.tag_uri_).second;
+
+            benchmark::RegisterBenchmark(
+                (name + "create" + suffix).c_str(),
+                [sample](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(create<T>(sample));
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "createFromURI" + suffix).c_str(),
+                [sample](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(
+                            T::createFromURI(sample.uri_));
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "createFromTagURI" + suffix).c_str(),
+                [sample](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(
+                            T::createFromTagURI(sample.tag_uri_));
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "createFromBinary" + suffix).c_str(),
+                [sample](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(
+                            T::createFromBinary(sample.hex_));
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "getURI" + suffix).c_str(),
+                [epc](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(epc.getURI());
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "getTagURI" + suffix).c_str(),
+                [epc](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(epc.getTagURI());
+                    }
+                });
+            benchmark::RegisterBenchmark(
+                (name + "getBinary" + suffix).c_str(),
+                [epc](benchmark::State &state) {
+                    for (auto _ : state) {
+                        benchmark::DoNotOptimize(epc.getBinary());
+                    }
+                });
+        }
+        return true;
+    }
+}
+
+// Samples are made in main() rather than in static initializers, which may
+// run before those of the library.
+int main(int argc, char **argv) {
+    if (!register_scheme<SGTIN>("sgtin", 96)
+        || !register_scheme<SGTIN>("sgtin", 198)
+        || !register_scheme<SSCC>("sscc", 96)
+        || !register_scheme<SGLN>("sgln", 96)
+        || !register_scheme<SGLN>("sgln", 195)
+        || !register_scheme<GRAI>("grai", 96)
+        || !register_scheme<GRAI>("grai", 170)
+        || !register_scheme<GIAI>("giai", 96)
+        || !register_scheme<GIAI>("giai", 202)) {
+        return 1;
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "classify.h"
+#include "encode.h"
+#include "layout.h"
+
+#include <tuple>
+
+namespace epc {
+    namespace {
+        // The bits of the header, filter and partition.
+        constexpr unsigned int FIELD_BITS = LAYOUT_COMPANY_PREFIX_OFFSET;
+        // The bits of the longest company prefix, of partition 0.
+        constexpr unsigned int MAX_COMPANY_PREFIX_BITS = 40;
+
+        // Classifies the leading bits of a binary aligned to the most
+        // significant bit of a word, of which the first bits are valid.
+        std::pair<Status, Classification> classify_word(
+            uint64_t word, unsigned int bits, bool company_prefix) {
+            Classification c = Classification();
+            c.header_ = static_cast<uint8_t>(word >> 56);
+            const SchemeInfo *scheme = get_scheme_info(c.header_);
+            if (scheme == nullptr) {
+                return std::make_pair(Status::kInvalidArgument, c);
+            }
+            c.type_ = scheme->type_;
+            c.bits_ = scheme->bits_;
+            c.filter_ = static_cast<unsigned int>(
+                word >> (64 - LAYOUT_PARTITION_OFFSET) & 0x7);
+            c.partition_ = static_cast<unsigned int>(
+                word >> (64 - LAYOUT_COMPANY_PREFIX_OFFSET) & 0x7);
+            if (!company_prefix) {
+                return std::make_pair(Status::kOk, c);
+            }
+            Status status;
+            Layout layout;
+            std::tie(status, layout) = get_layout(c.header_, c.partition_);
+            unsigned int end = FIELD_BITS + layout.company_prefix_bits_;
+            if (status != Status::kOk || bits < end) {
+                return std::make_pair(Status::kInvalidArgument, c);
+            }
+            c.company_prefix_ = word << FIELD_BITS
+                >> (64 - layout.company_prefix_bits_);
+            c.company_prefix_digits_ = layout.company_prefix_digits_;
+            return std::make_pair(Status::kOk, c);
+        }
+    }
+
+    std::pair<Status, Classification> classify(const std::string &hex,
+                                               bool company_prefix) {
+        size_t digits = ((company_prefix
+                          ? FIELD_BITS + MAX_COMPANY_PREFIX_BITS
+                          : FIELD_BITS) + 3) / 4;
+        if (digits > hex.length()) {
+            digits = hex.length();
+        }
+        if (digits * 4 < FIELD_BITS) {
+            return std::make_pair(Status::kInvalidArgument, Classification());
+        }
+        uint64_t word = 0;
+        for (size_t i = 0; i < digits; i++) {
+            int value = hex_digit_value(hex[i]);
+            if (value < 0) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      Classification());
+            }
+            word |= static_cast<uint64_t>(value) << (60 - i * 4);
+        }
+        return classify_word(word, static_cast<unsigned int>(digits * 4),
+                             company_prefix);
+    }
+
+    std::pair<Status, Classification> classify(const uint8_t *bytes, size_t n,
+                                               bool company_prefix) {
+        size_t length = ((company_prefix
+                          ? FIELD_BITS + MAX_COMPANY_PREFIX_BITS
+                          : FIELD_BITS) + 7) / 8;
+        if (length > n) {
+            length = n;
+        }
+        if (length * 8 < FIELD_BITS) {
+            return std::make_pair(Status::kInvalidArgument, Classification());
+        }
+        uint64_t word = 0;
+        for (size_t i = 0; i < length; i++) {
+            word |= static_cast<uint64_t>(bytes[i]) << (56 - i * 8);
+        }
+        return classify_word(word, static_cast<unsigned int>(length * 8),
+                             company_prefix);
+    }
+}
@@ -0,0 +1,560 @@
+#include "column_file.h"
+#include "encode.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        constexpr char MAGIC[8] = {'E', 'P', 'C', 'C', 'O', 'L', '\0', '\0'};
+        constexpr uint32_t VERSION = 2;
+        constexpr size_t ALIGNMENT = 8;
+
+        using FileHeader = struct FileHeaderStruct {
+            char magic_[8];
+            uint32_t version_;
+            uint32_t block_count_;
+            uint64_t row_count_;
+            uint64_t reserved_;
+        };
+
+        using BlockHeader = struct BlockHeaderStruct {
+            uint8_t header_;
+            // The bytes of each element of the columns of integers, where
+            // the serial width is of serials or serial offsets.
+            uint8_t company_prefix_index_width_;
+            uint8_t reference_width_;
+            uint8_t serial_width_;
+            uint32_t company_prefix_count_;
+            uint64_t row_count_;
+            uint64_t filter_values_offset_;
+            uint64_t company_prefixes_offset_;
+            uint64_t company_prefix_indices_offset_;
+            uint64_t references_offset_;
+            uint64_t serials_offset_;
+            uint64_t serial_offsets_offset_;
+            uint64_t serial_data_offset_;
+            uint64_t serial_data_size_;
+        };
+
+        // The columns of integers of a block packed to their widths.
+        using PackedColumns = struct PackedColumnsStruct {
+            std::string company_prefix_indices_;
+            std::string references_;
+            /** Serials or serial offsets */
+            std::string serials_;
+        };
+
+        enum class SerialKind {
+            kNone,
+            kInteger,
+            kString,
+        };
+
+        SerialKind get_serial_kind(uint8_t header) {
+            const SchemeInfo *scheme = get_scheme_info(header);
+            if (scheme == nullptr || scheme->type_ == TagType::kSSCC) {
+                return SerialKind::kNone;
+            }
+            // Serials of 96-bit schemes are integers.
+            return scheme->bits_ == 96 ? SerialKind::kInteger
+                                       : SerialKind::kString;
+        }
+
+        bool has_reference(uint8_t header) {
+            return get_tag_type(header) != TagType::kGIAI;
+        }
+
+        unsigned int get_total_digits(TagType type) {
+            switch (type) {
+            case TagType::kSGTIN:
+                return 13;
+            case TagType::kSSCC:
+                return 17;
+            default:
+                return 12;
+            }
+        }
+
+        bool is_integer_serial(const std::string &s) {
+            return !s.empty() && s.length() <= 19 && is_padded_numbers(s)
+                && (s.length() == 1 || s[0] != '0');
+        }
+
+        size_t align(size_t n) {
+            return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        // Returns the fewest bytes of 1, 2, 4 and 8 holding every value.
+        template <typename T>
+        unsigned int get_width(const std::vector<T> &values) {
+            uint64_t max = 0;
+            for (T value : values) max = std::max<uint64_t>(max, value);
+            if (max <= UINT8_MAX) return 1;
+            if (max <= UINT16_MAX) return 2;
+            if (max <= UINT32_MAX) return 4;
+            return 8;
+        }
+
+        template <typename U, typename T>
+        void narrow(const std::vector<T> &values, std::string &bytes) {
+            bytes.resize(values.size() * sizeof(U));
+            for (size_t i = 0; i < values.size(); i++) {
+                U value = static_cast<U>(values[i]);
+                std::memcpy(&bytes[i * sizeof(U)], &value, sizeof(U));
+            }
+        }
+
+        // Packs values into elements of a width in host byte order.
+        template <typename T>
+        std::string pack(const std::vector<T> &values, unsigned int width) {
+            std::string bytes;
+            switch (width) {
+            case 1:
+                narrow<uint8_t>(values, bytes);
+                break;
+            case 2:
+                narrow<uint16_t>(values, bytes);
+                break;
+            case 4:
+                narrow<uint32_t>(values, bytes);
+                break;
+            default:
+                narrow<uint64_t>(values, bytes);
+                break;
+            }
+            return bytes;
+        }
+
+        bool get_integers(const char *data, size_t length, uint64_t offset,
+                          size_t count, unsigned int width,
+                          ColumnIntegers &column) {
+            if ((width != 1 && width != 2 && width != 4 && width != 8)
+                || offset % ALIGNMENT != 0 || offset > length
+                || count > (length - offset) / width) {
+                return false;
+            }
+            column = ColumnIntegers(data + offset, count, width);
+            return true;
+        }
+
+        template <typename T>
+        bool get_span(const char *data, size_t length, uint64_t offset,
+                      size_t count, Span<T> &span) {
+            if (offset % ALIGNMENT != 0 || offset > length
+                || count > (length - offset) / sizeof(T)) {
+                return false;
+            }
+            span = Span<T>(reinterpret_cast<const T *>(data + offset), count);
+            return true;
+        }
+    }
+
+    std::string ColumnBlock::getCompanyPrefix(size_t row) const {
+        uint64_t index = company_prefix_indices_[row];
+        if (index >= company_prefixes_.size()) return "";
+        const ColumnCompanyPrefix &entry = company_prefixes_[index];
+        std::string s = std::to_string(entry.value_);
+        lpad(s, entry.digits_, '0');
+        return s;
+    }
+
+    std::string ColumnBlock::getSerial(size_t row) const {
+        if (!serials_.empty()) return std::to_string(serials_[row]);
+        if (serial_offsets_.empty()) return "";
+        uint64_t begin = serial_offsets_[row];
+        uint64_t end = serial_offsets_[row + 1];
+        if (begin > end || end > serial_data_.size()) return "";
+        return std::string(serial_data_.data() + begin, end - begin);
+    }
+
+    std::pair<Status, Tag> ColumnBlock::getTag(size_t row) const {
+        Status status;
+        TagType type = get_tag_type(header_);
+        bool is96 = type != TagType::kUnknown
+            && get_scheme_info(header_)->bits_ == 96;
+        std::string company_prefix = getCompanyPrefix(row);
+        std::string reference;
+        if (!references_.empty()) {
+            reference = std::to_string(references_[row]);
+            size_t digits = get_total_digits(type) - company_prefix.length();
+            lpad(reference, digits, '0');
+        }
+        std::string serial = getSerial(row);
+
+        Tag tag;
+        switch (type) {
+        case TagType::kSGTIN: {
+            SGTIN sgtin;
+            std::tie(status, sgtin) = SGTIN::create(
+                company_prefix, reference, serial);
+            sgtin.setSGTINScheme(is96 ? SGTIN::Scheme::kSGTIN96
+                                 : SGTIN::Scheme::kSGTIN198);
+            tag = Tag(sgtin);
+            break;
+        }
+        case TagType::kSSCC: {
+            SSCC sscc;
+            std::tie(status, sscc) = SSCC::create(company_prefix, reference);
+            tag = Tag(sscc);
+            break;
+        }
+        case TagType::kSGLN: {
+            SGLN sgln;
+            std::tie(status, sgln) = SGLN::create(
+                company_prefix, reference, serial);
+            sgln.setSGLNScheme(is96 ? SGLN::Scheme::kSGLN96
+                               : SGLN::Scheme::kSGLN195);
+            tag = Tag(sgln);
+            break;
+        }
+        case TagType::kGRAI: {
+            GRAI grai;
+            std::tie(status, grai) = GRAI::create(
+                company_prefix, reference, serial);
+            grai.setGRAIScheme(is96 ? GRAI::Scheme::kGRAI96
+                               : GRAI::Scheme::kGRAI170);
+            tag = Tag(grai);
+            break;
+        }
+        case TagType::kGIAI: {
+            GIAI giai;
+            std::tie(status, giai) = GIAI::create(company_prefix, serial);
+            giai.setGIAIScheme(is96 ? GIAI::Scheme::kGIAI96
+                               : GIAI::Scheme::kGIAI202);
+            tag = Tag(giai);
+            break;
+        }
+        default:
+            return std::make_pair(Status::kInvalidArgument, Tag());
+        }
+        if (status != Status::kOk) {
+            return std::make_pair(status, Tag());
+        }
+        if ((status = tag.setFilterValue(filter_values_[row])) != Status::kOk) {
+            return std::make_pair(status, Tag());
+        }
+        return std::make_pair(Status::kOk, tag);
+    }
+
+    ColumnFile::ColumnFile(ColumnFile &&other)
+        : data_(other.data_), length_(other.length_), size_(other.size_),
+          blocks_(std::move(other.blocks_)) {
+        other.data_ = nullptr;
+        other.length_ = 0;
+        other.size_ = 0;
+    }
+
+    ColumnFile &ColumnFile::operator=(ColumnFile &&other) {
+        if (this != &other) {
+            close();
+            data_ = other.data_;
+            length_ = other.length_;
+            size_ = other.size_;
+            blocks_ = std::move(other.blocks_);
+            other.data_ = nullptr;
+            other.length_ = 0;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ColumnFile::~ColumnFile() {
+        close();
+    }
+
+    void ColumnFile::close() {
+        if (data_) ::munmap(data_, length_);
+        data_ = nullptr;
+        length_ = 0;
+        size_ = 0;
+        blocks_.clear();
+    }
+
+    std::pair<Status, ColumnFile> ColumnFile::open(const std::string &path) {
+        ColumnFile file;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::make_pair(Status::kInvalidArgument, std::move(file));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || st.st_size == 0) {
+            ::close(fd);
+            return std::make_pair(Status::kInvalidArgument, std::move(file));
+        }
+        void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return std::make_pair(Status::kInvalidArgument, std::move(file));
+        }
+        file.data_ = data;
+        file.length_ = st.st_size;
+        Status status = file.parse();
+        if (status != Status::kOk) {
+            file.close();
+            return std::make_pair(status, std::move(file));
+        }
+        return std::make_pair(Status::kOk, std::move(file));
+    }
+
+    Status ColumnFile::parse() {
+        const char *data = static_cast<const char *>(data_);
+        if (length_ < sizeof(FileHeader)) return Status::kInvalidArgument;
+        FileHeader file_header;
+        std::memcpy(&file_header, data, sizeof(file_header));
+        if (std::memcmp(file_header.magic_, MAGIC, sizeof(MAGIC)) != 0
+            || file_header.version_ != VERSION
+            || file_header.block_count_
+            > (length_ - sizeof(FileHeader)) / sizeof(BlockHeader)) {
+            return Status::kInvalidArgument;
+        }
+
+        size_t rows = 0;
+        for (uint32_t i = 0; i < file_header.block_count_; i++) {
+            BlockHeader h;
+            std::memcpy(&h, data + sizeof(FileHeader) + i * sizeof(h),
+                        sizeof(h));
+            ColumnBlock block;
+            block.header_ = h.header_;
+            block.size_ = h.row_count_;
+            if (get_tag_type(h.header_) == TagType::kUnknown
+                || h.row_count_ > length_) {
+                return Status::kInvalidArgument;
+            }
+            size_t n = h.row_count_;
+            bool ok = get_span(data, length_, h.filter_values_offset_, n,
+                               block.filter_values_)
+                && get_span(data, length_, h.company_prefixes_offset_,
+                            h.company_prefix_count_, block.company_prefixes_)
+                && get_integers(data, length_,
+                                h.company_prefix_indices_offset_, n,
+                                h.company_prefix_index_width_,
+                                block.company_prefix_indices_);
+            if (ok && has_reference(h.header_)) {
+                ok = get_integers(data, length_, h.references_offset_, n,
+                                  h.reference_width_, block.references_);
+            }
+            switch (get_serial_kind(h.header_)) {
+            case SerialKind::kInteger:
+                ok = ok && get_integers(data, length_, h.serials_offset_, n,
+                                        h.serial_width_, block.serials_);
+                break;
+            case SerialKind::kString:
+                ok = ok && get_integers(data, length_,
+                                        h.serial_offsets_offset_, n + 1,
+                                        h.serial_width_,
+                                        block.serial_offsets_)
+                    && h.serial_data_offset_ <= length_
+                    && h.serial_data_size_ <= length_ - h.serial_data_offset_;
+                if (ok) {
+                    block.serial_data_ = Span<char>(
+                        data + h.serial_data_offset_, h.serial_data_size_);
+                }
+                break;
+            default:
+                break;
+            }
+            if (!ok) return Status::kInvalidArgument;
+            rows += n;
+            blocks_.push_back(block);
+        }
+        if (rows != file_header.row_count_) return Status::kInvalidArgument;
+        size_ = rows;
+        return Status::kOk;
+    }
+
+    Status ColumnFileWriter::add(const Tag &tag) {
+        uint8_t header = tag.getHeader();
+        if (header == 0) return Status::kInvalidArgument;
+
+        Status status;
+        std::string bin;
+        std::tie(status, bin) = tag.getBinary();
+        if (status != Status::kOk) return status;
+
+        std::string company_prefix;
+        std::string reference;
+        std::string serial;
+        switch (tag.getType()) {
+        case TagType::kSGTIN:
+            company_prefix = tag.getSGTIN().getCompanyPrefix();
+            reference = tag.getSGTIN().getItemReferenceAndIndicator();
+            serial = tag.getSGTIN().getSerial();
+            break;
+        case TagType::kSSCC:
+            company_prefix = tag.getSSCC().getCompanyPrefix();
+            reference = tag.getSSCC().getSerialReference();
+            break;
+        case TagType::kSGLN:
+            company_prefix = tag.getSGLN().getCompanyPrefix();
+            reference = tag.getSGLN().getLocationReference();
+            serial = tag.getSGLN().getExtension();
+            break;
+        case TagType::kGRAI:
+            company_prefix = tag.getGRAI().getCompanyPrefix();
+            reference = tag.getGRAI().getAssetType();
+            serial = tag.getGRAI().getSerial();
+            break;
+        case TagType::kGIAI:
+            company_prefix = tag.getGIAI().getCompanyPrefix();
+            serial = tag.getGIAI().getAssetReference();
+            break;
+        default:
+            return Status::kInvalidArgument;
+        }
+        SerialKind serial_kind = get_serial_kind(header);
+        if (serial_kind == SerialKind::kInteger
+            && !is_integer_serial(serial)) {
+            return Status::kInvalidSerial;
+        }
+
+        Block &block = blocks_[header];
+        auto it = block.company_prefix_map_.find(company_prefix);
+        uint32_t index;
+        if (it == block.company_prefix_map_.end()) {
+            index = block.company_prefixes_.size();
+            ColumnCompanyPrefix entry = {
+                std::stoull(company_prefix),
+                static_cast<uint32_t>(company_prefix.length()), 0};
+            block.company_prefixes_.push_back(entry);
+            block.company_prefix_map_.emplace(company_prefix, index);
+        } else {
+            index = it->second;
+        }
+        block.filter_values_.push_back(tag.getEPC().getFilterValue());
+        block.company_prefix_indices_.push_back(index);
+        if (has_reference(header)) {
+            block.references_.push_back(std::stoull(reference));
+        }
+        if (serial_kind == SerialKind::kInteger) {
+            block.serials_.push_back(std::stoull(serial));
+        } else if (serial_kind == SerialKind::kString) {
+            if (block.serial_offsets_.empty()) {
+                block.serial_offsets_.push_back(0);
+            }
+            block.serial_data_ += serial;
+            block.serial_offsets_.push_back(block.serial_data_.size());
+        }
+        return Status::kOk;
+    }
+
+    size_t ColumnFileWriter::size() const {
+        size_t n = 0;
+        for (auto &entry : blocks_) {
+            n += entry.second.filter_values_.size();
+        }
+        return n;
+    }
+
+    Status ColumnFileWriter::write(const std::string &path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) return Status::kInvalidArgument;
+
+        FileHeader file_header = {};
+        std::memcpy(file_header.magic_, MAGIC, sizeof(MAGIC));
+        file_header.version_ = VERSION;
+        file_header.block_count_ = blocks_.size();
+        file_header.row_count_ = size();
+
+        // Lay out columns after the headers.
+        std::vector<BlockHeader> block_headers;
+        std::vector<PackedColumns> packed;
+        size_t offset = align(sizeof(FileHeader)
+                              + blocks_.size() * sizeof(BlockHeader));
+        auto place = [&offset](size_t bytes) {
+            uint64_t placed = offset;
+            offset = align(offset + bytes);
+            return placed;
+        };
+        for (auto &entry : blocks_) {
+            const Block &block = entry.second;
+            BlockHeader h = {};
+            h.header_ = entry.first;
+            h.company_prefix_count_ = block.company_prefixes_.size();
+            h.row_count_ = block.filter_values_.size();
+            h.filter_values_offset_ = place(block.filter_values_.size());
+            h.company_prefixes_offset_ = place(
+                block.company_prefixes_.size() * sizeof(ColumnCompanyPrefix));
+            PackedColumns columns;
+            unsigned int width = get_width(block.company_prefix_indices_);
+            h.company_prefix_index_width_ = static_cast<uint8_t>(width);
+            columns.company_prefix_indices_ = pack(
+                block.company_prefix_indices_, width);
+            h.company_prefix_indices_offset_ = place(
+                columns.company_prefix_indices_.size());
+            if (!block.references_.empty()) {
+                width = get_width(block.references_);
+                h.reference_width_ = static_cast<uint8_t>(width);
+                columns.references_ = pack(block.references_, width);
+                h.references_offset_ = place(columns.references_.size());
+            }
+            if (!block.serials_.empty()) {
+                width = get_width(block.serials_);
+                h.serial_width_ = static_cast<uint8_t>(width);
+                columns.serials_ = pack(block.serials_, width);
+                h.serials_offset_ = place(columns.serials_.size());
+            }
+            if (!block.serial_offsets_.empty()) {
+                width = get_width(block.serial_offsets_);
+                h.serial_width_ = static_cast<uint8_t>(width);
+                columns.serials_ = pack(block.serial_offsets_, width);
+                h.serial_offsets_offset_ = place(columns.serials_.size());
+                h.serial_data_offset_ = place(block.serial_data_.size());
+                h.serial_data_size_ = block.serial_data_.size();
+            }
+            block_headers.push_back(h);
+            packed.push_back(std::move(columns));
+        }
+
+        size_t written = 0;
+        auto put = [&os, &written](uint64_t at, const void *p, size_t n) {
+            static const char zeros[ALIGNMENT] = {};
+            if (at > written) {
+                os.write(zeros, at - written);
+            }
+            os.write(static_cast<const char *>(p), n);
+            written = at + n;
+        };
+        put(0, &file_header, sizeof(file_header));
+        for (auto &h : block_headers) {
+            put(written, &h, sizeof(h));
+        }
+        size_t i = 0;
+        for (auto &entry : blocks_) {
+            const Block &block = entry.second;
+            const PackedColumns &columns = packed[i];
+            const BlockHeader &h = block_headers[i++];
+            put(h.filter_values_offset_, block.filter_values_.data(),
+                block.filter_values_.size());
+            put(h.company_prefixes_offset_, block.company_prefixes_.data(),
+                block.company_prefixes_.size() * sizeof(ColumnCompanyPrefix));
+            put(h.company_prefix_indices_offset_,
+                columns.company_prefix_indices_.data(),
+                columns.company_prefix_indices_.size());
+            if (!block.references_.empty()) {
+                put(h.references_offset_, columns.references_.data(),
+                    columns.references_.size());
+            }
+            if (!block.serials_.empty()) {
+                put(h.serials_offset_, columns.serials_.data(),
+                    columns.serials_.size());
+            }
+            if (!block.serial_offsets_.empty()) {
+                put(h.serial_offsets_offset_, columns.serials_.data(),
+                    columns.serials_.size());
+                put(h.serial_data_offset_, block.serial_data_.data(),
+                    block.serial_data_.size());
+            }
+        }
+        put(offset, nullptr, 0);
+        os.flush();
+        return os ? Status::kOk : Status::kInvalidArgument;
+    }
+}
@@ -0,0 +1,436 @@
+#include "corpus.h"
+#include "encode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        constexpr size_t MAX_BYTES = 26;
+        // Longer than the Tag URIs of any scheme.
+        constexpr size_t MAX_RECORD_LENGTH = 128;
+        constexpr uint64_t MAX_UINT64 = ~0ULL;
+        constexpr char DIGIT_PAIRS[] =
+            "00010203040506070809101112131415161718192021222324"
+            "25262728293031323334353637383940414243444546474849"
+            "50515253545556575859606162636465666768697071727374"
+            "75767778798081828384858687888990919293949596979899";
+        constexpr char ALPHANUMERICS[] =
+            "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        constexpr uint64_t ALPHANUMERICS_SIZE = sizeof(ALPHANUMERICS) - 1;
+        constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+        // The stream of company prefixes, apart from those of records.
+        constexpr uint64_t COMPANY_PREFIX_STREAM = 0x5851F42D4C957F2DULL;
+
+        // The finalizer of SplitMix64.
+        uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // SplitMix64, whose streams of distinct states overlap only after
+        // far more draws than a record takes.
+        class Random {
+        public:
+            explicit Random(uint64_t state) : state_(state) {}
+            uint64_t next() { return mix(state_ += GOLDEN_GAMMA); }
+
+        private:
+            uint64_t state_;
+        };
+
+        // Maps a draw to [0, max] by the high 64 bits of the product,
+        // which is faster than the remainder and as uniform.
+        uint64_t uniform(uint64_t r, uint64_t max) {
+            if (max == MAX_UINT64) return r;
+            return static_cast<uint64_t>(
+                static_cast<unsigned __int128>(r) * (max + 1) >> 64);
+        }
+
+        // The largest integer of up to a number of digits.
+        uint64_t get_max_integer(unsigned int digits) {
+            return digits < 20 ? POW10[digits] - 1 : MAX_UINT64;
+        }
+
+        bool is_weight(double weight) {
+            return std::isfinite(weight) && weight >= 0;
+        }
+
+        std::vector<double> get_zipf_weights(size_t n, double skew) {
+            std::vector<double> weights(n);
+            for (size_t i = 0; i < n; i++) {
+                weights[i] = std::pow(static_cast<double>(i + 1), -skew);
+            }
+            return weights;
+        }
+
+        // Writes digits of an integer padded with zeros, 2 digits at once.
+        char *put_integer(char *p, uint64_t value, unsigned int digits) {
+            char s[20];
+            char *q = s + sizeof(s);
+            while (value >= 100) {
+                q -= 2;
+                std::memcpy(q, DIGIT_PAIRS + value % 100 * 2, 2);
+                value /= 100;
+            }
+            if (value >= 10) {
+                q -= 2;
+                std::memcpy(q, DIGIT_PAIRS + value * 2, 2);
+            } else {
+                *--q = static_cast<char>('0' + value);
+            }
+            unsigned int n = static_cast<unsigned int>(s + sizeof(s) - q);
+            for (; n < digits; digits--) *p++ = '0';
+            std::memcpy(p, q, n);
+            return p + n;
+        }
+
+        // Writes bits from the most significant bit of bytes.
+        class BitWriter {
+        public:
+            explicit BitWriter(uint8_t *bytes) : p_(bytes) {}
+
+            void put(uint64_t value, unsigned int bits) {
+                if (bits > 32) {
+                    putShort(value >> 32, bits - 32);
+                    bits = 32;
+                }
+                putShort(value & 0xFFFFFFFFULL, bits);
+            }
+            void flush() {
+                if (n_ > 0) *p_++ = static_cast<uint8_t>(acc_ << (8 - n_));
+                n_ = 0;
+            }
+
+        private:
+            // Takes up to 32 bits, so acc_ holds up to 39 bits.
+            void putShort(uint64_t value, unsigned int bits) {
+                acc_ = acc_ << bits | value;
+                n_ += bits;
+                while (n_ >= 8) {
+                    n_ -= 8;
+                    *p_++ = static_cast<uint8_t>(acc_ >> n_);
+                }
+            }
+
+            uint8_t *p_;
+            uint64_t acc_ = 0;
+            unsigned int n_ = 0;
+        };
+    }
+
+    bool CorpusGenerator::buildAliasTable(const std::vector<double> &weights,
+                                          AliasTable &table) {
+        // Vose's alias method.
+        size_t n = weights.size();
+        double sum = 0;
+        for (double weight : weights) sum += weight;
+        if (n == 0 || !(sum > 0) || !std::isfinite(sum)) return false;
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; i++) {
+            scaled[i] = weights[i] * n / sum;
+            (scaled[i] < 1 ? small : large).push_back(
+                static_cast<uint32_t>(i));
+        }
+        table.thresholds_.assign(n, 1ULL << 32);
+        table.aliases_.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            table.aliases_[i] = static_cast<uint32_t>(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back();
+            uint32_t l = large.back();
+            small.pop_back();
+            table.thresholds_[s] = static_cast<uint64_t>(
+                scaled[s] * 4294967296.0);
+            table.aliases_[s] = l;
+            scaled[l] -= 1 - scaled[s];
+            if (scaled[l] < 1) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        return true;
+    }
+
+    uint32_t CorpusGenerator::sample(const AliasTable &table, uint64_t r) {
+        // The high 32 bits choose a column and the low 32 bits the column
+        // or its alias.
+        uint32_t i = static_cast<uint32_t>(
+            (r >> 32) * table.aliases_.size() >> 32);
+        return (r & 0xFFFFFFFFULL) < table.thresholds_[i]
+            ? i : table.aliases_[i];
+    }
+
+    std::pair<Status, CorpusGenerator> CorpusGenerator::create(
+        const CorpusConfig &config) {
+        CorpusGenerator generator;
+        generator.config_ = config;
+        if (config.filter_ > EPC::MAX_FILTER_VALUE
+            || config.partition_weights_.size() != PARTITIONS
+            || config.company_prefixes_ == 0
+            || config.company_prefixes_ > MAX_COMPANY_PREFIXES
+            || config.repeat_window_ == 0
+            || config.repeat_window_ > MAX_REPEAT_WINDOW
+            || !(config.repeat_rate_ >= 0 && config.repeat_rate_ < 1)
+            || !is_weight(config.company_prefix_skew_)
+            || !is_weight(config.repeat_skew_)) {
+            return std::make_pair(Status::kInvalidArgument, CorpusGenerator());
+        }
+        for (double weight : config.partition_weights_) {
+            if (!is_weight(weight)) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      CorpusGenerator());
+            }
+        }
+
+        std::vector<double> scheme_weights;
+        for (const CorpusScheme &corpus_scheme : config.schemes_) {
+            TagType type = get_tag_type(corpus_scheme.header_);
+            if (type == TagType::kUnknown
+                || !is_weight(corpus_scheme.weight_)) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      CorpusGenerator());
+            }
+            if (corpus_scheme.weight_ == 0) continue;
+
+            Scheme scheme;
+            scheme.type_ = type;
+            scheme.hex_length_ = get_hex_length(corpus_scheme.header_);
+            std::vector<double> partition_weights(config.partition_weights_);
+            for (unsigned int partition = 0; partition < PARTITIONS;
+                 partition++) {
+                Slot &slot = scheme.slots_[partition];
+                std::tie(std::ignore, slot.layout_) = get_layout(
+                    corpus_scheme.header_, partition);
+                const Layout &layout = slot.layout_;
+                slot.max_length_ = 0;
+                if (type == TagType::kSSCC) {
+                    slot.max_serial_ = get_max_integer(
+                        layout.reference_digits_);
+                } else if (type == TagType::kGIAI) {
+                    if (layout.bits_ == 96) {
+                        slot.max_serial_ = (1ULL << layout.reference_bits_) - 1;
+                    } else {
+                        slot.max_length_ = std::min(
+                            layout.reference_digits_,
+                            layout.reference_bits_ / LAYOUT_CHAR_BITS);
+                    }
+                } else {
+                    // References of no digits aren't taken by the scheme
+                    // classes.
+                    if (layout.reference_digits_ == 0) {
+                        partition_weights[partition] = 0;
+                    }
+                    if (layout.bits_ == 96) {
+                        slot.max_serial_ = (1ULL << layout.serial_bits_) - 1;
+                    } else {
+                        slot.max_length_ =
+                            layout.serial_bits_ / LAYOUT_CHAR_BITS;
+                    }
+                }
+                if (slot.max_length_ != 0) {
+                    slot.max_serial_ = get_max_integer(slot.max_length_);
+                }
+            }
+            if (!buildAliasTable(partition_weights, scheme.partitions_)) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      CorpusGenerator());
+            }
+
+            scheme.uri_prefix_ = "urn:epc:id:";
+            scheme.uri_prefix_ += get_tag_type_name(type);
+            scheme.uri_prefix_ += ':';
+            scheme.tag_uri_prefix_ = "urn:epc:tag:";
+            scheme.tag_uri_prefix_ += get_scheme_info(corpus_scheme.header_)
+                ->name_;
+            scheme.tag_uri_prefix_ += ':';
+            scheme.tag_uri_prefix_ += static_cast<char>('0' + config.filter_);
+            scheme.tag_uri_prefix_ += '.';
+            generator.schemes_.push_back(scheme);
+            scheme_weights.push_back(corpus_scheme.weight_);
+        }
+        if (!buildAliasTable(scheme_weights, generator.scheme_table_)) {
+            return std::make_pair(Status::kInvalidArgument, CorpusGenerator());
+        }
+
+        generator.seed_key_ = mix(config.seed_);
+        Random random(generator.seed_key_ ^ COMPANY_PREFIX_STREAM);
+        generator.company_prefixes_.resize(
+            PARTITIONS * config.company_prefixes_);
+        for (unsigned int partition = 0; partition < PARTITIONS;
+             partition++) {
+            // Partition 0 is for 12 digits of company prefix, and so on.
+            uint64_t max = get_max_integer(12 - partition);
+            for (size_t i = 0; i < config.company_prefixes_; i++) {
+                generator.company_prefixes_[
+                    partition * config.company_prefixes_ + i] =
+                    uniform(random.next(), max);
+            }
+        }
+        buildAliasTable(get_zipf_weights(config.company_prefixes_,
+                                         config.company_prefix_skew_),
+                        generator.company_prefix_table_);
+        buildAliasTable(get_zipf_weights(config.repeat_window_,
+                                         config.repeat_skew_),
+                        generator.repeat_table_);
+        generator.repeat_threshold_ = static_cast<uint64_t>(
+            config.repeat_rate_ * 18446744073709551616.0);
+        return std::make_pair(Status::kOk, generator);
+    }
+
+    void CorpusGenerator::makeRecord(uint64_t index, Record &record) const {
+        Random random(mix(seed_key_ ^ index));
+        // A re-read is the same as the record it re-reads, which may be a
+        // re-read itself.
+        while (repeat_threshold_ != 0 && index > 0
+               && random.next() < repeat_threshold_) {
+            uint64_t age = sample(repeat_table_, random.next()) + 1;
+            if (age > index) break;
+            index -= age;
+            random = Random(mix(seed_key_ ^ index));
+        }
+
+        const Scheme &scheme = schemes_[sample(scheme_table_, random.next())];
+        unsigned int partition = sample(scheme.partitions_, random.next());
+        const Slot &slot = scheme.slots_[partition];
+        const Layout &layout = slot.layout_;
+        record.scheme_ = &scheme;
+        record.slot_ = &slot;
+        record.company_prefix_ = company_prefixes_[
+            partition * config_.company_prefixes_
+            + sample(company_prefix_table_, random.next())];
+        record.reference_ = uniform(
+            random.next(), get_max_integer(layout.reference_digits_));
+        record.length_ = 0;
+
+        if (config_.serial_mode_ == SerialMode::kAlphanumeric
+            && slot.max_length_ != 0) {
+            uint64_t r = random.next();
+            record.length_ = 1 + static_cast<unsigned int>(
+                r % slot.max_length_);
+            // Takes 2 characters of each draw.
+            for (unsigned int i = 0; i < record.length_; i++) {
+                if (i % 2 == 0) r = random.next();
+                uint64_t bits = i % 2 == 0 ? r >> 32 : r & 0xFFFFFFFFULL;
+                record.chars_[i] = ALPHANUMERICS[
+                    bits * ALPHANUMERICS_SIZE >> 32];
+            }
+            return;
+        }
+
+        uint64_t serial;
+        if (config_.serial_mode_ == SerialMode::kSequential) {
+            // Wraps around past the largest serial.
+            serial = config_.first_serial_ + index;
+            if (slot.max_serial_ != MAX_UINT64) {
+                serial %= slot.max_serial_ + 1;
+            }
+        } else {
+            serial = uniform(random.next(), slot.max_serial_);
+        }
+        if (scheme.type_ == TagType::kSSCC) {
+            record.reference_ = serial;
+        } else if (slot.max_length_ != 0) {
+            char *end = put_integer(record.chars_, serial, 0);
+            record.length_ = static_cast<unsigned int>(end - record.chars_);
+        } else {
+            record.serial_ = serial;
+        }
+    }
+
+    void CorpusGenerator::appendRecord(const Record &record,
+                                       CorpusFormat format,
+                                       std::string &buffer) const {
+        const Scheme &scheme = *record.scheme_;
+        const Layout &layout = record.slot_->layout_;
+        char s[MAX_RECORD_LENGTH];
+        char *p = s;
+
+        if (format == CorpusFormat::kHex || format == CorpusFormat::kBytes) {
+            uint8_t bytes[MAX_BYTES] = {};
+            BitWriter writer(bytes);
+            writer.put(layout.header_, 8);
+            writer.put(config_.filter_, 3);
+            writer.put(layout.partition_, 3);
+            writer.put(record.company_prefix_, layout.company_prefix_bits_);
+            if (scheme.type_ != TagType::kGIAI) {
+                writer.put(record.reference_, layout.reference_bits_);
+            }
+            if (scheme.type_ != TagType::kSSCC) {
+                if (record.length_ != 0) {
+                    for (unsigned int i = 0; i < record.length_; i++) {
+                        writer.put(static_cast<uint8_t>(record.chars_[i]),
+                                   LAYOUT_CHAR_BITS);
+                    }
+                } else {
+                    writer.put(record.serial_,
+                               scheme.type_ == TagType::kGIAI
+                               ? layout.reference_bits_
+                               : layout.serial_bits_);
+                }
+            }
+            writer.flush();
+
+            size_t n = scheme.hex_length_;
+            if (format == CorpusFormat::kBytes) {
+                buffer.append(reinterpret_cast<const char *>(bytes),
+                              (n + 1) / 2);
+                return;
+            }
+            for (size_t i = 0; i < n / 2; i++) {
+                *p++ = HEX_DIGITS[bytes[i] >> 4];
+                *p++ = HEX_DIGITS[bytes[i] & 0xF];
+            }
+            if (n % 2 != 0) *p++ = HEX_DIGITS[bytes[n / 2] >> 4];
+            buffer.append(s, p - s);
+            return;
+        }
+
+        const std::string &prefix = format == CorpusFormat::kURI
+            ? scheme.uri_prefix_ : scheme.tag_uri_prefix_;
+        std::memcpy(p, prefix.data(), prefix.length());
+        p += prefix.length();
+        p = put_integer(p, record.company_prefix_,
+                        layout.company_prefix_digits_);
+        *p++ = '.';
+        if (scheme.type_ != TagType::kGIAI) {
+            p = put_integer(p, record.reference_, layout.reference_digits_);
+            if (scheme.type_ != TagType::kSSCC) *p++ = '.';
+        }
+        if (scheme.type_ != TagType::kSSCC) {
+            // Alphanumerics need no escapes.
+            if (record.length_ != 0) {
+                std::memcpy(p, record.chars_, record.length_);
+                p += record.length_;
+            } else {
+                p = put_integer(p, record.serial_, 0);
+            }
+        }
+        buffer.append(s, p - s);
+    }
+
+    void CorpusGenerator::append(uint64_t index, CorpusFormat format,
+                                 std::string &buffer) const {
+        Record record;
+        makeRecord(index, record);
+        appendRecord(record, format, buffer);
+    }
+
+    void CorpusGenerator::generate(uint64_t first, size_t n,
+                                   CorpusFormat format, std::string &buffer,
+                                   size_t *offsets) const {
+        buffer.clear();
+        Record record;
+        for (size_t i = 0; i < n; i++) {
+            if (offsets) offsets[i] = buffer.size();
+            makeRecord(first + i, record);
+            appendRecord(record, format, buffer);
+        }
+        if (offsets) offsets[n] = buffer.size();
+    }
+}
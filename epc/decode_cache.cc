@@ -0,0 +1,200 @@
+#include "decode_cache.h"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace epc {
+    namespace {
+        int upper_hex_digit_value(char c) {
+            if ('0' <= c && c <= '9') return c - '0';
+            if ('A' <= c && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+    }
+
+    // EPC binary packed into 4 words, most significant nibble first. The
+    // header determines the number of nibbles, so keys of different lengths
+    // never collide.
+    struct DecodeCache::Key {
+        uint64_t words_[4];
+
+        bool operator==(const Key &other) const {
+            return std::memcmp(words_, other.words_, sizeof(words_)) == 0;
+        }
+    };
+
+    struct DecodeCache::KeyHash {
+        size_t operator()(const Key &key) const {
+            const uint64_t k = 0x9E3779B97F4A7C15;
+            uint64_t h = key.words_[0] * k;
+            h = (h ^ key.words_[1]) * k;
+            h = (h ^ key.words_[2]) * k;
+            h = (h ^ key.words_[3]) * k;
+            return h ^ h >> 32;
+        }
+    };
+
+    struct DecodeCache::Shard {
+        using Slot = struct SlotStruct {
+            Key key_;
+            std::shared_ptr<const DecodeCacheEntry> entry_;
+            bool referenced_;
+        };
+
+        std::mutex mutex_;
+        size_t capacity_;
+        std::unordered_map<Key, size_t, KeyHash> index_;
+        std::vector<Slot> slots_;
+        size_t hand_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+    };
+
+    DecodeCache::DecodeCache(size_t capacity, size_t shard_count)
+        : capacity_(capacity) {
+        if (shard_count == 0) shard_count = 1;
+        if (shard_count > capacity && capacity > 0) shard_count = capacity;
+        for (size_t i = 0; i < shard_count; i++) {
+            std::unique_ptr<Shard> shard(new Shard());
+            // Spread the capacity so that the shards add up to it.
+            shard->capacity_ = capacity / shard_count
+                + (i < capacity % shard_count ? 1 : 0);
+            shard->index_.reserve(shard->capacity_);
+            shard->slots_.reserve(shard->capacity_);
+            shards_.push_back(std::move(shard));
+        }
+    }
+
+    DecodeCache::~DecodeCache() = default;
+
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>>
+    DecodeCache::get(const std::string &hex) {
+        auto decode = [&hex] { return Tag::createFromBinary(hex); };
+        Key key = Key();
+        int hi, lo;
+        if (hex.length() < 2
+            || (hi = upper_hex_digit_value(hex[0])) < 0
+            || (lo = upper_hex_digit_value(hex[1])) < 0
+            || get_hex_length(hi << 4 | lo) != hex.length()) {
+            return get(Key(), decode);
+        }
+        for (size_t i = 0; i < hex.length(); i++) {
+            int v = upper_hex_digit_value(hex[i]);
+            if (v < 0) return get(Key(), decode);
+            key.words_[i / 16] |=
+                static_cast<uint64_t>(v) << (60 - i % 16 * 4);
+        }
+        return get(key, decode);
+    }
+
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>>
+    DecodeCache::get(const uint8_t *bytes, size_t size) {
+        auto decode = [bytes, size] {
+            return Tag::createFromBytes(bytes, size);
+        };
+        Key key = Key();
+        size_t length = size > 0 ? get_hex_length(bytes[0]) : 0;
+        if (length == 0 || size < (length + 1) / 2) return get(Key(), decode);
+        // Every bit Tag::createFromBytes decodes, in the nibbles of the
+        // hex string.
+        for (size_t i = 0; i < length; i++) {
+            uint64_t v = i % 2 == 0 ? bytes[i / 2] >> 4 : bytes[i / 2] & 0xF;
+            key.words_[i / 16] |= v << (60 - i % 16 * 4);
+        }
+        return get(key, decode);
+    }
+
+    template <typename Decode>
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>>
+    DecodeCache::get(const Key &key, Decode decode) {
+        // Binaries failing to be packed have the key of all zeros, which is
+        // never cached since its header is unknown.
+        size_t hash = KeyHash()(key);
+        Shard &shard = *shards_[(hash >> 48) % shards_.size()];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            auto it = shard.index_.find(key);
+            if (it != shard.index_.end()) {
+                Shard::Slot &slot = shard.slots_[it->second];
+                slot.referenced_ = true;
+                shard.hits_++;
+                return std::make_pair(Status::kOk, slot.entry_);
+            }
+            shard.misses_++;
+        }
+
+        // Decode without the lock so that hits on the shard aren't blocked.
+        Status status;
+        std::shared_ptr<DecodeCacheEntry> entry =
+            std::make_shared<DecodeCacheEntry>();
+        std::tie(status, entry->tag_) = decode();
+        if (status != Status::kOk) return std::make_pair(status, nullptr);
+        entry->uri_ = entry->tag_.getURI();
+        entry->tag_uri_ = entry->tag_.getTagURI();
+        if (shard.capacity_ == 0) return std::make_pair(Status::kOk, entry);
+
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        auto it = shard.index_.find(key);
+        if (it != shard.index_.end()) {
+            // Inserted by another thread in the meantime.
+            return std::make_pair(Status::kOk,
+                                  shard.slots_[it->second].entry_);
+        }
+        size_t index;
+        if (shard.slots_.size() < shard.capacity_) {
+            index = shard.slots_.size();
+            shard.slots_.push_back(Shard::Slot());
+        } else {
+            while (shard.slots_[shard.hand_].referenced_) {
+                shard.slots_[shard.hand_].referenced_ = false;
+                shard.hand_ = (shard.hand_ + 1) % shard.slots_.size();
+            }
+            index = shard.hand_;
+            shard.hand_ = (shard.hand_ + 1) % shard.slots_.size();
+            shard.index_.erase(shard.slots_[index].key_);
+        }
+        Shard::Slot &slot = shard.slots_[index];
+        slot.key_ = key;
+        slot.entry_ = entry;
+        slot.referenced_ = false;
+        shard.index_.emplace(key, index);
+        return std::make_pair(Status::kOk, entry);
+    }
+
+    uint64_t DecodeCache::getHits() const {
+        uint64_t hits = 0;
+        for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex_);
+            hits += shard->hits_;
+        }
+        return hits;
+    }
+
+    uint64_t DecodeCache::getMisses() const {
+        uint64_t misses = 0;
+        for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex_);
+            misses += shard->misses_;
+        }
+        return misses;
+    }
+
+    size_t DecodeCache::size() const {
+        size_t size = 0;
+        for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex_);
+            size += shard->slots_.size();
+        }
+        return size;
+    }
+
+    void DecodeCache::clear() {
+        for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex_);
+            shard->index_.clear();
+            shard->slots_.clear();
+            shard->hand_ = 0;
+        }
+    }
+}
@@ -0,0 +1,202 @@
+#include "deduplicator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace epc {
+    namespace {
+        // The number of slots swept per offer. Sweeping more slots than
+        // entries inserted keeps the table free of expired entries.
+        constexpr size_t SWEEP_STEPS = 2;
+        // The number of reads whose slots are prefetched ahead in batches.
+        constexpr size_t PREFETCH_DISTANCE = 16;
+
+        size_t round_up_to_power_of_2(size_t n) {
+            size_t p = 16;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+        unsigned int log2(size_t n) {
+            unsigned int bits = 0;
+            while (n > 1) {
+                n >>= 1;
+                bits++;
+            }
+            return bits;
+        }
+
+        // Adds a window to a timestamp, saturating instead of wrapping
+        // around to 0, which marks empty slots.
+        uint64_t add_saturated(uint64_t timestamp, uint64_t window) {
+            return timestamp > ~0ULL - window ? ~0ULL : timestamp + window;
+        }
+
+        inline void prefetch(const void *p) {
+#if defined(__GNUC__)
+            __builtin_prefetch(p, 1);
+#else
+            (void)p;
+#endif
+        }
+    }
+
+    Deduplicator::Deduplicator(uint64_t window, size_t initial_capacity)
+        : window_(window > 0 ? window : 1) {
+        // Keep the load factor at most 1/2.
+        size_t slots = round_up_to_power_of_2(initial_capacity * 2);
+        entries_.assign(slots, Entry());
+        mask_ = slots - 1;
+        shift_ = 64 - log2(slots);
+    }
+
+    size_t Deduplicator::getHome(uint64_t low, uint32_t high,
+                                 uint32_t zone) const {
+        uint64_t h = low * 0x9E3779B97F4A7C15
+            ^ (static_cast<uint64_t>(high) << 32 | zone) * 0xC2B2AE3D27D4EB4F;
+        h ^= h >> 29;
+        return (h * 0x9E3779B97F4A7C15) >> shift_;
+    }
+
+    bool Deduplicator::offerAt(size_t index, const Epc96 &epc, uint32_t zone,
+                               uint64_t timestamp) {
+        uint64_t low = epc.getLow();
+        uint32_t high = epc.getHigh();
+        if (timestamp > now_) now_ = timestamp;
+        for (;; index = (index + 1) & mask_) {
+            Entry &entry = entries_[index];
+            if (entry.expires_ == 0) {
+                entry.low_ = low;
+                entry.high_ = high;
+                entry.zone_ = zone;
+                entry.expires_ = add_saturated(timestamp, window_);
+                size_++;
+                return true;
+            }
+            if (entry.low_ == low && entry.high_ == high
+                && entry.zone_ == zone) {
+                if (timestamp < entry.expires_) return false;
+                entry.expires_ = add_saturated(timestamp, window_);
+                return true;
+            }
+        }
+    }
+
+    bool Deduplicator::offer(const Epc96 &epc, uint32_t zone,
+                             uint64_t timestamp) {
+        reserve(1);
+        bool first = offerAt(getHome(epc.getLow(), epc.getHigh(), zone), epc,
+                             zone, timestamp);
+        sweep(SWEEP_STEPS);
+        return first;
+    }
+
+    size_t Deduplicator::offer(const Epc96 *epcs, const uint32_t *zones,
+                               const uint64_t *timestamps, size_t n,
+                               uint64_t *mask) {
+        std::memset(mask, 0, (n + 63) / 64 * sizeof(uint64_t));
+        size_t count = 0;
+        size_t homes[PREFETCH_DISTANCE];
+        for (size_t begin = 0; begin < n; begin += PREFETCH_DISTANCE) {
+            size_t end = std::min(n, begin + PREFETCH_DISTANCE);
+            // Make room first so that the homes stay valid.
+            reserve(end - begin);
+            for (size_t i = begin; i < end; i++) {
+                uint32_t zone = zones ? zones[i] : 0;
+                size_t home = getHome(epcs[i].getLow(), epcs[i].getHigh(),
+                                      zone);
+                homes[i - begin] = home;
+                prefetch(&entries_[home]);
+            }
+            for (size_t i = begin; i < end; i++) {
+                uint32_t zone = zones ? zones[i] : 0;
+                if (offerAt(homes[i - begin], epcs[i], zone, timestamps[i])) {
+                    mask[i / 64] |= uint64_t(1) << (i % 64);
+                    count++;
+                }
+            }
+            sweep(SWEEP_STEPS * (end - begin));
+        }
+        return count;
+    }
+
+    void Deduplicator::reserve(size_t n) {
+        if ((size_ + n) * 2 <= entries_.size()) return;
+        // Rebuild the table without expired entries, growing it only if
+        // the rest still fill it.
+        size_t live = 0;
+        for (const Entry &entry : entries_) {
+            if (entry.expires_ > now_) live++;
+        }
+        size_t slots = entries_.size();
+        if ((live + n) * 4 > slots) {
+            slots = round_up_to_power_of_2((live + n) * 4);
+        }
+        std::vector<Entry> old;
+        old.swap(entries_);
+        entries_.assign(slots, Entry());
+        mask_ = slots - 1;
+        shift_ = 64 - log2(slots);
+        size_ = 0;
+        cursor_ = 0;
+        for (const Entry &entry : old) {
+            if (entry.expires_ <= now_) continue;
+            size_t index = getHome(entry.low_, entry.high_, entry.zone_);
+            while (entries_[index].expires_ != 0) index = (index + 1) & mask_;
+            entries_[index] = entry;
+            size_++;
+        }
+    }
+
+    // Removes an entry with backward shift deletion, moving the following
+    // entries of the same cluster back unless it'd put them before their
+    // home slots.
+    void Deduplicator::remove(size_t index) {
+        size_t j = index;
+        for (;;) {
+            j = (j + 1) & mask_;
+            Entry &entry = entries_[j];
+            if (entry.expires_ == 0) break;
+            size_t home = getHome(entry.low_, entry.high_, entry.zone_);
+            // Distances from the home slot to the hole and to the entry.
+            if (((index - home) & mask_) < ((j - home) & mask_)) {
+                entries_[index] = entry;
+                index = j;
+            }
+        }
+        entries_[index] = Entry();
+        size_--;
+    }
+
+    void Deduplicator::sweep(size_t steps) {
+        steps = std::min(steps, entries_.size());
+        for (size_t i = 0; i < steps; i++) {
+            Entry &entry = entries_[cursor_];
+            if (entry.expires_ != 0 && entry.expires_ <= now_) {
+                // The slot may get an entry shifted into it, so check it
+                // again.
+                remove(cursor_);
+            } else {
+                cursor_ = (cursor_ + 1) & mask_;
+            }
+        }
+    }
+
+    void Deduplicator::expire(uint64_t now) {
+        if (now > now_) now_ = now;
+        for (size_t i = 0; i < entries_.size();) {
+            Entry &entry = entries_[i];
+            if (entry.expires_ != 0 && entry.expires_ <= now_) {
+                remove(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    void Deduplicator::clear() {
+        std::fill(entries_.begin(), entries_.end(), Entry());
+        size_ = 0;
+        cursor_ = 0;
+    }
+}
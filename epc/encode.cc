@@ -5,6 +5,19 @@
 #include <sstream>
 
 namespace epc {
+    namespace {
+        using UriEscape = struct UriEscapeStruct {
+            char c_;
+            char hex_[3];
+        };
+
+        // The characters of serials escaped in EPC URIs.
+        const UriEscape URI_ESCAPES[] = {
+            {'%', "25"}, {'"', "22"}, {'&', "26"}, {'/', "2F"},
+            {'<', "3C"}, {'>', "3E"}, {'?', "3F"},
+        };
+    }
+
     std::string encode_integer(uint64_t i, unsigned int bit_len) {
         std::string s = std::bitset<64>(i).to_string();
         return s.substr(64-bit_len, 64);
@@ -65,6 +78,13 @@ namespace epc {
         return std::make_pair(Status::kOk, ss.str());
     }
 
+    int hex_digit_value(char c) {
+        if ('0' <= c && c <= '9') return c - '0';
+        if ('A' <= c && c <= 'F') return c - 'A' + 10;
+        if ('a' <= c && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
     void replace_all(std::string& str, const std::string& from,
                      const std::string& to) {
         if(from.empty())
@@ -77,27 +97,54 @@ namespace epc {
     }
 
     std::string uri_encode(const std::string &s) {
-        std::string copy = s;
-        replace_all(copy, "%", "%25");
-        replace_all(copy, "\"", "%22");
-        replace_all(copy, "&", "%26");
-        replace_all(copy, "/", "%2F");
-        replace_all(copy, "<", "%3C");
-        replace_all(copy, ">", "%3E");
-        replace_all(copy, "?", "%3F");
-        return copy;
+        std::string encoded;
+        encoded.reserve(s.length());
+        append_uri_encoded(encoded, s.data(), s.length());
+        return encoded;
     }
 
     std::string uri_decode(const std::string &s) {
-        std::string copy = s;
-        replace_all(copy, "%22", "\"");
-        replace_all(copy, "%26", "&");
-        replace_all(copy, "%2F", "/");
-        replace_all(copy, "%3C", "<");
-        replace_all(copy, "%3E", ">");
-        replace_all(copy, "%3F", "?");
-        replace_all(copy, "%25", "%");
-        return copy;
+        std::string decoded;
+        decoded.reserve(s.length());
+        append_uri_decoded(decoded, s.data(), s.length());
+        return decoded;
+    }
+
+    void append_uri_encoded(std::string &buffer, char c) {
+        for (const UriEscape &escape : URI_ESCAPES) {
+            if (c == escape.c_) {
+                buffer += '%';
+                buffer.append(escape.hex_, 2);
+                return;
+            }
+        }
+        buffer += c;
+    }
+
+    void append_uri_encoded(std::string &buffer, const char *s, size_t n) {
+        for (size_t i = 0; i < n; i++) append_uri_encoded(buffer, s[i]);
+    }
+
+    const char *decode_uri_char(const char *p, const char *end, char *c) {
+        if (*p == '%' && end - p >= 3) {
+            for (const UriEscape &escape : URI_ESCAPES) {
+                if (p[1] == escape.hex_[0] && p[2] == escape.hex_[1]) {
+                    *c = escape.c_;
+                    return p + 3;
+                }
+            }
+        }
+        *c = *p;
+        return p + 1;
+    }
+
+    void append_uri_decoded(std::string &buffer, const char *s, size_t n) {
+        const char *end = s + n;
+        char c;
+        while (s != end) {
+            s = decode_uri_char(s, end, &c);
+            buffer += c;
+        }
     }
 
     std::string read_string(std::stringstream &ss, size_t n) {
@@ -3,6 +3,7 @@
 
 #include "status.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -14,10 +15,19 @@ namespace epc {
     std::string decode_string(const std::string &s);
     std::pair<Status, std::string> convert_bin_to_hex(const std::string &bin);
     std::pair<Status, std::string> convert_hex_to_bin(const std::string &hex);
+    int hex_digit_value(char c);
     void replace_all(std::string& str, const std::string& from,
                      const std::string& to);
     std::string uri_encode(const std::string &s);
     std::string uri_decode(const std::string &s);
+    // Appends a character or a string URI encoded as uri_encode() does.
+    void append_uri_encoded(std::string &buffer, char c);
+    void append_uri_encoded(std::string &buffer, const char *s, size_t n);
+    // Decodes the character of an URI encoded string at p as uri_decode()
+    // does, and returns the position of the next.
+    const char *decode_uri_char(const char *p, const char *end, char *c);
+    // Appends an URI encoded string decoded as uri_decode() does.
+    void append_uri_decoded(std::string &buffer, const char *s, size_t n);
     std::string read_string(std::stringstream &ss, size_t n);
     void lpad(std::string &s, size_t n, char ch);
     void rpad(std::string &s, size_t n, char ch);
@@ -35,6 +45,49 @@ namespace epc {
         {'8', "1000"}, {'9', "1001"}, {'A', "1010"}, {'B', "1011"},
         {'C', "1100"}, {'D', "1101"}, {'E', "1110"}, {'F', "1111"},
     };
+
+    constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+    // Powers of 10 up to the largest of 64 bits.
+    constexpr uint64_t POW10[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+        10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+        100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+        100000000000000000ULL, 1000000000000000000ULL,
+        10000000000000000000ULL
+    };
+
+    // Reads length bits, up to 64, from a bit offset of bytes, counted from
+    // the most significant bit of the first byte.
+    inline uint64_t get_bits(const uint8_t *bytes, unsigned int offset,
+                             unsigned int length) {
+        uint64_t value = 0;
+        while (length > 0) {
+            unsigned int shift = offset % 8;
+            unsigned int bits = 8 - shift < length ? 8 - shift : length;
+            unsigned int byte = bytes[offset / 8] >> (8 - shift - bits);
+            value = value << bits | (byte & ((1U << bits) - 1));
+            offset += bits;
+            length -= bits;
+        }
+        return value;
+    }
+
+    // Writes length bits of a value as get_bits() reads them, into bytes
+    // whose bits there are 0.
+    inline void put_bits(uint8_t *bytes, unsigned int offset,
+                         unsigned int length, uint64_t value) {
+        while (length > 0) {
+            unsigned int shift = offset % 8;
+            unsigned int bits = 8 - shift < length ? 8 - shift : length;
+            unsigned int byte = static_cast<unsigned int>(
+                value >> (length - bits)) & ((1U << bits) - 1);
+            bytes[offset / 8] |= static_cast<uint8_t>(
+                byte << (8 - shift - bits));
+            offset += bits;
+            length -= bits;
+        }
+    }
 }
 
 #endif
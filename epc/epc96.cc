@@ -0,0 +1,69 @@
+#include "epc96.h"
+#include "encode.h"
+
+namespace epc {
+    std::pair<Status, Epc96> Epc96::createFromBinary(const std::string &hex) {
+        if (hex.length() != BYTES * 2) {
+            return std::make_pair(Status::kInvalidArgument, Epc96());
+        }
+        uint8_t bytes[BYTES];
+        for (size_t i = 0; i < BYTES; i++) {
+            int hi = hex_digit_value(hex[i * 2]);
+            int lo = hex_digit_value(hex[i * 2 + 1]);
+            if (hi < 0 || lo < 0) {
+                return std::make_pair(Status::kInvalidArgument, Epc96());
+            }
+            bytes[i] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+        return std::make_pair(Status::kOk, createFromBytes(bytes));
+    }
+
+    Epc96 Epc96::createFromBytes(const uint8_t *bytes) {
+        uint32_t high = 0;
+        uint64_t low = 0;
+        for (size_t i = 0; i < 4; i++) {
+            high = high << 8 | bytes[i];
+        }
+        for (size_t i = 4; i < BYTES; i++) {
+            low = low << 8 | bytes[i];
+        }
+        return Epc96(high, low);
+    }
+
+    std::string Epc96::getBinary() const {
+        static const char digits[] = "0123456789ABCDEF";
+        uint8_t bytes[BYTES];
+        getBytes(bytes);
+        std::string hex(BYTES * 2, '0');
+        for (size_t i = 0; i < BYTES; i++) {
+            hex[i * 2] = digits[bytes[i] >> 4];
+            hex[i * 2 + 1] = digits[bytes[i] & 0xF];
+        }
+        return hex;
+    }
+
+    void Epc96::getBytes(uint8_t *bytes) const {
+        for (size_t i = 0; i < 4; i++) {
+            bytes[i] = high_ >> (24 - i * 8);
+        }
+        for (size_t i = 4; i < BYTES; i++) {
+            bytes[i] = low_ >> (88 - i * 8);
+        }
+    }
+
+    uint64_t Epc96::getBits(unsigned int offset, unsigned int length) const {
+        if (length == 0) return 0;
+        // Bits are numbered from the most significant bit of high_.
+        unsigned int end = offset + length;
+        uint64_t value;
+        if (end <= 32) {
+            value = high_ >> (32 - end);
+        } else if (offset >= 32) {
+            value = low_ >> (96 - end);
+        } else {
+            value = (static_cast<uint64_t>(high_) << (end - 32))
+                | (low_ >> (96 - end));
+        }
+        return length == 64 ? value : value & ((1ULL << length) - 1);
+    }
+}
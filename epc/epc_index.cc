@@ -0,0 +1,368 @@
+#include "epc_index.h"
+#include "layout.h"
+#include "tag.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        constexpr unsigned int BITS = 96;
+
+        inline unsigned int get_bit(const Epc96 &epc, unsigned int bit) {
+            return bit < 32 ? epc.getHigh() >> (31 - bit) & 1
+                            : epc.getLow() >> (95 - bit) & 1;
+        }
+
+        // Returns the first bit two keys differ at, or BITS if they're
+        // equal.
+        inline unsigned int get_critical_bit(const Epc96 &a, const Epc96 &b) {
+            uint32_t high = a.getHigh() ^ b.getHigh();
+            if (high != 0) return __builtin_clz(high);
+            uint64_t low = a.getLow() ^ b.getLow();
+            if (low != 0) return 32 + __builtin_clzll(low);
+            return BITS;
+        }
+
+        Epc96 set_bits(const Epc96 &epc, unsigned int offset,
+                       unsigned int length, uint64_t value) {
+            uint32_t high = epc.getHigh();
+            uint64_t low = epc.getLow();
+            for (unsigned int i = 0; i < length; i++) {
+                unsigned int bit = offset + i;
+                unsigned int shift = length - 1 - i;
+                uint64_t v = shift < 64 ? value >> shift & 1 : 0;
+                if (bit < 32) {
+                    high = (high & ~(1U << (31 - bit)))
+                        | static_cast<uint32_t>(v << (31 - bit));
+                } else {
+                    low = (low & ~(1ULL << (95 - bit))) | v << (95 - bit);
+                }
+            }
+            return Epc96(high, low);
+        }
+
+        EpcRange get_prefix_range(const Epc96 &prefix, unsigned int bits) {
+            uint32_t high_mask = bits >= 32 ? ~0U
+                : bits == 0 ? 0 : ~0U << (32 - bits);
+            uint64_t low_mask = bits <= 32 ? 0
+                : bits >= BITS ? ~0ULL : ~0ULL << (BITS - bits);
+            EpcRange range;
+            range.first_ = Epc96(prefix.getHigh() & high_mask,
+                                 prefix.getLow() & low_mask);
+            range.last_ = Epc96(prefix.getHigh() | ~high_mask,
+                                prefix.getLow() | ~low_mask);
+            return range;
+        }
+
+        unsigned int count_trailing_zeros(const Epc96 &epc) {
+            if (epc.getLow() != 0) return __builtin_ctzll(epc.getLow());
+            if (epc.getHigh() != 0) return 64 + __builtin_ctz(epc.getHigh());
+            return BITS;
+        }
+
+        Epc96 increment(const Epc96 &epc) {
+            uint64_t low = epc.getLow() + 1;
+            return Epc96(epc.getHigh() + (low == 0 ? 1 : 0), low);
+        }
+
+        bool parse_digits(const std::string &s, uint64_t *value) {
+            if (s.empty() || s.length() > 19 || !is_padded_numbers(s)) {
+                return false;
+            }
+            *value = std::stoull(s);
+            return true;
+        }
+
+        uint64_t get_max_value(unsigned int bits) {
+            return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+        }
+    }
+
+    EpcIndexQuery make_index_query(uint8_t header,
+                                   const std::string &company_prefix,
+                                   const std::string &reference) {
+        EpcIndexQuery query;
+        query.header_ = header;
+        query.filter_ = -1;
+        query.company_prefix_ = company_prefix;
+        query.reference_ = reference;
+        query.first_serial_ = 0;
+        query.last_serial_ = ~0ULL;
+        return query;
+    }
+
+    std::pair<Status, std::vector<EpcRange>> get_index_ranges(
+        const EpcIndexQuery &query) {
+        std::vector<EpcRange> ranges;
+        Status status;
+        Layout layout;
+        std::tie(status, layout) =
+            get_layout(query.header_, query.company_prefix_);
+        uint64_t company_prefix;
+        if (status != Status::kOk || layout.bits_ != BITS
+            || query.filter_ > EPC::MAX_FILTER_VALUE
+            || !parse_digits(query.company_prefix_, &company_prefix)) {
+            return std::make_pair(Status::kInvalidArgument, ranges);
+        }
+        uint64_t reference = 0;
+        bool has_reference = !query.reference_.empty();
+        if (has_reference) {
+            // GIAI asset references are of variable length.
+            size_t digits = query.reference_.length();
+            if (!parse_digits(query.reference_, &reference)
+                || (get_tag_type(query.header_) == TagType::kGIAI
+                    ? digits > layout.reference_digits_
+                    : digits != layout.reference_digits_)
+                || reference > get_max_value(layout.reference_bits_)) {
+                return std::make_pair(Status::kInvalidArgument, ranges);
+            }
+        }
+
+        uint64_t first_serial = query.first_serial_;
+        uint64_t last_serial = std::min(query.last_serial_,
+                                        get_max_value(layout.serial_bits_));
+        bool has_serials = has_reference && layout.serial_bits_ > 0;
+        if (has_serials && first_serial > last_serial) {
+            return std::make_pair(Status::kOk, ranges);
+        }
+
+        unsigned int first_filter = query.filter_ < 0 ? 0 : query.filter_;
+        unsigned int last_filter = query.filter_ < 0 ? EPC::MAX_FILTER_VALUE
+                                                     : query.filter_;
+        for (unsigned int filter = first_filter; filter <= last_filter;
+             filter++) {
+            Epc96 key = set_bits(Epc96(), 0, 8, query.header_);
+            key = set_bits(key, LAYOUT_FILTER_OFFSET, 3, filter);
+            key = set_bits(key, LAYOUT_PARTITION_OFFSET, 3,
+                           layout.partition_);
+            key = set_bits(key, LAYOUT_COMPANY_PREFIX_OFFSET,
+                           layout.company_prefix_bits_, company_prefix);
+            if (!has_reference) {
+                ranges.push_back(
+                    get_prefix_range(key, layout.getReferenceOffset()));
+                continue;
+            }
+            key = set_bits(key, layout.getReferenceOffset(),
+                           layout.reference_bits_, reference);
+            EpcRange range = get_prefix_range(key, layout.getSerialOffset());
+            if (has_serials) {
+                range.first_ = set_bits(range.first_, layout.getSerialOffset(),
+                                        layout.serial_bits_, first_serial);
+                range.last_ = set_bits(range.last_, layout.getSerialOffset(),
+                                       layout.serial_bits_, last_serial);
+            }
+            ranges.push_back(range);
+        }
+        return std::make_pair(Status::kOk, ranges);
+    }
+
+    std::vector<EpcPrefix> get_range_prefixes(const EpcRange &range) {
+        std::vector<EpcPrefix> prefixes;
+        if (range.last_ < range.first_) return prefixes;
+        Epc96 first = range.first_;
+        for (;;) {
+            // The largest block aligned at first and ending in the range.
+            unsigned int bits = BITS - count_trailing_zeros(first);
+            while (get_prefix_range(first, bits).last_ > range.last_) bits++;
+            prefixes.push_back(EpcPrefix{first, bits});
+            Epc96 last = get_prefix_range(first, bits).last_;
+            if (last >= range.last_) break;
+            first = increment(last);
+        }
+        return prefixes;
+    }
+
+    bool EpcIndex::insert(const Epc96 &epc, uint64_t value) {
+        Leaf leaf = {epc, value};
+        if (leaves_.empty()) {
+            leaves_.push_back(leaf);
+            root_ = LEAF;
+            return true;
+        }
+        uint32_t ref = root_;
+        while (!(ref & LEAF)) {
+            const Node &node = nodes_[ref];
+            ref = node.children_[get_bit(epc, node.bit_)];
+        }
+        Leaf &closest = leaves_[ref & ~LEAF];
+        unsigned int bit = get_critical_bit(closest.epc_, epc);
+        if (bit == BITS) {
+            closest.value_ = value;
+            return false;
+        }
+
+        // Find the edge to split, where the keys below start to differ
+        // after the new bit.
+        const uint32_t ROOT = ~0U;
+        uint32_t parent = ROOT;
+        unsigned int side = 0;
+        ref = root_;
+        while (!(ref & LEAF) && nodes_[ref].bit_ < bit) {
+            parent = ref;
+            side = get_bit(epc, nodes_[ref].bit_);
+            ref = nodes_[ref].children_[side];
+        }
+        uint32_t leaf_ref = LEAF | static_cast<uint32_t>(leaves_.size());
+        leaves_.push_back(leaf);
+        Node node;
+        node.bit_ = bit;
+        unsigned int direction = get_bit(epc, bit);
+        node.children_[direction] = leaf_ref;
+        node.children_[1 - direction] = ref;
+        uint32_t node_ref = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(node);
+        if (parent == ROOT) {
+            root_ = node_ref;
+        } else {
+            nodes_[parent].children_[side] = node_ref;
+        }
+        return true;
+    }
+
+    void EpcIndex::load(const Epc96 *epcs, const uint64_t *values,
+                        size_t n) {
+        leaves_.reserve(leaves_.size() + n);
+        for (size_t i = 0; i < n; i++) {
+            Leaf leaf = {epcs[i], values ? values[i] : i};
+            leaves_.push_back(leaf);
+        }
+        // Existing keys stay before the new ones, so the later values of
+        // duplicate keys win as they do with insert.
+        std::stable_sort(leaves_.begin(), leaves_.end(),
+                         [](const Leaf &a, const Leaf &b) {
+                             return a.epc_ < b.epc_;
+                         });
+        size_t size = 0;
+        for (size_t i = 0; i < leaves_.size(); i++) {
+            if (size > 0 && leaves_[size - 1].epc_ == leaves_[i].epc_) {
+                leaves_[size - 1] = leaves_[i];
+            } else {
+                leaves_[size++] = leaves_[i];
+            }
+        }
+        leaves_.resize(size);
+        nodes_.clear();
+        nodes_.reserve(size);
+        root_ = size > 0 ? build(0, size) : 0;
+    }
+
+    // Builds the subtree of sorted leaves [first, last).
+    uint32_t EpcIndex::build(size_t first, size_t last) {
+        if (last - first == 1) return LEAF | static_cast<uint32_t>(first);
+        // The first and the last keys differ first at the critical bit of
+        // the range, and the keys with the bit set follow the others.
+        unsigned int bit = get_critical_bit(leaves_[first].epc_,
+                                            leaves_[last - 1].epc_);
+        size_t middle = std::partition_point(
+            leaves_.begin() + first, leaves_.begin() + last,
+            [bit](const Leaf &leaf) { return get_bit(leaf.epc_, bit) == 0; })
+            - leaves_.begin();
+        uint32_t node_ref = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(Node());
+        uint32_t left = build(first, middle);
+        uint32_t right = build(middle, last);
+        Node &node = nodes_[node_ref];
+        node.children_[0] = left;
+        node.children_[1] = right;
+        node.bit_ = bit;
+        return node_ref;
+    }
+
+    bool EpcIndex::find(const Epc96 &epc, uint64_t *value) const {
+        if (leaves_.empty()) return false;
+        uint32_t ref = root_;
+        while (!(ref & LEAF)) {
+            const Node &node = nodes_[ref];
+            ref = node.children_[get_bit(epc, node.bit_)];
+        }
+        const Leaf &leaf = leaves_[ref & ~LEAF];
+        if (leaf.epc_ != epc) return false;
+        if (value) *value = leaf.value_;
+        return true;
+    }
+
+    size_t EpcIndex::scan(const EpcRange &range, const Visitor &visitor,
+                          bool *stopped) const {
+        if (leaves_.empty() || range.last_ < range.first_) return 0;
+        const Epc96 &first = range.first_;
+        uint32_t ref = root_;
+        while (!(ref & LEAF)) {
+            const Node &node = nodes_[ref];
+            ref = node.children_[get_bit(first, node.bit_)];
+        }
+        unsigned int bit = get_critical_bit(leaves_[ref & ~LEAF].epc_, first);
+
+        // Right children not visited yet along the path, nearest last. The
+        // critical bits increase along a path, so the path is no longer
+        // than the number of bits.
+        uint32_t pending[BITS];
+        size_t depth = 0;
+        // Descend to the subtree sharing the bits before the critical bit
+        // with the first key.
+        ref = root_;
+        while (!(ref & LEAF) && nodes_[ref].bit_ < bit) {
+            const Node &node = nodes_[ref];
+            unsigned int side = get_bit(first, node.bit_);
+            if (side == 0) pending[depth++] = node.children_[1];
+            ref = node.children_[side];
+        }
+        if (bit < BITS && get_bit(first, bit) == 1) {
+            // All the keys of the subtree precede the first key.
+            if (depth == 0) return 0;
+            ref = pending[--depth];
+        }
+
+        size_t count = 0;
+        for (;;) {
+            while (!(ref & LEAF)) {
+                const Node &node = nodes_[ref];
+                pending[depth++] = node.children_[1];
+                ref = node.children_[0];
+            }
+            const Leaf &leaf = leaves_[ref & ~LEAF];
+            if (range.last_ < leaf.epc_) break;
+            count++;
+            if (!visitor(leaf.epc_, leaf.value_)) {
+                *stopped = true;
+                break;
+            }
+            if (depth == 0) break;
+            ref = pending[--depth];
+        }
+        return count;
+    }
+
+    size_t EpcIndex::scan(const EpcRange &range,
+                          const Visitor &visitor) const {
+        bool stopped = false;
+        return scan(range, visitor, &stopped);
+    }
+
+    size_t EpcIndex::scanPrefix(const Epc96 &prefix, unsigned int bits,
+                                const Visitor &visitor) const {
+        return scan(get_prefix_range(prefix, bits), visitor);
+    }
+
+    std::pair<Status, size_t> EpcIndex::scan(const EpcIndexQuery &query,
+                                             const Visitor &visitor) const {
+        Status status;
+        std::vector<EpcRange> ranges;
+        std::tie(status, ranges) = get_index_ranges(query);
+        if (status != Status::kOk) return std::make_pair(status, 0);
+        size_t count = 0;
+        bool stopped = false;
+        for (const EpcRange &range : ranges) {
+            count += scan(range, visitor, &stopped);
+            if (stopped) break;
+        }
+        return std::make_pair(Status::kOk, count);
+    }
+
+    void EpcIndex::clear() {
+        leaves_.clear();
+        nodes_.clear();
+        root_ = 0;
+    }
+}
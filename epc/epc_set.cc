@@ -0,0 +1,272 @@
+#include "epc_set.h"
+#include "tag.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace epc {
+    namespace {
+        // Sets smaller than this are sorted by comparison.
+        constexpr size_t RADIX_SORT_THRESHOLD = 256;
+        // A set is searched by galloping if it's this many times larger
+        // than the other.
+        constexpr size_t GALLOP_RATIO = 16;
+        // The minimum number of EPCs merged or rendered by a thread.
+        constexpr size_t MIN_PARALLEL_SIZE = 1 << 16;
+
+        inline unsigned int get_byte(const Epc96 &epc, unsigned int i) {
+            return i < 8 ? (epc.getLow() >> (i * 8)) & 0xFF
+                         : (epc.getHigh() >> ((i - 8) * 8)) & 0xFF;
+        }
+
+        void radix_sort(std::vector<Epc96> &epcs) {
+            size_t n = epcs.size();
+            if (n < RADIX_SORT_THRESHOLD) {
+                std::sort(epcs.begin(), epcs.end());
+                return;
+            }
+            std::vector<size_t> counts(Epc96::BYTES * 256);
+            for (const Epc96 &epc : epcs) {
+                for (unsigned int i = 0; i < Epc96::BYTES; i++) {
+                    counts[i * 256 + get_byte(epc, i)]++;
+                }
+            }
+            std::vector<Epc96> buffer(n);
+            Epc96 *src = epcs.data();
+            Epc96 *dst = buffer.data();
+            // Least significant byte first, skipping bytes shared by all.
+            for (unsigned int i = 0; i < Epc96::BYTES; i++) {
+                size_t *count = &counts[i * 256];
+                if (count[get_byte(src[0], i)] == n) continue;
+                size_t offset = 0;
+                for (unsigned int b = 0; b < 256; b++) {
+                    size_t c = count[b];
+                    count[b] = offset;
+                    offset += c;
+                }
+                for (size_t j = 0; j < n; j++) {
+                    dst[count[get_byte(src[j], i)]++] = src[j];
+                }
+                std::swap(src, dst);
+            }
+            if (src != epcs.data()) epcs.swap(buffer);
+        }
+
+        using Keep = struct KeepStruct {
+            bool first_only_;
+            bool second_only_;
+            bool both_;
+        };
+
+        void merge_linear(const Epc96 *a, const Epc96 *a_end,
+                          const Epc96 *b, const Epc96 *b_end, Keep keep,
+                          std::vector<Epc96> &out) {
+            while (a != a_end && b != b_end) {
+                if (*a < *b) {
+                    if (keep.first_only_) out.push_back(*a);
+                    ++a;
+                } else if (*b < *a) {
+                    if (keep.second_only_) out.push_back(*b);
+                    ++b;
+                } else {
+                    if (keep.both_) out.push_back(*a);
+                    ++a;
+                    ++b;
+                }
+            }
+            if (keep.first_only_) out.insert(out.end(), a, a_end);
+            if (keep.second_only_) out.insert(out.end(), b, b_end);
+        }
+
+        /**
+         * Returns the first EPC not less than a key, searching exponentially
+         * growing steps from the first EPC and then bisecting the last step.
+         */
+        const Epc96 *gallop(const Epc96 *first, const Epc96 *last,
+                            const Epc96 &key) {
+            size_t step = 1;
+            while (step < static_cast<size_t>(last - first)
+                   && first[step] < key) {
+                first += step;
+                step <<= 1;
+            }
+            const Epc96 *bound = step < static_cast<size_t>(last - first)
+                ? first + step : last;
+            return std::lower_bound(first, bound, key);
+        }
+
+        /**
+         * Merges a small range into a large one by galloping the large one
+         * for each EPC of the small one.
+         */
+        void merge_galloping(const Epc96 *small, const Epc96 *small_end,
+                             const Epc96 *large, const Epc96 *large_end,
+                             bool keep_small_only, bool keep_large_only,
+                             bool keep_both, std::vector<Epc96> &out) {
+            for (; small != small_end && large != large_end; ++small) {
+                const Epc96 *p = gallop(large, large_end, *small);
+                if (keep_large_only) out.insert(out.end(), large, p);
+                bool found = p != large_end && *p == *small;
+                if (found ? keep_both : keep_small_only) out.push_back(*small);
+                large = found ? p + 1 : p;
+            }
+            if (keep_small_only) out.insert(out.end(), small, small_end);
+            if (keep_large_only) out.insert(out.end(), large, large_end);
+        }
+
+        void merge_range(const Epc96 *a, const Epc96 *a_end,
+                         const Epc96 *b, const Epc96 *b_end, Keep keep,
+                         std::vector<Epc96> &out) {
+            size_t a_size = a_end - a;
+            size_t b_size = b_end - b;
+            if (a_size * GALLOP_RATIO < b_size) {
+                merge_galloping(a, a_end, b, b_end, keep.first_only_,
+                                keep.second_only_, keep.both_, out);
+            } else if (b_size * GALLOP_RATIO < a_size) {
+                merge_galloping(b, b_end, a, a_end, keep.second_only_,
+                                keep.first_only_, keep.both_, out);
+            } else {
+                merge_linear(a, a_end, b, b_end, keep, out);
+            }
+        }
+
+        template <typename Function>
+        void run_parallel(size_t count, Function function) {
+            std::vector<std::thread> threads;
+            threads.reserve(count - 1);
+            for (size_t i = 1; i < count; i++) {
+                threads.emplace_back(function, i);
+            }
+            function(0);
+            for (std::thread &thread : threads) thread.join();
+        }
+
+        size_t get_thread_count(size_t size, unsigned int thread_count) {
+            size_t count = std::min<size_t>(thread_count,
+                                            size / MIN_PARALLEL_SIZE);
+            return std::max<size_t>(count, 1);
+        }
+    }
+
+    EpcSet EpcSet::create(std::vector<Epc96> epcs) {
+        EpcSet set;
+        radix_sort(epcs);
+        epcs.erase(std::unique(epcs.begin(), epcs.end()), epcs.end());
+        set.epcs_ = std::move(epcs);
+        return set;
+    }
+
+    EpcSet EpcSet::create(const Epc96 *epcs, size_t n) {
+        return create(std::vector<Epc96>(epcs, epcs + n));
+    }
+
+    EpcSet EpcSet::merge(const EpcSet &other, Operation operation,
+                         unsigned int thread_count) const {
+        Keep keep = Keep();
+        keep.first_only_ = operation != Operation::kIntersection;
+        keep.second_only_ = operation == Operation::kUnion;
+        keep.both_ = operation != Operation::kDifference;
+
+        const std::vector<Epc96> &a = epcs_;
+        const std::vector<Epc96> &b = other.epcs_;
+        const std::vector<Epc96> &larger = a.size() < b.size() ? b : a;
+        size_t count = get_thread_count(larger.size(), thread_count);
+
+        // Split both sets at EPCs of the larger one, so that equal EPCs
+        // fall in the same part.
+        std::vector<size_t> a_bounds(count + 1, a.size());
+        std::vector<size_t> b_bounds(count + 1, b.size());
+        a_bounds[0] = 0;
+        b_bounds[0] = 0;
+        for (size_t i = 1; i < count; i++) {
+            const Epc96 &split = larger[larger.size() * i / count];
+            a_bounds[i] = std::lower_bound(a.begin(), a.end(), split)
+                - a.begin();
+            b_bounds[i] = std::lower_bound(b.begin(), b.end(), split)
+                - b.begin();
+        }
+
+        std::vector<std::vector<Epc96>> parts(count);
+        run_parallel(count, [&](size_t i) {
+            const Epc96 *a_first = a.data() + a_bounds[i];
+            const Epc96 *a_last = a.data() + a_bounds[i + 1];
+            const Epc96 *b_first = b.data() + b_bounds[i];
+            const Epc96 *b_last = b.data() + b_bounds[i + 1];
+            size_t a_size = a_last - a_first;
+            size_t b_size = b_last - b_first;
+            std::vector<Epc96> &part = parts[i];
+            switch (operation) {
+            case Operation::kUnion:
+                part.reserve(a_size + b_size);
+                break;
+            case Operation::kIntersection:
+                part.reserve(std::min(a_size, b_size));
+                break;
+            case Operation::kDifference:
+                part.reserve(a_size);
+                break;
+            }
+            merge_range(a_first, a_last, b_first, b_last, keep, part);
+        });
+
+        EpcSet set;
+        if (count == 1) {
+            set.epcs_ = std::move(parts[0]);
+            set.epcs_.shrink_to_fit();
+            return set;
+        }
+        size_t size = 0;
+        for (const std::vector<Epc96> &part : parts) size += part.size();
+        set.epcs_.reserve(size);
+        for (const std::vector<Epc96> &part : parts) {
+            set.epcs_.insert(set.epcs_.end(), part.begin(), part.end());
+        }
+        return set;
+    }
+
+    EpcSet EpcSet::unite(const EpcSet &other,
+                         unsigned int thread_count) const {
+        return merge(other, Operation::kUnion, thread_count);
+    }
+
+    EpcSet EpcSet::intersect(const EpcSet &other,
+                             unsigned int thread_count) const {
+        return merge(other, Operation::kIntersection, thread_count);
+    }
+
+    EpcSet EpcSet::subtract(const EpcSet &other,
+                            unsigned int thread_count) const {
+        return merge(other, Operation::kDifference, thread_count);
+    }
+
+    bool EpcSet::contains(const Epc96 &epc) const {
+        return std::binary_search(epcs_.begin(), epcs_.end(), epc);
+    }
+
+    std::vector<std::string> EpcSet::render(bool tag_uri,
+                                            unsigned int thread_count) const {
+        std::vector<std::string> uris(epcs_.size());
+        size_t count = get_thread_count(epcs_.size(), thread_count);
+        run_parallel(count, [&](size_t i) {
+            size_t first = epcs_.size() * i / count;
+            size_t last = epcs_.size() * (i + 1) / count;
+            for (size_t j = first; j < last; j++) {
+                std::pair<Status, Tag> tag = Tag::createFromEpc96(epcs_[j]);
+                if (tag.first != Status::kOk) continue;
+                uris[j] = tag_uri ? tag.second.getTagURI()
+                                  : tag.second.getURI();
+            }
+        });
+        return uris;
+    }
+
+    std::vector<std::string> EpcSet::getURIs(
+        unsigned int thread_count) const {
+        return render(false, thread_count);
+    }
+
+    std::vector<std::string> EpcSet::getTagURIs(
+        unsigned int thread_count) const {
+        return render(true, thread_count);
+    }
+}
@@ -0,0 +1,154 @@
+#include "epc_view.h"
+#include "encode.h"
+
+#include <tuple>
+
+namespace epc {
+    namespace {
+        // Formats an integer padded with leading zeros to digits.
+        std::string format_integer(uint64_t value, unsigned int digits) {
+            std::string s = std::to_string(value);
+            lpad(s, digits, '0');
+            return s;
+        }
+    }
+
+    const Layout &EpcView::getLayout() const {
+        if (decoded_ & kLayout) return layout_;
+        decoded_ |= kLayout;
+        if (n_ < 2) return layout_;
+        Status status;
+        Layout layout;
+        std::tie(status, layout) = get_layout(
+            bytes_[0], static_cast<unsigned int>(
+                getBits(LAYOUT_PARTITION_OFFSET, 3)));
+        // The bits following the binary, if any, are ignored.
+        if (status == Status::kOk && n_ * 8 >= layout.bits_) {
+            layout_ = layout;
+            type_ = get_tag_type(bytes_[0]);
+        }
+        return layout_;
+    }
+
+    uint64_t EpcView::getBits(unsigned int offset, unsigned int length) const {
+        return get_bits(bytes_, offset, length);
+    }
+
+    std::string EpcView::getString(unsigned int offset,
+                                   unsigned int length) const {
+        std::string s;
+        for (unsigned int i = 0; i + LAYOUT_CHAR_BITS <= length;
+             i += LAYOUT_CHAR_BITS) {
+            char c = static_cast<char>(
+                getBits(offset + i, LAYOUT_CHAR_BITS));
+            if (c == 0) break;
+            s.push_back(c);
+        }
+        return s;
+    }
+
+    TagType EpcView::getType() const {
+        getLayout();
+        return type_;
+    }
+
+    unsigned int EpcView::getBitLength() const {
+        return getLayout().bits_;
+    }
+
+    unsigned int EpcView::getFilterValue() const {
+        if (getLayout().bits_ == 0) return 0;
+        return static_cast<unsigned int>(getBits(LAYOUT_FILTER_OFFSET, 3));
+    }
+
+    unsigned int EpcView::getPartition() const {
+        return getLayout().partition_;
+    }
+
+    const std::string &EpcView::getCompanyPrefix() const {
+        if (decoded_ & kCompanyPrefix) return company_prefix_;
+        decoded_ |= kCompanyPrefix;
+        const Layout &layout = getLayout();
+        if (layout.bits_ != 0) {
+            company_prefix_ = format_integer(
+                getBits(LAYOUT_COMPANY_PREFIX_OFFSET,
+                        layout.company_prefix_bits_),
+                layout.company_prefix_digits_);
+        }
+        return company_prefix_;
+    }
+
+    const std::string &EpcView::getReference() const {
+        if (decoded_ & kReference) return reference_;
+        decoded_ |= kReference;
+        const Layout &layout = getLayout();
+        if (layout.bits_ == 0) return reference_;
+        if (type_ != TagType::kGIAI) {
+            reference_ = format_integer(
+                getBits(layout.getReferenceOffset(), layout.reference_bits_),
+                layout.reference_digits_);
+        } else if (layout.bits_ == 96) {
+            // The asset reference of GIAI-96 isn't padded.
+            reference_ = std::to_string(
+                getBits(layout.getReferenceOffset(), layout.reference_bits_));
+        } else {
+            reference_ = getString(layout.getReferenceOffset(),
+                                   layout.reference_bits_);
+        }
+        return reference_;
+    }
+
+    const std::string &EpcView::getSerial() const {
+        if (decoded_ & kSerial) return serial_;
+        decoded_ |= kSerial;
+        const Layout &layout = getLayout();
+        if (layout.serial_bits_ == 0) return serial_;
+        if (layout.bits_ == 96) {
+            serial_ = std::to_string(
+                getBits(layout.getSerialOffset(), layout.serial_bits_));
+        } else {
+            serial_ = getString(layout.getSerialOffset(), layout.serial_bits_);
+        }
+        return serial_;
+    }
+
+    void EpcView::renderFields(std::string &uri) const {
+        uri += getCompanyPrefix();
+        uri += '.';
+        if (type_ == TagType::kGIAI) {
+            const std::string &reference = getReference();
+            append_uri_encoded(uri, reference.data(), reference.length());
+            return;
+        }
+        uri += getReference();
+        if (type_ != TagType::kSSCC) {
+            uri += '.';
+            const std::string &serial = getSerial();
+            append_uri_encoded(uri, serial.data(), serial.length());
+        }
+    }
+
+    std::string EpcView::getURI() const {
+        std::string uri;
+        if (getType() == TagType::kUnknown) return uri;
+        uri += "urn:epc:id:";
+        uri += get_tag_type_name(type_);
+        uri += ':';
+        renderFields(uri);
+        return uri;
+    }
+
+    std::string EpcView::getTagURI() const {
+        std::string uri;
+        if (getType() == TagType::kUnknown) return uri;
+        uri += "urn:epc:tag:";
+        uri += get_tag_type_name(type_);
+        uri += '-';
+        uri += std::to_string(layout_.bits_);
+        uri += ':';
+        uri += static_cast<char>('0' + getFilterValue());
+        uri += '.';
+        renderFields(uri);
+        return uri;
+    }
+}
@@ -0,0 +1,288 @@
+#include "gcp_table.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        constexpr char MAGIC[8] = {'E', 'P', 'C', 'G', 'C', 'P', 'L', 'T'};
+        constexpr uint32_t VERSION = 1;
+        constexpr size_t MAX_PREFIX_DIGITS = 12;
+        constexpr unsigned int MAX_LENGTH = 12;
+        // A word of a node holds the length of the prefix ending at the
+        // digit plus 1, or 0 if there's no such prefix, in the lower bits
+        // and the index of the next node, or 0 if there's none, in the
+        // upper bits. The root is never a next node.
+        constexpr unsigned int LENGTH_BITS = 4;
+        constexpr uint32_t LENGTH_MASK = (1U << LENGTH_BITS) - 1;
+        constexpr size_t MAX_NODE_COUNT = size_t(1) << (32 - LENGTH_BITS);
+
+        using FileHeader = struct FileHeaderStruct {
+            char magic_[8];
+            uint32_t version_;
+            uint32_t reserved_;
+            uint64_t node_count_;
+        };
+
+        bool is_digits(const std::string &s) {
+            for (char c : s) {
+                if (c < '0' || c > '9') return false;
+            }
+            return true;
+        }
+
+        // Returns the value of an attribute of an element, or false if it
+        // has no such attribute.
+        bool get_attribute(const std::string &element, const char *name,
+                           std::string *value) {
+            std::string key = std::string(" ") + name + "=\"";
+            size_t begin = element.find(key);
+            if (begin == std::string::npos) return false;
+            begin += key.length();
+            size_t end = element.find('"', begin);
+            if (end == std::string::npos) return false;
+            *value = element.substr(begin, end - begin);
+            return true;
+        }
+    }
+
+    GcpLengthTable::GcpLengthTable(GcpLengthTable &&other)
+        : nodes_(other.nodes_), node_count_(other.node_count_),
+          storage_(std::move(other.storage_)), mapping_(other.mapping_),
+          mapping_length_(other.mapping_length_) {
+        other.nodes_ = nullptr;
+        other.node_count_ = 0;
+        other.mapping_ = nullptr;
+        other.mapping_length_ = 0;
+    }
+
+    GcpLengthTable &GcpLengthTable::operator=(GcpLengthTable &&other) {
+        if (this != &other) {
+            close();
+            nodes_ = other.nodes_;
+            node_count_ = other.node_count_;
+            storage_ = std::move(other.storage_);
+            mapping_ = other.mapping_;
+            mapping_length_ = other.mapping_length_;
+            other.nodes_ = nullptr;
+            other.node_count_ = 0;
+            other.mapping_ = nullptr;
+            other.mapping_length_ = 0;
+        }
+        return *this;
+    }
+
+    GcpLengthTable::~GcpLengthTable() {
+        close();
+    }
+
+    void GcpLengthTable::close() {
+        if (mapping_) ::munmap(mapping_, mapping_length_);
+        mapping_ = nullptr;
+        mapping_length_ = 0;
+        nodes_ = nullptr;
+        node_count_ = 0;
+        storage_.clear();
+    }
+
+    std::pair<Status, GcpLengthTable> GcpLengthTable::create(
+        const std::vector<Entry> &entries) {
+        GcpLengthTable table;
+        std::vector<uint32_t> &nodes = table.storage_;
+        nodes.assign(NODE_WORDS, 0);
+        for (const Entry &entry : entries) {
+            const std::string &prefix = entry.prefix_;
+            if (prefix.empty() || prefix.length() > MAX_PREFIX_DIGITS
+                || !is_digits(prefix) || entry.length_ > MAX_LENGTH) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      GcpLengthTable());
+            }
+            size_t node = 0;
+            for (size_t i = 0;; i++) {
+                size_t word = node * NODE_WORDS + (prefix[i] - '0');
+                if (i + 1 == prefix.length()) {
+                    nodes[word] = (nodes[word] & ~LENGTH_MASK)
+                        | (entry.length_ + 1);
+                    break;
+                }
+                size_t next = nodes[word] >> LENGTH_BITS;
+                if (next == 0) {
+                    next = nodes.size() / NODE_WORDS;
+                    if (next >= MAX_NODE_COUNT) {
+                        return std::make_pair(Status::kInvalidArgument,
+                                              GcpLengthTable());
+                    }
+                    nodes.resize(nodes.size() + NODE_WORDS, 0);
+                    nodes[word] |= static_cast<uint32_t>(next) << LENGTH_BITS;
+                }
+                node = next;
+            }
+        }
+        table.nodes_ = nodes.data();
+        table.node_count_ = nodes.size() / NODE_WORDS;
+        return std::make_pair(Status::kOk, std::move(table));
+    }
+
+    std::pair<Status, GcpLengthTable> GcpLengthTable::createFromFormatList(
+        const std::string &path) {
+        std::ifstream is(path, std::ios::binary);
+        if (!is) {
+            return std::make_pair(Status::kInvalidArgument, GcpLengthTable());
+        }
+        std::string xml((std::istreambuf_iterator<char>(is)),
+                        std::istreambuf_iterator<char>());
+        std::vector<Entry> entries;
+        for (size_t pos = xml.find("<entry "); pos != std::string::npos;
+             pos = xml.find("<entry ", pos)) {
+            size_t end = xml.find('>', pos);
+            if (end == std::string::npos) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      GcpLengthTable());
+            }
+            std::string element = xml.substr(pos, end - pos);
+            std::string length;
+            Entry entry;
+            if (!get_attribute(element, "prefix", &entry.prefix_)
+                || !get_attribute(element, "gcpLength", &length)
+                || length.empty() || length.length() > 2
+                || !is_digits(length)) {
+                return std::make_pair(Status::kInvalidArgument,
+                                      GcpLengthTable());
+            }
+            entry.length_ = static_cast<unsigned int>(std::stoi(length));
+            entries.push_back(entry);
+            pos = end;
+        }
+        return create(entries);
+    }
+
+    std::pair<Status, GcpLengthTable> GcpLengthTable::open(
+        const std::string &path) {
+        GcpLengthTable table;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::make_pair(Status::kInvalidArgument, std::move(table));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) < 0
+            || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            return std::make_pair(Status::kInvalidArgument, std::move(table));
+        }
+        void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return std::make_pair(Status::kInvalidArgument, std::move(table));
+        }
+        table.mapping_ = data;
+        table.mapping_length_ = st.st_size;
+
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        size_t words = (st.st_size - sizeof(FileHeader)) / sizeof(uint32_t);
+        if (std::memcmp(header.magic_, MAGIC, sizeof(MAGIC)) != 0
+            || header.version_ != VERSION || header.node_count_ == 0
+            || header.node_count_ > MAX_NODE_COUNT
+            || (st.st_size - sizeof(FileHeader)) % sizeof(uint32_t) != 0
+            || header.node_count_ * NODE_WORDS != words) {
+            table.close();
+            return std::make_pair(Status::kInvalidArgument, std::move(table));
+        }
+        const uint32_t *nodes = reinterpret_cast<const uint32_t *>(
+            static_cast<const char *>(data) + sizeof(FileHeader));
+        // Lookups follow next nodes without checking them.
+        for (size_t i = 0; i < words; i++) {
+            if ((nodes[i] >> LENGTH_BITS) >= header.node_count_
+                || (nodes[i] & LENGTH_MASK) > MAX_LENGTH + 1) {
+                table.close();
+                return std::make_pair(Status::kInvalidArgument,
+                                      std::move(table));
+            }
+        }
+        table.nodes_ = nodes;
+        table.node_count_ = header.node_count_;
+        return std::make_pair(Status::kOk, std::move(table));
+    }
+
+    Status GcpLengthTable::write(const std::string &path) const {
+        FileHeader header = FileHeader();
+        std::memcpy(header.magic_, MAGIC, sizeof(MAGIC));
+        header.version_ = VERSION;
+        header.node_count_ = node_count_;
+        if (node_count_ == 0) return Status::kInvalidArgument;
+        // The table is written to a temporary file renamed over the path,
+        // since truncating a file in place fails reads of its mappings by
+        // open() with SIGBUS.
+        std::string temp_path = path + ".XXXXXX";
+        int fd = ::mkstemp(&temp_path[0]);
+        if (fd < 0) return Status::kInvalidArgument;
+        bool ok = ::fchmod(fd, 0644) == 0;
+        ::close(fd);
+        if (ok) {
+            std::ofstream os(temp_path, std::ios::binary | std::ios::trunc);
+            os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            os.write(reinterpret_cast<const char *>(nodes_),
+                     node_count_ * NODE_WORDS * sizeof(uint32_t));
+            os.close();
+            ok = !os.fail();
+        }
+        if (!ok || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            return Status::kInvalidArgument;
+        }
+        return Status::kOk;
+    }
+
+    unsigned int GcpLengthTable::lookup(const char *digits, size_t n) const {
+        if (nodes_ == nullptr) return 0;
+        if (n > MAX_PREFIX_DIGITS) n = MAX_PREFIX_DIGITS;
+        uint32_t length = 0;
+        size_t node = 0;
+        for (size_t i = 0; i < n; i++) {
+            unsigned int digit = static_cast<unsigned char>(digits[i]) - '0';
+            if (digit > 9) break;
+            uint32_t word = nodes_[node * NODE_WORDS + digit];
+            if ((word & LENGTH_MASK) != 0) length = word & LENGTH_MASK;
+            node = word >> LENGTH_BITS;
+            if (node == 0) break;
+        }
+        return length == 0 ? 0 : length - 1;
+    }
+
+    std::shared_ptr<const GcpLengthTable> AtomicGcpLengthTable::get() const {
+        return std::atomic_load(&table_);
+    }
+
+    void AtomicGcpLengthTable::set(
+        std::shared_ptr<const GcpLengthTable> table) {
+        std::atomic_store(&table_, std::move(table));
+    }
+
+    Status AtomicGcpLengthTable::reload(const std::string &path) {
+        Status status;
+        GcpLengthTable table;
+        std::tie(status, table) = GcpLengthTable::open(path);
+        if (status != Status::kOk) {
+            std::tie(status, table) =
+                GcpLengthTable::createFromFormatList(path);
+            if (status != Status::kOk) return status;
+        }
+        set(std::make_shared<const GcpLengthTable>(std::move(table)));
+        return Status::kOk;
+    }
+
+    unsigned int AtomicGcpLengthTable::lookup(const char *digits,
+                                              size_t n) const {
+        std::shared_ptr<const GcpLengthTable> table = get();
+        return table ? table->lookup(digits, n) : 0;
+    }
+}
@@ -47,7 +47,7 @@ namespace epc {
         GIAI giai;
         std::smatch m;
         if (std::regex_match(uri, m, std::regex(URI_RE))) {
-            return create(m[1].str(), m[2].str());
+            return create(m[1].str(), uri_decode(m[2].str()));
         }
         return std::make_pair(Status::kInvalidArgument, giai);
     }
@@ -105,7 +105,7 @@ namespace epc {
 
     GIAI::PartitionTable GIAI::getPartitionTable(
         GIAI::Scheme scheme, unsigned int partition) {
-        if (scheme == GIAI::Scheme::kGIAI202) {
+        if (scheme == GIAI::Scheme::kGIAI96) {
             for (int i = 0; i < PARTITION_TABLE_SIZE; i++) {
                 if (partition
                     == GIAI96_PARTITION_TABLE[i].partition_) {
@@ -150,10 +150,16 @@ namespace epc {
         }
         unsigned int filter = decode_integer(read_string(ss, 3));
         unsigned int partition = decode_integer(read_string(ss, 3));
+        if (partition >= PARTITION_TABLE_SIZE) {
+            return std::make_pair(Status::kInvalidArgument, giai);
+        }
         PartitionTable table = getPartitionTable(scheme, partition);
         std::string company_prefix = std::to_string(
             decode_integer(read_string(ss, table.company_prefix_bits_)));
         lpad(company_prefix, table.company_prefix_digits_, '0');
+        if (company_prefix.length() != table.company_prefix_digits_) {
+            return std::make_pair(Status::kInvalidArgument, giai);
+        }
         std::string asset_ref;
         if (scheme == Scheme::kGIAI96) {
             asset_ref = std::to_string(
@@ -201,13 +207,18 @@ namespace epc {
     }
 
     Status GIAI::validateAssetReferenceForBinaryCoding() const {
+        PartitionTable table = getPartitionTable(scheme_, company_prefix_);
         if (scheme_ == Scheme::kGIAI96) {
-            if (is_padded_numbers(asset_ref_)) {
+            if (is_integer_at_most(
+                    asset_ref_, (1ULL << table.asset_ref_bits_) - 1)) {
                 return Status::kOk;
             }
         } else {
+            // Fewer characters than MAX_ASSET_REFERENCE_LENGTH fit in the
+            // longer company prefixes.
             if (is_serial(asset_ref_)
-                && asset_ref_.length() <= MAX_ASSET_REFERENCE_LENGTH) {
+                && asset_ref_.length() <= MAX_ASSET_REFERENCE_LENGTH
+                && asset_ref_.length() * 7 <= table.asset_ref_bits_) {
                 return Status::kOk;
             }
         }
@@ -215,10 +226,13 @@ namespace epc {
     }
 
     std::pair<Status, std::string> GIAI::getBinary() const {
+        PartitionTable table = getPartitionTable(scheme_, company_prefix_);
+        if (table.company_prefix_digits_ != company_prefix_.length()) {
+            return std::make_pair(Status::kInvalidArgument, "");
+        }
         Status status = validateAssetReferenceForBinaryCoding();
         if (status != Status::kOk) return std::make_pair(status, "");
         std::stringstream ss;
-        PartitionTable table = getPartitionTable(scheme_, company_prefix_);
         if (scheme_ == Scheme::kGIAI96) {
             ss << GIAI96_HEADER;
         } else {
@@ -226,10 +240,10 @@ namespace epc {
         }
         ss << encode_integer(getFilterValue(), FILTER_VALUE_BITS);
         ss << encode_integer(table.partition_, PARTITION_BITS);
-        ss << encode_integer(std::stoi(company_prefix_),
+        ss << encode_integer(std::stoll(company_prefix_),
                              table.company_prefix_bits_);
         if (scheme_ == Scheme::kGIAI96) {
-            ss << encode_integer(std::stoi(asset_ref_),
+            ss << encode_integer(std::stoll(asset_ref_),
                                  table.asset_ref_bits_);
         } else {
             ss << encode_string(asset_ref_, table.asset_ref_bits_);
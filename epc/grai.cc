@@ -92,6 +92,9 @@ namespace epc {
         }
         unsigned int filter = decode_integer(read_string(ss, 3));
         unsigned int partition = decode_integer(read_string(ss, 3));
+        if (partition >= PARTITION_TABLE_SIZE) {
+            return std::make_pair(Status::kInvalidArgument, grai);
+        }
         PartitionTable table = getPartitionTable(partition);
         std::string company_prefix = std::to_string(
             decode_integer(read_string(ss, table.company_prefix_bits_)));
@@ -185,8 +188,7 @@ namespace epc {
 
     Status GRAI::validateSerialForBinaryCoding() const {
         if (scheme_ == Scheme::kGRAI96) {
-            if (is_padded_numbers(serial_)
-                && std::stoll(serial_, nullptr, 10) <= MAX_GRAI96_SERIAL) {
+            if (is_integer_at_most(serial_, MAX_GRAI96_SERIAL)) {
                 return Status::kOk;
             }
         } else {
@@ -199,10 +201,13 @@ namespace epc {
     }
 
     std::pair<Status, std::string> GRAI::getBinary() const {
+        PartitionTable table = getPartitionTable(company_prefix_);
+        if (table.company_prefix_digits_ != company_prefix_.length()) {
+            return std::make_pair(Status::kInvalidArgument, "");
+        }
         Status status = validateSerialForBinaryCoding();
         if (status != Status::kOk) return std::make_pair(status, "");
         std::stringstream ss;
-        PartitionTable table = getPartitionTable(company_prefix_);
         if (scheme_ == Scheme::kGRAI96) {
             ss << GRAI96_HEADER;
         } else {
@@ -210,7 +215,7 @@ namespace epc {
         }
         ss << encode_integer(getFilterValue(), FILTER_VALUE_BITS);
         ss << encode_integer(table.partition_, PARTITION_BITS);
-        ss << encode_integer(std::stoi(company_prefix_),
+        ss << encode_integer(std::stoll(company_prefix_),
                              table.company_prefix_bits_);
         ss << encode_integer(std::stoi(asset_type_),
                              table.asset_type_bits_);
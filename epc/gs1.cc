@@ -0,0 +1,720 @@
+#include "gs1.h"
+#include "layout.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        // Long enough for any element string.
+        constexpr size_t MAX_ELEMENT_STRING_LENGTH = 64;
+        // The maximum number of digits of a 64-bit integer.
+        constexpr size_t MAX_INTEGER_DIGITS = 20;
+        // The maximum length of serials and extensions of all schemes.
+        constexpr size_t MAX_SERIAL_LENGTH = 20;
+        constexpr size_t GTIN_DATA_DIGITS = 13;
+        constexpr size_t SSCC_DATA_DIGITS = 17;
+        constexpr size_t GLN_DATA_DIGITS = 12;
+        constexpr size_t GRAI_DATA_DIGITS = 12;
+        constexpr size_t MAX_GIAI_DIGITS = 30;
+
+        constexpr uint64_t ZEROS = 0x3030303030303030ULL;
+        constexpr uint64_t ONES = 0x0101010101010101ULL;
+        // The bytes of the odd indices of 8 chars loaded into a word.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        constexpr uint64_t ODD_BYTES = 0x00FF00FF00FF00FFULL;
+#else
+        constexpr uint64_t ODD_BYTES = 0xFF00FF00FF00FF00ULL;
+#endif
+
+        using Fields = struct FieldsStruct {
+            TagType type_;
+            const char *company_prefix_;
+            size_t company_prefix_length_;
+            const char *reference_;
+            size_t reference_length_;
+            const char *serial_;
+            size_t serial_length_;
+        };
+
+        char *append(char *out, const char *s, size_t n) {
+            std::memcpy(out, s, n);
+            return out + n;
+        }
+
+        char *append(char *out, const char *s) {
+            return append(out, s, std::strlen(s));
+        }
+
+        // Writes the key, or with element_string the element string, of
+        // fields to out of MAX_ELEMENT_STRING_LENGTH chars.
+        // Returns the length, or 0 if the fields don't make a key.
+        size_t render(const Fields &f, bool element_string, char *out) {
+            char *p = out;
+            size_t digits = f.company_prefix_length_ + f.reference_length_;
+            switch (f.type_) {
+            case TagType::kSGTIN:
+            case TagType::kSSCC: {
+                bool sgtin = f.type_ == TagType::kSGTIN;
+                if (f.reference_length_ == 0
+                    || digits != (sgtin ? GTIN_DATA_DIGITS
+                                        : SSCC_DATA_DIGITS)) {
+                    return 0;
+                }
+                if (element_string) p = append(p, sgtin ? "(01)" : "(00)");
+                // The indicator or extension digit leads the key.
+                char *key = p;
+                *p++ = f.reference_[0];
+                p = append(p, f.company_prefix_, f.company_prefix_length_);
+                p = append(p, f.reference_ + 1, f.reference_length_ - 1);
+                *p = static_cast<char>('0' + get_check_digit(key, digits));
+                p++;
+                if (sgtin && element_string) {
+                    p = append(p, "(21)");
+                    p = append(p, f.serial_, f.serial_length_);
+                }
+                break;
+            }
+            case TagType::kSGLN:
+            case TagType::kGRAI: {
+                bool sgln = f.type_ == TagType::kSGLN;
+                if (digits != (sgln ? GLN_DATA_DIGITS : GRAI_DATA_DIGITS)) {
+                    return 0;
+                }
+                if (element_string) p = append(p, sgln ? "(414)" : "(8003)");
+                if (!sgln) *p++ = '0';
+                char *key = p;
+                p = append(p, f.company_prefix_, f.company_prefix_length_);
+                p = append(p, f.reference_, f.reference_length_);
+                *p = static_cast<char>('0' + get_check_digit(key, digits));
+                p++;
+                // The extension "0" means no extension.
+                bool extension = f.serial_length_ != 1 || f.serial_[0] != '0';
+                if (!sgln) {
+                    p = append(p, f.serial_, f.serial_length_);
+                } else if (element_string && extension) {
+                    p = append(p, "(254)");
+                    p = append(p, f.serial_, f.serial_length_);
+                }
+                break;
+            }
+            case TagType::kGIAI:
+                if (digits > MAX_GIAI_DIGITS) return 0;
+                if (element_string) p = append(p, "(8004)");
+                p = append(p, f.company_prefix_, f.company_prefix_length_);
+                p = append(p, f.reference_, f.reference_length_);
+                break;
+            default:
+                return 0;
+            }
+            return static_cast<size_t>(p - out);
+        }
+
+        std::pair<Status, std::string> render(
+            TagType type, const std::string &company_prefix,
+            const std::string &reference, const std::string &serial,
+            bool element_string) {
+            // Fields longer than any key are rejected before rendering.
+            if (company_prefix.length() + reference.length()
+                    > MAX_GIAI_DIGITS
+                || serial.length() > MAX_SERIAL_LENGTH) {
+                return std::make_pair(Status::kInvalidArgument, "");
+            }
+            Fields f = {
+                type,
+                company_prefix.data(), company_prefix.length(),
+                reference.data(), reference.length(),
+                serial.data(), serial.length(),
+            };
+            char out[MAX_ELEMENT_STRING_LENGTH];
+            size_t length = render(f, element_string, out);
+            if (length == 0) {
+                return std::make_pair(Status::kInvalidArgument, "");
+            }
+            return std::make_pair(Status::kOk, std::string(out, length));
+        }
+
+        // Formats an integer of at least digits, padded with leading zeros,
+        // to the end of out of MAX_INTEGER_DIGITS chars.
+        // Returns the first char.
+        char *format_integer(uint64_t value, size_t digits, char *end) {
+            char *p = end;
+            do {
+                *--p = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            while (static_cast<size_t>(end - p) < digits) *--p = '0';
+            return p;
+        }
+
+        size_t render(const Epc96 &epc, bool element_string, char *out) {
+            Status status;
+            Layout layout;
+            std::tie(status, layout) = get_layout(epc);
+            if (status != Status::kOk) return 0;
+            char company_prefix[MAX_INTEGER_DIGITS];
+            char reference[MAX_INTEGER_DIGITS];
+            char serial[MAX_INTEGER_DIGITS];
+            char *cp_end = company_prefix + MAX_INTEGER_DIGITS;
+            char *ref_end = reference + MAX_INTEGER_DIGITS;
+            char *serial_end = serial + MAX_INTEGER_DIGITS;
+            char *cp = format_integer(
+                epc.getBits(LAYOUT_COMPANY_PREFIX_OFFSET,
+                            layout.company_prefix_bits_),
+                layout.company_prefix_digits_, cp_end);
+            if (static_cast<size_t>(cp_end - cp)
+                != layout.company_prefix_digits_) {
+                return 0;
+            }
+            uint64_t ref_value = epc.getBits(layout.getReferenceOffset(),
+                                             layout.reference_bits_);
+            TagType type = get_tag_type(layout.header_);
+            // The asset reference of GIAI isn't padded.
+            char *ref = format_integer(
+                ref_value,
+                type == TagType::kGIAI ? 0 : layout.reference_digits_,
+                ref_end);
+            char *s = serial_end;
+            if (layout.serial_bits_ != 0) {
+                s = format_integer(epc.getBits(layout.getSerialOffset(),
+                                               layout.serial_bits_),
+                                   0, serial_end);
+            }
+            Fields f = {
+                type,
+                cp, static_cast<size_t>(cp_end - cp),
+                ref, static_cast<size_t>(ref_end - ref),
+                s, static_cast<size_t>(serial_end - s),
+            };
+            return render(f, element_string, out);
+        }
+
+        std::pair<Status, std::string> render(const Epc96 &epc,
+                                              bool element_string) {
+            char out[MAX_ELEMENT_STRING_LENGTH];
+            size_t length = render(epc, element_string, out);
+            if (length == 0) {
+                return std::make_pair(Status::kInvalidArgument, "");
+            }
+            return std::make_pair(Status::kOk, std::string(out, length));
+        }
+
+        std::pair<Status, std::string> render(const Tag &tag,
+                                              bool element_string) {
+            switch (tag.getType()) {
+            case TagType::kSGTIN:
+                return element_string ? get_element_string(tag.getSGTIN())
+                                      : get_gs1_key(tag.getSGTIN());
+            case TagType::kSSCC:
+                return element_string ? get_element_string(tag.getSSCC())
+                                      : get_gs1_key(tag.getSSCC());
+            case TagType::kSGLN:
+                return element_string ? get_element_string(tag.getSGLN())
+                                      : get_gs1_key(tag.getSGLN());
+            case TagType::kGRAI:
+                return element_string ? get_element_string(tag.getGRAI())
+                                      : get_gs1_key(tag.getGRAI());
+            case TagType::kGIAI:
+                return element_string ? get_element_string(tag.getGIAI())
+                                      : get_gs1_key(tag.getGIAI());
+            default:
+                return std::make_pair(Status::kInvalidArgument, "");
+            }
+        }
+
+        size_t render(const Epc96 *epcs, size_t n, bool element_string,
+                      std::string &buffer, size_t *offsets) {
+            buffer.clear();
+            offsets[0] = 0;
+            size_t count = 0;
+            char out[MAX_ELEMENT_STRING_LENGTH];
+            for (size_t i = 0; i < n; i++) {
+                size_t length = render(epcs[i], element_string, out);
+                if (length != 0) {
+                    buffer.append(out, length);
+                    count++;
+                }
+                offsets[i + 1] = buffer.size();
+            }
+            return count;
+        }
+
+        constexpr char GS = '\x1D';
+        constexpr unsigned int BITS = 96;
+        // The maximum number of digits of an integer field of 96 bits.
+        constexpr size_t MAX_FIELD_DIGITS = 19;
+        constexpr size_t MAX_GRAI_SERIAL_LENGTH = 16;
+
+        using ApplicationIdentifier = struct ApplicationIdentifierStruct {
+            const char *ai_;
+            /** The fixed length of the data, or 0 if variable */
+            size_t length_;
+            size_t max_length_;
+        };
+
+        // In the order of ElementStrings.
+        const ApplicationIdentifier AIS[] = {
+            {"00", SSCC_DATA_DIGITS + 1, SSCC_DATA_DIGITS + 1},
+            {"01", GTIN_DATA_DIGITS + 1, GTIN_DATA_DIGITS + 1},
+            {"21", 0, MAX_SERIAL_LENGTH},
+            {"414", GLN_DATA_DIGITS + 1, GLN_DATA_DIGITS + 1},
+            {"254", 0, MAX_SERIAL_LENGTH},
+            {"8003", 0, GRAI_DATA_DIGITS + 2 + MAX_GRAI_SERIAL_LENGTH},
+            {"8004", 0, MAX_GIAI_DIGITS},
+        };
+        constexpr size_t AI_COUNT = sizeof(AIS) / sizeof(AIS[0]);
+
+        // Data of the application identifiers, indexed as AIS.
+        using ElementStrings = struct ElementStringsStruct {
+            std::string data_[AI_COUNT];
+            bool present_[AI_COUNT];
+        };
+
+        bool is_digits(const char *s, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                if (s[i] < '0' || s[i] > '9') return false;
+            }
+            return true;
+        }
+
+        // Finds the application identifier at the start of s.
+        const ApplicationIdentifier *find_ai(const std::string &s,
+                                             size_t pos) {
+            for (const ApplicationIdentifier &ai : AIS) {
+                if (s.compare(pos, std::strlen(ai.ai_), ai.ai_) == 0) {
+                    return &ai;
+                }
+            }
+            return nullptr;
+        }
+
+        bool add_element(const ApplicationIdentifier *ai,
+                         const std::string &data, ElementStrings &elements) {
+            size_t i = static_cast<size_t>(ai - AIS);
+            if (elements.present_[i] || data.empty()
+                || data.length() > ai->max_length_
+                || (ai->length_ != 0 && data.length() != ai->length_)) {
+                return false;
+            }
+            elements.data_[i] = data;
+            elements.present_[i] = true;
+            return true;
+        }
+
+        bool split_parenthesized(const std::string &s,
+                                 ElementStrings &elements) {
+            size_t pos = 0;
+            while (pos < s.length()) {
+                if (s[pos] != '(') return false;
+                size_t close = s.find(')', pos);
+                if (close == std::string::npos) return false;
+                const ApplicationIdentifier *ai = find_ai(s, pos + 1);
+                if (ai == nullptr
+                    || close != pos + 1 + std::strlen(ai->ai_)) {
+                    return false;
+                }
+                size_t end = std::min(s.find('(', close), s.length());
+                if (!add_element(ai, s.substr(close + 1, end - close - 1),
+                                 elements)) {
+                    return false;
+                }
+                pos = end;
+            }
+            return true;
+        }
+
+        bool split_raw(const std::string &s, ElementStrings &elements) {
+            size_t pos = 0;
+            // A symbology identifier and FNC1 in the first position.
+            if (s.length() >= 3 && s[0] == ']') pos = 3;
+            if (pos < s.length() && s[pos] == GS) pos++;
+            while (pos < s.length()) {
+                const ApplicationIdentifier *ai = find_ai(s, pos);
+                if (ai == nullptr) return false;
+                pos += std::strlen(ai->ai_);
+                size_t end = ai->length_ != 0
+                    ? std::min(pos + ai->length_, s.length())
+                    : std::min(s.find(GS, pos), s.length());
+                if (!add_element(ai, s.substr(pos, end - pos), elements)) {
+                    return false;
+                }
+                pos = end;
+                // GS may follow fields of fixed length too.
+                if (pos < s.length() && s[pos] == GS) pos++;
+            }
+            return true;
+        }
+
+        bool has_valid_check_digit(const std::string &key, size_t digits) {
+            return is_digits(key.data(), digits + 1)
+                && key[digits] - '0' == static_cast<int>(
+                    get_check_digit(key.data(), digits));
+        }
+
+        // Returns the length of the company prefix at the start of n
+        // digits, or 0 if it's unknown or invalid.
+        size_t lookup_company_prefix(const CompanyPrefixLength &lookup,
+                                     const char *digits, size_t n) {
+            size_t length = lookup(digits, n);
+            if (length < LAYOUT_MIN_COMPANY_PREFIX_DIGITS
+                || length > LAYOUT_MAX_COMPANY_PREFIX_DIGITS || length > n
+                || !is_digits(digits, length)) {
+                return 0;
+            }
+            return length;
+        }
+
+        // The fields of an EPC of an element string.
+        using Key = struct KeyStruct {
+            TagType type_;
+            std::string company_prefix_;
+            std::string reference_;
+            std::string serial_;
+        };
+
+        std::pair<Status, Key> parse_key(
+            const std::string &element_string,
+            const CompanyPrefixLength &company_prefix_length) {
+            ElementStrings e = ElementStrings();
+            bool parsed = !element_string.empty() && element_string[0] == '('
+                ? split_parenthesized(element_string, e)
+                : split_raw(element_string, e);
+            Key key = Key();
+            if (!parsed) return std::make_pair(Status::kInvalidArgument, key);
+
+            // The application identifiers present, as bits of AIS.
+            unsigned int present = 0;
+            for (size_t i = 0; i < AI_COUNT; i++) {
+                if (e.present_[i]) present |= 1U << i;
+            }
+            const std::string *data = nullptr;
+            size_t cp = 0;
+            switch (present) {
+            case 1U << 0:
+            case 1U << 1 | 1U << 2: {
+                // SSCC, or GTIN and serial, with a leading digit.
+                bool sscc = present == 1U << 0;
+                data = &e.data_[sscc ? 0 : 1];
+                size_t digits = data->length() - 1;
+                if (!has_valid_check_digit(*data, digits)) break;
+                cp = lookup_company_prefix(company_prefix_length,
+                                           data->data() + 1, digits - 1);
+                if (cp == 0) break;
+                key.type_ = sscc ? TagType::kSSCC : TagType::kSGTIN;
+                key.company_prefix_ = data->substr(1, cp);
+                key.reference_ = data->substr(0, 1)
+                    + data->substr(1 + cp, digits - 1 - cp);
+                if (!sscc) key.serial_ = e.data_[2];
+                return std::make_pair(Status::kOk, key);
+            }
+            case 1U << 3:
+            case 1U << 3 | 1U << 4: {
+                data = &e.data_[3];
+                if (!has_valid_check_digit(*data, GLN_DATA_DIGITS)) break;
+                cp = lookup_company_prefix(company_prefix_length,
+                                           data->data(), GLN_DATA_DIGITS);
+                if (cp == 0) break;
+                key.type_ = TagType::kSGLN;
+                key.company_prefix_ = data->substr(0, cp);
+                key.reference_ = data->substr(cp, GLN_DATA_DIGITS - cp);
+                key.serial_ = e.present_[4] ? e.data_[4] : "0";
+                return std::make_pair(Status::kOk, key);
+            }
+            case 1U << 5: {
+                // A padding zero, GRAI and serial.
+                data = &e.data_[5];
+                if (data->length() <= GRAI_DATA_DIGITS + 2
+                    || (*data)[0] != '0'
+                    || !has_valid_check_digit(data->substr(1),
+                                              GRAI_DATA_DIGITS)) {
+                    break;
+                }
+                cp = lookup_company_prefix(company_prefix_length,
+                                           data->data() + 1,
+                                           GRAI_DATA_DIGITS);
+                if (cp == 0) break;
+                key.type_ = TagType::kGRAI;
+                key.company_prefix_ = data->substr(1, cp);
+                key.reference_ = data->substr(1 + cp, GRAI_DATA_DIGITS - cp);
+                key.serial_ = data->substr(GRAI_DATA_DIGITS + 2);
+                return std::make_pair(Status::kOk, key);
+            }
+            case 1U << 6: {
+                data = &e.data_[6];
+                cp = lookup_company_prefix(company_prefix_length,
+                                           data->data(), data->length());
+                if (cp == 0) break;
+                key.type_ = TagType::kGIAI;
+                key.company_prefix_ = data->substr(0, cp);
+                key.reference_ = data->substr(cp);
+                return std::make_pair(Status::kOk, key);
+            }
+            default:
+                break;
+            }
+            return std::make_pair(Status::kInvalidArgument, Key());
+        }
+
+        // Sets the scheme of 96 bits if the EPC is encoded in it, or
+        // otherwise the longer scheme.
+        template <typename T, typename Scheme>
+        Status set_scheme(T &epc, Scheme scheme96, Scheme scheme,
+                          Status (T::*setter)(Scheme)) {
+            Status status = (epc.*setter)(scheme96);
+            if (status == Status::kOk && epc.getBinary().first != Status::kOk) {
+                status = (epc.*setter)(scheme);
+            }
+            return status;
+        }
+
+        template <typename T>
+        std::pair<Status, Tag> make_tag(std::pair<Status, T> created,
+                                        unsigned int filter) {
+            Status status = created.first;
+            if (status == Status::kOk) {
+                status = created.second.setFilterValue(filter);
+            }
+            if (status != Status::kOk) return std::make_pair(status, Tag());
+            return std::make_pair(Status::kOk, Tag(created.second));
+        }
+
+        // Parses an integer without leading zeros, as encoded in binaries,
+        // of up to bits.
+        bool parse_integer(const std::string &s, unsigned int bits,
+                           uint64_t *value) {
+            if (s.empty() || s.length() > MAX_FIELD_DIGITS
+                || !is_digits(s.data(), s.length())
+                || (s[0] == '0' && s.length() > 1)) {
+                return false;
+            }
+            *value = std::stoull(s);
+            return bits >= 64 || *value >> bits == 0;
+        }
+
+        // Appends bits to the least significant end of an EPC.
+        void push_bits(uint32_t &high, uint64_t &low, unsigned int bits,
+                       uint64_t value) {
+            if (bits == 0) return;
+            high = static_cast<uint32_t>(
+                static_cast<uint64_t>(high) << bits | low >> (64 - bits));
+            low = low << bits | value;
+        }
+    }
+
+    unsigned int get_check_digit(const char *digits, size_t n) {
+        // Right-aligned so that the rightmost digit, weighted 3, has an odd
+        // index. Leading zeros don't change the sum.
+        char padded[MAX_CHECK_DIGIT_DIGITS];
+        std::memset(padded, '0', MAX_CHECK_DIGIT_DIGITS);
+        std::memcpy(padded + MAX_CHECK_DIGIT_DIGITS - n, digits, n);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < MAX_CHECK_DIGIT_DIGITS; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, padded + i, 8);
+            word -= ZEROS;
+            // Triple the digits of odd indices, which stay under 28 and
+            // leave bytes summing to under 256.
+            word += (word & ODD_BYTES) << 1;
+            sum += (word * ONES) >> 56;
+        }
+        return static_cast<unsigned int>((10 - sum % 10) % 10);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const Tag &tag) {
+        return render(tag, false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const SGTIN &sgtin) {
+        return render(TagType::kSGTIN, sgtin.getCompanyPrefix(),
+                      sgtin.getItemReferenceAndIndicator(),
+                      sgtin.getSerial(), false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const SSCC &sscc) {
+        return render(TagType::kSSCC, sscc.getCompanyPrefix(),
+                      sscc.getSerialReference(), "", false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const SGLN &sgln) {
+        return render(TagType::kSGLN, sgln.getCompanyPrefix(),
+                      sgln.getLocationReference(), sgln.getExtension(),
+                      false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const GRAI &grai) {
+        return render(TagType::kGRAI, grai.getCompanyPrefix(),
+                      grai.getAssetType(), grai.getSerial(), false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const GIAI &giai) {
+        return render(TagType::kGIAI, giai.getCompanyPrefix(),
+                      giai.getAssetReference(), "", false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const EpcView &view) {
+        return render(view.getType(), view.getCompanyPrefix(),
+                      view.getReference(), view.getSerial(), false);
+    }
+
+    std::pair<Status, std::string> get_gs1_key(const Epc96 &epc) {
+        return render(epc, false);
+    }
+
+    std::pair<Status, std::string> get_element_string(const Tag &tag) {
+        return render(tag, true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const SGTIN &sgtin) {
+        return render(TagType::kSGTIN, sgtin.getCompanyPrefix(),
+                      sgtin.getItemReferenceAndIndicator(),
+                      sgtin.getSerial(), true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const SSCC &sscc) {
+        return render(TagType::kSSCC, sscc.getCompanyPrefix(),
+                      sscc.getSerialReference(), "", true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const SGLN &sgln) {
+        return render(TagType::kSGLN, sgln.getCompanyPrefix(),
+                      sgln.getLocationReference(), sgln.getExtension(),
+                      true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const GRAI &grai) {
+        return render(TagType::kGRAI, grai.getCompanyPrefix(),
+                      grai.getAssetType(), grai.getSerial(), true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const GIAI &giai) {
+        return render(TagType::kGIAI, giai.getCompanyPrefix(),
+                      giai.getAssetReference(), "", true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const EpcView &view) {
+        return render(view.getType(), view.getCompanyPrefix(),
+                      view.getReference(), view.getSerial(), true);
+    }
+
+    std::pair<Status, std::string> get_element_string(const Epc96 &epc) {
+        return render(epc, true);
+    }
+
+    size_t get_gs1_keys(const Epc96 *epcs, size_t n, std::string &buffer,
+                        size_t *offsets) {
+        return render(epcs, n, false, buffer, offsets);
+    }
+
+    size_t get_element_strings(const Epc96 *epcs, size_t n,
+                               std::string &buffer, size_t *offsets) {
+        return render(epcs, n, true, buffer, offsets);
+    }
+
+    std::pair<Status, Tag> parse_element_string(
+        const std::string &element_string,
+        const CompanyPrefixLength &company_prefix_length,
+        unsigned int filter) {
+        Status status;
+        Key key;
+        std::tie(status, key) = parse_key(element_string,
+                                          company_prefix_length);
+        if (status != Status::kOk) return std::make_pair(status, Tag());
+        switch (key.type_) {
+        case TagType::kSGTIN: {
+            auto sgtin = SGTIN::create(key.company_prefix_, key.reference_,
+                                       key.serial_);
+            if (sgtin.first == Status::kOk) {
+                sgtin.first = set_scheme(sgtin.second,
+                                         SGTIN::Scheme::kSGTIN96,
+                                         SGTIN::Scheme::kSGTIN198,
+                                         &SGTIN::setSGTINScheme);
+            }
+            return make_tag(sgtin, filter);
+        }
+        case TagType::kSSCC:
+            return make_tag(SSCC::create(key.company_prefix_, key.reference_),
+                            filter);
+        case TagType::kSGLN: {
+            auto sgln = SGLN::create(key.company_prefix_, key.reference_,
+                                     key.serial_);
+            if (sgln.first == Status::kOk) {
+                sgln.first = set_scheme(sgln.second, SGLN::Scheme::kSGLN96,
+                                        SGLN::Scheme::kSGLN195,
+                                        &SGLN::setSGLNScheme);
+            }
+            return make_tag(sgln, filter);
+        }
+        case TagType::kGRAI: {
+            auto grai = GRAI::create(key.company_prefix_, key.reference_,
+                                     key.serial_);
+            if (grai.first == Status::kOk) {
+                grai.first = set_scheme(grai.second, GRAI::Scheme::kGRAI96,
+                                        GRAI::Scheme::kGRAI170,
+                                        &GRAI::setGRAIScheme);
+            }
+            return make_tag(grai, filter);
+        }
+        case TagType::kGIAI: {
+            auto giai = GIAI::create(key.company_prefix_, key.reference_);
+            if (giai.first == Status::kOk) {
+                giai.first = set_scheme(giai.second, GIAI::Scheme::kGIAI96,
+                                        GIAI::Scheme::kGIAI202,
+                                        &GIAI::setGIAIScheme);
+            }
+            return make_tag(giai, filter);
+        }
+        default:
+            return std::make_pair(Status::kInvalidArgument, Tag());
+        }
+    }
+
+    std::pair<Status, Epc96> parse_element_string_to_epc96(
+        const std::string &element_string,
+        const CompanyPrefixLength &company_prefix_length,
+        unsigned int filter) {
+        Status status;
+        Key key;
+        std::tie(status, key) = parse_key(element_string,
+                                          company_prefix_length);
+        if (status != Status::kOk || filter > EPC::MAX_FILTER_VALUE) {
+            return std::make_pair(Status::kInvalidArgument, Epc96());
+        }
+        uint8_t header = get_scheme_info(key.type_, 96)->header_;
+        Layout layout;
+        std::tie(status, layout) = get_layout(header, key.company_prefix_);
+        uint64_t company_prefix, reference, serial = 0;
+        // Only the asset reference of GIAI isn't padded.
+        if (status != Status::kOk
+            || key.reference_.length() > MAX_FIELD_DIGITS
+            || !is_digits(key.reference_.data(), key.reference_.length())
+            || (key.type_ == TagType::kGIAI
+                && !parse_integer(key.reference_, layout.reference_bits_,
+                                  &reference))
+            || (layout.serial_bits_ != 0
+                && !parse_integer(key.serial_, layout.serial_bits_,
+                                  &serial))) {
+            return std::make_pair(Status::kInvalidArgument, Epc96());
+        }
+        company_prefix = std::stoull(key.company_prefix_);
+        if (key.type_ != TagType::kGIAI) {
+            reference = key.reference_.empty()
+                ? 0 : std::stoull(key.reference_);
+        }
+        uint32_t high = 0;
+        uint64_t low = 0;
+        push_bits(high, low, LAYOUT_FILTER_OFFSET, header);
+        push_bits(high, low, LAYOUT_PARTITION_OFFSET - LAYOUT_FILTER_OFFSET,
+                  filter);
+        push_bits(high, low,
+                  LAYOUT_COMPANY_PREFIX_OFFSET - LAYOUT_PARTITION_OFFSET,
+                  layout.partition_);
+        push_bits(high, low, layout.company_prefix_bits_, company_prefix);
+        push_bits(high, low, layout.reference_bits_, reference);
+        push_bits(high, low, layout.serial_bits_, serial);
+        // The reserved bits of SSCC.
+        push_bits(high, low, BITS - layout.getSerialOffset()
+                  - layout.serial_bits_, 0);
+        return std::make_pair(Status::kOk, Epc96(high, low));
+    }
+}
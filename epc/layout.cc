@@ -0,0 +1,100 @@
+#include "layout.h"
+#include "sgtin.h"
+#include "sscc.h"
+#include "sgln.h"
+#include "grai.h"
+#include "giai.h"
+#include "tag.h"
+
+#include <tuple>
+
+namespace epc {
+    std::pair<Status, Layout> get_layout(uint8_t header,
+                                         unsigned int partition) {
+        Layout layout = Layout();
+        const SchemeInfo *scheme = get_scheme_info(header);
+        if (scheme == nullptr || partition > LAYOUT_MAX_PARTITION) {
+            return std::make_pair(Status::kInvalidArgument, layout);
+        }
+        layout.header_ = header;
+        layout.bits_ = scheme->bits_;
+        layout.partition_ = partition;
+        bool is96 = layout.bits_ == 96;
+        switch (scheme->type_) {
+        case TagType::kSGTIN: {
+            SGTIN::PartitionTable table = SGTIN::getPartitionTable(partition);
+            layout.company_prefix_bits_ = table.company_prefix_bits_;
+            layout.company_prefix_digits_ = table.company_prefix_digits_;
+            layout.reference_bits_ = table.indicator_itemref_bits_;
+            layout.reference_digits_ = table.indicator_itemref_digits_;
+            layout.serial_bits_ = is96
+                ? SGTIN::SGTIN96_SERIAL_BITS : SGTIN::SGTIN198_SERIAL_BITS;
+            break;
+        }
+        case TagType::kSSCC: {
+            SSCC::PartitionTable table = SSCC::getPartitionTable(partition);
+            layout.company_prefix_bits_ = table.company_prefix_bits_;
+            layout.company_prefix_digits_ = table.company_prefix_digits_;
+            layout.reference_bits_ = table.serial_ref_bits_;
+            layout.reference_digits_ = table.serial_ref_digits_;
+            break;
+        }
+        case TagType::kSGLN: {
+            SGLN::PartitionTable table = SGLN::getPartitionTable(partition);
+            layout.company_prefix_bits_ = table.company_prefix_bits_;
+            layout.company_prefix_digits_ = table.company_prefix_digits_;
+            layout.reference_bits_ = table.location_ref_bits_;
+            layout.reference_digits_ = table.location_ref_digits_;
+            layout.serial_bits_ = is96
+                ? SGLN::SGLN96_EXTENSION_BITS : SGLN::SGLN195_EXTENSION_BITS;
+            break;
+        }
+        case TagType::kGRAI: {
+            GRAI::PartitionTable table = GRAI::getPartitionTable(partition);
+            layout.company_prefix_bits_ = table.company_prefix_bits_;
+            layout.company_prefix_digits_ = table.company_prefix_digits_;
+            layout.reference_bits_ = table.asset_type_bits_;
+            layout.reference_digits_ = table.asset_type_digits_;
+            layout.serial_bits_ = is96
+                ? GRAI::GRAI96_SERIAL_BITS : GRAI::GRAI170_SERIAL_BITS;
+            break;
+        }
+        case TagType::kGIAI: {
+            // The tables are in the order of partitions.
+            GIAI::PartitionTable table = is96
+                ? GIAI::GIAI96_PARTITION_TABLE[partition]
+                : GIAI::GIAI202_PARTITION_TABLE[partition];
+            layout.company_prefix_bits_ = table.company_prefix_bits_;
+            layout.company_prefix_digits_ = table.company_prefix_digits_;
+            layout.reference_bits_ = table.asset_ref_bits_;
+            layout.reference_digits_ = table.asset_ref_digits_;
+            break;
+        }
+        default:
+            return std::make_pair(Status::kInvalidArgument, Layout());
+        }
+        return std::make_pair(Status::kOk, layout);
+    }
+
+    std::pair<Status, Layout> get_layout(uint8_t header,
+                                         const std::string &company_prefix) {
+        size_t digits = company_prefix.length();
+        if (digits < LAYOUT_MIN_COMPANY_PREFIX_DIGITS
+            || digits > LAYOUT_MAX_COMPANY_PREFIX_DIGITS) {
+            return std::make_pair(Status::kInvalidArgument, Layout());
+        }
+        // Partition 0 is for 12 digits of company prefix, and so on.
+        return get_layout(header, LAYOUT_MAX_COMPANY_PREFIX_DIGITS - digits);
+    }
+
+    std::pair<Status, Layout> get_layout(const Epc96 &epc) {
+        Status status;
+        Layout layout;
+        std::tie(status, layout) = get_layout(
+            epc.getHeader(), epc.getBits(LAYOUT_PARTITION_OFFSET, 3));
+        if (status == Status::kOk && layout.bits_ != 96) {
+            return std::make_pair(Status::kInvalidArgument, Layout());
+        }
+        return std::make_pair(status, layout);
+    }
+}
@@ -0,0 +1,209 @@
+#include "llrp.h"
+
+namespace epc {
+    namespace {
+        constexpr uint16_t TAG_REPORT_DATA = 240;
+        constexpr uint16_t EPC_DATA = 241;
+
+        constexpr uint8_t ANTENNA_ID = 1;
+        constexpr uint8_t FIRST_SEEN_TIMESTAMP_UTC = 2;
+        constexpr uint8_t FIRST_SEEN_TIMESTAMP_UPTIME = 3;
+        constexpr uint8_t PEAK_RSSI = 6;
+        constexpr uint8_t EPC_96 = 13;
+
+        // Lengths of the values of TV parameters indexed by type.
+        constexpr uint8_t TV_LENGTHS[] = {
+            0,  // 0: reserved
+            2,  // 1: AntennaID
+            8,  // 2: FirstSeenTimestampUTC
+            8,  // 3: FirstSeenTimestampUptime
+            8,  // 4: LastSeenTimestampUTC
+            8,  // 5: LastSeenTimestampUptime
+            1,  // 6: PeakRSSI
+            2,  // 7: ChannelIndex
+            2,  // 8: TagSeenCount
+            4,  // 9: ROSpecID
+            2,  // 10: InventoryParameterSpecID
+            2,  // 11: C1G2CRC
+            2,  // 12: C1G2PC
+            12, // 13: EPC-96
+            2,  // 14: SpecIndex
+            2,  // 15: ClientRequestOpSpecResult
+            4,  // 16: AccessSpecID
+            2,  // 17: OpSpecID
+            4,  // 18: C1G2SingulationDetails
+            2,  // 19: C1G2XPCW1
+            2,  // 20: C1G2XPCW2
+        };
+
+        uint16_t read_u16(const uint8_t *p) {
+            return static_cast<uint16_t>(p[0] << 8 | p[1]);
+        }
+
+        uint32_t read_u32(const uint8_t *p) {
+            return static_cast<uint32_t>(p[0]) << 24
+                | static_cast<uint32_t>(p[1]) << 16
+                | static_cast<uint32_t>(p[2]) << 8 | p[3];
+        }
+
+        uint64_t read_u64(const uint8_t *p) {
+            return static_cast<uint64_t>(read_u32(p)) << 32 | read_u32(p + 4);
+        }
+
+        /**
+         * A parameter of LLRP, either TV or TLV.
+         */
+        using Parameter = struct ParameterStruct {
+            bool tv_;
+            uint16_t type_;
+            /** The value following the type, or the length of TLV */
+            const uint8_t *value_;
+            size_t value_length_;
+            /** The length of the whole parameter */
+            size_t length_;
+        };
+
+        bool read_parameter(const uint8_t *p, const uint8_t *end,
+                            Parameter &parameter) {
+            if (p == end) return false;
+            if (p[0] & 0x80) {
+                uint8_t type = p[0] & 0x7F;
+                if (type == 0 || type >= sizeof(TV_LENGTHS)) return false;
+                size_t length = 1 + TV_LENGTHS[type];
+                if (static_cast<size_t>(end - p) < length) return false;
+                parameter.tv_ = true;
+                parameter.type_ = type;
+                parameter.value_ = p + 1;
+                parameter.value_length_ = length - 1;
+                parameter.length_ = length;
+                return true;
+            }
+            if (end - p < 4) return false;
+            size_t length = read_u16(p + 2);
+            if (length < 4 || static_cast<size_t>(end - p) < length) {
+                return false;
+            }
+            parameter.tv_ = false;
+            parameter.type_ = read_u16(p) & 0x3FF;
+            parameter.value_ = p + 4;
+            parameter.value_length_ = length - 4;
+            parameter.length_ = length;
+            return true;
+        }
+
+        bool read_tag_report(const uint8_t *p, const uint8_t *end,
+                             LLRPTagReport &report) {
+            report = LLRPTagReport();
+            Parameter parameter;
+            for (; p != end; p += parameter.length_) {
+                if (!read_parameter(p, end, parameter)) return false;
+                const uint8_t *value = parameter.value_;
+                if (!parameter.tv_) {
+                    if (parameter.type_ != EPC_DATA) continue;
+                    if (parameter.value_length_ < 2) return false;
+                    size_t bits = read_u16(value);
+                    if ((bits + 7) / 8 > parameter.value_length_ - 2) {
+                        return false;
+                    }
+                    report.epc_ = value + 2;
+                    report.epc_bits_ = bits;
+                    continue;
+                }
+                switch (parameter.type_) {
+                case EPC_96:
+                    report.epc_ = value;
+                    report.epc_bits_ = 96;
+                    break;
+                case ANTENNA_ID:
+                    report.has_antenna_ = true;
+                    report.antenna_ = read_u16(value);
+                    break;
+                case PEAK_RSSI:
+                    report.has_peak_rssi_ = true;
+                    report.peak_rssi_ = static_cast<int8_t>(value[0]);
+                    break;
+                case FIRST_SEEN_TIMESTAMP_UTC:
+                    report.has_first_seen_utc_ = true;
+                    report.first_seen_utc_ = read_u64(value);
+                    break;
+                case FIRST_SEEN_TIMESTAMP_UPTIME:
+                    report.has_first_seen_uptime_ = true;
+                    report.first_seen_uptime_ = read_u64(value);
+                    break;
+                default:
+                    break;
+                }
+            }
+            return report.epc_ != nullptr;
+        }
+    }
+
+    std::pair<Status, LLRPMessageHeader> parse_llrp_message_header(
+        const uint8_t *data, size_t size) {
+        LLRPMessageHeader header = LLRPMessageHeader();
+        if (size < LLRP_MESSAGE_HEADER_LENGTH) {
+            return std::make_pair(Status::kInvalidArgument, header);
+        }
+        uint16_t version_type = read_u16(data);
+        header.version_ = (version_type >> 10) & 0x7;
+        header.type_ = version_type & 0x3FF;
+        header.length_ = read_u32(data + 2);
+        header.id_ = read_u32(data + 6);
+        if (header.length_ < LLRP_MESSAGE_HEADER_LENGTH) {
+            return std::make_pair(Status::kInvalidArgument, header);
+        }
+        return std::make_pair(Status::kOk, header);
+    }
+
+    std::pair<Status, size_t> walk_llrp_messages(
+        const uint8_t *data, size_t size,
+        const std::function<void(const LLRPMessageHeader &header,
+                                 const uint8_t *message)> &callback) {
+        size_t offset = 0;
+        while (size - offset >= LLRP_MESSAGE_HEADER_LENGTH) {
+            Status status;
+            LLRPMessageHeader header;
+            std::tie(status, header) = parse_llrp_message_header(
+                data + offset, size - offset);
+            if (status != Status::kOk) return std::make_pair(status, offset);
+            if (header.length_ > size - offset) break;
+            callback(header, data + offset);
+            offset += header.length_;
+        }
+        return std::make_pair(Status::kOk, offset);
+    }
+
+    Status walk_llrp_tag_reports(
+        const uint8_t *message, size_t size,
+        const std::function<void(const LLRPTagReport &report)> &callback) {
+        Status status;
+        LLRPMessageHeader header;
+        std::tie(status, header) = parse_llrp_message_header(message, size);
+        if (status != Status::kOk) return status;
+        if (header.type_ != LLRP_RO_ACCESS_REPORT || header.length_ > size) {
+            return Status::kInvalidArgument;
+        }
+        const uint8_t *p = message + LLRP_MESSAGE_HEADER_LENGTH;
+        const uint8_t *end = message + header.length_;
+        Parameter parameter;
+        LLRPTagReport report;
+        for (; p != end; p += parameter.length_) {
+            if (!read_parameter(p, end, parameter)) {
+                return Status::kInvalidArgument;
+            }
+            if (parameter.tv_ || parameter.type_ != TAG_REPORT_DATA) continue;
+            const uint8_t *value = parameter.value_;
+            if (!read_tag_report(value, value + parameter.value_length_,
+                                 report)) {
+                return Status::kInvalidArgument;
+            }
+            callback(report);
+        }
+        return Status::kOk;
+    }
+
+    std::pair<Status, Tag> decode_llrp_tag_report(const LLRPTagReport &report) {
+        if (!report.epc_) return std::make_pair(Status::kInvalidArgument, Tag());
+        return Tag::createFromBytes(report.epc_, (report.epc_bits_ + 7) / 8);
+    }
+}
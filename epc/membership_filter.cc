@@ -0,0 +1,585 @@
+#include "membership_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        constexpr char BLOOM_MAGIC[8] = {'E', 'P', 'C', 'B', 'L', 'O', 'O',
+                                         'M'};
+        constexpr char CUCKOO_MAGIC[8] = {'E', 'P', 'C', 'C', 'U', 'C', 'K',
+                                          'O'};
+        constexpr uint32_t VERSION = 1;
+        constexpr unsigned int BLOCK_BITS = 512;
+        constexpr unsigned int MAX_HASH_COUNT = 16;
+        constexpr size_t PREFETCH_DISTANCE = 16;
+        // Cuckoo filters fill up at about 95% of their buckets.
+        constexpr double CUCKOO_LOAD_FACTOR = 0.95;
+        constexpr uint64_t LANES_LOW = 0x0001000100010001;
+        constexpr uint64_t LANES_HIGH = 0x8000800080008000;
+
+        // The header is as long as a cache line, so that the blocks of a
+        // mapped filter stay aligned to cache lines.
+        using FileHeader = struct FileHeaderStruct {
+            char magic_[8];
+            uint32_t version_;
+            /** Bloom filters only */
+            uint32_t hash_count_;
+            uint64_t word_count_;
+            uint64_t size_;
+            /** Cuckoo filters only */
+            uint64_t victim_index_;
+            /** Cuckoo filters only */
+            uint32_t victim_;
+            uint32_t reserved_[5];
+        };
+
+        // Mixes all bits of an EPC, since the bits carrying entropy, e.g.
+        // serials, are in different positions by scheme.
+        inline uint64_t hash_epc(const Epc96 &epc) {
+            uint64_t h = epc.getLow()
+                ^ static_cast<uint64_t>(epc.getHigh()) * 0x9E3779B97F4A7C15;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCD;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53;
+            h ^= h >> 33;
+            return h;
+        }
+
+        inline void prefetch(const void *p) {
+#if defined(__GNUC__)
+            __builtin_prefetch(p);
+#else
+            (void)p;
+#endif
+        }
+
+        double estimate_bloom_false_positive_rate(double keys, size_t blocks,
+                                                  unsigned int hash_count) {
+            if (blocks == 0) return 1;
+            if (keys == 0) return 0;
+            // Keys per block follow a Poisson distribution.
+            double lambda = keys / blocks;
+            double rate = 0;
+            size_t max = static_cast<size_t>(
+                lambda + 12 * std::sqrt(lambda) + 12);
+            for (size_t i = 0; i <= max; i++) {
+                double p = std::exp(i * std::log(lambda) - lambda
+                                    - std::lgamma(i + 1.0));
+                double set = 1 - std::pow(1 - 1.0 / BLOCK_BITS,
+                                          static_cast<double>(hash_count) * i);
+                rate += p * std::pow(set, hash_count);
+            }
+            return rate;
+        }
+
+        bool get_bloom_parameters(size_t expected, double false_positive_rate,
+                                  size_t *blocks, unsigned int *hash_count) {
+            if (!(false_positive_rate > 0 && false_positive_rate < 1)) {
+                return false;
+            }
+            // Start from the bits per key of a standard Bloom filter, and
+            // add bits until the blocks reach the rate.
+            const double ln2 = std::log(2.0);
+            double bits_per_key = -std::log(false_positive_rate) / ln2 / ln2;
+            for (;;) {
+                *blocks = std::max<size_t>(
+                    1, static_cast<size_t>(
+                        std::ceil(expected * bits_per_key / BLOCK_BITS)));
+                *hash_count = std::min<unsigned int>(
+                    MAX_HASH_COUNT, std::max<unsigned int>(
+                        1, std::lround(bits_per_key * ln2)));
+                if (estimate_bloom_false_positive_rate(
+                        expected, *blocks, *hash_count)
+                    <= false_positive_rate) {
+                    return true;
+                }
+                bits_per_key *= 1.05;
+            }
+        }
+
+        size_t get_cuckoo_bucket_count(size_t capacity) {
+            size_t buckets = static_cast<size_t>(std::ceil(
+                capacity / (CUCKOO_LOAD_FACTOR * 4)));
+            size_t p = 1;
+            while (p < buckets) p <<= 1;
+            return p;
+        }
+
+        inline bool has_lane(uint64_t bucket, uint16_t value) {
+            uint64_t x = bucket ^ LANES_LOW * value;
+            return ((x - LANES_LOW) & ~x & LANES_HIGH) != 0;
+        }
+
+        Status write_file(const std::string &path, const FileHeader &header,
+                          const uint64_t *words) {
+            std::ofstream os(path, std::ios::binary | std::ios::trunc);
+            if (!os) return Status::kInvalidArgument;
+            os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            os.write(reinterpret_cast<const char *>(words),
+                     header.word_count_ * sizeof(uint64_t));
+            return os ? Status::kOk : Status::kInvalidArgument;
+        }
+
+        // Maps a file privately, so that the filter can be changed without
+        // writing back to the file.
+        Status map_file(const std::string &path, const char *magic,
+                        FileHeader *header, void **mapping, size_t *length) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return Status::kInvalidArgument;
+            struct stat st;
+            if (::fstat(fd, &st) < 0
+                || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+                ::close(fd);
+                return Status::kInvalidArgument;
+            }
+            void *data = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) return Status::kInvalidArgument;
+            std::memcpy(header, data, sizeof(FileHeader));
+            size_t words = (st.st_size - sizeof(FileHeader)) / sizeof(uint64_t);
+            if (std::memcmp(header->magic_, magic, sizeof(header->magic_)) != 0
+                || header->version_ != VERSION
+                || header->word_count_ != words
+                || (st.st_size - sizeof(FileHeader)) % sizeof(uint64_t) != 0) {
+                ::munmap(data, st.st_size);
+                return Status::kInvalidArgument;
+            }
+            *mapping = data;
+            *length = st.st_size;
+            return Status::kOk;
+        }
+    }
+
+    BloomFilter::BloomFilter(BloomFilter &&other)
+        : words_(other.words_), block_count_(other.block_count_),
+          hash_count_(other.hash_count_), size_(other.size_),
+          storage_(std::move(other.storage_)), mapping_(other.mapping_),
+          mapping_length_(other.mapping_length_) {
+        other.words_ = nullptr;
+        other.block_count_ = 0;
+        other.size_ = 0;
+        other.mapping_ = nullptr;
+        other.mapping_length_ = 0;
+    }
+
+    BloomFilter &BloomFilter::operator=(BloomFilter &&other) {
+        if (this != &other) {
+            close();
+            words_ = other.words_;
+            block_count_ = other.block_count_;
+            hash_count_ = other.hash_count_;
+            size_ = other.size_;
+            storage_ = std::move(other.storage_);
+            mapping_ = other.mapping_;
+            mapping_length_ = other.mapping_length_;
+            other.words_ = nullptr;
+            other.block_count_ = 0;
+            other.size_ = 0;
+            other.mapping_ = nullptr;
+            other.mapping_length_ = 0;
+        }
+        return *this;
+    }
+
+    BloomFilter::~BloomFilter() {
+        close();
+    }
+
+    void BloomFilter::close() {
+        if (mapping_) ::munmap(mapping_, mapping_length_);
+        mapping_ = nullptr;
+        mapping_length_ = 0;
+        storage_.clear();
+        words_ = nullptr;
+        block_count_ = 0;
+        size_ = 0;
+    }
+
+    std::pair<Status, BloomFilter> BloomFilter::create(
+        size_t expected, double false_positive_rate) {
+        BloomFilter filter;
+        size_t blocks;
+        unsigned int hash_count;
+        if (!get_bloom_parameters(expected, false_positive_rate, &blocks,
+                                  &hash_count)) {
+            return std::make_pair(Status::kInvalidArgument, std::move(filter));
+        }
+        filter.storage_.assign(blocks * BLOCK_WORDS, 0);
+        filter.words_ = filter.storage_.data();
+        filter.block_count_ = blocks;
+        filter.hash_count_ = hash_count;
+        return std::make_pair(Status::kOk, std::move(filter));
+    }
+
+    std::pair<Status, BloomFilter> BloomFilter::open(const std::string &path) {
+        BloomFilter filter;
+        FileHeader header;
+        Status status = map_file(path, BLOOM_MAGIC, &header, &filter.mapping_,
+                                 &filter.mapping_length_);
+        if (status != Status::kOk) {
+            return std::make_pair(status, std::move(filter));
+        }
+        if (header.word_count_ == 0 || header.word_count_ % BLOCK_WORDS != 0
+            || header.hash_count_ == 0
+            || header.hash_count_ > MAX_HASH_COUNT) {
+            filter.close();
+            return std::make_pair(Status::kInvalidArgument, std::move(filter));
+        }
+        filter.words_ = reinterpret_cast<uint64_t *>(
+            static_cast<char *>(filter.mapping_) + sizeof(FileHeader));
+        filter.block_count_ = header.word_count_ / BLOCK_WORDS;
+        filter.hash_count_ = header.hash_count_;
+        filter.size_ = header.size_;
+        return std::make_pair(Status::kOk, std::move(filter));
+    }
+
+    size_t BloomFilter::estimateBytes(size_t expected,
+                                      double false_positive_rate) {
+        size_t blocks;
+        unsigned int hash_count;
+        if (!get_bloom_parameters(expected, false_positive_rate, &blocks,
+                                  &hash_count)) {
+            return 0;
+        }
+        return blocks * BLOCK_BYTES;
+    }
+
+    namespace {
+        // Returns the block of a key, and sets the bits of the key in the
+        // block to a mask. The bits are picked by double hashing, so they
+        // are distinct.
+        inline size_t get_bloom_bits(uint64_t h, size_t block_count,
+                                     unsigned int hash_count,
+                                     uint64_t *mask) {
+            size_t block = static_cast<size_t>(
+                (h >> 32) * block_count >> 32);
+            uint64_t g = h * 0x9E3779B97F4A7C15;
+            unsigned int bit = g >> 55;
+            unsigned int step = (g >> 46 & (BLOCK_BITS - 1)) | 1;
+            std::memset(mask, 0, BLOCK_BITS / 8);
+            for (unsigned int i = 0; i < hash_count; i++) {
+                mask[bit / 64] |= uint64_t(1) << (bit % 64);
+                bit = (bit + step) & (BLOCK_BITS - 1);
+            }
+            return block;
+        }
+    }
+
+    void BloomFilter::insert(const Epc96 &epc) {
+        if (!words_) return;
+        uint64_t mask[BLOCK_WORDS];
+        size_t block = get_bloom_bits(hash_epc(epc), block_count_,
+                                      hash_count_, mask);
+        uint64_t *words = words_ + block * BLOCK_WORDS;
+        for (size_t i = 0; i < BLOCK_WORDS; i++) words[i] |= mask[i];
+        size_++;
+    }
+
+    bool BloomFilter::mayContain(const Epc96 &epc) const {
+        if (!words_) return false;
+        uint64_t mask[BLOCK_WORDS];
+        size_t block = get_bloom_bits(hash_epc(epc), block_count_,
+                                      hash_count_, mask);
+        const uint64_t *words = words_ + block * BLOCK_WORDS;
+        uint64_t missing = 0;
+        for (size_t i = 0; i < BLOCK_WORDS; i++) {
+            missing |= mask[i] & ~words[i];
+        }
+        return missing == 0;
+    }
+
+    size_t BloomFilter::mayContain(const Epc96 *epcs, size_t n,
+                                   uint64_t *mask) const {
+        std::memset(mask, 0, (n + 63) / 64 * sizeof(uint64_t));
+        if (!words_) return 0;
+        size_t count = 0;
+        uint64_t hashes[PREFETCH_DISTANCE];
+        for (size_t begin = 0; begin < n; begin += PREFETCH_DISTANCE) {
+            size_t end = std::min(n, begin + PREFETCH_DISTANCE);
+            for (size_t i = begin; i < end; i++) {
+                uint64_t h = hash_epc(epcs[i]);
+                hashes[i - begin] = h;
+                prefetch(words_
+                         + ((h >> 32) * block_count_ >> 32) * BLOCK_WORDS);
+            }
+            for (size_t i = begin; i < end; i++) {
+                uint64_t bits[BLOCK_WORDS];
+                size_t block = get_bloom_bits(hashes[i - begin], block_count_,
+                                              hash_count_, bits);
+                const uint64_t *words = words_ + block * BLOCK_WORDS;
+                uint64_t missing = 0;
+                for (size_t j = 0; j < BLOCK_WORDS; j++) {
+                    missing |= bits[j] & ~words[j];
+                }
+                if (missing == 0) {
+                    mask[i / 64] |= uint64_t(1) << (i % 64);
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
+
+    Status BloomFilter::write(const std::string &path) const {
+        FileHeader header = {};
+        std::memcpy(header.magic_, BLOOM_MAGIC, sizeof(BLOOM_MAGIC));
+        header.version_ = VERSION;
+        header.hash_count_ = hash_count_;
+        header.word_count_ = block_count_ * BLOCK_WORDS;
+        header.size_ = size_;
+        return write_file(path, header, words_);
+    }
+
+    double BloomFilter::getFalsePositiveRate() const {
+        return estimate_bloom_false_positive_rate(size_, block_count_,
+                                                  hash_count_);
+    }
+
+    CuckooFilter::CuckooFilter(CuckooFilter &&other)
+        : buckets_(other.buckets_), mask_(other.mask_), size_(other.size_),
+          victim_(other.victim_), victim_index_(other.victim_index_),
+          random_(other.random_), storage_(std::move(other.storage_)),
+          mapping_(other.mapping_), mapping_length_(other.mapping_length_) {
+        other.buckets_ = nullptr;
+        other.mask_ = 0;
+        other.size_ = 0;
+        other.victim_ = 0;
+        other.mapping_ = nullptr;
+        other.mapping_length_ = 0;
+    }
+
+    CuckooFilter &CuckooFilter::operator=(CuckooFilter &&other) {
+        if (this != &other) {
+            close();
+            buckets_ = other.buckets_;
+            mask_ = other.mask_;
+            size_ = other.size_;
+            victim_ = other.victim_;
+            victim_index_ = other.victim_index_;
+            random_ = other.random_;
+            storage_ = std::move(other.storage_);
+            mapping_ = other.mapping_;
+            mapping_length_ = other.mapping_length_;
+            other.buckets_ = nullptr;
+            other.mask_ = 0;
+            other.size_ = 0;
+            other.victim_ = 0;
+            other.mapping_ = nullptr;
+            other.mapping_length_ = 0;
+        }
+        return *this;
+    }
+
+    CuckooFilter::~CuckooFilter() {
+        close();
+    }
+
+    void CuckooFilter::close() {
+        if (mapping_) ::munmap(mapping_, mapping_length_);
+        mapping_ = nullptr;
+        mapping_length_ = 0;
+        storage_.clear();
+        buckets_ = nullptr;
+        mask_ = 0;
+        size_ = 0;
+        victim_ = 0;
+    }
+
+    CuckooFilter CuckooFilter::create(size_t capacity) {
+        CuckooFilter filter;
+        size_t buckets = get_cuckoo_bucket_count(capacity);
+        filter.storage_.assign(buckets, 0);
+        filter.buckets_ = filter.storage_.data();
+        filter.mask_ = buckets - 1;
+        return filter;
+    }
+
+    std::pair<Status, CuckooFilter> CuckooFilter::open(
+        const std::string &path) {
+        CuckooFilter filter;
+        FileHeader header;
+        Status status = map_file(path, CUCKOO_MAGIC, &header,
+                                 &filter.mapping_, &filter.mapping_length_);
+        if (status != Status::kOk) {
+            return std::make_pair(status, std::move(filter));
+        }
+        size_t buckets = header.word_count_;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0
+            || header.victim_ > 0xFFFF || header.victim_index_ >= buckets) {
+            filter.close();
+            return std::make_pair(Status::kInvalidArgument, std::move(filter));
+        }
+        filter.buckets_ = reinterpret_cast<uint64_t *>(
+            static_cast<char *>(filter.mapping_) + sizeof(FileHeader));
+        filter.mask_ = buckets - 1;
+        filter.size_ = header.size_;
+        filter.victim_ = header.victim_;
+        filter.victim_index_ = header.victim_index_;
+        return std::make_pair(Status::kOk, std::move(filter));
+    }
+
+    size_t CuckooFilter::estimateBytes(size_t capacity) {
+        return get_cuckoo_bucket_count(capacity) * sizeof(uint64_t);
+    }
+
+    namespace {
+        inline uint16_t get_fingerprint(uint64_t h) {
+            uint16_t fingerprint = h >> 48;
+            return fingerprint == 0 ? 1 : fingerprint;
+        }
+
+        // The alternate bucket is derived from the fingerprint alone, so
+        // fingerprints can be moved without their keys.
+        inline size_t get_alternate_index(size_t index, uint16_t fingerprint,
+                                          size_t mask) {
+            return (index ^ static_cast<size_t>(fingerprint) * 0x5BD1E995u)
+                & mask;
+        }
+
+        inline bool put(uint64_t &bucket, uint16_t fingerprint) {
+            for (unsigned int i = 0; i < 4; i++) {
+                if ((bucket >> (i * 16) & 0xFFFF) == 0) {
+                    bucket |= static_cast<uint64_t>(fingerprint) << (i * 16);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline bool take(uint64_t &bucket, uint16_t fingerprint) {
+            for (unsigned int i = 0; i < 4; i++) {
+                if ((bucket >> (i * 16) & 0xFFFF) == fingerprint) {
+                    bucket &= ~(uint64_t(0xFFFF) << (i * 16));
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    bool CuckooFilter::insert(size_t index, uint16_t fingerprint) {
+        size_t alternate = get_alternate_index(index, fingerprint, mask_);
+        if (put(buckets_[index], fingerprint)
+            || put(buckets_[alternate], fingerprint)) {
+            return true;
+        }
+        // Evict a random fingerprint to its alternate bucket until one
+        // fits.
+        for (unsigned int kick = 0; kick < MAX_KICKS; kick++) {
+            random_ ^= random_ << 13;
+            random_ ^= random_ >> 7;
+            random_ ^= random_ << 17;
+            if (kick == 0 && (random_ & 4)) index = alternate;
+            unsigned int lane = (random_ & 3) * 16;
+            uint64_t &bucket = buckets_[index];
+            uint16_t evicted = bucket >> lane & 0xFFFF;
+            bucket = (bucket & ~(uint64_t(0xFFFF) << lane))
+                | static_cast<uint64_t>(fingerprint) << lane;
+            fingerprint = evicted;
+            index = get_alternate_index(index, fingerprint, mask_);
+            if (put(buckets_[index], fingerprint)) return true;
+        }
+        victim_ = fingerprint;
+        victim_index_ = index;
+        return false;
+    }
+
+    bool CuckooFilter::insert(const Epc96 &epc) {
+        if (victim_ != 0 || !buckets_) return false;
+        uint64_t h = hash_epc(epc);
+        // The key is held even if another fingerprint becomes the victim.
+        insert(h & mask_, get_fingerprint(h));
+        size_++;
+        return true;
+    }
+
+    bool CuckooFilter::remove(const Epc96 &epc) {
+        if (!buckets_) return false;
+        uint64_t h = hash_epc(epc);
+        uint16_t fingerprint = get_fingerprint(h);
+        size_t index = h & mask_;
+        size_t alternate = get_alternate_index(index, fingerprint, mask_);
+        if (victim_ == fingerprint
+            && (victim_index_ == index || victim_index_ == alternate)) {
+            victim_ = 0;
+        } else if (!take(buckets_[index], fingerprint)
+                   && !take(buckets_[alternate], fingerprint)) {
+            return false;
+        } else if (victim_ != 0) {
+            // Room is made for the victim.
+            uint16_t victim = victim_;
+            victim_ = 0;
+            insert(victim_index_, victim);
+        }
+        size_--;
+        return true;
+    }
+
+    bool CuckooFilter::mayContain(const Epc96 &epc) const {
+        if (!buckets_) return false;
+        uint64_t h = hash_epc(epc);
+        uint16_t fingerprint = get_fingerprint(h);
+        size_t index = h & mask_;
+        size_t alternate = get_alternate_index(index, fingerprint, mask_);
+        return has_lane(buckets_[index], fingerprint)
+            || has_lane(buckets_[alternate], fingerprint)
+            || (victim_ == fingerprint
+                && (victim_index_ == index || victim_index_ == alternate));
+    }
+
+    size_t CuckooFilter::mayContain(const Epc96 *epcs, size_t n,
+                                    uint64_t *mask) const {
+        std::memset(mask, 0, (n + 63) / 64 * sizeof(uint64_t));
+        if (!buckets_) return 0;
+        size_t count = 0;
+        uint64_t hashes[PREFETCH_DISTANCE];
+        for (size_t begin = 0; begin < n; begin += PREFETCH_DISTANCE) {
+            size_t end = std::min(n, begin + PREFETCH_DISTANCE);
+            for (size_t i = begin; i < end; i++) {
+                uint64_t h = hash_epc(epcs[i]);
+                hashes[i - begin] = h;
+                size_t index = h & mask_;
+                prefetch(&buckets_[index]);
+                prefetch(&buckets_[get_alternate_index(
+                    index, get_fingerprint(h), mask_)]);
+            }
+            for (size_t i = begin; i < end; i++) {
+                uint64_t h = hashes[i - begin];
+                uint16_t fingerprint = get_fingerprint(h);
+                size_t index = h & mask_;
+                size_t alternate = get_alternate_index(index, fingerprint,
+                                                       mask_);
+                if (has_lane(buckets_[index], fingerprint)
+                    || has_lane(buckets_[alternate], fingerprint)
+                    || (victim_ == fingerprint
+                        && (victim_index_ == index
+                            || victim_index_ == alternate))) {
+                    mask[i / 64] |= uint64_t(1) << (i % 64);
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
+
+    Status CuckooFilter::write(const std::string &path) const {
+        FileHeader header = {};
+        std::memcpy(header.magic_, CUCKOO_MAGIC, sizeof(CUCKOO_MAGIC));
+        header.version_ = VERSION;
+        header.word_count_ = buckets_ ? mask_ + 1 : 0;
+        header.size_ = size_;
+        header.victim_index_ = victim_index_;
+        header.victim_ = victim_;
+        return write_file(path, header, buckets_);
+    }
+}
@@ -0,0 +1,285 @@
+#include "pattern_matcher.h"
+#include "encode.h"
+#include "layout.h"
+#include "tag.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <regex>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        const std::string PATTERN_RE =
+            "urn:epc:(idpat|pat):(sgtin|sscc|sgln|grai|giai)(-96)?:(.+)";
+        // The maximum number of digits of a serial of 96 bits.
+        constexpr size_t MAX_SERIAL_DIGITS = 19;
+
+        using Scheme = struct SchemeStruct {
+            TagType type_;
+            /** The number of fields of the pure identity */
+            size_t field_count_;
+        };
+
+        const Scheme SCHEMES[] = {
+            {TagType::kSGTIN, 3},
+            {TagType::kSSCC, 2},
+            {TagType::kSGLN, 3},
+            {TagType::kGRAI, 3},
+            {TagType::kGIAI, 2},
+        };
+
+        using Range = struct RangeStruct {
+            uint64_t first_;
+            uint64_t last_;
+        };
+
+        std::vector<std::string> split(const std::string &s) {
+            std::vector<std::string> fields;
+            size_t begin = 0;
+            for (;;) {
+                size_t end = s.find('.', begin);
+                fields.push_back(s.substr(begin, end - begin));
+                if (end == std::string::npos) return fields;
+                begin = end + 1;
+            }
+        }
+
+        // Parses an integer without leading zeros, as encoded in binaries.
+        bool parse_integer(const std::string &s, uint64_t *value) {
+            if (s.empty() || s.length() > MAX_SERIAL_DIGITS
+                || !is_padded_numbers(s) || (s[0] == '0' && s.length() > 1)) {
+                return false;
+            }
+            *value = std::stoull(s);
+            return true;
+        }
+
+        // Parses a field of an integer, "*" or "[lo-hi]". A field of an
+        // integer not encoded in 96 bits is an empty range.
+        bool parse_range(const std::string &s, bool allow_range,
+                         Range *range) {
+            if (s == "*") {
+                *range = Range{0, ~0ULL};
+                return true;
+            }
+            if (allow_range && s.length() > 2 && s.front() == '['
+                && s.back() == ']') {
+                size_t dash = s.find('-');
+                if (dash == std::string::npos) return false;
+                return parse_integer(s.substr(1, dash - 1), &range->first_)
+                    && parse_integer(s.substr(dash + 1, s.length() - dash - 2),
+                                     &range->last_)
+                    && range->first_ <= range->last_;
+            }
+            if (!parse_integer(s, &range->first_)) {
+                // An empty range.
+                *range = Range{1, 0};
+                return true;
+            }
+            range->last_ = range->first_;
+            return true;
+        }
+
+        bool is_range(const std::string &s) {
+            return !s.empty() && s.front() == '[';
+        }
+
+        // Formats a reference of SSCC padded to the digits of the layout,
+        // or of GIAI without leading zeros.
+        std::string format_reference(TagType type, const Layout &layout,
+                                     uint64_t value) {
+            std::string s = std::to_string(value);
+            if (type == TagType::kSSCC) {
+                lpad(s, layout.reference_digits_, '0');
+            }
+            return s;
+        }
+
+        Epc96 increment(const Epc96 &epc) {
+            uint64_t low = epc.getLow() + 1;
+            return Epc96(epc.getHigh() + (low == 0 ? 1 : 0), low);
+        }
+    }
+
+    std::pair<Status, std::vector<EpcRange>> get_pattern_ranges(
+        const std::string &pattern) {
+        std::vector<EpcRange> ranges;
+        std::smatch m;
+        if (!std::regex_match(pattern, m, std::regex(PATTERN_RE))) {
+            return std::make_pair(Status::kInvalidArgument, ranges);
+        }
+        bool tag_pattern = m[1].str() == "pat";
+        if (tag_pattern != m[3].matched) {
+            return std::make_pair(Status::kInvalidArgument, ranges);
+        }
+        const Scheme *scheme = std::find_if(
+            std::begin(SCHEMES), std::end(SCHEMES),
+            [&m](const Scheme &s) {
+                return m[2].str() == get_tag_type_name(s.type_);
+            });
+        // Patterns are of 96-bit schemes only.
+        uint8_t header = get_scheme_info(scheme->type_, 96)->header_;
+
+        std::vector<std::string> fields = split(m[4].str());
+        if (fields.size() != scheme->field_count_ + (tag_pattern ? 1 : 0)) {
+            return std::make_pair(Status::kInvalidArgument, ranges);
+        }
+        const uint64_t max_filter = EPC::MAX_FILTER_VALUE;
+        Range filters = Range{0, max_filter};
+        if (tag_pattern) {
+            if (!parse_range(fields[0], true, &filters)
+                || (fields[0] != "*" && (filters.first_ > filters.last_
+                                         || filters.last_ > max_filter))) {
+                return std::make_pair(Status::kInvalidArgument, ranges);
+            }
+            filters.last_ = std::min(filters.last_, max_filter);
+            fields.erase(fields.begin());
+        }
+        // Fields following "*" must be "*".
+        for (size_t i = 1; i < fields.size(); i++) {
+            if (fields[i - 1] == "*" && fields[i] != "*") {
+                return std::make_pair(Status::kInvalidArgument, ranges);
+            }
+        }
+        const std::string &company_prefix = fields[0];
+        std::string reference = fields[1] == "*" ? "" : fields[1];
+        Range serials = Range{0, ~0ULL};
+        if (fields.size() > 2
+            && !parse_range(fields[2], tag_pattern, &serials)) {
+            return std::make_pair(Status::kInvalidArgument, ranges);
+        }
+        // The serial reference of SSCC and the asset reference of GIAI are
+        // their last fields, which take ranges as serials do.
+        bool empty = false;
+        std::string last_reference;
+        if (fields.size() == 2 && is_range(reference)) {
+            Range references;
+            Status status;
+            Layout layout;
+            std::tie(status, layout) = get_layout(header, company_prefix);
+            if (!tag_pattern || !parse_range(reference, true, &references)
+                || status != Status::kOk) {
+                return std::make_pair(Status::kInvalidArgument, ranges);
+            }
+            uint64_t max = layout.reference_bits_ >= 64
+                ? ~0ULL : (1ULL << layout.reference_bits_) - 1;
+            if (layout.reference_digits_ < 20) {
+                max = std::min(max, POW10[layout.reference_digits_] - 1);
+            }
+            references.last_ = std::min(references.last_, max);
+            empty = references.first_ > references.last_;
+            if (empty) {
+                reference.clear();
+            } else {
+                reference = format_reference(scheme->type_, layout,
+                                             references.first_);
+                last_reference = format_reference(scheme->type_, layout,
+                                                  references.last_);
+            }
+        } else if (scheme->type_ == TagType::kGIAI && !reference.empty()) {
+            // The asset reference of GIAI is encoded as serials are, so one
+            // not encoded in 96 bits matches nothing. The query of any
+            // reference still validates the company prefix.
+            uint64_t value;
+            empty = !parse_integer(reference, &value);
+            if (empty) reference.clear();
+        }
+
+        for (uint64_t filter = filters.first_; filter <= filters.last_;
+             filter++) {
+            uint32_t high = static_cast<uint32_t>(header) << 24
+                | static_cast<uint32_t>(filter) << 21;
+            if (company_prefix == "*") {
+                // All valid partitions.
+                ranges.push_back(EpcRange{
+                    Epc96(high, 0),
+                    Epc96(high | LAYOUT_MAX_PARTITION << 18 | 0x3FFFF,
+                          ~0ULL)});
+                continue;
+            }
+            EpcIndexQuery query = make_index_query(
+                header, company_prefix, reference);
+            query.filter_ = static_cast<int>(filter);
+            query.first_serial_ = serials.first_;
+            query.last_serial_ = serials.last_;
+            Status status;
+            std::vector<EpcRange> query_ranges;
+            std::tie(status, query_ranges) = get_index_ranges(query);
+            if (status != Status::kOk) {
+                return std::make_pair(status, std::vector<EpcRange>());
+            }
+            if (empty) continue;
+            if (!last_reference.empty()) {
+                // From the first of the first reference to the last of the
+                // last.
+                query.reference_ = last_reference;
+                std::vector<EpcRange> last_ranges;
+                std::tie(status, last_ranges) = get_index_ranges(query);
+                if (status != Status::kOk) {
+                    return std::make_pair(status, std::vector<EpcRange>());
+                }
+                query_ranges[0].last_ = last_ranges[0].last_;
+            }
+            ranges.insert(ranges.end(), query_ranges.begin(),
+                          query_ranges.end());
+        }
+        return std::make_pair(Status::kOk, ranges);
+    }
+
+    std::pair<Status, PatternMatcher> PatternMatcher::create(
+        const std::vector<std::string> &patterns) {
+        PatternMatcher matcher;
+        std::vector<EpcRange> ranges;
+        for (const std::string &pattern : patterns) {
+            Status status;
+            std::vector<EpcRange> pattern_ranges;
+            std::tie(status, pattern_ranges) = get_pattern_ranges(pattern);
+            if (status != Status::kOk) {
+                return std::make_pair(status, PatternMatcher());
+            }
+            ranges.insert(ranges.end(), pattern_ranges.begin(),
+                          pattern_ranges.end());
+        }
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const EpcRange &a, const EpcRange &b) {
+                      return a.first_ < b.first_;
+                  });
+        // Merge overlapping and adjacent ranges.
+        for (const EpcRange &range : ranges) {
+            if (!matcher.ranges_.empty()) {
+                EpcRange &last = matcher.ranges_.back();
+                if (last.last_ == Epc96(~0U, ~0ULL)
+                    || range.first_ <= increment(last.last_)) {
+                    last.last_ = std::max(last.last_, range.last_);
+                    continue;
+                }
+            }
+            matcher.ranges_.push_back(range);
+        }
+        for (const EpcRange &range : matcher.ranges_) {
+            matcher.lasts_.push_back(range.last_);
+        }
+        return std::make_pair(Status::kOk, matcher);
+    }
+
+    bool PatternMatcher::matches(const Epc96 &epc) const {
+        // The first range ending at or after the EPC.
+        auto it = std::lower_bound(lasts_.begin(), lasts_.end(), epc);
+        return it != lasts_.end()
+            && ranges_[it - lasts_.begin()].first_ <= epc;
+    }
+
+    size_t PatternMatcher::matches(const Epc96 *epcs, size_t n,
+                                   uint64_t *mask) const {
+        std::fill(mask, mask + (n + 63) / 64, 0);
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (matches(epcs[i])) {
+                mask[i / 64] |= uint64_t(1) << (i % 64);
+                count++;
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,198 @@
+#include "reader_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        bool is_separator(char c) {
+            return c == ',' || c == '\t' || c == ' ';
+        }
+
+        const char *skip_separators(const char *p, const char *end) {
+            while (p != end && is_separator(*p)) p++;
+            return p;
+        }
+
+        const char *find_separator(const char *p, const char *end) {
+            while (p != end && !is_separator(*p)) p++;
+            return p;
+        }
+
+        bool parse_unsigned(const char *begin, const char *end,
+                            uint64_t &value) {
+            if (begin == end) return false;
+            uint64_t v = 0;
+            for (const char *p = begin; p != end; p++) {
+                if (*p < '0' || '9' < *p) return false;
+                v = v * 10 + (*p - '0');
+            }
+            value = v;
+            return true;
+        }
+
+        std::function<long(char *, size_t)> fd_reader(int fd) {
+            return [fd](char *buf, size_t n) -> long {
+                ssize_t r;
+                do {
+                    r = ::read(fd, buf, n);
+                } while (r < 0 && errno == EINTR);
+                return r;
+            };
+        }
+
+        std::function<long(char *, size_t)> stream_reader(std::istream &is) {
+            return [&is](char *buf, size_t n) -> long {
+                is.read(buf, n);
+                if (is.bad()) return -1;
+                return is.gcount();
+            };
+        }
+    }
+
+    ReaderLogDecoder::ReaderLogDecoder(size_t chunk_size)
+        : buffer_(std::max<size_t>(chunk_size, 1)) {}
+
+    Status ReaderLogDecoder::decode(int fd, const Callback &callback) {
+        return run(fd_reader(fd), callback);
+    }
+
+    Status ReaderLogDecoder::decode(std::istream &is,
+                                    const Callback &callback) {
+        return run(stream_reader(is), callback);
+    }
+
+    Status ReaderLogDecoder::decodeBatches(int fd, size_t batch_size,
+                                           const BatchCallback &callback) {
+        return runBatches(fd_reader(fd), batch_size, callback);
+    }
+
+    Status ReaderLogDecoder::decodeBatches(std::istream &is, size_t batch_size,
+                                           const BatchCallback &callback) {
+        return runBatches(stream_reader(is), batch_size, callback);
+    }
+
+    Status ReaderLogDecoder::runBatches(const ReadFunction &read,
+                                        size_t batch_size,
+                                        const BatchCallback &callback) {
+        if (batch_size == 0) return Status::kInvalidArgument;
+        std::vector<ReaderLogRecord> batch(batch_size);
+        size_t count = 0;
+        Status status = run(read, [&](const ReaderLogRecord &record) {
+            batch[count++] = record;
+            if (count == batch_size) {
+                callback(batch);
+                count = 0;
+            }
+        });
+        if (count > 0) {
+            batch.resize(count);
+            callback(batch);
+        }
+        return status;
+    }
+
+    Status ReaderLogDecoder::run(const ReadFunction &read,
+                                 const Callback &callback) {
+        char *begin = buffer_.data();
+        const size_t size = buffer_.size();
+        size_t used = 0;
+        size_t line = 1;
+        bool skipping = false;
+        ReaderLogRecord record;
+
+        for (;;) {
+            long n = read(begin + used, size - used);
+            if (n < 0) return Status::kInvalidArgument;
+            used += n;
+            const char *p = begin;
+            const char *end = begin + used;
+            const char *nl;
+            while ((nl = static_cast<const char *>(
+                        std::memchr(p, '\n', end - p))) != nullptr) {
+                if (skipping) {
+                    skipping = false;
+                } else {
+                    record.line_ = line;
+                    if (decodeLine(p, nl, record)) callback(record);
+                }
+                line++;
+                p = nl + 1;
+            }
+            if (n == 0) {
+                if (p != end && !skipping) {
+                    record.line_ = line;
+                    if (decodeLine(p, end, record)) callback(record);
+                }
+                return Status::kOk;
+            }
+            size_t rest = end - p;
+            if (rest == size) {
+                // The line doesn't fit in the buffer.
+                if (!skipping) {
+                    record = ReaderLogRecord();
+                    record.line_ = line;
+                    record.status_ = Status::kInvalidArgument;
+                    callback(record);
+                }
+                skipping = true;
+                used = 0;
+            } else {
+                std::memmove(begin, p, rest);
+                used = rest;
+            }
+        }
+    }
+
+    bool ReaderLogDecoder::decodeLine(const char *begin, const char *end,
+                                      ReaderLogRecord &record) {
+        record.status_ = Status::kOk;
+        record.tag_ = Tag();
+        record.has_timestamp_ = false;
+        record.timestamp_ = 0;
+        record.has_antenna_ = false;
+        record.antenna_ = 0;
+
+        if (begin != end && end[-1] == '\r') end--;
+        const char *p = skip_separators(begin, end);
+        if (p == end) return false;  // Empty line
+
+        const char *q = find_separator(p, end);
+        hex_.assign(p, q);
+        std::transform(hex_.begin(), hex_.end(), hex_.begin(),
+                       [](char c) {
+                           return ('a' <= c && c <= 'f') ? c - 'a' + 'A' : c;
+                       });
+        Status status;
+        std::tie(status, record.tag_) = Tag::createFromBinary(hex_);
+        if (status != Status::kOk) {
+            record.status_ = status;
+            return true;
+        }
+
+        p = skip_separators(q, end);
+        if (p == end) return true;
+        q = find_separator(p, end);
+        if (!parse_unsigned(p, q, record.timestamp_)) {
+            record.status_ = Status::kInvalidArgument;
+            return true;
+        }
+        record.has_timestamp_ = true;
+
+        p = skip_separators(q, end);
+        if (p == end) return true;
+        q = find_separator(p, end);
+        uint64_t antenna;
+        if (!parse_unsigned(p, q, antenna)
+            || skip_separators(q, end) != end) {
+            record.status_ = Status::kInvalidArgument;
+            return true;
+        }
+        record.antenna_ = static_cast<unsigned int>(antenna);
+        record.has_antenna_ = true;
+        return true;
+    }
+}
@@ -0,0 +1,373 @@
+#include "rule_matcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBEPC_RULE_MATCHER_X86
+#include <immintrin.h>
+#endif
+
+namespace epc {
+    namespace {
+        constexpr unsigned int BITS = 96;
+        // The number of EPCs matched at a time, one bit each in a word.
+        constexpr size_t BLOCK_SIZE = 64;
+        // The number of EPCs or terms whose results of 64-bit lanes fill a
+        // word. Terms are padded to a multiple of it.
+        constexpr size_t CHUNK_SIZE = 32;
+        // Vectors match batches rule-major up to this number of terms,
+        // where a term stays in registers while blocks of EPCs are loaded
+        // in a loop without dependencies. Beyond it, scattering sparse hits
+        // of terms costs more than loading terms for each EPC. Scalar code
+        // is always faster tag-major, which skips the scattering.
+        constexpr size_t RULE_MAJOR_MAX_TERMS = 512;
+
+        using Terms = struct TermsStruct {
+            const uint64_t *masks_;
+            const uint64_t *values_;
+            const uint64_t *rule_bits_;
+            size_t count_;
+            /** The number of terms including padding */
+            size_t padded_count_;
+            bool one_term_per_rule_;
+        };
+
+        /**
+         * A function matching n EPCs of a block given as pairs of the lower
+         * and the upper 64 bits, padded with zeros to BLOCK_SIZE EPCs.
+         * Bitmaps of rules are ORed into rules.
+         */
+        using Kernel = void (*)(const Terms &terms, const uint64_t *keys,
+                                size_t n, uint64_t *rules);
+
+        Epc96 get_prefix_mask(unsigned int bits) {
+            uint32_t high = bits >= 32 ? ~0U
+                : bits == 0 ? 0 : ~0U << (32 - bits);
+            uint64_t low = bits <= 32 ? 0
+                : bits >= BITS ? ~0ULL : ~0ULL << (BITS - bits);
+            return Epc96(high, low);
+        }
+
+        inline uint64_t get_valid_bits(size_t n) {
+            return n >= 64 ? ~0ULL : (1ULL << n) - 1;
+        }
+
+        inline void scatter(uint64_t hits, uint64_t rule_bit,
+                            uint64_t *rules) {
+            while (hits != 0) {
+                rules[__builtin_ctzll(hits)] |= rule_bit;
+                hits &= hits - 1;
+            }
+        }
+
+        inline uint64_t to_rules(const Terms &terms, size_t first,
+                                 uint64_t hits) {
+            if (terms.one_term_per_rule_) return hits << first;
+            uint64_t rules = 0;
+            while (hits != 0) {
+                rules |= terms.rule_bits_[first + __builtin_ctzll(hits)];
+                hits &= hits - 1;
+            }
+            return rules;
+        }
+
+        inline bool matches(const uint64_t *key, const uint64_t *mask,
+                            const uint64_t *value) {
+            return (((key[0] & mask[0]) ^ value[0])
+                    | ((key[1] & mask[1]) ^ value[1])) == 0;
+        }
+
+        void scalar_rule_major(const Terms &terms, const uint64_t *keys,
+                               size_t n, uint64_t *rules) {
+            for (size_t t = 0; t < terms.count_; t++) {
+                const uint64_t *mask = terms.masks_ + 2 * t;
+                const uint64_t *value = terms.values_ + 2 * t;
+                uint64_t hits = 0;
+                for (size_t i = 0; i < n; i++) {
+                    hits |= static_cast<uint64_t>(
+                        matches(keys + 2 * i, mask, value)) << i;
+                }
+                scatter(hits, terms.rule_bits_[t], rules);
+            }
+        }
+
+        void scalar_tag_major(const Terms &terms, const uint64_t *keys,
+                              size_t n, uint64_t *rules) {
+            for (size_t i = 0; i < n; i++) {
+                uint64_t result = 0;
+                for (size_t t = 0; t < terms.count_; t++) {
+                    if (matches(keys + 2 * i, terms.masks_ + 2 * t,
+                                terms.values_ + 2 * t)) {
+                        result |= terms.rule_bits_[t];
+                    }
+                }
+                rules[i] |= result;
+            }
+        }
+
+#ifdef LIBEPC_RULE_MATCHER_X86
+        /**
+         * Returns a bit for each pair of bits of 64-bit lanes compared, set
+         * if both lanes of the pair are equal. Results of 2 or 4 lanes are
+         * collected in words and compressed at once, which costs less than
+         * compressing each comparison.
+         */
+        inline uint64_t compress_pairs(uint64_t lanes) {
+            uint64_t x = lanes & lanes >> 1 & 0x5555555555555555;
+            x = (x | x >> 1) & 0x3333333333333333;
+            x = (x | x >> 2) & 0x0F0F0F0F0F0F0F0F;
+            x = (x | x >> 4) & 0x00FF00FF00FF00FF;
+            x = (x | x >> 8) & 0x0000FFFF0000FFFF;
+            return (x | x >> 16) & 0x00000000FFFFFFFF;
+        }
+
+        __attribute__((target("avx2")))
+        inline uint64_t avx2_compare(__m256i keys, __m256i masks,
+                                     __m256i values) {
+            __m256i eq = _mm256_cmpeq_epi64(_mm256_and_si256(keys, masks),
+                                            values);
+            return _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i avx2_broadcast(const uint64_t *p) {
+            return _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i avx2_load(const uint64_t *p) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        }
+
+        __attribute__((target("avx2")))
+        void avx2_rule_major(const Terms &terms, const uint64_t *keys,
+                             size_t n, uint64_t *rules) {
+            for (size_t t = 0; t < terms.count_; t++) {
+                __m256i masks = avx2_broadcast(terms.masks_ + 2 * t);
+                __m256i values = avx2_broadcast(terms.values_ + 2 * t);
+                uint64_t hits = 0;
+                for (size_t first = 0; first < BLOCK_SIZE;
+                     first += CHUNK_SIZE) {
+                    const uint64_t *chunk = keys + 2 * first;
+                    uint64_t lanes = 0;
+                    for (size_t i = 0; i < CHUNK_SIZE; i += 2) {
+                        lanes |= avx2_compare(avx2_load(chunk + 2 * i), masks,
+                                              values) << 2 * i;
+                    }
+                    hits |= compress_pairs(lanes) << first;
+                }
+                scatter(hits & get_valid_bits(n), terms.rule_bits_[t],
+                        rules);
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void avx2_tag_major(const Terms &terms, const uint64_t *keys,
+                            size_t n, uint64_t *rules) {
+            for (size_t i = 0; i < n; i++) {
+                __m256i key = avx2_broadcast(keys + 2 * i);
+                uint64_t result = 0;
+                for (size_t first = 0; first < terms.padded_count_;
+                     first += CHUNK_SIZE) {
+                    const uint64_t *masks = terms.masks_ + 2 * first;
+                    const uint64_t *values = terms.values_ + 2 * first;
+                    uint64_t lanes = 0;
+                    for (size_t t = 0; t < CHUNK_SIZE; t += 2) {
+                        lanes |= avx2_compare(key, avx2_load(masks + 2 * t),
+                                              avx2_load(values + 2 * t))
+                            << 2 * t;
+                    }
+                    result |= to_rules(terms, first, compress_pairs(lanes));
+                }
+                rules[i] |= result;
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        inline uint64_t avx512_compare(__m512i keys, __m512i masks,
+                                       __m512i values) {
+            return _mm512_cmpeq_epi64_mask(_mm512_and_si512(keys, masks),
+                                           values);
+        }
+
+        __attribute__((target("avx512f")))
+        inline __m512i avx512_broadcast(const uint64_t *p) {
+            // Both words in each 128-bit lane, i.e. p[0] in even and p[1]
+            // in odd elements.
+            return _mm512_set4_epi64(static_cast<long long>(p[1]),
+                                     static_cast<long long>(p[0]),
+                                     static_cast<long long>(p[1]),
+                                     static_cast<long long>(p[0]));
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512_rule_major(const Terms &terms, const uint64_t *keys,
+                               size_t n, uint64_t *rules) {
+            for (size_t t = 0; t < terms.count_; t++) {
+                __m512i masks = avx512_broadcast(terms.masks_ + 2 * t);
+                __m512i values = avx512_broadcast(terms.values_ + 2 * t);
+                uint64_t hits = 0;
+                for (size_t first = 0; first < BLOCK_SIZE;
+                     first += CHUNK_SIZE) {
+                    const uint64_t *chunk = keys + 2 * first;
+                    uint64_t lanes = 0;
+                    for (size_t i = 0; i < CHUNK_SIZE; i += 4) {
+                        lanes |= avx512_compare(
+                            _mm512_loadu_si512(chunk + 2 * i), masks, values)
+                            << 2 * i;
+                    }
+                    hits |= compress_pairs(lanes) << first;
+                }
+                scatter(hits & get_valid_bits(n), terms.rule_bits_[t],
+                        rules);
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void avx512_tag_major(const Terms &terms, const uint64_t *keys,
+                              size_t n, uint64_t *rules) {
+            for (size_t i = 0; i < n; i++) {
+                __m512i key = avx512_broadcast(keys + 2 * i);
+                uint64_t result = 0;
+                for (size_t first = 0; first < terms.padded_count_;
+                     first += CHUNK_SIZE) {
+                    const uint64_t *masks = terms.masks_ + 2 * first;
+                    const uint64_t *values = terms.values_ + 2 * first;
+                    uint64_t lanes = 0;
+                    for (size_t t = 0; t < CHUNK_SIZE; t += 4) {
+                        lanes |= avx512_compare(
+                            key, _mm512_loadu_si512(masks + 2 * t),
+                            _mm512_loadu_si512(values + 2 * t)) << 2 * t;
+                    }
+                    result |= to_rules(terms, first, compress_pairs(lanes));
+                }
+                rules[i] |= result;
+            }
+        }
+#endif
+
+        Kernel get_kernel(RuleMatcher::InstructionSet instruction_set,
+                          bool rule_major) {
+            switch (instruction_set) {
+#ifdef LIBEPC_RULE_MATCHER_X86
+            case RuleMatcher::InstructionSet::kAVX512:
+                return rule_major ? avx512_rule_major : avx512_tag_major;
+            case RuleMatcher::InstructionSet::kAVX2:
+                return rule_major ? avx2_rule_major : avx2_tag_major;
+#endif
+            default:
+                return rule_major ? scalar_rule_major : scalar_tag_major;
+            }
+        }
+    }
+
+    RuleMatcher::RuleMatcher()
+        : instruction_set_(getSupportedInstructionSet()) {}
+
+    RuleMatcher::InstructionSet RuleMatcher::getSupportedInstructionSet() {
+#ifdef LIBEPC_RULE_MATCHER_X86
+        if (__builtin_cpu_supports("avx512f")) {
+            return InstructionSet::kAVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) return InstructionSet::kAVX2;
+#endif
+        return InstructionSet::kScalar;
+    }
+
+    bool RuleMatcher::setInstructionSet(InstructionSet instruction_set) {
+        if (instruction_set > getSupportedInstructionSet()) return false;
+        instruction_set_ = instruction_set;
+        return true;
+    }
+
+    void RuleMatcher::addTerm(const Epc96 &mask, const Epc96 &value,
+                              size_t rule) {
+        if (term_count_ % CHUNK_SIZE == 0) {
+            // Padding terms never match since their masked bits are zeros.
+            masks_.resize(masks_.size() + 2 * CHUNK_SIZE, 0);
+            values_.resize(values_.size() + 2 * CHUNK_SIZE, ~0ULL);
+            rule_bits_.resize(rule_bits_.size() + CHUNK_SIZE, 0);
+        }
+        size_t t = term_count_++;
+        masks_[2 * t] = mask.getLow();
+        masks_[2 * t + 1] = mask.getHigh();
+        values_[2 * t] = value.getLow() & mask.getLow();
+        values_[2 * t + 1] = value.getHigh() & mask.getHigh();
+        rule_bits_[t] = 1ULL << rule;
+        if (t != rule) one_term_per_rule_ = false;
+    }
+
+    std::pair<Status, size_t> RuleMatcher::addRule(const Epc96 &mask,
+                                                   const Epc96 &value) {
+        if (rule_count_ == MAX_RULES) {
+            return std::make_pair(Status::kInvalidArgument, 0);
+        }
+        addTerm(mask, value, rule_count_);
+        return std::make_pair(Status::kOk, rule_count_++);
+    }
+
+    std::pair<Status, size_t> RuleMatcher::addRule(
+        const EpcIndexQuery &query) {
+        Status status;
+        std::vector<EpcRange> ranges;
+        std::tie(status, ranges) = get_index_ranges(query);
+        if (status != Status::kOk || rule_count_ == MAX_RULES) {
+            return std::make_pair(Status::kInvalidArgument, 0);
+        }
+        size_t term_count = 0;
+        for (const EpcRange &range : ranges) {
+            for (const EpcPrefix &prefix : get_range_prefixes(range)) {
+                addTerm(get_prefix_mask(prefix.bits_), prefix.value_,
+                        rule_count_);
+                term_count++;
+            }
+        }
+        if (term_count != 1) one_term_per_rule_ = false;
+        return std::make_pair(Status::kOk, rule_count_++);
+    }
+
+    uint64_t RuleMatcher::match(const Epc96 &epc) const {
+        uint64_t key[2] = {epc.getLow(), epc.getHigh()};
+        uint64_t rules = 0;
+        for (size_t t = 0; t < term_count_; t++) {
+            if (matches(key, &masks_[2 * t], &values_[2 * t])) {
+                rules |= rule_bits_[t];
+            }
+        }
+        return rules;
+    }
+
+    size_t RuleMatcher::match(const Epc96 *epcs, size_t n, uint64_t *rules,
+                              LoopOrder order) const {
+        std::memset(rules, 0, n * sizeof(uint64_t));
+        if (term_count_ == 0) return 0;
+        if (order == LoopOrder::kAuto) {
+            order = instruction_set_ != InstructionSet::kScalar
+                    && term_count_ <= RULE_MAJOR_MAX_TERMS
+                ? LoopOrder::kRuleMajor : LoopOrder::kTagMajor;
+        }
+        Kernel kernel = get_kernel(instruction_set_,
+                                   order == LoopOrder::kRuleMajor);
+        Terms terms = {masks_.data(), values_.data(), rule_bits_.data(),
+                       term_count_, rule_bits_.size(), one_term_per_rule_};
+
+        alignas(64) uint64_t keys[2 * BLOCK_SIZE];
+        size_t count = 0;
+        for (size_t begin = 0; begin < n; begin += BLOCK_SIZE) {
+            size_t m = std::min(BLOCK_SIZE, n - begin);
+            for (size_t i = 0; i < m; i++) {
+                keys[2 * i] = epcs[begin + i].getLow();
+                keys[2 * i + 1] = epcs[begin + i].getHigh();
+            }
+            std::fill(keys + 2 * m, keys + 2 * BLOCK_SIZE, 0);
+            kernel(terms, keys, m, rules + begin);
+            for (size_t i = 0; i < m; i++) {
+                if (rules[begin + i] != 0) count++;
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,132 @@
+#include "select_mask.h"
+#include "layout.h"
+
+#include <cstring>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        constexpr unsigned int BITS = 96;
+        constexpr unsigned int HEADER_BITS = 8;
+
+        inline unsigned int get_bit(const Epc96 &epc, unsigned int bit) {
+            return bit < 32 ? epc.getHigh() >> (31 - bit) & 1
+                            : epc.getLow() >> (95 - bit) & 1;
+        }
+
+        inline Epc96 set_bit(const Epc96 &epc, unsigned int bit) {
+            return bit < 32 ? Epc96(epc.getHigh() | 1U << (31 - bit),
+                                    epc.getLow())
+                            : Epc96(epc.getHigh(),
+                                    epc.getLow() | 1ULL << (95 - bit));
+        }
+
+        SelectMask make_mask(uint8_t action, const Epc96 &value,
+                             unsigned int first, unsigned int last) {
+            SelectMask mask;
+            mask.action_ = action;
+            mask.pointer_ = SELECT_EPC_POINTER + first;
+            mask.length_ = last - first;
+            mask.mask_.assign((mask.length_ + 7) / 8, 0);
+            for (unsigned int i = 0; i < mask.length_; i++) {
+                mask.mask_[i / 8] |= get_bit(value, first + i) << (7 - i % 8);
+            }
+            return mask;
+        }
+
+        bool apply(uint8_t action, bool matched, bool selected) {
+            switch (action) {
+            case SELECT_ACTION_ASSERT_DEASSERT:
+                return matched;
+            case SELECT_ACTION_ASSERT_NOTHING:
+                return matched || selected;
+            case SELECT_ACTION_NOTHING_DEASSERT:
+                return matched && selected;
+            case SELECT_ACTION_NEGATE_NOTHING:
+                return matched ? !selected : selected;
+            case SELECT_ACTION_DEASSERT_ASSERT:
+                return !matched;
+            case SELECT_ACTION_DEASSERT_NOTHING:
+                return !matched && selected;
+            case SELECT_ACTION_NOTHING_ASSERT:
+                return !matched || selected;
+            case SELECT_ACTION_NOTHING_NEGATE:
+                return matched ? selected : !selected;
+            default:
+                return selected;
+            }
+        }
+    }
+
+    std::pair<Status, std::vector<SelectMask>> compile_select_masks(
+        const EpcIndexQuery &query) {
+        std::vector<SelectMask> masks;
+        Status status;
+        std::vector<EpcRange> ranges;
+        std::tie(status, ranges) = get_index_ranges(query);
+        if (status != Status::kOk || ranges.empty()) {
+            return std::make_pair(Status::kInvalidArgument, masks);
+        }
+        // The ranges of filter values differ only in the filter.
+        bool any_filter = query.filter_ < 0;
+        unsigned int first = any_filter ? LAYOUT_PARTITION_OFFSET : 0;
+        std::vector<EpcPrefix> prefixes = get_range_prefixes(ranges[0]);
+        for (size_t i = 0; i < prefixes.size(); i++) {
+            uint8_t action = i == 0 ? SELECT_ACTION_ASSERT_DEASSERT
+                                    : SELECT_ACTION_ASSERT_NOTHING;
+            masks.push_back(make_mask(action, prefixes[i].value_, first,
+                                      prefixes[i].bits_));
+        }
+        if (any_filter) {
+            masks.push_back(make_mask(SELECT_ACTION_NOTHING_DEASSERT,
+                                      ranges[0].first_, 0, HEADER_BITS));
+        }
+        return std::make_pair(Status::kOk, masks);
+    }
+
+    SelectMatcher::SelectMatcher(const std::vector<SelectMask> &masks) {
+        for (const SelectMask &mask : masks) {
+            Command command = Command();
+            command.action_ = mask.action_;
+            command.valid_ = mask.pointer_ >= SELECT_EPC_POINTER
+                && mask.pointer_ - SELECT_EPC_POINTER + mask.length_ <= BITS
+                && mask.mask_.size() * 8 >= mask.length_;
+            if (command.valid_) {
+                unsigned int first = mask.pointer_ - SELECT_EPC_POINTER;
+                for (unsigned int i = 0; i < mask.length_; i++) {
+                    command.care_ = set_bit(command.care_, first + i);
+                    if (mask.mask_[i / 8] >> (7 - i % 8) & 1) {
+                        command.value_ = set_bit(command.value_, first + i);
+                    }
+                }
+            }
+            commands_.push_back(command);
+        }
+    }
+
+    bool SelectMatcher::matches(const Epc96 &epc) const {
+        bool selected = false;
+        for (const Command &command : commands_) {
+            bool matched = command.valid_
+                && ((epc.getHigh() ^ command.value_.getHigh())
+                    & command.care_.getHigh()) == 0
+                && ((epc.getLow() ^ command.value_.getLow())
+                    & command.care_.getLow()) == 0;
+            selected = apply(command.action_, matched, selected);
+        }
+        return selected;
+    }
+
+    size_t SelectMatcher::matches(const Epc96 *epcs, size_t n,
+                                  uint64_t *mask) const {
+        std::memset(mask, 0, (n + 63) / 64 * sizeof(uint64_t));
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (matches(epcs[i])) {
+                mask[i / 64] |= uint64_t(1) << (i % 64);
+                count++;
+            }
+        }
+        return count;
+    }
+}
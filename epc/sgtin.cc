@@ -94,6 +94,9 @@ namespace epc {
         }
         unsigned int filter = decode_integer(read_string(ss, 3));
         unsigned int partition = decode_integer(read_string(ss, 3));
+        if (partition >= PARTITION_TABLE_SIZE) {
+            return std::make_pair(Status::kInvalidArgument, sgtin);
+        }
         PartitionTable table = getPartitionTable(partition);
         std::string company_prefix = std::to_string(
             decode_integer(read_string(ss, table.company_prefix_bits_)));
@@ -139,8 +142,7 @@ namespace epc {
 
     Status SGTIN::validateSerialForBinaryCoding() const {
         if (scheme_ == Scheme::kSGTIN96) {
-            if (is_padded_numbers(serial_)
-                && std::stoll(serial_, nullptr, 10) <= MAX_SGTIN96_SERIAL) {
+            if (is_integer_at_most(serial_, MAX_SGTIN96_SERIAL)) {
                 return Status::kOk;
             }
         } else {
@@ -200,11 +202,14 @@ namespace epc {
     }
 
     std::pair<Status, std::string> SGTIN::getBinary() const {
+        PartitionTable table = getPartitionTable(company_prefix_);
+        if (table.company_prefix_digits_ != company_prefix_.length()) {
+            return std::make_pair(Status::kInvalidArgument, "");
+        }
         Status status = validateSerialForBinaryCoding();
         if (status != Status::kOk) return std::make_pair(status, "");
 
         std::stringstream ss;
-        PartitionTable table = getPartitionTable(company_prefix_);
         if (scheme_ == Scheme::kSGTIN96) {
             ss << SGTIN96_HEADER;
         } else {
@@ -212,7 +217,7 @@ namespace epc {
         }
         ss << encode_integer(getFilterValue(), FILTER_VALUE_BITS);
         ss << encode_integer(table.partition_, PARTITION_BITS);
-        ss << encode_integer(std::stoi(company_prefix_),
+        ss << encode_integer(std::stoll(company_prefix_),
                              table.company_prefix_bits_);
         ss << encode_integer(std::stoi(itemref_indicator_),
                              table.indicator_itemref_bits_);
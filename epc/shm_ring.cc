@@ -0,0 +1,266 @@
+#include "shm_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        constexpr char MAGIC[8] = {'E', 'P', 'C', 'R', 'I', 'N', 'G', '\0'};
+        constexpr uint32_t VERSION = 1;
+        constexpr size_t CACHE_LINE = 64;
+        constexpr size_t MAX_CAPACITY = size_t(1) << 30;
+
+        static_assert(sizeof(ShmRingRecord) == 48, "unexpected record size");
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                      "positions must be lock-free to be shared");
+
+        uint64_t round_up_to_power_of_2(uint64_t n) {
+            uint64_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+    }
+
+    struct ShmRing::Header {
+        char magic_[8];
+        uint32_t version_;
+        uint32_t record_size_;
+        uint64_t capacity_;
+        // Position of the next record written by the producer.
+        alignas(CACHE_LINE) std::atomic<uint64_t> head_;
+        // Position of the next record read by the consumer.
+        alignas(CACHE_LINE) std::atomic<uint64_t> tail_;
+    };
+
+    ShmRing::ShmRing(ShmRing &&other)
+        : fd_(other.fd_), data_(other.data_), length_(other.length_),
+          header_(other.header_), records_(other.records_),
+          mask_(other.mask_), cached_head_(other.cached_head_),
+          cached_tail_(other.cached_tail_) {
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.length_ = 0;
+        other.header_ = nullptr;
+        other.records_ = nullptr;
+        other.mask_ = static_cast<uint64_t>(-1);
+    }
+
+    ShmRing &ShmRing::operator=(ShmRing &&other) {
+        if (this != &other) {
+            close();
+            fd_ = other.fd_;
+            data_ = other.data_;
+            length_ = other.length_;
+            header_ = other.header_;
+            records_ = other.records_;
+            mask_ = other.mask_;
+            cached_head_ = other.cached_head_;
+            cached_tail_ = other.cached_tail_;
+            other.fd_ = -1;
+            other.data_ = nullptr;
+            other.length_ = 0;
+            other.header_ = nullptr;
+            other.records_ = nullptr;
+            other.mask_ = static_cast<uint64_t>(-1);
+        }
+        return *this;
+    }
+
+    ShmRing::~ShmRing() {
+        close();
+    }
+
+    void ShmRing::close() {
+        if (data_) ::munmap(data_, length_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        data_ = nullptr;
+        length_ = 0;
+        header_ = nullptr;
+        records_ = nullptr;
+        mask_ = static_cast<uint64_t>(-1);
+    }
+
+    std::pair<Status, ShmRing> ShmRing::create(size_t capacity) {
+#ifdef __linux__
+        int fd = ::memfd_create("libepc-ring", MFD_CLOEXEC);
+        if (fd < 0) return std::make_pair(Status::kInvalidArgument, ShmRing());
+        return initialize(fd, capacity);
+#else
+        (void)capacity;
+        return std::make_pair(Status::kInvalidArgument, ShmRing());
+#endif
+    }
+
+    std::pair<Status, ShmRing> ShmRing::create(const std::string &name,
+                                               size_t capacity) {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) return std::make_pair(Status::kInvalidArgument, ShmRing());
+        auto result = initialize(fd, capacity);
+        if (result.first != Status::kOk) ::shm_unlink(name.c_str());
+        return result;
+    }
+
+    std::pair<Status, ShmRing> ShmRing::initialize(int fd, size_t capacity) {
+        if (capacity == 0 || capacity > MAX_CAPACITY) {
+            ::close(fd);
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        capacity = round_up_to_power_of_2(capacity);
+        size_t length = sizeof(Header) + capacity * sizeof(ShmRingRecord);
+        if (::ftruncate(fd, length) < 0) {
+            ::close(fd);
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        void *data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        // The memory is zero-filled by ftruncate.
+        Header *header = new (data) Header;
+        header->version_ = VERSION;
+        header->record_size_ = sizeof(ShmRingRecord);
+        header->capacity_ = capacity;
+        header->head_.store(0, std::memory_order_relaxed);
+        header->tail_.store(0, std::memory_order_relaxed);
+        // Publish the magic last so that a ring is never opened half-built.
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic_, MAGIC, sizeof(MAGIC));
+        ::munmap(data, length);
+
+        auto result = map(fd);
+        ::close(fd);
+        return result;
+    }
+
+    std::pair<Status, ShmRing> ShmRing::open(int fd) {
+        return map(fd);
+    }
+
+    std::pair<Status, ShmRing> ShmRing::open(const std::string &name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return std::make_pair(Status::kInvalidArgument, ShmRing());
+        auto result = map(fd);
+        ::close(fd);
+        return result;
+    }
+
+    Status ShmRing::unlink(const std::string &name) {
+        if (::shm_unlink(name.c_str()) < 0) return Status::kInvalidArgument;
+        return Status::kOk;
+    }
+
+    // Maps the ring in fd and holds a duplicate of fd.
+    std::pair<Status, ShmRing> ShmRing::map(int fd) {
+        struct stat st;
+        if (::fstat(fd, &st) < 0
+            || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        size_t length = st.st_size;
+        void *data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        ShmRing ring;
+        ring.data_ = data;
+        ring.length_ = length;
+        ring.header_ = static_cast<Header *>(data);
+        const Header &header = *ring.header_;
+        if (std::memcmp(header.magic_, MAGIC, sizeof(MAGIC)) != 0
+            || header.version_ != VERSION
+            || header.record_size_ != sizeof(ShmRingRecord)
+            || header.capacity_ == 0 || header.capacity_ > MAX_CAPACITY
+            || (header.capacity_ & (header.capacity_ - 1)) != 0
+            || length != sizeof(Header)
+                         + header.capacity_ * sizeof(ShmRingRecord)) {
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        ring.fd_ = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (ring.fd_ < 0) {
+            return std::make_pair(Status::kInvalidArgument, ShmRing());
+        }
+        ring.records_ = reinterpret_cast<ShmRingRecord *>(
+            static_cast<char *>(data) + sizeof(Header));
+        ring.mask_ = header.capacity_ - 1;
+        ring.cached_head_ = header.head_.load(std::memory_order_acquire);
+        ring.cached_tail_ = header.tail_.load(std::memory_order_acquire);
+        return std::make_pair(Status::kOk, std::move(ring));
+    }
+
+    size_t ShmRing::size() const {
+        if (!header_) return 0;
+        uint64_t tail = header_->tail_.load(std::memory_order_acquire);
+        uint64_t head = header_->head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    bool ShmRing::push(const uint8_t *epc, size_t size, uint64_t timestamp,
+                       uint16_t antenna) {
+        if (!header_ || size > MAX_EPC_BYTES) return false;
+        uint64_t head = header_->head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = header_->tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) return false;
+        }
+        ShmRingRecord &record = records_[head & mask_];
+        record.timestamp_ = timestamp;
+        record.antenna_ = antenna;
+        record.size_ = static_cast<uint8_t>(size);
+        std::memcpy(record.epc_, epc, size);
+        header_->head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t ShmRing::push(const ShmRingRecord *records, size_t n) {
+        if (!header_) return 0;
+        uint64_t head = header_->head_.load(std::memory_order_relaxed);
+        uint64_t capacity = mask_ + 1;
+        if (capacity - (head - cached_tail_) < n) {
+            cached_tail_ = header_->tail_.load(std::memory_order_acquire);
+        }
+        size_t count = std::min<uint64_t>(n, capacity - (head - cached_tail_));
+        if (count == 0) return 0;
+        size_t offset = head & mask_;
+        size_t first = std::min<size_t>(count, capacity - offset);
+        std::memcpy(records_ + offset, records, first * sizeof(ShmRingRecord));
+        std::memcpy(records_, records + first,
+                    (count - first) * sizeof(ShmRingRecord));
+        header_->head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t ShmRing::pop(ShmRingRecord *records, size_t n) {
+        return consume(n, [&records](const ShmRingRecord *run, size_t size) {
+            std::memcpy(records, run, size * sizeof(ShmRingRecord));
+            records += size;
+        });
+    }
+
+    size_t ShmRing::consume(size_t max, const Consumer &consumer) {
+        if (!header_) return 0;
+        uint64_t tail = header_->tail_.load(std::memory_order_relaxed);
+        if (cached_head_ - tail < max) {
+            cached_head_ = header_->head_.load(std::memory_order_acquire);
+        }
+        size_t count = std::min<uint64_t>(max, cached_head_ - tail);
+        if (count == 0) return 0;
+        uint64_t capacity = mask_ + 1;
+        size_t offset = tail & mask_;
+        size_t first = std::min<size_t>(count, capacity - offset);
+        consumer(records_ + offset, first);
+        if (first < count) consumer(records_, count - first);
+        header_->tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+}
@@ -0,0 +1,355 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace epc {
+    namespace {
+        constexpr char MAGIC[8] = {'E', 'P', 'C', 'S', 'N', 'A', 'P', '\0'};
+        constexpr size_t HEADER_SIZE = 24;
+        constexpr size_t INDEX_ENTRY_SIZE = 32;
+        constexpr unsigned int MAX_WIDTH = 96;
+
+        void store_le(std::string &s, size_t at, uint64_t v, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                s[at + i] = static_cast<char>(v >> (i * 8));
+            }
+        }
+
+        uint64_t load_le64(const char *p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap64(v);
+#endif
+            return v;
+        }
+
+        uint64_t load_le(const char *p, size_t n) {
+            uint64_t v = 0;
+            for (size_t i = 0; i < n; i++) {
+                v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (i * 8);
+            }
+            return v;
+        }
+
+        unsigned int bit_width(uint64_t v) {
+            return v == 0 ? 0 : 64 - __builtin_clzll(v);
+        }
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint64_t> &words) : words_(words) {}
+
+            void write(uint64_t v, unsigned int width) {
+                if (width == 0) return;
+                size_t word = pos_ >> 6;
+                unsigned int shift = pos_ & 63;
+                if (word >= words_.size()) words_.push_back(0);
+                words_[word] |= v << shift;
+                if (shift + width > 64) {
+                    words_.push_back(v >> (64 - shift));
+                }
+                pos_ += width;
+            }
+
+        private:
+            std::vector<uint64_t> &words_;
+            size_t pos_ = 0;
+        };
+
+        class BitReader {
+        public:
+            explicit BitReader(const char *data) : data_(data) {}
+
+            uint64_t read(unsigned int width) {
+                if (width == 0) return 0;
+                size_t word = pos_ >> 6;
+                unsigned int shift = pos_ & 63;
+                uint64_t v = load_le64(data_ + word * 8) >> shift;
+                if (shift + width > 64) {
+                    v |= load_le64(data_ + word * 8 + 8) << (64 - shift);
+                }
+                pos_ += width;
+                return width == 64 ? v : v & ((1ULL << width) - 1);
+            }
+
+        private:
+            const char *data_;
+            size_t pos_ = 0;
+        };
+
+        constexpr size_t EXCEPTION_SIZE = 16;
+
+        size_t get_word_count(size_t count, unsigned int width) {
+            return ((count - 1) * width + 63) / 64;
+        }
+
+        // Calls f on every EPC of a block in ascending order until f
+        // returns false. Differences listed in the exceptions replace the
+        // bit-packed ones at their positions.
+        template <typename F>
+        void for_each_epc(const char *data, const Epc96 &first,
+                          unsigned int width, size_t count,
+                          size_t exception_count, F f) {
+            uint32_t high = first.getHigh();
+            uint64_t low = first.getLow();
+            if (!f(first)) return;
+            BitReader reader(data);
+            const char *exception = data + get_word_count(count, width) * 8;
+            const char *exception_end =
+                exception + exception_count * EXCEPTION_SIZE;
+            size_t next = exception != exception_end
+                ? load_le(exception, 4) : count;
+            if (width <= 64) {
+                for (size_t i = 1; i < count; i++) {
+                    uint64_t d_low = reader.read(width);
+                    uint32_t d_high = 0;
+                    if (i == next) {
+                        d_high = load_le(exception + 4, 4);
+                        d_low = load_le64(exception + 8);
+                        exception += EXCEPTION_SIZE;
+                        next = exception != exception_end
+                            ? load_le(exception, 4) : count;
+                    }
+                    low += d_low;
+                    high += d_high + (low < d_low);
+                    if (!f(Epc96(high, low))) return;
+                }
+                return;
+            }
+            for (size_t i = 1; i < count; i++) {
+                uint64_t d_low = reader.read(64);
+                uint32_t d_high = reader.read(width - 64);
+                if (i == next) {
+                    d_high = load_le(exception + 4, 4);
+                    d_low = load_le64(exception + 8);
+                    exception += EXCEPTION_SIZE;
+                    next = exception != exception_end
+                        ? load_le(exception, 4) : count;
+                }
+                low += d_low;
+                high += d_high + (low < d_low);
+                if (!f(Epc96(high, low))) return;
+            }
+        }
+
+        // Returns the width minimizing the size of a block, where
+        // differences wider than the width are stored as exceptions.
+        unsigned int choose_width(const std::vector<unsigned int> &widths) {
+            std::vector<size_t> histogram(MAX_WIDTH + 1, 0);
+            for (auto w : widths) histogram[w]++;
+            size_t wider = widths.size();
+            size_t best_bits = SIZE_MAX;
+            unsigned int best = 0;
+            for (unsigned int w = 0; w <= MAX_WIDTH; w++) {
+                wider -= histogram[w];
+                size_t bits = (widths.size() * w + 63) / 64 * 64
+                    + wider * EXCEPTION_SIZE * 8;
+                if (bits < best_bits) {
+                    best_bits = bits;
+                    best = w;
+                }
+            }
+            return best;
+        }
+    }
+
+    Snapshot Snapshot::create(std::vector<Epc96> epcs, size_t block_size) {
+        if (block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+        std::sort(epcs.begin(), epcs.end());
+        epcs.erase(std::unique(epcs.begin(), epcs.end()), epcs.end());
+
+        Snapshot snapshot;
+        snapshot.size_ = epcs.size();
+        snapshot.block_size_ = block_size;
+        size_t block_count = (epcs.size() + block_size - 1) / block_size;
+        size_t offset = HEADER_SIZE + block_count * INDEX_ENTRY_SIZE;
+
+        std::vector<uint64_t> words;
+        std::string exceptions;
+        std::string data;
+        for (size_t begin = 0; begin < epcs.size(); begin += block_size) {
+            size_t end = std::min(begin + block_size, epcs.size());
+            std::vector<uint64_t> d_lows;
+            std::vector<uint32_t> d_highs;
+            std::vector<unsigned int> widths;
+            for (size_t i = begin + 1; i < end; i++) {
+                uint64_t d_low = epcs[i].getLow() - epcs[i - 1].getLow();
+                uint32_t d_high = epcs[i].getHigh() - epcs[i - 1].getHigh()
+                    - (epcs[i].getLow() < epcs[i - 1].getLow());
+                d_lows.push_back(d_low);
+                d_highs.push_back(d_high);
+                widths.push_back(d_high != 0
+                                 ? 64 + bit_width(d_high) : bit_width(d_low));
+            }
+            unsigned int width = choose_width(widths);
+            words.clear();
+            exceptions.clear();
+            BitWriter writer(words);
+            for (size_t i = 0; i < widths.size(); i++) {
+                bool exception = widths[i] > width;
+                uint64_t d_low = exception ? 0 : d_lows[i];
+                uint32_t d_high = exception ? 0 : d_highs[i];
+                if (width <= 64) {
+                    writer.write(d_low, width);
+                } else {
+                    writer.write(d_low, 64);
+                    writer.write(d_high, width - 64);
+                }
+                if (exception) {
+                    size_t at = exceptions.size();
+                    exceptions.resize(at + EXCEPTION_SIZE);
+                    store_le(exceptions, at, i + 1, 4);
+                    store_le(exceptions, at + 4, d_highs[i], 4);
+                    store_le(exceptions, at + 8, d_lows[i], 8);
+                }
+            }
+            // Packed words are padded so that they are read as whole words.
+            words.resize(get_word_count(end - begin, width), 0);
+
+            IndexEntry entry = {
+                epcs[begin], width, static_cast<uint32_t>(end - begin),
+                static_cast<uint32_t>(exceptions.size() / EXCEPTION_SIZE),
+                offset + data.size()};
+            snapshot.index_.push_back(entry);
+            size_t at = data.size();
+            data.resize(at + words.size() * 8);
+            for (size_t i = 0; i < words.size(); i++) {
+                store_le(data, at + i * 8, words[i], 8);
+            }
+            data += exceptions;
+        }
+
+        std::string &bytes = snapshot.bytes_;
+        bytes.assign(offset, '\0');
+        std::memcpy(&bytes[0], MAGIC, sizeof(MAGIC));
+        store_le(bytes, 8, snapshot.size_, 8);
+        store_le(bytes, 16, block_size, 4);
+        store_le(bytes, 20, block_count, 4);
+        for (size_t i = 0; i < block_count; i++) {
+            const IndexEntry &entry = snapshot.index_[i];
+            size_t at = HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+            store_le(bytes, at, entry.first_.getHigh(), 4);
+            store_le(bytes, at + 4, entry.width_, 4);
+            store_le(bytes, at + 8, entry.first_.getLow(), 8);
+            store_le(bytes, at + 16, entry.offset_, 8);
+            store_le(bytes, at + 24, entry.count_, 4);
+            store_le(bytes, at + 28, entry.exception_count_, 4);
+        }
+        bytes += data;
+        return snapshot;
+    }
+
+    std::pair<Status, Snapshot> Snapshot::createFromBytes(std::string bytes) {
+        Snapshot snapshot;
+        if (bytes.size() < HEADER_SIZE
+            || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            return std::make_pair(Status::kInvalidArgument, Snapshot());
+        }
+        const char *p = bytes.data();
+        size_t size = load_le(p + 8, 8);
+        size_t block_size = load_le(p + 16, 4);
+        size_t block_count = load_le(p + 20, 4);
+        if (block_size == 0
+            || block_count > (bytes.size() - HEADER_SIZE) / INDEX_ENTRY_SIZE
+            || block_count != (size + block_size - 1) / block_size) {
+            return std::make_pair(Status::kInvalidArgument, Snapshot());
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < block_count; i++) {
+            const char *q = p + HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+            IndexEntry entry = {
+                Epc96(load_le(q, 4), load_le(q + 8, 8)),
+                static_cast<uint32_t>(load_le(q + 4, 4)),
+                static_cast<uint32_t>(load_le(q + 24, 4)),
+                static_cast<uint32_t>(load_le(q + 28, 4)),
+                load_le(q + 16, 8)};
+            bool last = i + 1 == block_count;
+            if (entry.width_ > MAX_WIDTH || entry.count_ == 0
+                || (last ? entry.count_ > block_size
+                    : entry.count_ != block_size)
+                || entry.exception_count_ >= entry.count_
+                || entry.offset_ > bytes.size()
+                || get_word_count(entry.count_, entry.width_) * 8
+                + entry.exception_count_ * EXCEPTION_SIZE
+                > bytes.size() - entry.offset_
+                || !isValidExceptions(bytes.data(), entry)) {
+                return std::make_pair(Status::kInvalidArgument, Snapshot());
+            }
+            total += entry.count_;
+            snapshot.index_.push_back(entry);
+        }
+        if (total != size) {
+            return std::make_pair(Status::kInvalidArgument, Snapshot());
+        }
+        snapshot.size_ = size;
+        snapshot.block_size_ = block_size;
+        snapshot.bytes_ = std::move(bytes);
+        return std::make_pair(Status::kOk, std::move(snapshot));
+    }
+
+    bool Snapshot::isValidExceptions(const char *bytes,
+                                     const IndexEntry &entry) {
+        // Exception positions must be ascending and inside the block.
+        const char *p = bytes + entry.offset_
+            + get_word_count(entry.count_, entry.width_) * 8;
+        size_t previous = 0;
+        for (size_t i = 0; i < entry.exception_count_; i++) {
+            size_t position = load_le(p + i * EXCEPTION_SIZE, 4);
+            if (position <= previous || position >= entry.count_) return false;
+            previous = position;
+        }
+        return true;
+    }
+
+    Epc96 Snapshot::get(size_t i) const {
+        const IndexEntry &entry = index_[i / block_size_];
+        size_t n = i % block_size_;
+        Epc96 epc;
+        for_each_epc(bytes_.data() + entry.offset_, entry.first_, entry.width_,
+                     entry.count_, entry.exception_count_,
+                     [&](const Epc96 &e) {
+                         epc = e;
+                         return n-- > 0;
+                     });
+        return epc;
+    }
+
+    bool Snapshot::contains(const Epc96 &epc) const {
+        auto it = std::upper_bound(
+            index_.begin(), index_.end(), epc,
+            [](const Epc96 &e, const IndexEntry &entry) {
+                return e < entry.first_;
+            });
+        if (it == index_.begin()) return false;
+        --it;
+        bool found = false;
+        for_each_epc(bytes_.data() + it->offset_, it->first_, it->width_,
+                     it->count_, it->exception_count_, [&](const Epc96 &e) {
+                         found = e == epc;
+                         return e < epc;
+                     });
+        return found;
+    }
+
+    size_t Snapshot::decodeBlock(size_t block, Epc96 *out) const {
+        const IndexEntry &entry = index_[block];
+        for_each_epc(bytes_.data() + entry.offset_, entry.first_, entry.width_,
+                     entry.count_, entry.exception_count_, [&out](const Epc96 &e) {
+                         *out++ = e;
+                         return true;
+                     });
+        return entry.count_;
+    }
+
+    std::vector<Epc96> Snapshot::decode() const {
+        std::vector<Epc96> epcs(size_);
+        size_t n = 0;
+        for (size_t i = 0; i < index_.size(); i++) {
+            n += decodeBlock(i, epcs.data() + n);
+        }
+        return epcs;
+    }
+}
@@ -73,12 +73,16 @@ namespace epc {
         }
         unsigned int filter = decode_integer(read_string(ss, 3));
         unsigned int partition = decode_integer(read_string(ss, 3));
+        if (partition >= PARTITION_TABLE.size()) {
+            return std::make_pair(Status::kInvalidArgument, sscc);
+        }
         PartitionTable table = getPartitionTable(partition);
         std::string company_prefix = std::to_string(
             decode_integer(read_string(ss, table.company_prefix_bits_)));
         lpad(company_prefix, table.company_prefix_digits_, '0');
         std::string ext_digti_serial_ref = std::to_string(
             decode_integer(read_string(ss, table.serial_ref_bits_)));
+        lpad(ext_digti_serial_ref, table.serial_ref_digits_, '0');
         std::tie(status, sscc) = create(
             company_prefix, ext_digti_serial_ref);
         if (status != Status::kOk) {
@@ -119,10 +123,13 @@ namespace epc {
     }
 
     std::pair<Status, std::string> SSCC::getBinary() const {
+        PartitionTable table = getPartitionTable(company_prefix_);
+        if (table.company_prefix_digits_ != company_prefix_.length()) {
+            return std::make_pair(Status::kInvalidArgument, "");
+        }
         std::stringstream ss;
         ss << SSCC96_HEADER
            << encode_integer(getFilterValue(), FILTER_VALUE_BITS);
-        PartitionTable table = getPartitionTable(company_prefix_);
         ss << encode_integer(table.partition_, PARTITION_BITS)
            << encode_integer(
                std::stoll(company_prefix_), table.company_prefix_bits_)
@@ -0,0 +1,323 @@
+#include "tag.h"
+#include "encode.h"
+#include "epc_view.h"
+
+#include <cstring>
+
+namespace epc {
+    namespace {
+        constexpr uint8_t FIRST_HEADER = 0x30;
+
+        // The schemes by header from FIRST_HEADER, where 0x35 isn't one.
+        const SchemeInfo SCHEMES[] = {
+            {0x30, TagType::kSGTIN, 96, 24, "sgtin-96"},
+            {0x31, TagType::kSSCC, 96, 24, "sscc-96"},
+            {0x32, TagType::kSGLN, 96, 24, "sgln-96"},
+            {0x33, TagType::kGRAI, 96, 24, "grai-96"},
+            {0x34, TagType::kGIAI, 96, 24, "giai-96"},
+            {0x35, TagType::kUnknown, 0, 0, ""},
+            {0x36, TagType::kSGTIN, 198, 52, "sgtin-198"},
+            {0x37, TagType::kGRAI, 170, 43, "grai-170"},
+            {0x38, TagType::kGIAI, 202, 52, "giai-202"},
+            {0x39, TagType::kSGLN, 195, 49, "sgln-195"},
+        };
+    }
+
+    const SchemeInfo *get_scheme_info(uint8_t header) {
+        unsigned int i = static_cast<uint8_t>(header - FIRST_HEADER);
+        if (i >= sizeof(SCHEMES) / sizeof(SCHEMES[0])
+            || SCHEMES[i].type_ == TagType::kUnknown) {
+            return nullptr;
+        }
+        return &SCHEMES[i];
+    }
+
+    const SchemeInfo *get_scheme_info(TagType type, unsigned int bits) {
+        for (const SchemeInfo &scheme : SCHEMES) {
+            if (scheme.type_ == type && scheme.bits_ == bits
+                && type != TagType::kUnknown) {
+                return &scheme;
+            }
+        }
+        return nullptr;
+    }
+
+    const char *get_tag_type_name(TagType type) {
+        switch (type) {
+        case TagType::kSGTIN:
+            return "sgtin";
+        case TagType::kSSCC:
+            return "sscc";
+        case TagType::kSGLN:
+            return "sgln";
+        case TagType::kGRAI:
+            return "grai";
+        case TagType::kGIAI:
+            return "giai";
+        default:
+            return "";
+        }
+    }
+
+    TagType get_tag_type(uint8_t header) {
+        const SchemeInfo *scheme = get_scheme_info(header);
+        return scheme ? scheme->type_ : TagType::kUnknown;
+    }
+
+    size_t get_hex_length(uint8_t header) {
+        const SchemeInfo *scheme = get_scheme_info(header);
+        return scheme ? scheme->hex_length_ : 0;
+    }
+
+    std::pair<Status, Tag> Tag::createFromBinary(const std::string &hex) {
+        Tag tag;
+        Status status;
+        int hi, lo;
+        if (hex.length() < 2
+            || (hi = hex_digit_value(hex[0])) < 0
+            || (lo = hex_digit_value(hex[1])) < 0) {
+            return std::make_pair(Status::kInvalidArgument, tag);
+        }
+        switch (get_tag_type(static_cast<uint8_t>(hi << 4 | lo))) {
+        case TagType::kSGTIN:
+            std::tie(status, tag.sgtin_) = SGTIN::createFromBinary(hex);
+            tag.type_ = TagType::kSGTIN;
+            break;
+        case TagType::kSSCC:
+            std::tie(status, tag.sscc_) = SSCC::createFromBinary(hex);
+            tag.type_ = TagType::kSSCC;
+            break;
+        case TagType::kSGLN:
+            std::tie(status, tag.sgln_) = SGLN::createFromBinary(hex);
+            tag.type_ = TagType::kSGLN;
+            break;
+        case TagType::kGRAI:
+            std::tie(status, tag.grai_) = GRAI::createFromBinary(hex);
+            tag.type_ = TagType::kGRAI;
+            break;
+        case TagType::kGIAI:
+            std::tie(status, tag.giai_) = GIAI::createFromBinary(hex);
+            tag.type_ = TagType::kGIAI;
+            break;
+        default:
+            return std::make_pair(Status::kInvalidArgument, tag);
+        }
+        if (status != Status::kOk) {
+            return std::make_pair(status, Tag());
+        }
+        return std::make_pair(Status::kOk, tag);
+    }
+
+    std::pair<Status, Tag> Tag::createFromBytes(const uint8_t *bytes,
+                                                size_t size) {
+        Tag tag;
+        Status status;
+        if (size == 0) return std::make_pair(Status::kInvalidArgument, tag);
+        size_t length = get_hex_length(bytes[0]);
+        if (length == 0 || size < (length + 1) / 2) {
+            return std::make_pair(Status::kInvalidArgument, tag);
+        }
+        // The fields are read from the bits as EpcView reads them, and
+        // validated by the scheme classes as createFromBinary() does.
+        EpcView view(bytes, size);
+        tag.type_ = view.getType();
+        if (tag.type_ == TagType::kUnknown
+            || view.getCompanyPrefix().length()
+            != LAYOUT_MAX_COMPANY_PREFIX_DIGITS - view.getPartition()) {
+            return std::make_pair(Status::kInvalidArgument, Tag());
+        }
+        unsigned int filter = view.getFilterValue();
+        bool is96 = view.getBitLength() == 96;
+        switch (tag.type_) {
+        case TagType::kSGTIN:
+            std::tie(status, tag.sgtin_) = SGTIN::create(
+                view.getCompanyPrefix(), view.getReference(),
+                view.getSerial());
+            if (status == Status::kOk) {
+                status = tag.sgtin_.setFilterValue(filter);
+            }
+            if (status == Status::kOk) {
+                status = tag.sgtin_.setSGTINScheme(
+                    is96 ? SGTIN::Scheme::kSGTIN96
+                    : SGTIN::Scheme::kSGTIN198);
+            }
+            break;
+        case TagType::kSSCC:
+            std::tie(status, tag.sscc_) = SSCC::create(
+                view.getCompanyPrefix(), view.getReference());
+            if (status == Status::kOk) {
+                status = tag.sscc_.setFilterValue(filter);
+            }
+            break;
+        case TagType::kSGLN:
+            std::tie(status, tag.sgln_) = SGLN::create(
+                view.getCompanyPrefix(), view.getReference(),
+                view.getSerial());
+            if (status == Status::kOk) {
+                status = tag.sgln_.setFilterValue(filter);
+            }
+            if (status == Status::kOk) {
+                status = tag.sgln_.setSGLNScheme(
+                    is96 ? SGLN::Scheme::kSGLN96 : SGLN::Scheme::kSGLN195);
+            }
+            break;
+        case TagType::kGRAI:
+            std::tie(status, tag.grai_) = GRAI::create(
+                view.getCompanyPrefix(), view.getReference(),
+                view.getSerial());
+            if (status == Status::kOk) {
+                status = tag.grai_.setFilterValue(filter);
+            }
+            if (status == Status::kOk) {
+                status = tag.grai_.setGRAIScheme(
+                    is96 ? GRAI::Scheme::kGRAI96 : GRAI::Scheme::kGRAI170);
+            }
+            break;
+        default:
+            std::tie(status, tag.giai_) = GIAI::create(
+                view.getCompanyPrefix(), view.getReference());
+            if (status == Status::kOk) {
+                status = tag.giai_.setFilterValue(filter);
+            }
+            if (status == Status::kOk) {
+                status = tag.giai_.setGIAIScheme(
+                    is96 ? GIAI::Scheme::kGIAI96 : GIAI::Scheme::kGIAI202);
+            }
+            break;
+        }
+        if (status != Status::kOk) {
+            return std::make_pair(Status::kInvalidArgument, Tag());
+        }
+        return std::make_pair(Status::kOk, tag);
+    }
+
+    std::pair<Status, Tag> Tag::createFromEpc96(const Epc96 &epc) {
+        uint8_t bytes[Epc96::BYTES];
+        epc.getBytes(bytes);
+        return createFromBytes(bytes, sizeof(bytes));
+    }
+
+    std::pair<Status, Epc96> Tag::getEpc96() const {
+        if (type_ == TagType::kUnknown) {
+            return std::make_pair(Status::kInvalidArgument, Epc96());
+        }
+        Status status;
+        std::string binary;
+        std::tie(status, binary) = getBinary();
+        if (status != Status::kOk) return std::make_pair(status, Epc96());
+        return Epc96::createFromBinary(binary);
+    }
+
+    namespace {
+        bool starts_with(const std::string &s, const char *prefix) {
+            return s.compare(0, std::strlen(prefix), prefix) == 0;
+        }
+    }
+
+    std::pair<Status, Tag> Tag::createFromURI(const std::string &uri) {
+        Tag tag;
+        Status status;
+        if (starts_with(uri, "urn:epc:id:sgtin:")) {
+            std::tie(status, tag.sgtin_) = SGTIN::createFromURI(uri);
+            tag.type_ = TagType::kSGTIN;
+        } else if (starts_with(uri, "urn:epc:id:sscc:")) {
+            std::tie(status, tag.sscc_) = SSCC::createFromURI(uri);
+            tag.type_ = TagType::kSSCC;
+        } else if (starts_with(uri, "urn:epc:id:sgln:")) {
+            std::tie(status, tag.sgln_) = SGLN::createFromURI(uri);
+            tag.type_ = TagType::kSGLN;
+        } else if (starts_with(uri, "urn:epc:id:grai:")) {
+            std::tie(status, tag.grai_) = GRAI::createFromURI(uri);
+            tag.type_ = TagType::kGRAI;
+        } else if (starts_with(uri, "urn:epc:id:giai:")) {
+            std::tie(status, tag.giai_) = GIAI::createFromURI(uri);
+            tag.type_ = TagType::kGIAI;
+        } else {
+            return std::make_pair(Status::kInvalidArgument, tag);
+        }
+        if (status != Status::kOk) {
+            return std::make_pair(status, Tag());
+        }
+        return std::make_pair(Status::kOk, tag);
+    }
+
+    std::pair<Status, Tag> Tag::createFromTagURI(const std::string &tag_uri) {
+        Tag tag;
+        Status status;
+        if (starts_with(tag_uri, "urn:epc:tag:sgtin-")) {
+            std::tie(status, tag.sgtin_) = SGTIN::createFromTagURI(tag_uri);
+            tag.type_ = TagType::kSGTIN;
+        } else if (starts_with(tag_uri, "urn:epc:tag:sscc-")) {
+            std::tie(status, tag.sscc_) = SSCC::createFromTagURI(tag_uri);
+            tag.type_ = TagType::kSSCC;
+        } else if (starts_with(tag_uri, "urn:epc:tag:sgln-")) {
+            std::tie(status, tag.sgln_) = SGLN::createFromTagURI(tag_uri);
+            tag.type_ = TagType::kSGLN;
+        } else if (starts_with(tag_uri, "urn:epc:tag:grai-")) {
+            std::tie(status, tag.grai_) = GRAI::createFromTagURI(tag_uri);
+            tag.type_ = TagType::kGRAI;
+        } else if (starts_with(tag_uri, "urn:epc:tag:giai-")) {
+            std::tie(status, tag.giai_) = GIAI::createFromTagURI(tag_uri);
+            tag.type_ = TagType::kGIAI;
+        } else {
+            return std::make_pair(Status::kInvalidArgument, tag);
+        }
+        if (status != Status::kOk) {
+            return std::make_pair(status, Tag());
+        }
+        return std::make_pair(Status::kOk, tag);
+    }
+
+    Status Tag::setFilterValue(unsigned int value) {
+        switch (type_) {
+        case TagType::kSGTIN:
+            return sgtin_.setFilterValue(value);
+        case TagType::kSSCC:
+            return sscc_.setFilterValue(value);
+        case TagType::kSGLN:
+            return sgln_.setFilterValue(value);
+        case TagType::kGRAI:
+            return grai_.setFilterValue(value);
+        case TagType::kGIAI:
+            return giai_.setFilterValue(value);
+        default:
+            return Status::kInvalidArgument;
+        }
+    }
+
+    uint8_t Tag::getHeader() const {
+        switch (type_) {
+        case TagType::kSGTIN:
+            return sgtin_.getSGTINScheme() == SGTIN::Scheme::kSGTIN96
+                ? 0x30 : 0x36;
+        case TagType::kSSCC:
+            return 0x31;
+        case TagType::kSGLN:
+            return sgln_.getSGLNScheme() == SGLN::Scheme::kSGLN96
+                ? 0x32 : 0x39;
+        case TagType::kGRAI:
+            return grai_.getGRAIScheme() == GRAI::Scheme::kGRAI96
+                ? 0x33 : 0x37;
+        case TagType::kGIAI:
+            return giai_.getGIAIScheme() == GIAI::Scheme::kGIAI96
+                ? 0x34 : 0x38;
+        default:
+            return 0;
+        }
+    }
+
+    const EPC &Tag::getEPC() const {
+        switch (type_) {
+        case TagType::kSSCC:
+            return sscc_;
+        case TagType::kSGLN:
+            return sgln_;
+        case TagType::kGRAI:
+            return grai_;
+        case TagType::kGIAI:
+            return giai_;
+        default:
+            return sgtin_;
+        }
+    }
+}
@@ -0,0 +1,296 @@
+#include "tag_writer.h"
+#include "encode.h"
+
+#include <tuple>
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace epc {
+    namespace {
+        const char *get_column_name(TagWriter::Column column) {
+            switch (column) {
+            case TagWriter::Column::kURI:
+                return "uri";
+            case TagWriter::Column::kTagURI:
+                return "tag_uri";
+            case TagWriter::Column::kBinary:
+                return "binary";
+            case TagWriter::Column::kType:
+                return "type";
+            case TagWriter::Column::kScheme:
+                return "scheme";
+            case TagWriter::Column::kFilter:
+                return "filter";
+            case TagWriter::Column::kCompanyPrefix:
+                return "company_prefix";
+            case TagWriter::Column::kReference:
+                return "reference";
+            case TagWriter::Column::kSerial:
+                return "serial";
+            }
+            return "";
+        }
+
+        const std::string EMPTY;
+
+        const std::string &get_company_prefix(const Tag &tag) {
+            switch (tag.getType()) {
+            case TagType::kSGTIN:
+                return tag.getSGTIN().getCompanyPrefix();
+            case TagType::kSSCC:
+                return tag.getSSCC().getCompanyPrefix();
+            case TagType::kSGLN:
+                return tag.getSGLN().getCompanyPrefix();
+            case TagType::kGRAI:
+                return tag.getGRAI().getCompanyPrefix();
+            case TagType::kGIAI:
+                return tag.getGIAI().getCompanyPrefix();
+            default:
+                return EMPTY;
+            }
+        }
+
+        const std::string *get_reference(const Tag &tag) {
+            switch (tag.getType()) {
+            case TagType::kSGTIN:
+                return &tag.getSGTIN().getItemReferenceAndIndicator();
+            case TagType::kSSCC:
+                return &tag.getSSCC().getSerialReference();
+            case TagType::kSGLN:
+                return &tag.getSGLN().getLocationReference();
+            case TagType::kGRAI:
+                return &tag.getGRAI().getAssetType();
+            default:
+                return nullptr;
+            }
+        }
+
+        const std::string *get_serial(const Tag &tag) {
+            switch (tag.getType()) {
+            case TagType::kSGTIN:
+                return &tag.getSGTIN().getSerial();
+            case TagType::kSGLN:
+                return &tag.getSGLN().getExtension();
+            case TagType::kGRAI:
+                return &tag.getGRAI().getSerial();
+            case TagType::kGIAI:
+                return &tag.getGIAI().getAssetReference();
+            default:
+                return nullptr;
+            }
+        }
+
+        void append_id(std::string &out, const Tag &tag) {
+            out += get_company_prefix(tag);
+            const std::string *reference = get_reference(tag);
+            if (reference) {
+                out += '.';
+                out += *reference;
+            }
+            const std::string *serial = get_serial(tag);
+            if (serial) {
+                out += '.';
+                append_uri_encoded(out, serial->data(), serial->length());
+            }
+        }
+
+        void append_uri(std::string &out, const Tag &tag) {
+            out += "urn:epc:id:";
+            out += get_tag_type_name(tag.getType());
+            out += ':';
+            append_id(out, tag);
+        }
+
+        void append_tag_uri(std::string &out, const Tag &tag) {
+            out += "urn:epc:tag:";
+            out += get_scheme_info(tag.getHeader())->name_;
+            out += ':';
+            out += static_cast<char>('0' + tag.getEPC().getFilterValue());
+            out += '.';
+            append_id(out, tag);
+        }
+
+        void append_json_string(std::string &out, const std::string &s) {
+            static const char digits[] = "0123456789abcdef";
+            out += '"';
+            for (char c : s) {
+                unsigned char u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (u < 0x20) {
+                    out += "\\u00";
+                    out += digits[u >> 4];
+                    out += digits[u & 0xF];
+                } else {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        void append_csv_field(std::string &out, const std::string &s) {
+            if (s.find_first_of(",\"\r\n") == std::string::npos) {
+                out += s;
+                return;
+            }
+            out += '"';
+            for (char c : s) {
+                if (c == '"') out += '"';
+                out += c;
+            }
+            out += '"';
+        }
+
+        Status write_all(int fd, const char *p, size_t n) {
+            while (n > 0) {
+                ssize_t r = ::write(fd, p, n);
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    return Status::kInvalidArgument;
+                }
+                p += r;
+                n -= r;
+            }
+            return Status::kOk;
+        }
+    }
+
+    TagWriter::TagWriter(Format format, const std::vector<Column> &columns,
+                         const Sink &sink, size_t buffer_size)
+        : format_(format), columns_(columns), sink_(sink),
+          buffer_size_(buffer_size) {
+        buffer_.reserve(buffer_size_ + 256);
+    }
+
+    TagWriter::TagWriter(Format format, const std::vector<Column> &columns,
+                         int fd, size_t buffer_size)
+        : TagWriter(format, columns,
+                    [fd](const char *data, size_t size) {
+                        return write_all(fd, data, size);
+                    },
+                    buffer_size) {}
+
+    TagWriter::~TagWriter() {
+        flush();
+    }
+
+    Status TagWriter::flush() {
+        if (buffer_.empty()) return Status::kOk;
+        Status status = sink_(buffer_.data(), buffer_.size());
+        buffer_.clear();
+        return status;
+    }
+
+    Status TagWriter::writeHeader() {
+        if (format_ != Format::kCSV) return Status::kOk;
+        for (size_t i = 0; i < columns_.size(); i++) {
+            if (i > 0) buffer_ += ',';
+            buffer_ += get_column_name(columns_[i]);
+        }
+        buffer_ += '\n';
+        return buffer_.size() >= buffer_size_ ? flush() : Status::kOk;
+    }
+
+    Status TagWriter::write(const Tag &tag) {
+        if (tag.getType() == TagType::kUnknown) return Status::kInvalidArgument;
+        writeRecord(tag);
+        return buffer_.size() >= buffer_size_ ? flush() : Status::kOk;
+    }
+
+    Status TagWriter::write(const Tag *tags, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            if (tags[i].getType() == TagType::kUnknown) continue;
+            writeRecord(tags[i]);
+            if (buffer_.size() >= buffer_size_) {
+                Status status = flush();
+                if (status != Status::kOk) return status;
+            }
+        }
+        return Status::kOk;
+    }
+
+    void TagWriter::writeRecord(const Tag &tag) {
+        bool json = format_ == Format::kNDJSON;
+        if (json) buffer_ += '{';
+        for (size_t i = 0; i < columns_.size(); i++) {
+            if (i > 0) buffer_ += ',';
+            if (json) {
+                buffer_ += '"';
+                buffer_ += get_column_name(columns_[i]);
+                buffer_ += "\":";
+            }
+            field_.clear();
+            switch (columns_[i]) {
+            case Column::kURI:
+                append_uri(field_, tag);
+                writeValue(field_);
+                break;
+            case Column::kTagURI:
+                append_tag_uri(field_, tag);
+                writeValue(field_);
+                break;
+            case Column::kBinary: {
+                Status status;
+                std::string hex;
+                std::tie(status, hex) = tag.getBinary();
+                if (status == Status::kOk) {
+                    writeValue(hex);
+                } else {
+                    writeNull();
+                }
+                break;
+            }
+            case Column::kType:
+                field_ += get_tag_type_name(tag.getType());
+                writeValue(field_);
+                break;
+            case Column::kScheme:
+                field_ += get_scheme_info(tag.getHeader())->name_;
+                writeValue(field_);
+                break;
+            case Column::kFilter:
+                // Filter values are a single digit.
+                buffer_ += static_cast<char>(
+                    '0' + tag.getEPC().getFilterValue());
+                break;
+            case Column::kCompanyPrefix:
+                writeValue(get_company_prefix(tag));
+                break;
+            case Column::kReference: {
+                const std::string *reference = get_reference(tag);
+                if (reference) {
+                    writeValue(*reference);
+                } else {
+                    writeNull();
+                }
+                break;
+            }
+            case Column::kSerial: {
+                const std::string *serial = get_serial(tag);
+                if (serial) {
+                    writeValue(*serial);
+                } else {
+                    writeNull();
+                }
+                break;
+            }
+            }
+        }
+        if (json) buffer_ += '}';
+        buffer_ += '\n';
+    }
+
+    void TagWriter::writeValue(const std::string &value) {
+        if (format_ == Format::kNDJSON) {
+            append_json_string(buffer_, value);
+        } else {
+            append_csv_field(buffer_, value);
+        }
+    }
+
+    void TagWriter::writeNull() {
+        if (format_ == Format::kNDJSON) buffer_ += "null";
+    }
+}
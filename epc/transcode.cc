@@ -0,0 +1,539 @@
+#include "transcode.h"
+#include "encode.h"
+#include "layout.h"
+#include "tag.h"
+#include "validation.h"
+
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+
+namespace epc {
+    namespace {
+        constexpr size_t MAX_BYTES = 26;
+
+        using Scheme = struct SchemeStruct {
+            TagType type_;
+            /**
+             * The number of digits of company prefix and reference, or 0 if
+             * the reference isn't digits
+             */
+            unsigned int total_digits_;
+        };
+
+        const Scheme SCHEMES[] = {
+            {TagType::kSGTIN, 13},
+            {TagType::kSSCC, 17},
+            {TagType::kSGLN, 12},
+            {TagType::kGRAI, 12},
+            {TagType::kGIAI, 0},
+        };
+
+        // The fields of an EPC URI or EPC Tag URI, where the reference of
+        // GIAI and the serial are URI encoded.
+        using Fields = struct FieldsStruct {
+            const Scheme *scheme_;
+            uint8_t header_;
+            unsigned int filter_;
+            const char *company_prefix_;
+            size_t company_prefix_length_;
+            const char *reference_;
+            size_t reference_length_;
+            const char *serial_;
+            size_t serial_length_;
+        };
+
+        bool is_digit(char c) {
+            return '0' <= c && c <= '9';
+        }
+
+        bool consume(const char *&p, const char *end, const char *prefix) {
+            size_t length = std::strlen(prefix);
+            if (static_cast<size_t>(end - p) < length
+                || std::memcmp(p, prefix, length) != 0) {
+                return false;
+            }
+            p += length;
+            return true;
+        }
+
+        size_t count_digits(const char *p, const char *end) {
+            const char *q = p;
+            while (q != end && is_digit(*q)) q++;
+            return q - p;
+        }
+
+        uint64_t parse_digits(const char *p, size_t n) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < n; i++) value = value * 10 + (p[i] - '0');
+            return value;
+        }
+
+        // Appends an URI encoded string decoded and encoded again, which
+        // normalizes the escapes as the scheme classes do.
+        void append_reencoded(std::string &buffer, const char *p, size_t n) {
+            const char *end = p + n;
+            char c;
+            while (p != end) {
+                p = decode_uri_char(p, end, &c);
+                append_uri_encoded(buffer, c);
+            }
+        }
+
+        bool is_encoded_serial(const char *p, size_t n) {
+            const char *end = p + n;
+            char c;
+            while (p != end) {
+                p = decode_uri_char(p, end, &c);
+                if (!is_serial_char(c)) return false;
+            }
+            return true;
+        }
+
+        size_t get_decoded_length(const char *p, size_t n) {
+            const char *end = p + n;
+            size_t length = 0;
+            char c;
+            while (p != end) {
+                p = decode_uri_char(p, end, &c);
+                length++;
+            }
+            return length;
+        }
+
+        // The same as is_integer_at_most() of validation.h but of an URI
+        // encoded string, returning the value.
+        bool get_integer_at_most(const char *p, size_t n, uint64_t max,
+                                 uint64_t *value) {
+            const char *end = p + n;
+            char c;
+            *value = 0;
+            if (p == end) return false;
+            while (p != end) {
+                p = decode_uri_char(p, end, &c);
+                if (!is_digit(c)) return false;
+                uint64_t digit = c - '0';
+                if (*value > (max - digit) / 10) return false;
+                *value = *value * 10 + digit;
+            }
+            return true;
+        }
+
+        void append_integer(std::string &buffer, uint64_t value,
+                            unsigned int digits) {
+            char s[20];
+            unsigned int n = 0;
+            do {
+                s[sizeof(s) - ++n] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            if (n < digits) buffer.append(digits - n, '0');
+            buffer.append(s + sizeof(s) - n, n);
+        }
+
+        // Returns the header of a scheme of a bit length, or 0 if there's
+        // no such scheme.
+        uint8_t get_header(const Scheme &scheme, unsigned int bits) {
+            const SchemeInfo *info = get_scheme_info(scheme.type_, bits);
+            return info ? info->header_ : 0;
+        }
+
+        // Appends a string of 7-bit characters up to the first 0 URI
+        // encoded, or returns false if a character isn't of serials.
+        bool append_string(std::string &buffer, const uint8_t *bytes,
+                           unsigned int offset, unsigned int length) {
+            for (unsigned int i = 0; i + LAYOUT_CHAR_BITS <= length;
+                 i += LAYOUT_CHAR_BITS) {
+                char c = static_cast<char>(
+                    get_bits(bytes, offset + i, LAYOUT_CHAR_BITS));
+                if (c == 0) break;
+                if (!is_serial_char(c)) return false;
+                append_uri_encoded(buffer, c);
+            }
+            return true;
+        }
+
+        // Appends the fields of an EPC binary as createFromBinary() of the
+        // scheme classes decodes them, or returns false if it would fail.
+        bool append_binary_fields(std::string &buffer, const uint8_t *bytes,
+                                  TagType type, const Layout &layout) {
+            uint64_t company_prefix = get_bits(
+                bytes, LAYOUT_COMPANY_PREFIX_OFFSET,
+                layout.company_prefix_bits_);
+            if (company_prefix >= POW10[layout.company_prefix_digits_]) {
+                return false;
+            }
+            append_integer(buffer, company_prefix,
+                           layout.company_prefix_digits_);
+            buffer += '.';
+            if (type == TagType::kGIAI) {
+                if (layout.bits_ != 96) {
+                    return append_string(buffer, bytes,
+                                         layout.getReferenceOffset(),
+                                         layout.reference_bits_);
+                }
+                // The asset reference of GIAI-96 isn't padded.
+                append_integer(buffer,
+                               get_bits(bytes, layout.getReferenceOffset(),
+                                        layout.reference_bits_), 0);
+                return true;
+            }
+            // References of no digits, i.e. of SGLN and GRAI of 12-digit
+            // company prefixes, aren't taken by the scheme classes.
+            uint64_t reference = get_bits(
+                bytes, layout.getReferenceOffset(), layout.reference_bits_);
+            if (layout.reference_digits_ == 0
+                || reference >= POW10[layout.reference_digits_]) {
+                return false;
+            }
+            append_integer(buffer, reference, layout.reference_digits_);
+            if (type == TagType::kSSCC) return true;
+            buffer += '.';
+            if (layout.bits_ != 96) {
+                return append_string(buffer, bytes, layout.getSerialOffset(),
+                                     layout.serial_bits_);
+            }
+            append_integer(buffer,
+                           get_bits(bytes, layout.getSerialOffset(),
+                                    layout.serial_bits_), 0);
+            return true;
+        }
+
+        Status transcode_binary(const char *hex, size_t n, bool tag_uri,
+                                std::string &buffer) {
+            buffer.clear();
+            int hi, lo;
+            if (n < 2 || (hi = hex_digit_value(hex[0])) < 0
+                || (lo = hex_digit_value(hex[1])) < 0) {
+                return Status::kInvalidArgument;
+            }
+            uint8_t header = static_cast<uint8_t>(hi << 4 | lo);
+            if (n != get_hex_length(header)) return Status::kInvalidArgument;
+            // The scheme classes take only upper case digits.
+            uint8_t bytes[MAX_BYTES] = {};
+            for (size_t i = 0; i < n; i++) {
+                char c = hex[i];
+                if (c >= 'a' && c <= 'f') return Status::kInvalidArgument;
+                int value = hex_digit_value(c);
+                if (value < 0) return Status::kInvalidArgument;
+                bytes[i / 2] |= static_cast<uint8_t>(
+                    i % 2 == 0 ? value << 4 : value);
+            }
+            Status status;
+            Layout layout;
+            std::tie(status, layout) = get_layout(
+                header, static_cast<unsigned int>(
+                    get_bits(bytes, LAYOUT_PARTITION_OFFSET, 3)));
+            if (status != Status::kOk) return Status::kInvalidArgument;
+
+            TagType type = get_tag_type(header);
+            if (tag_uri) {
+                buffer += "urn:epc:tag:";
+                buffer += get_scheme_info(header)->name_;
+                buffer += ':';
+                buffer += static_cast<char>(
+                    '0' + get_bits(bytes, LAYOUT_FILTER_OFFSET, 3));
+                buffer += '.';
+            } else {
+                buffer += "urn:epc:id:";
+                buffer += get_tag_type_name(type);
+                buffer += ':';
+            }
+            if (!append_binary_fields(buffer, bytes, type, layout)) {
+                buffer.clear();
+                return Status::kInvalidArgument;
+            }
+            return Status::kOk;
+        }
+
+        // Parses the fields following the scheme, i.e. those matched by
+        // (\d+)\.(\d+)\.(.+), or (\d+)\.(\d+) of SSCC and (\d+)\.(.+) of
+        // GIAI, as URI_RE and TAG_URI_RE of the scheme classes do.
+        bool parse_fields(const char *p, const char *end, Fields &fields) {
+            fields.company_prefix_ = p;
+            fields.company_prefix_length_ = count_digits(p, end);
+            p += fields.company_prefix_length_;
+            if (fields.company_prefix_length_ == 0 || !consume(p, end, ".")) {
+                return false;
+            }
+            fields.reference_ = p;
+            if (fields.scheme_->type_ == TagType::kGIAI) {
+                fields.reference_length_ = end - p;
+                fields.serial_length_ = 0;
+                return fields.reference_length_ != 0;
+            }
+            fields.reference_length_ = count_digits(p, end);
+            p += fields.reference_length_;
+            if (fields.reference_length_ == 0) return false;
+            if (fields.scheme_->type_ == TagType::kSSCC) {
+                fields.serial_length_ = 0;
+                return p == end;
+            }
+            if (!consume(p, end, ".")) return false;
+            fields.serial_ = p;
+            fields.serial_length_ = end - p;
+            return fields.serial_length_ != 0;
+        }
+
+        // Validates the fields as create() of the scheme classes does.
+        Status validate(const Fields &fields) {
+            const Scheme &scheme = *fields.scheme_;
+            if (scheme.total_digits_ != 0
+                && fields.company_prefix_length_ + fields.reference_length_
+                != scheme.total_digits_) {
+                return Status::kInvalidArgument;
+            }
+            if (scheme.type_ == TagType::kGIAI) {
+                if (!is_encoded_serial(fields.reference_,
+                                       fields.reference_length_)) {
+                    return Status::kInvalidArgument;
+                }
+            } else if (!is_encoded_serial(fields.serial_,
+                                          fields.serial_length_)) {
+                return Status::kInvalidArgument;
+            }
+            return Status::kOk;
+        }
+
+        Status parse_uri(const char *uri, size_t n, Fields &fields) {
+            const char *p = uri;
+            const char *end = uri + n;
+            if (!consume(p, end, "urn:epc:id:")) {
+                return Status::kInvalidArgument;
+            }
+            fields.scheme_ = nullptr;
+            for (const Scheme &scheme : SCHEMES) {
+                const char *q = p;
+                if (consume(q, end, get_tag_type_name(scheme.type_))
+                    && consume(q, end, ":")) {
+                    fields.scheme_ = &scheme;
+                    p = q;
+                    break;
+                }
+            }
+            if (fields.scheme_ == nullptr || !parse_fields(p, end, fields)) {
+                return Status::kInvalidArgument;
+            }
+            return validate(fields);
+        }
+
+        Status parse_tag_uri(const char *tag_uri, size_t n, Fields &fields) {
+            const char *p = tag_uri;
+            const char *end = tag_uri + n;
+            if (!consume(p, end, "urn:epc:tag:")) {
+                return Status::kInvalidArgument;
+            }
+            fields.scheme_ = nullptr;
+            for (const Scheme &scheme : SCHEMES) {
+                const char *q = p;
+                if (consume(q, end, get_tag_type_name(scheme.type_))
+                    && consume(q, end, "-")) {
+                    fields.scheme_ = &scheme;
+                    p = q;
+                    break;
+                }
+            }
+            if (fields.scheme_ == nullptr) return Status::kInvalidArgument;
+            size_t digits = count_digits(p, end);
+            // The bit length is matched as a string.
+            if (digits == 0 || digits > 3 || *p == '0') {
+                return Status::kInvalidArgument;
+            }
+            fields.header_ = get_header(
+                *fields.scheme_,
+                static_cast<unsigned int>(parse_digits(p, digits)));
+            p += digits;
+            if (fields.header_ == 0 || !consume(p, end, ":")
+                || p == end || !is_digit(*p)) {
+                return Status::kInvalidArgument;
+            }
+            fields.filter_ = *p++ - '0';
+            if (!consume(p, end, ".") || !parse_fields(p, end, fields)) {
+                return Status::kInvalidArgument;
+            }
+            Status status = validate(fields);
+            if (status != Status::kOk) return status;
+            if (fields.filter_ > EPC::MAX_FILTER_VALUE) {
+                return Status::kInvalidArgument;
+            }
+            return Status::kOk;
+        }
+
+        // Sets the scheme of a bit length and the filter value of the
+        // fields of an EPC URI.
+        Status set_scheme(Fields &fields, unsigned int bits,
+                          unsigned int filter) {
+            fields.header_ = get_header(*fields.scheme_, bits);
+            fields.filter_ = filter;
+            if (fields.header_ == 0 || filter > EPC::MAX_FILTER_VALUE) {
+                return Status::kInvalidArgument;
+            }
+            return Status::kOk;
+        }
+
+        // Packs an URI encoded serial, either an integer or a string of
+        // 7-bit characters, or returns Status::kInvalidSerial if it doesn't
+        // fit.
+        Status put_serial(uint8_t *bytes, unsigned int offset,
+                          unsigned int length, bool integer, const char *p,
+                          size_t n) {
+            if (integer) {
+                uint64_t value;
+                if (!get_integer_at_most(p, n, (1ULL << length) - 1,
+                                         &value)) {
+                    return Status::kInvalidSerial;
+                }
+                put_bits(bytes, offset, length, value);
+                return Status::kOk;
+            }
+            if (get_decoded_length(p, n) > length / LAYOUT_CHAR_BITS) {
+                return Status::kInvalidSerial;
+            }
+            const char *end = p + n;
+            char c;
+            while (p != end) {
+                p = decode_uri_char(p, end, &c);
+                put_bits(bytes, offset, LAYOUT_CHAR_BITS,
+                         static_cast<unsigned char>(c));
+                offset += LAYOUT_CHAR_BITS;
+            }
+            return Status::kOk;
+        }
+
+        // Packs the fields as getBinary() of the scheme classes does.
+        Status append_binary(std::string &buffer, const Fields &fields) {
+            if (fields.company_prefix_length_
+                < LAYOUT_MIN_COMPANY_PREFIX_DIGITS
+                || fields.company_prefix_length_
+                > LAYOUT_MAX_COMPANY_PREFIX_DIGITS) {
+                return Status::kInvalidArgument;
+            }
+            Status status;
+            Layout layout;
+            std::tie(status, layout) = get_layout(
+                fields.header_, static_cast<unsigned int>(
+                    LAYOUT_MAX_COMPANY_PREFIX_DIGITS
+                    - fields.company_prefix_length_));
+            if (status != Status::kOk) return Status::kInvalidArgument;
+
+            uint8_t bytes[MAX_BYTES] = {};
+            put_bits(bytes, 0, 8, fields.header_);
+            put_bits(bytes, LAYOUT_FILTER_OFFSET, 3, fields.filter_);
+            put_bits(bytes, LAYOUT_PARTITION_OFFSET, 3, layout.partition_);
+            put_bits(bytes, LAYOUT_COMPANY_PREFIX_OFFSET,
+                     layout.company_prefix_bits_,
+                     parse_digits(fields.company_prefix_,
+                                  fields.company_prefix_length_));
+            // The asset reference of GIAI is checked as serials are.
+            if (fields.scheme_->type_ == TagType::kGIAI) {
+                status = put_serial(bytes, layout.getReferenceOffset(),
+                                    layout.reference_bits_,
+                                    layout.bits_ == 96, fields.reference_,
+                                    fields.reference_length_);
+            } else {
+                put_bits(bytes, layout.getReferenceOffset(),
+                         layout.reference_bits_,
+                         parse_digits(fields.reference_,
+                                      fields.reference_length_));
+            }
+            if (status == Status::kOk && layout.serial_bits_ != 0) {
+                status = put_serial(bytes, layout.getSerialOffset(),
+                                    layout.serial_bits_, layout.bits_ == 96,
+                                    fields.serial_, fields.serial_length_);
+            }
+            if (status != Status::kOk) return status;
+
+            size_t n = get_hex_length(fields.header_);
+            for (size_t i = 0; i < n; i++) {
+                uint8_t b = bytes[i / 2];
+                buffer += HEX_DIGITS[i % 2 == 0 ? b >> 4 : b & 0xF];
+            }
+            return Status::kOk;
+        }
+
+        void append_fields(std::string &buffer, const Fields &fields) {
+            buffer.append(fields.company_prefix_,
+                          fields.company_prefix_length_);
+            buffer += '.';
+            if (fields.scheme_->type_ == TagType::kGIAI) {
+                append_reencoded(buffer, fields.reference_,
+                                 fields.reference_length_);
+                return;
+            }
+            buffer.append(fields.reference_, fields.reference_length_);
+            if (fields.scheme_->type_ == TagType::kSSCC) return;
+            buffer += '.';
+            append_reencoded(buffer, fields.serial_, fields.serial_length_);
+        }
+
+        void append_uri(std::string &buffer, const Fields &fields) {
+            buffer += "urn:epc:id:";
+            buffer += get_tag_type_name(fields.scheme_->type_);
+            buffer += ':';
+            append_fields(buffer, fields);
+        }
+
+        void append_tag_uri(std::string &buffer, const Fields &fields) {
+            buffer += "urn:epc:tag:";
+            buffer += get_scheme_info(fields.header_)->name_;
+            buffer += ':';
+            buffer += static_cast<char>('0' + fields.filter_);
+            buffer += '.';
+            append_fields(buffer, fields);
+        }
+    }
+
+    Status transcode_binary_to_uri(const char *hex, size_t n,
+                                   std::string &buffer) {
+        return transcode_binary(hex, n, false, buffer);
+    }
+
+    Status transcode_binary_to_tag_uri(const char *hex, size_t n,
+                                       std::string &buffer) {
+        return transcode_binary(hex, n, true, buffer);
+    }
+
+    Status transcode_tag_uri_to_binary(const char *tag_uri, size_t n,
+                                       std::string &buffer) {
+        buffer.clear();
+        Fields fields;
+        Status status = parse_tag_uri(tag_uri, n, fields);
+        if (status != Status::kOk) return status;
+        return append_binary(buffer, fields);
+    }
+
+    Status transcode_uri_to_binary(const char *uri, size_t n,
+                                   unsigned int bits, unsigned int filter,
+                                   std::string &buffer) {
+        buffer.clear();
+        Fields fields;
+        Status status = parse_uri(uri, n, fields);
+        if (status != Status::kOk) return status;
+        status = set_scheme(fields, bits, filter);
+        if (status != Status::kOk) return status;
+        return append_binary(buffer, fields);
+    }
+
+    Status transcode_tag_uri_to_uri(const char *tag_uri, size_t n,
+                                    std::string &buffer) {
+        buffer.clear();
+        Fields fields;
+        Status status = parse_tag_uri(tag_uri, n, fields);
+        if (status != Status::kOk) return status;
+        append_uri(buffer, fields);
+        return Status::kOk;
+    }
+
+    Status transcode_uri_to_tag_uri(const char *uri, size_t n,
+                                    unsigned int bits, unsigned int filter,
+                                    std::string &buffer) {
+        buffer.clear();
+        Fields fields;
+        Status status = parse_uri(uri, n, fields);
+        if (status != Status::kOk) return status;
+        status = set_scheme(fields, bits, filter);
+        if (status != Status::kOk) return status;
+        append_tag_uri(buffer, fields);
+        return Status::kOk;
+    }
+}
@@ -8,15 +8,27 @@ namespace epc {
     }
 
     bool is_serial(const std::string &s) {
-        return std::all_of(s.cbegin(), s.cend(),
-                           [](char c) {
-                               return
-                                   (0x21 <= c && c <= 0x22) ||
-                                   (0x25 <= c && c <= 0x3f) ||
-                                   (0x41 <= c && c <= 0x5a) ||
-                                   (c == 0x5a) ||
-                                   (c == 0x5f) ||
-                                   (0x61 <= c && c <= 0x7a);
-                           });
+        return std::all_of(s.cbegin(), s.cend(), is_serial_char);
+    }
+
+    bool is_serial_char(char c) {
+        return
+            (0x21 <= c && c <= 0x22) ||
+            (0x25 <= c && c <= 0x3f) ||
+            (0x41 <= c && c <= 0x5a) ||
+            (c == 0x5a) ||
+            (c == 0x5f) ||
+            (0x61 <= c && c <= 0x7a);
+    }
+
+    bool is_integer_at_most(const std::string &s, uint64_t max) {
+        if (s.empty() || !is_padded_numbers(s)) return false;
+        uint64_t value = 0;
+        for (char c : s) {
+            uint64_t digit = c - '0';
+            if (value > (max - digit) / 10) return false;
+            value = value * 10 + digit;
+        }
+        return true;
     }
 }
@@ -1,11 +1,16 @@
 #ifndef LIBEPC_EPC_VALIDATION_H_
 #define LIBEPC_EPC_VALIDATION_H_
 
+#include <cstdint>
 #include <string>
 
 namespace epc {
     bool is_padded_numbers(const std::string &s);
     bool is_serial(const std::string &s);
+    bool is_serial_char(char c);
+    // Whether s is digits of an integer up to max, which may have leading
+    // zeros of any length.
+    bool is_integer_at_most(const std::string &s, uint64_t max);
 }
 
 #endif
@@ -0,0 +1,73 @@
+#ifndef LIBEPC_EPC_CLASSIFY_H_
+#define LIBEPC_EPC_CLASSIFY_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * The fields every scheme starts with, read from an EPC binary without
+ * decoding the rest of it.
+ */
+using Classification = struct ClassificationStruct {
+    TagType type_;
+    uint8_t header_;
+    /** The number of bits of the binary of the scheme */
+    unsigned int bits_;
+    unsigned int filter_;
+    unsigned int partition_;
+    /** The company prefix as an integer, or 0 unless requested */
+    uint64_t company_prefix_;
+    /**
+     * The number of digits of the company prefix, to which it's padded with
+     * leading zeros, or 0 unless requested
+     */
+    unsigned int company_prefix_digits_;
+};
+
+/**
+ * A function classifying an EPC binary in hex string format.
+ *
+ * Only the hex digits of the requested fields are read: 4 for the header,
+ * filter and partition, and up to 14 with the company prefix. Neither the
+ * length of the binary nor the values of the fields are validated, and
+ * the reference and serial aren't decoded, so a successful classification
+ * doesn't mean the binary is valid.
+ *
+ * @param hex EPC binary in hex string format.
+ * @param company_prefix true to read the company prefix.
+ * @return A pair of a status and a classification.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the digits read are too short or not hex,
+ * the header is unsupported, or the company prefix is requested and the
+ * partition is invalid.
+ */
+std::pair<Status, Classification> classify(const std::string &hex,
+                                           bool company_prefix = false);
+/**
+ * A function classifying an EPC binary in bytes.
+ *
+ * The same as classify() of a hex string, reading 2 bytes, or up to 7 with
+ * the company prefix.
+ *
+ * @param bytes EPC binary.
+ * @param n The number of bytes.
+ * @param company_prefix true to read the company prefix.
+ * @return A pair of a status and a classification.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the bytes read are too short, the header is
+ * unsupported, or the company prefix is requested and the partition is
+ * invalid.
+ */
+std::pair<Status, Classification> classify(const uint8_t *bytes, size_t n,
+                                           bool company_prefix = false);
+
+}
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef LIBEPC_EPC_COLUMN_FILE_H_
+#define LIBEPC_EPC_COLUMN_FILE_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A read-only view of a contiguous array.
+ */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(const T *data, size_t size) : data_(data), size_(size) {}
+
+    const T *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T &operator[](size_t i) const { return data_[i]; }
+    const T *begin() const { return data_; }
+    const T *end() const { return data_ + size_; }
+
+private:
+    const T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * A read-only column of unsigned integers, each stored in the fewest of 1,
+ * 2, 4 or 8 bytes that holds the largest integer of the column.
+ *
+ * Scans should switch on getWidth() once and iterate the span of that
+ * width, e.g. getSpan<uint16_t>() for a width of 2, which is the only one
+ * not empty. operator[] reads an element of any width.
+ */
+class ColumnIntegers {
+public:
+    ColumnIntegers() = default;
+    ColumnIntegers(const void *data, size_t size, unsigned int width)
+        : data_(data), size_(size), width_(width) {}
+
+    /**
+     * A method returning the number of bytes of each element.
+     * @return 1, 2, 4 or 8, or 0 for an empty column.
+     */
+    unsigned int getWidth() const { return width_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    uint64_t operator[](size_t i) const {
+        switch (width_) {
+        case 1:
+            return static_cast<const uint8_t *>(data_)[i];
+        case 2:
+            return static_cast<const uint16_t *>(data_)[i];
+        case 4:
+            return static_cast<const uint32_t *>(data_)[i];
+        default:
+            return static_cast<const uint64_t *>(data_)[i];
+        }
+    }
+    /**
+     * A method returning the elements as an array of their width.
+     * @return A span of the elements if T is the unsigned integer of the
+     * width of the column, or an empty span otherwise.
+     */
+    template <typename T>
+    Span<T> getSpan() const {
+        if (sizeof(T) != width_) return Span<T>();
+        return Span<T>(static_cast<const T *>(data_), size_);
+    }
+
+private:
+    const void *data_ = nullptr;
+    size_t size_ = 0;
+    unsigned int width_ = 0;
+};
+
+/**
+ * An entry of the company prefix dictionary of a column block.
+ */
+using ColumnCompanyPrefix = struct ColumnCompanyPrefixStruct {
+    uint64_t value_;
+    uint32_t digits_;
+    uint32_t reserved_;
+};
+
+/**
+ * Columns of the tags of a single encoding scheme in a column file.
+ *
+ * A block has the following columns, one element per row:
+ *
+ * - filter values
+ * - indices into the company prefix dictionary
+ * - references: item reference and indicator (SGTIN), serial reference
+ *   (SSCC), location reference (SGLN) or asset type (GRAI). GIAI has no
+ *   reference column.
+ * - serials: serial (SGTIN, GRAI), extension (SGLN) or asset reference
+ *   (GIAI). Schemes encoding them as integers, e.g. SGTIN-96, have a
+ *   column of integers. Schemes encoding them as strings, e.g. SGTIN-198,
+ *   have a column of offsets into the serial data instead, with one more
+ *   element than rows.
+ *
+ * References are stored as integers; their digits are the number of
+ * digits of the EPC minus the digits of the company prefix. The columns
+ * of integers other than filter values are of the width of their largest
+ * element in the block, so e.g. the serials of SGTIN-96 take 8 bytes only
+ * in blocks of serials over 2^32 - 1.
+ */
+class ColumnBlock {
+public:
+    /**
+     * A method returning the binary header of the encoding scheme.
+     * @return A binary header.
+     */
+    uint8_t getHeader() const { return header_; }
+    /**
+     * A method returning the number of rows in the block.
+     * @return The number of rows.
+     */
+    size_t size() const { return size_; }
+
+    Span<uint8_t> getFilterValues() const { return filter_values_; }
+    Span<ColumnCompanyPrefix> getCompanyPrefixes() const {
+        return company_prefixes_;
+    }
+    ColumnIntegers getCompanyPrefixIndices() const {
+        return company_prefix_indices_;
+    }
+    /** Empty for GIAI. */
+    ColumnIntegers getReferences() const { return references_; }
+    /** Empty for schemes encoding serials as strings. */
+    ColumnIntegers getSerials() const { return serials_; }
+    /** Empty for schemes encoding serials as integers. */
+    ColumnIntegers getSerialOffsets() const { return serial_offsets_; }
+    /** Empty for schemes encoding serials as integers. */
+    Span<char> getSerialData() const { return serial_data_; }
+
+    /**
+     * A method returning the company prefix of a row.
+     * @param row A row number.
+     * @return A company prefix in string.
+     */
+    std::string getCompanyPrefix(size_t row) const;
+    /**
+     * A method returning the serial of a row.
+     * @param row A row number.
+     * @return A serial in string.
+     */
+    std::string getSerial(size_t row) const;
+    /**
+     * A method materializing the tag of a row.
+     *
+     * @param row A row number.
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    std::pair<Status, Tag> getTag(size_t row) const;
+
+private:
+    friend class ColumnFile;
+
+    uint8_t header_ = 0;
+    size_t size_ = 0;
+    Span<uint8_t> filter_values_;
+    Span<ColumnCompanyPrefix> company_prefixes_;
+    ColumnIntegers company_prefix_indices_;
+    ColumnIntegers references_;
+    ColumnIntegers serials_;
+    ColumnIntegers serial_offsets_;
+    Span<char> serial_data_;
+};
+
+/**
+ * A memory-mapped column file of tags.
+ *
+ * Columns are exposed as spans pointing directly into the mapping, so
+ * opening a file only reads its headers regardless of the number of rows.
+ * The file must be written by ColumnFileWriter on a host of the same byte
+ * order.
+ */
+class ColumnFile {
+public:
+    ColumnFile() = default;
+    ColumnFile(ColumnFile &&other);
+    ColumnFile &operator=(ColumnFile &&other);
+    ColumnFile(const ColumnFile &) = delete;
+    ColumnFile &operator=(const ColumnFile &) = delete;
+    ~ColumnFile();
+
+    /**
+     * A static method opening a column file.
+     *
+     * @param path A path of the file.
+     * @return A pair of a status and a ColumnFile instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be read or is malformed.
+     */
+    static std::pair<Status, ColumnFile> open(const std::string &path);
+
+    /**
+     * A method returning the number of rows in all blocks.
+     * @return The number of rows.
+     */
+    size_t size() const { return size_; }
+    /**
+     * A method returning the blocks, ordered by binary header.
+     * @return Column blocks.
+     */
+    const std::vector<ColumnBlock> &getBlocks() const { return blocks_; }
+
+private:
+    Status parse();
+    void close();
+
+    void *data_ = nullptr;
+    size_t length_ = 0;
+    size_t size_ = 0;
+    std::vector<ColumnBlock> blocks_;
+};
+
+/**
+ * A writer of column files.
+ *
+ * Tags are buffered in memory until the file is written.
+ */
+class ColumnFileWriter {
+public:
+    /**
+     * A method adding a tag.
+     *
+     * @param tag A tag.
+     * @return Status::kOk on normal completion,
+     * Status::kInvalidArgument if the tag is of TagType::kUnknown, or
+     * Status::kInvalidSerial if the serial can't be encoded in the
+     * encoding scheme of the tag.
+     */
+    Status add(const Tag &tag);
+    /**
+     * A method writing all tags added so far.
+     *
+     * @param path A path of the file.
+     * @return Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be written.
+     */
+    Status write(const std::string &path) const;
+    /**
+     * A method returning the number of tags added so far.
+     * @return The number of tags.
+     */
+    size_t size() const;
+
+private:
+    using Block = struct BlockStruct {
+        std::map<std::string, uint32_t> company_prefix_map_;
+        std::vector<ColumnCompanyPrefix> company_prefixes_;
+        std::vector<uint8_t> filter_values_;
+        std::vector<uint32_t> company_prefix_indices_;
+        std::vector<uint64_t> references_;
+        std::vector<uint64_t> serials_;
+        std::vector<uint64_t> serial_offsets_;
+        std::string serial_data_;
+    };
+
+    std::map<uint8_t, Block> blocks_;
+};
+
+}
+
+#endif
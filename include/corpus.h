@@ -0,0 +1,233 @@
+#ifndef LIBEPC_EPC_CORPUS_H_
+#define LIBEPC_EPC_CORPUS_H_
+
+#include "layout.h"
+#include "status.h"
+#include "tag.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * Representations of records of a corpus.
+ */
+enum class CorpusFormat {
+    /** EPC binaries in upper case hex */
+    kHex,
+    /**
+     * EPC binaries of get_hex_length() digits in bytes, as taken by
+     * Tag::createFromBytes()
+     */
+    kBytes,
+    kURI,
+    kTagURI,
+};
+
+/**
+ * Kinds of serials of a corpus, which are the serials of SGTIN, the
+ * extensions of SGLN, the serials of GRAI, the serial references of SSCC
+ * and the asset references of GIAI.
+ */
+enum class SerialMode {
+    /** Serials counting up by the index of records */
+    kSequential,
+    /** Integers uniformly distributed over the range of the scheme */
+    kRandom,
+    /**
+     * Strings of digits and letters of up to the maximum length of the
+     * scheme, e.g. 20 characters of SGTIN-198. Schemes taking only
+     * integers fall back to kRandom.
+     */
+    kAlphanumeric,
+};
+
+/**
+ * A scheme of a corpus and its relative frequency.
+ */
+using CorpusScheme = struct CorpusSchemeStruct {
+    /** The first 8 bits of EPC binaries, e.g. 0x30 for SGTIN-96 */
+    uint8_t header_;
+    double weight_;
+};
+
+/**
+ * A configuration of a corpus.
+ */
+using CorpusConfig = struct CorpusConfigStruct {
+    uint64_t seed_ = 0;
+    std::vector<CorpusScheme> schemes_ = {{0x30, 1}};
+    /**
+     * Relative frequencies of partitions 0 to 6, i.e. of company prefixes
+     * of 12 to 6 digits. Partition 0 is never taken for SGLN and GRAI, of
+     * which it leaves no digits of reference.
+     */
+    std::vector<double> partition_weights_ = {1, 1, 1, 1, 1, 1, 1};
+    unsigned int filter_ = 0;
+    /**
+     * The number of distinct company prefixes of each partition, up to
+     * CorpusGenerator::MAX_COMPANY_PREFIXES
+     */
+    size_t company_prefixes_ = 1000;
+    /**
+     * The exponent of the Zipf distribution of company prefixes, where the
+     * company prefix of rank i is taken in proportion to 1 / i^skew, or 0
+     * for the uniform distribution
+     */
+    double company_prefix_skew_ = 1;
+    SerialMode serial_mode_ = SerialMode::kRandom;
+    /** The serial of the record 0 of SerialMode::kSequential */
+    uint64_t first_serial_ = 0;
+    /**
+     * The probability, less than 1, that a record is a re-read of one of
+     * the preceding records, as readers at a portal report a tag many times
+     */
+    double repeat_rate_ = 0;
+    /**
+     * The number of preceding records a re-read is of, up to
+     * CorpusGenerator::MAX_REPEAT_WINDOW
+     */
+    size_t repeat_window_ = 64;
+    /**
+     * The exponent of the distribution of re-reads, where the record i
+     * records before is re-read in proportion to 1 / i^skew
+     */
+    double repeat_skew_ = 1;
+};
+
+/**
+ * A generator of deterministic synthetic corpora of EPCs.
+ *
+ * Every record is a function of the seed and its index only, drawn from
+ * a counter-based random number generator, so any range of records can be
+ * generated by any thread in any order and the corpus stays the same. The
+ * scheme, partition, company prefix and re-read of a record are each drawn
+ * in constant time from alias tables, and the fields are formatted straight
+ * into the buffer. Every record is valid, i.e. taken by Tag::createFrom*()
+ * and reproduced by Tag::get*().
+ *
+ * Corpora of the same configuration are the same across runs and
+ * platforms, but may change between versions of the library.
+ */
+class CorpusGenerator {
+public:
+    /**
+     * The largest numbers of company prefixes and of the repeat window,
+     * which keep the company prefixes of all partitions and the indices of
+     * alias tables within 32 bits.
+     */
+    static constexpr size_t MAX_COMPANY_PREFIXES = 1 << 20;
+    static constexpr size_t MAX_REPEAT_WINDOW = 1 << 20;
+
+    CorpusGenerator() = default;
+
+    /**
+     * A static method creating a generator.
+     *
+     * @param config A configuration.
+     * @return A pair of a status and a CorpusGenerator instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if a header isn't supported, a weight is
+     * negative or not finite, a scheme has no partition of positive weight,
+     * the filter value is over 7, the number of company prefixes or the
+     * repeat window is 0 or over its maximum or the repeat rate isn't in
+     * [0, 1).
+     */
+    static std::pair<Status, CorpusGenerator> create(
+        const CorpusConfig &config);
+
+    /**
+     * A method appending a record.
+     *
+     * @param index The index of the record.
+     * @param format A representation.
+     * @param buffer A buffer the record is appended to.
+     */
+    void append(uint64_t index, CorpusFormat format,
+                std::string &buffer) const;
+    /**
+     * A method generating records.
+     *
+     * @param first The index of the first record.
+     * @param n The number of records.
+     * @param format A representation.
+     * @param buffer A buffer replaced by the records.
+     * @param offsets An array of n + 1 offsets, where the record first + i
+     * is from offsets[i] to offsets[i + 1] of the buffer, or nullptr.
+     */
+    void generate(uint64_t first, size_t n, CorpusFormat format,
+                  std::string &buffer, size_t *offsets) const;
+
+private:
+    static constexpr unsigned int PARTITIONS = 7;
+    static constexpr unsigned int MAX_SERIAL_LENGTH = 24;
+
+    using AliasTable = struct AliasTableStruct {
+        /** Thresholds of the low 32 bits of draws, scaled by 2^32 */
+        std::vector<uint64_t> thresholds_;
+        std::vector<uint32_t> aliases_;
+    };
+
+    using Slot = struct SlotStruct {
+        Layout layout_;
+        /** The largest serial in integer */
+        uint64_t max_serial_;
+        /**
+         * The maximum length of serials in characters, or 0 if serials are
+         * integers in the binary
+         */
+        unsigned int max_length_;
+    };
+
+    using Scheme = struct SchemeStruct {
+        TagType type_;
+        size_t hex_length_;
+        std::string uri_prefix_;
+        std::string tag_uri_prefix_;
+        Slot slots_[PARTITIONS];
+        AliasTable partitions_;
+    };
+
+    using Record = struct RecordStruct {
+        const Scheme *scheme_;
+        const Slot *slot_;
+        uint64_t company_prefix_;
+        /** The reference, which is the serial of SSCC */
+        uint64_t reference_;
+        /**
+         * The serial, which is the asset reference of GIAI, in integer
+         * unless it's in characters
+         */
+        uint64_t serial_;
+        char chars_[MAX_SERIAL_LENGTH];
+        /** The length of the serial in characters, or 0 if it's integer */
+        unsigned int length_;
+    };
+
+    static bool buildAliasTable(const std::vector<double> &weights,
+                                AliasTable &table);
+    static uint32_t sample(const AliasTable &table, uint64_t r);
+
+    void makeRecord(uint64_t index, Record &record) const;
+    void appendRecord(const Record &record, CorpusFormat format,
+                      std::string &buffer) const;
+
+    CorpusConfig config_;
+    std::vector<Scheme> schemes_;
+    AliasTable scheme_table_;
+    /** Company prefixes of the partition p from p * company_prefixes_ */
+    std::vector<uint64_t> company_prefixes_;
+    AliasTable company_prefix_table_;
+    AliasTable repeat_table_;
+    /** Draws below it make re-reads */
+    uint64_t repeat_threshold_ = 0;
+    uint64_t seed_key_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef LIBEPC_EPC_DECODE_CACHE_H_
+#define LIBEPC_EPC_DECODE_CACHE_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A decoded tag cached by DecodeCache with its URIs rendered.
+ */
+using DecodeCacheEntry = struct DecodeCacheEntryStruct {
+    Tag tag_;
+    std::string uri_;
+    std::string tag_uri_;
+};
+
+/**
+ * A thread-safe cache of decoded tags keyed by EPC binary.
+ *
+ * The cache is split into shards, each guarded by its own mutex and
+ * evicting entries with the CLOCK algorithm once it holds its share of the
+ * capacity. A hit costs packing the binary into a fixed-size key, a hash
+ * lookup and a reference count increment; tags and URIs are decoded and
+ * rendered only on a miss.
+ *
+ * Binaries failing to be decoded aren't cached. The status of a lookup is
+ * the same as the one of Tag::createFromBinary or Tag::createFromBytes.
+ */
+class DecodeCache {
+public:
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+    /**
+     * @param capacity The maximum number of entries.
+     * @param shard_count The number of shards. More shards reduce
+     * contention between threads.
+     */
+    explicit DecodeCache(size_t capacity,
+                         size_t shard_count = DEFAULT_SHARD_COUNT);
+    DecodeCache(const DecodeCache &) = delete;
+    DecodeCache &operator=(const DecodeCache &) = delete;
+    ~DecodeCache();
+
+    /**
+     * A method returning a decoded tag for EPC binary in hex string format.
+     *
+     * @param hex EPC binary in hex string format.
+     * @return A pair of a status and an entry, which stays valid after it's
+     * evicted. The status is Status::kOk on normal completion or the error
+     * factor on error, in which case the entry is nullptr.
+     */
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>> get(
+        const std::string &hex);
+    /**
+     * A method returning a decoded tag for EPC binary in bytes.
+     *
+     * @param bytes EPC binary, most significant byte first.
+     * @param size The number of bytes.
+     * @return A pair of a status and an entry, which stays valid after it's
+     * evicted. The status is Status::kOk on normal completion or the error
+     * factor on error, in which case the entry is nullptr.
+     */
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>> get(
+        const uint8_t *bytes, size_t size);
+
+    /**
+     * A method returning the number of lookups found in the cache.
+     * @return The number of hits.
+     */
+    uint64_t getHits() const;
+    /**
+     * A method returning the number of lookups not found in the cache,
+     * including the ones failing to be decoded.
+     * @return The number of misses.
+     */
+    uint64_t getMisses() const;
+    /**
+     * A method returning the number of entries.
+     * @return The number of entries.
+     */
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+    /**
+     * A method removing all entries. Counters are kept.
+     */
+    void clear();
+
+private:
+    struct Key;
+    struct KeyHash;
+    struct Shard;
+
+    template <typename Decode>
+    std::pair<Status, std::shared_ptr<const DecodeCacheEntry>> get(
+        const Key &key, Decode decode);
+
+    size_t capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}
+
+#endif
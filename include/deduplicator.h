@@ -0,0 +1,102 @@
+#ifndef LIBEPC_EPC_DEDUPLICATOR_H_
+#define LIBEPC_EPC_DEDUPLICATOR_H_
+
+#include "epc96.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A deduplicator of tag reads emitting each EPC once per time window per
+ * zone, e.g. per reader or antenna.
+ *
+ * A read is first-seen if its EPC hasn't been emitted in its zone, or was
+ * emitted a window or more before the read; the window then restarts at
+ * the read. Reads older than the last emission are duplicates.
+ *
+ * Entries are held in an open-addressing table with linear probing.
+ * Expired entries are removed by a sweep advancing a few slots per offer,
+ * so the cost of expiry is spread over offers instead of stalling one of
+ * them. Timestamps are in any unit agreed by the caller, and are expected
+ * to be roughly increasing.
+ */
+class Deduplicator {
+public:
+    /**
+     * @param window The length of the window in the unit of timestamps.
+     * Must be positive.
+     * @param initial_capacity The number of entries held before the table
+     * grows.
+     */
+    explicit Deduplicator(uint64_t window, size_t initial_capacity = 1024);
+
+    /**
+     * A method offering a read.
+     *
+     * @param epc An EPC.
+     * @param zone A zone of the read.
+     * @param timestamp A timestamp of the read.
+     * @return true if the read is first-seen in the window.
+     */
+    bool offer(const Epc96 &epc, uint32_t zone, uint64_t timestamp);
+    /**
+     * A method offering reads.
+     *
+     * @param epcs EPCs.
+     * @param zones Zones of the reads, or nullptr for zone 0.
+     * @param timestamps Timestamps of the reads.
+     * @param n The number of reads.
+     * @param mask A bitmask of at least (n + 63) / 64 words, whose bit
+     * i % 64 of word i / 64 is set if the read i is first-seen.
+     * @return The number of first-seen reads.
+     */
+    size_t offer(const Epc96 *epcs, const uint32_t *zones,
+                 const uint64_t *timestamps, size_t n, uint64_t *mask);
+    /**
+     * A method removing all entries expired at a time.
+     * @param now A timestamp.
+     */
+    void expire(uint64_t now);
+    /**
+     * A method removing all entries.
+     */
+    void clear();
+
+    /**
+     * A method returning the number of entries, including expired entries
+     * not swept yet.
+     * @return The number of entries.
+     */
+    size_t size() const { return size_; }
+    uint64_t getWindow() const { return window_; }
+
+private:
+    using Entry = struct EntryStruct {
+        uint64_t low_;
+        uint32_t high_;
+        uint32_t zone_;
+        /** Timestamp the window ends at, or 0 for an empty slot */
+        uint64_t expires_;
+    };
+
+    size_t getHome(uint64_t low, uint32_t high, uint32_t zone) const;
+    bool offerAt(size_t index, const Epc96 &epc, uint32_t zone,
+                 uint64_t timestamp);
+    void reserve(size_t n);
+    void remove(size_t index);
+    void sweep(size_t steps);
+
+    uint64_t window_;
+    std::vector<Entry> entries_;
+    size_t mask_;
+    unsigned int shift_;
+    size_t size_ = 0;
+    size_t cursor_ = 0;
+    uint64_t now_ = 0;
+};
+
+}
+
+#endif
@@ -46,13 +46,14 @@ public:
      */
     unsigned int getFilterValue() const { return filter_value_; }
 
+    static constexpr int MAX_FILTER_VALUE = 7;
+
 protected:
     static constexpr int FILTER_VALUE_BITS = 3;
     static constexpr int PARTITION_BITS = 3;
 
 private:
     unsigned int filter_value_ = 0;
-    static constexpr int MAX_FILTER_VALUE = 7;
 };
 
 }
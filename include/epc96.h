@@ -0,0 +1,95 @@
+#ifndef LIBEPC_EPC_EPC96_H_
+#define LIBEPC_EPC_EPC96_H_
+
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * A packed 96-bit EPC binary.
+ *
+ * The 96 bits are held as the upper 32 bits and the lower 64 bits of the
+ * binary, so values are ordered the same way as their binaries.
+ */
+class Epc96 {
+public:
+    static constexpr size_t BYTES = 12;
+
+    Epc96() = default;
+    Epc96(uint32_t high, uint64_t low) : high_(high), low_(low) {}
+
+    /**
+     * A static method creating an Epc96 instance from EPC Binary.
+     *
+     * @param hex EPC Binary in hex string format.
+     * @return A pair of a status and an Epc96 instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if hex isn't 24 hex digits.
+     */
+    static std::pair<Status, Epc96> createFromBinary(const std::string &hex);
+    /**
+     * A static method creating an Epc96 instance from 12 bytes of EPC
+     * binary, most significant byte first.
+     *
+     * @param bytes EPC Binary.
+     * @return An Epc96 instance.
+     */
+    static Epc96 createFromBytes(const uint8_t *bytes);
+
+    /**
+     * A method returning EPC binary in hex string.
+     * @return EPC binary of 24 hex digits.
+     */
+    std::string getBinary() const;
+    /**
+     * A method writing 12 bytes of EPC binary, most significant byte first.
+     * @param bytes A buffer of at least 12 bytes.
+     */
+    void getBytes(uint8_t *bytes) const;
+
+    uint32_t getHigh() const { return high_; }
+    uint64_t getLow() const { return low_; }
+    /**
+     * A method returning the binary header.
+     * @return The first 8 bits.
+     */
+    uint8_t getHeader() const { return high_ >> 24; }
+    /**
+     * A method returning bits of the binary as an integer.
+     *
+     * @param offset The offset of the first bit from the most significant
+     * bit.
+     * @param length The number of bits, up to 64.
+     * @return The bits.
+     */
+    uint64_t getBits(unsigned int offset, unsigned int length) const;
+
+    friend bool operator==(const Epc96 &a, const Epc96 &b) {
+        return a.high_ == b.high_ && a.low_ == b.low_;
+    }
+    friend bool operator!=(const Epc96 &a, const Epc96 &b) {
+        return !(a == b);
+    }
+    friend bool operator<(const Epc96 &a, const Epc96 &b) {
+        return a.high_ < b.high_ || (a.high_ == b.high_ && a.low_ < b.low_);
+    }
+    friend bool operator>(const Epc96 &a, const Epc96 &b) { return b < a; }
+    friend bool operator<=(const Epc96 &a, const Epc96 &b) {
+        return !(b < a);
+    }
+    friend bool operator>=(const Epc96 &a, const Epc96 &b) {
+        return !(a < b);
+    }
+
+private:
+    uint32_t high_ = 0;
+    uint64_t low_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef LIBEPC_EPC_EPC96_MAP_H_
+#define LIBEPC_EPC_EPC96_MAP_H_
+
+#include "epc96.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace epc {
+
+/**
+ * Control bytes of Epc96Map. A full slot has the 7 bits of the hash not
+ * used for its position, and the others have the high bit set.
+ */
+constexpr int8_t EPC96_MAP_EMPTY = -128;
+constexpr int8_t EPC96_MAP_DELETED = -2;
+
+/**
+ * A group of 8 control bytes of Epc96Map matched in a 64-bit word, for
+ * targets without SSE2.
+ *
+ * Masks have the high bit of each matching byte set.
+ */
+class Epc96MapPortableGroup {
+public:
+    using Mask = uint64_t;
+    static constexpr size_t WIDTH = 8;
+
+    explicit Epc96MapPortableGroup(const int8_t *ctrl) {
+        std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        ctrl_ = __builtin_bswap64(ctrl_);
+#endif
+    }
+
+    /**
+     * A method matching full slots of a hash. Bytes following a match may
+     * match falsely, so keys must be compared.
+     */
+    Mask match(int8_t h2) const {
+        uint64_t x = ctrl_ ^ (LSBS * static_cast<uint8_t>(h2));
+        return (x - LSBS) & ~x & MSBS;
+    }
+    Mask matchEmpty() const {
+        // EMPTY is the only control byte with the high bit set and bit 1
+        // clear.
+        return ctrl_ & ~(ctrl_ << 6) & MSBS;
+    }
+    Mask matchEmptyOrDeleted() const { return ctrl_ & MSBS; }
+    static size_t getLowest(Mask mask) { return __builtin_ctzll(mask) / 8; }
+
+private:
+    static constexpr uint64_t LSBS = 0x0101010101010101;
+    static constexpr uint64_t MSBS = 0x8080808080808080;
+
+    uint64_t ctrl_;
+};
+
+#if defined(__SSE2__)
+/**
+ * A group of 16 control bytes of Epc96Map matched with SSE2.
+ */
+class Epc96MapSSE2Group {
+public:
+    using Mask = uint32_t;
+    static constexpr size_t WIDTH = 16;
+
+    explicit Epc96MapSSE2Group(const int8_t *ctrl)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+    Mask match(int8_t h2) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+    }
+    Mask matchEmpty() const { return match(EPC96_MAP_EMPTY); }
+    Mask matchEmptyOrDeleted() const { return _mm_movemask_epi8(ctrl_); }
+    static size_t getLowest(Mask mask) { return __builtin_ctz(mask); }
+
+private:
+    __m128i ctrl_;
+};
+
+using Epc96MapGroup = Epc96MapSSE2Group;
+#else
+using Epc96MapGroup = Epc96MapPortableGroup;
+#endif
+
+/**
+ * An open-addressing hash map keyed by 96-bit EPCs.
+ *
+ * Slots are probed in groups by matching a control byte per slot, which
+ * holds 7 bits of the hash of the key, against all bytes of a group at
+ * once, so keys are compared only for slots whose bytes match. Keys are
+ * stored inline as three 32-bit words apart from values, and values are
+ * touched only on hits.
+ *
+ * The map grows at 7/8 load. Pointers to values are invalidated by
+ * inserts growing the map.
+ *
+ * @tparam V A type of values.
+ * @tparam Group A type matching groups of control bytes.
+ */
+template <typename V, typename Group = Epc96MapGroup>
+class Epc96Map {
+public:
+    Epc96Map() = default;
+    /**
+     * @param n The number of keys held without growing.
+     */
+    explicit Epc96Map(size_t n) { reserve(n); }
+    Epc96Map(Epc96Map &&other) noexcept { swap(other); }
+    Epc96Map &operator=(Epc96Map &&other) noexcept {
+        if (this != &other) {
+            Epc96Map moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+    Epc96Map(const Epc96Map &) = delete;
+    Epc96Map &operator=(const Epc96Map &) = delete;
+    ~Epc96Map() { release(); }
+
+    /**
+     * A static method hashing a key. The serial in the low bits carries
+     * most of the entropy, and the multiplication spreads it to all bits.
+     */
+    static uint64_t hash(const Epc96 &key) {
+        uint64_t h = (key.getLow()
+                      ^ static_cast<uint64_t>(key.getHigh())
+                      * 0x9E3779B97F4A7C15) * 0xC2B2AE3D27D4EB4F;
+        return h ^ h >> 32;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    /**
+     * A method returning the number of slots.
+     * @return The number of slots.
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * A method making room for a number of keys.
+     * @param n The number of keys held without growing.
+     */
+    void reserve(size_t n) {
+        size_t capacity = Group::WIDTH;
+        while (capacity - capacity / 8 < n) capacity <<= 1;
+        if (capacity > capacity_) rehash(capacity);
+    }
+
+    /**
+     * A method looking up a key.
+     * @param key A key.
+     * @return A pointer to the value, or nullptr if the key isn't found.
+     */
+    V *find(const Epc96 &key) {
+        size_t i = findIndex(key, hash(key));
+        return i == NPOS ? nullptr : &values_[i];
+    }
+    const V *find(const Epc96 &key) const {
+        size_t i = findIndex(key, hash(key));
+        return i == NPOS ? nullptr : &values_[i];
+    }
+    bool contains(const Epc96 &key) const { return find(key) != nullptr; }
+
+    /**
+     * A method looking up keys, prefetching slots of following keys.
+     *
+     * @param keys Keys.
+     * @param n The number of keys.
+     * @param values Pointers receiving the values, or nullptr for keys not
+     * found.
+     * @return The number of keys found.
+     */
+    size_t find(const Epc96 *keys, size_t n, const V **values) const {
+        const size_t PREFETCH_DISTANCE = 16;
+        size_t count = 0;
+        uint64_t hashes[PREFETCH_DISTANCE];
+        for (size_t begin = 0; begin < n; begin += PREFETCH_DISTANCE) {
+            size_t end = begin + PREFETCH_DISTANCE < n
+                ? begin + PREFETCH_DISTANCE : n;
+            for (size_t i = begin; i < end; i++) {
+                uint64_t h = hash(keys[i]);
+                hashes[i - begin] = h;
+                if (capacity_ > 0) {
+                    size_t offset = (h >> 7) & mask_;
+                    prefetch(ctrl_ + offset);
+                    prefetch(keys_ + offset * 3);
+                }
+            }
+            for (size_t i = begin; i < end; i++) {
+                size_t index = findIndex(keys[i], hashes[i - begin]);
+                values[i] = index == NPOS ? nullptr : &values_[index];
+                if (values[i]) count++;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * A method inserting a key unless it's in the map.
+     *
+     * @param key A key.
+     * @param value A value.
+     * @return A pair of a pointer to the value of the key and whether the
+     * key is inserted.
+     */
+    std::pair<V *, bool> insert(const Epc96 &key, const V &value) {
+        uint64_t h = hash(key);
+        size_t i = findIndex(key, h);
+        if (i != NPOS) return std::make_pair(&values_[i], false);
+        i = prepareInsert(key, h);
+        new (&values_[i]) V(value);
+        return std::make_pair(&values_[i], true);
+    }
+    /**
+     * A method returning the value of a key, inserting a default value if
+     * the key isn't in the map.
+     */
+    V &operator[](const Epc96 &key) {
+        uint64_t h = hash(key);
+        size_t i = findIndex(key, h);
+        if (i != NPOS) return values_[i];
+        i = prepareInsert(key, h);
+        new (&values_[i]) V();
+        return values_[i];
+    }
+    /**
+     * A method removing a key.
+     * @param key A key.
+     * @return true if the key is removed.
+     */
+    bool erase(const Epc96 &key) {
+        size_t i = findIndex(key, hash(key));
+        if (i == NPOS) return false;
+        values_[i].~V();
+        // Probes pass through the slot, so it can't be made empty.
+        setCtrl(i, EPC96_MAP_DELETED);
+        size_--;
+        return true;
+    }
+    /**
+     * A method removing all keys, keeping the slots.
+     */
+    void clear() {
+        for (size_t i = 0; i < capacity_; i++) {
+            if (ctrl_[i] >= 0) values_[i].~V();
+        }
+        if (ctrl_) {
+            std::memset(ctrl_, EPC96_MAP_EMPTY, capacity_ + Group::WIDTH);
+        }
+        size_ = 0;
+        growth_left_ = capacity_ - capacity_ / 8;
+    }
+
+    /**
+     * A method calling a function with each key and value in no
+     * particular order.
+     *
+     * @param f A function taking a key and a value.
+     */
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < capacity_; i++) {
+            if (ctrl_[i] >= 0) f(getKey(i), values_[i]);
+        }
+    }
+
+private:
+    static constexpr size_t NPOS = ~static_cast<size_t>(0);
+
+    static void prefetch(const void *p) {
+#if defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    Epc96 getKey(size_t i) const {
+        const uint32_t *k = keys_ + i * 3;
+        return Epc96(k[0], static_cast<uint64_t>(k[1]) << 32 | k[2]);
+    }
+
+    // The first WIDTH control bytes are mirrored after the last one, so
+    // that groups starting near the end wrap around.
+    void setCtrl(size_t i, int8_t c) {
+        ctrl_[i] = c;
+        if (i < Group::WIDTH) ctrl_[capacity_ + i] = c;
+    }
+
+    // Groups are probed quadratically, which visits all of them since the
+    // capacity is a power of 2.
+    size_t findIndex(const Epc96 &key, uint64_t h) const {
+        if (capacity_ == 0) return NPOS;
+        int8_t h2 = h & 0x7F;
+        uint32_t high = key.getHigh();
+        uint32_t middle = key.getLow() >> 32;
+        uint32_t low = static_cast<uint32_t>(key.getLow());
+        size_t offset = (h >> 7) & mask_;
+        for (size_t step = Group::WIDTH;; step += Group::WIDTH) {
+            Group group(ctrl_ + offset);
+            for (typename Group::Mask m = group.match(h2); m != 0;
+                 m &= m - 1) {
+                size_t i = (offset + Group::getLowest(m)) & mask_;
+                const uint32_t *k = keys_ + i * 3;
+                if (k[2] == low && k[1] == middle && k[0] == high) return i;
+            }
+            if (group.matchEmpty() != 0) return NPOS;
+            offset = (offset + step) & mask_;
+        }
+    }
+
+    size_t findFreeIndex(uint64_t h) const {
+        size_t offset = (h >> 7) & mask_;
+        for (size_t step = Group::WIDTH;; step += Group::WIDTH) {
+            typename Group::Mask m = Group(ctrl_ + offset)
+                .matchEmptyOrDeleted();
+            if (m != 0) return (offset + Group::getLowest(m)) & mask_;
+            offset = (offset + step) & mask_;
+        }
+    }
+
+    // Claims a slot for a key not in the map, leaving its value to be
+    // constructed.
+    size_t prepareInsert(const Epc96 &key, uint64_t h) {
+        size_t i = capacity_ > 0 ? findFreeIndex(h) : 0;
+        if (capacity_ == 0
+            || (growth_left_ == 0 && ctrl_[i] == EPC96_MAP_EMPTY)) {
+            // Drop deleted slots if they take much of the room, or grow.
+            size_t capacity = capacity_ == 0 ? Group::WIDTH : capacity_;
+            if (size_ * 32 > capacity * 25) capacity <<= 1;
+            rehash(capacity);
+            i = findFreeIndex(h);
+        }
+        if (ctrl_[i] == EPC96_MAP_EMPTY) growth_left_--;
+        setCtrl(i, h & 0x7F);
+        uint32_t *k = keys_ + i * 3;
+        k[0] = key.getHigh();
+        k[1] = key.getLow() >> 32;
+        k[2] = static_cast<uint32_t>(key.getLow());
+        size_++;
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        Epc96Map map;
+        map.capacity_ = capacity;
+        map.mask_ = capacity - 1;
+        map.ctrl_ = new int8_t[capacity + Group::WIDTH];
+        std::memset(map.ctrl_, EPC96_MAP_EMPTY, capacity + Group::WIDTH);
+        map.keys_ = new uint32_t[capacity * 3];
+        map.values_ = std::allocator<V>().allocate(capacity);
+        map.growth_left_ = capacity - capacity / 8;
+        for (size_t i = 0; i < capacity_; i++) {
+            if (ctrl_[i] < 0) continue;
+            Epc96 key = getKey(i);
+            size_t j = map.prepareInsert(key, hash(key));
+            new (&map.values_[j]) V(std::move(values_[i]));
+        }
+        swap(map);
+    }
+
+    void release() {
+        if (!ctrl_) return;
+        clear();
+        delete[] ctrl_;
+        delete[] keys_;
+        std::allocator<V>().deallocate(values_, capacity_);
+        ctrl_ = nullptr;
+        keys_ = nullptr;
+        values_ = nullptr;
+    }
+
+    void swap(Epc96Map &other) {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(keys_, other.keys_);
+        std::swap(values_, other.values_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(mask_, other.mask_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+    }
+
+    int8_t *ctrl_ = nullptr;
+    uint32_t *keys_ = nullptr;
+    V *values_ = nullptr;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    /** The number of empty slots that can be filled before growing */
+    size_t growth_left_ = 0;
+};
+
+}
+
+#endif
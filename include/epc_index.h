@@ -0,0 +1,198 @@
+#ifndef LIBEPC_EPC_EPC_INDEX_H_
+#define LIBEPC_EPC_EPC_INDEX_H_
+
+#include "epc96.h"
+#include "status.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * An inclusive range of 96-bit EPC binaries.
+ */
+using EpcRange = struct EpcRangeStruct {
+    Epc96 first_;
+    Epc96 last_;
+};
+
+/**
+ * A query of EpcIndex by the fields of a scheme.
+ *
+ * Since every scheme lays out its fields in the order of header, filter,
+ * partition, company prefix, reference and serial, the EPCs matching a
+ * query make up a range of binaries for each filter value.
+ */
+using EpcIndexQuery = struct EpcIndexQueryStruct {
+    /** The header of a 96-bit scheme */
+    uint8_t header_;
+    /** A filter value, or a negative value for any */
+    int filter_;
+    std::string company_prefix_;
+    /** A reference in digits, or an empty string for any */
+    std::string reference_;
+    /** The first serial, used only with a reference */
+    uint64_t first_serial_;
+    /** The last serial, used only with a reference */
+    uint64_t last_serial_;
+};
+
+/**
+ * A function creating a query of a company prefix and, optionally, a
+ * reference in all filter values.
+ *
+ * @param header The header of a 96-bit scheme.
+ * @param company_prefix A company prefix.
+ * @param reference A reference, or an empty string for any.
+ * @return A query of all serials.
+ */
+EpcIndexQuery make_index_query(uint8_t header,
+                               const std::string &company_prefix,
+                               const std::string &reference = "");
+
+/**
+ * A function returning the ranges of binaries matching a query.
+ *
+ * @param query A query.
+ * @return A pair of a status and ranges in ascending order.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the query doesn't fit the layout of the
+ * scheme.
+ */
+std::pair<Status, std::vector<EpcRange>> get_index_ranges(
+    const EpcIndexQuery &query);
+
+/**
+ * The EPCs whose first bits are those of a value.
+ */
+using EpcPrefix = struct EpcPrefixStruct {
+    /** An EPC whose bits following the prefix are zeros */
+    Epc96 value_;
+    /** The number of bits of the prefix */
+    unsigned int bits_;
+};
+
+/**
+ * A function splitting a range into the fewest prefixes, e.g. to match a
+ * range of serials with masks.
+ *
+ * @param range A range.
+ * @return Prefixes in ascending order.
+ */
+std::vector<EpcPrefix> get_range_prefixes(const EpcRange &range);
+
+/**
+ * An in-memory index of 96-bit EPC binaries.
+ *
+ * The index is a crit-bit tree over the bits of binaries, branching only on
+ * bits where keys differ, so its depth is bounded by the number of bits
+ * regardless of how keys cluster under common company prefixes. Prefix and
+ * range scans visit keys in the order of binaries, i.e. by scheme, filter,
+ * company prefix, reference and serial.
+ *
+ * Each key is mapped to a value of the caller, e.g. a row number.
+ */
+class EpcIndex {
+public:
+    /**
+     * A function receiving keys and values of a scan. It returns false to
+     * stop the scan.
+     */
+    using Visitor = std::function<bool(const Epc96 &epc, uint64_t value)>;
+
+    EpcIndex() = default;
+
+    /**
+     * A method inserting a key.
+     *
+     * @param epc A key.
+     * @param value A value.
+     * @return true if the key is new, or false if the value of the key is
+     * replaced.
+     */
+    bool insert(const Epc96 &epc, uint64_t value);
+    /**
+     * A method inserting keys at once. Faster than inserting them one by
+     * one since the tree is built from sorted keys.
+     *
+     * @param epcs Keys.
+     * @param values Values of the keys, or nullptr for the positions of the
+     * keys in epcs.
+     * @param n The number of keys.
+     */
+    void load(const Epc96 *epcs, const uint64_t *values, size_t n);
+    /**
+     * A method looking up a key.
+     *
+     * @param epc A key.
+     * @param value A pointer receiving the value, or nullptr.
+     * @return true if the key is found.
+     */
+    bool find(const Epc96 &epc, uint64_t *value) const;
+
+    /**
+     * A method visiting keys of a range in ascending order.
+     *
+     * @param range A range.
+     * @param visitor A visitor.
+     * @return The number of keys visited.
+     */
+    size_t scan(const EpcRange &range, const Visitor &visitor) const;
+    /**
+     * A method visiting keys starting with bits in ascending order.
+     *
+     * @param prefix A key whose first bits are the prefix.
+     * @param bits The number of bits of the prefix.
+     * @param visitor A visitor.
+     * @return The number of keys visited.
+     */
+    size_t scanPrefix(const Epc96 &prefix, unsigned int bits,
+                      const Visitor &visitor) const;
+    /**
+     * A method visiting keys matching a query in ascending order.
+     *
+     * @param query A query.
+     * @param visitor A visitor.
+     * @return A pair of a status and the number of keys visited.
+     * The status is Status::kOk on normal completion or the error factor
+     * of get_index_ranges.
+     */
+    std::pair<Status, size_t> scan(const EpcIndexQuery &query,
+                                   const Visitor &visitor) const;
+
+    size_t size() const { return leaves_.size(); }
+    /**
+     * A method removing all keys.
+     */
+    void clear();
+
+private:
+    using Leaf = struct LeafStruct {
+        Epc96 epc_;
+        uint64_t value_;
+    };
+    using Node = struct NodeStruct {
+        /** Children, leaves of which are marked with LEAF */
+        uint32_t children_[2];
+        /** The bit the children differ first at */
+        uint32_t bit_;
+    };
+
+    static constexpr uint32_t LEAF = 0x80000000;
+
+    uint32_t build(size_t first, size_t last);
+    size_t scan(const EpcRange &range, const Visitor &visitor,
+                bool *stopped) const;
+
+    std::vector<Leaf> leaves_;
+    std::vector<Node> nodes_;
+    uint32_t root_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef LIBEPC_EPC_EPC_SET_H_
+#define LIBEPC_EPC_EPC_SET_H_
+
+#include "epc96.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace epc {
+
+/**
+ * An immutable set of 96-bit EPCs held in ascending order, e.g. the tags
+ * read in an inventory cycle.
+ *
+ * A set is built by a radix sort over the packed binaries, skipping bytes
+ * shared by all EPCs such as the header and company prefix. Set operations
+ * merge two sets in linear time, or search the larger set by galloping if
+ * one set is much smaller. Large sets can be merged by multiple threads,
+ * each merging a range of EPCs.
+ *
+ * Cycle counting, for example, is
+ * @code
+ * EpcSet missing = expected.subtract(read);
+ * EpcSet unexpected = read.subtract(expected);
+ * EpcSet found = expected.intersect(read);
+ * @endcode
+ */
+class EpcSet {
+public:
+    EpcSet() = default;
+
+    /**
+     * A static method creating a set of EPCs.
+     *
+     * @param epcs EPCs in any order. Duplicates are removed.
+     * @return A set.
+     */
+    static EpcSet create(std::vector<Epc96> epcs);
+    /**
+     * A static method creating a set of EPCs.
+     *
+     * @param epcs EPCs in any order. Duplicates are removed.
+     * @param n The number of EPCs.
+     * @return A set.
+     */
+    static EpcSet create(const Epc96 *epcs, size_t n);
+
+    /**
+     * A method returning EPCs in either of the sets.
+     *
+     * @param other A set.
+     * @param thread_count The maximum number of threads merging the sets.
+     * @return A set.
+     */
+    EpcSet unite(const EpcSet &other, unsigned int thread_count = 1) const;
+    /**
+     * A method returning EPCs in both of the sets.
+     *
+     * @param other A set.
+     * @param thread_count The maximum number of threads merging the sets.
+     * @return A set.
+     */
+    EpcSet intersect(const EpcSet &other, unsigned int thread_count = 1) const;
+    /**
+     * A method returning EPCs in this set but not in the other.
+     *
+     * @param other A set.
+     * @param thread_count The maximum number of threads merging the sets.
+     * @return A set.
+     */
+    EpcSet subtract(const EpcSet &other, unsigned int thread_count = 1) const;
+
+    /**
+     * A method testing whether an EPC is in the set.
+     * @param epc An EPC.
+     * @return true if the EPC is in the set.
+     */
+    bool contains(const Epc96 &epc) const;
+    /**
+     * A method rendering EPC URIs of all EPCs in ascending order.
+     *
+     * @param thread_count The maximum number of threads rendering URIs.
+     * @return EPC URIs. EPCs failing to be decoded are rendered as empty
+     * strings.
+     */
+    std::vector<std::string> getURIs(unsigned int thread_count = 1) const;
+    /**
+     * A method rendering EPC Tag URIs of all EPCs in ascending order.
+     *
+     * @param thread_count The maximum number of threads rendering URIs.
+     * @return EPC Tag URIs. EPCs failing to be decoded are rendered as empty
+     * strings.
+     */
+    std::vector<std::string> getTagURIs(unsigned int thread_count = 1) const;
+
+    size_t size() const { return epcs_.size(); }
+    bool empty() const { return epcs_.empty(); }
+    const Epc96 *begin() const { return epcs_.data(); }
+    const Epc96 *end() const { return epcs_.data() + epcs_.size(); }
+    const Epc96 &operator[](size_t i) const { return epcs_[i]; }
+    /**
+     * A method returning all EPCs in ascending order.
+     * @return EPCs.
+     */
+    const std::vector<Epc96> &getEpcs() const { return epcs_; }
+
+    friend bool operator==(const EpcSet &a, const EpcSet &b) {
+        return a.epcs_ == b.epcs_;
+    }
+    friend bool operator!=(const EpcSet &a, const EpcSet &b) {
+        return !(a == b);
+    }
+
+private:
+    enum class Operation { kUnion, kIntersection, kDifference };
+
+    EpcSet merge(const EpcSet &other, Operation operation,
+                 unsigned int thread_count) const;
+    std::vector<std::string> render(bool tag_uri,
+                                    unsigned int thread_count) const;
+
+    std::vector<Epc96> epcs_;
+};
+
+}
+
+#endif
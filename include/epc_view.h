@@ -0,0 +1,117 @@
+#ifndef LIBEPC_EPC_EPC_VIEW_H_
+#define LIBEPC_EPC_EPC_VIEW_H_
+
+#include "layout.h"
+#include "tag.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace epc {
+
+/**
+ * A non-owning view of an EPC binary in raw tag memory of any supported
+ * scheme.
+ *
+ * Nothing is decoded on construction. Each field is decoded from the bits
+ * when its accessor is first called, and cached for later calls, so tags
+ * filtered on a few fields never pay for the rest. The memory must outlive
+ * the view and not change while it's in use.
+ *
+ * Only the header, the partition and the length of the memory are
+ * validated. The fields of a binary which an owning EPC class would reject,
+ * e.g. a company prefix of more digits than its partition, are rendered as
+ * they're encoded.
+ */
+class EpcView {
+public:
+    EpcView() = default;
+    /**
+     * @param bytes EPC binary, most significant byte first.
+     * @param n The number of bytes, at least those of the scheme.
+     */
+    EpcView(const uint8_t *bytes, size_t n) : bytes_(bytes), n_(n) {}
+
+    /**
+     * A method returning the kind of EPC.
+     * @return A kind of EPC, or TagType::kUnknown if the header or the
+     * partition is unsupported or the memory is shorter than the binary.
+     */
+    TagType getType() const;
+    /**
+     * A method returning the binary header.
+     * @return The first 8 bits, or 0 if the memory is empty.
+     */
+    uint8_t getHeader() const { return n_ > 0 ? bytes_[0] : 0; }
+    /**
+     * A method returning the number of bits of the binary of the scheme.
+     * @return The number of bits, or 0 for a view of TagType::kUnknown.
+     */
+    unsigned int getBitLength() const;
+    unsigned int getFilterValue() const;
+    unsigned int getPartition() const;
+
+    /**
+     * A method returning the company prefix.
+     * @return A company prefix padded to the digits of the partition, or an
+     * empty string for a view of TagType::kUnknown.
+     */
+    const std::string &getCompanyPrefix() const;
+    /**
+     * A method returning the field following the company prefix: item
+     * reference and indicator of SGTIN, serial reference of SSCC, location
+     * reference of SGLN, asset type of GRAI and asset reference of GIAI.
+     * @return A reference, or an empty string for a view of
+     * TagType::kUnknown.
+     */
+    const std::string &getReference() const;
+    /**
+     * A method returning the serial of SGTIN and GRAI, or the extension of
+     * SGLN.
+     * @return A serial, or an empty string for SSCC, GIAI and a view of
+     * TagType::kUnknown.
+     */
+    const std::string &getSerial() const;
+
+    /**
+     * A method rendering EPC URI.
+     * @return EPC URI, or an empty string for a view of TagType::kUnknown.
+     */
+    std::string getURI() const;
+    /**
+     * A method rendering EPC Tag URI.
+     * @return EPC Tag URI, or an empty string for a view of
+     * TagType::kUnknown.
+     */
+    std::string getTagURI() const;
+
+private:
+    /** Bits of decoded_ for the fields cached */
+    enum Field : uint8_t {
+        kLayout = 1,
+        kCompanyPrefix = 1 << 1,
+        kReference = 1 << 2,
+        kSerial = 1 << 3,
+    };
+
+    const Layout &getLayout() const;
+    uint64_t getBits(unsigned int offset, unsigned int length) const;
+    std::string getString(unsigned int offset, unsigned int length) const;
+    void renderFields(std::string &uri) const;
+
+    const uint8_t *bytes_ = nullptr;
+    size_t n_ = 0;
+
+    mutable uint8_t decoded_ = 0;
+    /** The layout, whose bits_ is 0 for a view of TagType::kUnknown */
+    mutable Layout layout_ = Layout();
+    mutable TagType type_ = TagType::kUnknown;
+    mutable std::string company_prefix_;
+    mutable std::string reference_;
+    mutable std::string serial_;
+};
+
+}
+
+#endif
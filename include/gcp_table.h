@@ -0,0 +1,177 @@
+#ifndef LIBEPC_EPC_GCP_TABLE_H_
+#define LIBEPC_EPC_GCP_TABLE_H_
+
+#include "status.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A table of lengths of GS1 Company Prefix by the leading digits of GS1
+ * keys, e.g. loaded from GS1's Company Prefix format list
+ * (gcpprefixformatlist.xml).
+ *
+ * The prefixes are held in a digit trie in a flat array of nodes of 10
+ * words, each holding the next node and the length of the prefix ending at
+ * the digit, so the longest-prefix lookup reads one word per digit. The
+ * array can be written to a file and opened by mapping the file.
+ *
+ * lookup() matches CompanyPrefixLength of gs1.h, e.g.
+ * [&table](const char *d, size_t n) { return table.lookup(d, n); }.
+ */
+class GcpLengthTable {
+public:
+    using Entry = struct EntryStruct {
+        /** Leading digits of GS1 keys */
+        std::string prefix_;
+        /**
+         * The length of company prefix of keys of the prefix, or 0 if they
+         * have no company prefix
+         */
+        unsigned int length_;
+    };
+
+    GcpLengthTable() = default;
+    GcpLengthTable(GcpLengthTable &&other);
+    GcpLengthTable &operator=(GcpLengthTable &&other);
+    GcpLengthTable(const GcpLengthTable &) = delete;
+    GcpLengthTable &operator=(const GcpLengthTable &) = delete;
+    ~GcpLengthTable();
+
+    /**
+     * A static method creating a table of entries.
+     *
+     * @param entries Entries, of which the last wins for the same prefix.
+     * @return A pair of a status and a GcpLengthTable instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if a prefix isn't of 1 to 12 digits or a
+     * length is over 12.
+     */
+    static std::pair<Status, GcpLengthTable> create(
+        const std::vector<Entry> &entries);
+    /**
+     * A static method creating a table of a GS1 Company Prefix format list,
+     * an XML file of elements <entry prefix="..." gcpLength="..."/>.
+     *
+     * @param path A path of the file.
+     * @return A pair of a status and a GcpLengthTable instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be read or has an invalid
+     * entry.
+     */
+    static std::pair<Status, GcpLengthTable> createFromFormatList(
+        const std::string &path);
+    /**
+     * A static method opening a table written by write().
+     *
+     * @param path A path of the file.
+     * @return A pair of a status and a GcpLengthTable instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be read or is malformed.
+     */
+    static std::pair<Status, GcpLengthTable> open(const std::string &path);
+    /**
+     * A method writing the table.
+     *
+     * The table is written to a temporary file in the same directory, which
+     * is renamed over the path, so tables opened from the path keep mapping
+     * the file they've opened. This is the safe way to replace a file
+     * reloaded by AtomicGcpLengthTable::reload(); a file must not be
+     * truncated or rewritten in place while it's mapped.
+     *
+     * @param path A path of the file.
+     * @return Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be written.
+     */
+    Status write(const std::string &path) const;
+
+    /**
+     * A method returning the length of company prefix of a GS1 key by the
+     * longest prefix of its digits in the table.
+     *
+     * @param digits Digits starting at the company prefix.
+     * @param n The number of digits.
+     * @return A length, or 0 if no prefix matches or the key has no company
+     * prefix.
+     */
+    unsigned int lookup(const char *digits, size_t n) const;
+    unsigned int lookup(const std::string &digits) const {
+        return lookup(digits.data(), digits.length());
+    }
+
+    /**
+     * A method returning the number of nodes of the trie.
+     * @return The number of nodes.
+     */
+    size_t getNodeCount() const { return node_count_; }
+
+private:
+    static constexpr size_t NODE_WORDS = 10;
+
+    void close();
+
+    const uint32_t *nodes_ = nullptr;
+    size_t node_count_ = 0;
+    std::vector<uint32_t> storage_;
+    void *mapping_ = nullptr;
+    size_t mapping_length_ = 0;
+};
+
+/**
+ * A GcpLengthTable which can be replaced while other threads look up.
+ *
+ * Each lookup() takes the current table atomically, which costs more than
+ * the lookup itself, so threads looking up many keys should take the table
+ * once with get() and look up in it.
+ */
+class AtomicGcpLengthTable {
+public:
+    AtomicGcpLengthTable() = default;
+    explicit AtomicGcpLengthTable(std::shared_ptr<const GcpLengthTable> table)
+        : table_(std::move(table)) {}
+
+    /**
+     * A method returning the current table.
+     * @return The table, or nullptr if it's never been set.
+     */
+    std::shared_ptr<const GcpLengthTable> get() const;
+    /**
+     * A method replacing the table. Lookups in progress keep using the
+     * table they've taken.
+     * @param table A table.
+     */
+    void set(std::shared_ptr<const GcpLengthTable> table);
+    /**
+     * A method replacing the table by a file, either written by
+     * GcpLengthTable::write() or a GS1 Company Prefix format list.
+     *
+     * @param path A path of the file.
+     * @return Status::kOk on normal completion or the error factor of
+     * GcpLengthTable::createFromFormatList(), in which case the table isn't
+     * replaced.
+     */
+    Status reload(const std::string &path);
+
+    /**
+     * A method looking up the current table.
+     *
+     * @param digits Digits starting at the company prefix.
+     * @param n The number of digits.
+     * @return A length, or 0 if no prefix matches, the key has no company
+     * prefix or there's no table.
+     */
+    unsigned int lookup(const char *digits, size_t n) const;
+
+private:
+    std::shared_ptr<const GcpLengthTable> table_;
+};
+
+}
+
+#endif
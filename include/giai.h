@@ -2,6 +2,7 @@
 #define LIBEPC_EPC_GIAI_H_
 
 #include "epc.h"
+#include "layout.h"
 
 #include <utility>
 #include <regex>
@@ -68,12 +69,12 @@ public:
      * A method returning company prefix of the GIAI.
      * @return A company prefix in string.
      */
-    std::string getCompanyPrefix() const { return company_prefix_; }
+    const std::string &getCompanyPrefix() const { return company_prefix_; }
     /**
      * A method returning asset reference of the GIAI.
      * @return An asset reference in string.
      */
-    std::string getAssetReference() const { return asset_ref_; }
+    const std::string &getAssetReference() const { return asset_ref_; }
 
     /**
      * A method setting GIAI encoding scheme.
@@ -88,6 +89,9 @@ public:
     Scheme getGIAIScheme() const { return scheme_; }
 
 private:
+    friend std::pair<Status, Layout> get_layout(uint8_t header,
+                                                unsigned int partition);
+
     using PartitionTable = struct PartitionTableStruct {
         unsigned int partition_;
         unsigned int company_prefix_bits_;
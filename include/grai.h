@@ -2,6 +2,7 @@
 #define LIBEPC_EPC_GRAI_H_
 
 #include "epc.h"
+#include "layout.h"
 
 #include <utility>
 
@@ -68,17 +69,17 @@ public:
      * A method returning company prefix of the GRAI.
      * @return A company prefix in string.
      */
-    std::string getCompanyPrefix() const { return company_prefix_; }
+    const std::string &getCompanyPrefix() const { return company_prefix_; }
     /**
      * A method returning asset type of the GRAI.
      * @return An asset type in string.
      */
-    std::string getAssetType() const { return asset_type_; }
+    const std::string &getAssetType() const { return asset_type_; }
     /**
      * A method returning serial of the GRAI.
      * @return A serial string.
      */
-    std::string getSerial() const { return serial_; }
+    const std::string &getSerial() const { return serial_; }
 
     /**
      * A method setting GRAI scheme.
@@ -93,6 +94,9 @@ public:
     Scheme getGRAIScheme() const { return scheme_; }
 
 private:
+    friend std::pair<Status, Layout> get_layout(uint8_t header,
+                                                unsigned int partition);
+
     using PartitionTable = struct PartitionTableStruct {
         unsigned int partition_;
         unsigned int company_prefix_bits_;
@@ -0,0 +1,176 @@
+#ifndef LIBEPC_EPC_GS1_H_
+#define LIBEPC_EPC_GS1_H_
+
+#include "epc96.h"
+#include "epc_view.h"
+#include "giai.h"
+#include "grai.h"
+#include "sgln.h"
+#include "sgtin.h"
+#include "sscc.h"
+#include "status.h"
+#include "tag.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * The maximum number of digits of get_check_digit().
+ */
+constexpr size_t MAX_CHECK_DIGIT_DIGITS = 24;
+
+/**
+ * A function computing the GS1 mod-10 check digit of digits.
+ *
+ * The digits are weighted 3 and 1 alternately from the rightmost, 8 at a
+ * time in a word without branches.
+ *
+ * @param digits Decimal digits, which aren't validated.
+ * @param n The number of digits, up to MAX_CHECK_DIGIT_DIGITS.
+ * @return A check digit from 0 to 9.
+ */
+unsigned int get_check_digit(const char *digits, size_t n);
+
+/**
+ * A function returning the GS1 key of a tag, without application
+ * identifier.
+ *
+ * The key is GTIN-14 of SGTIN, SSCC-18 of SSCC, GLN-13 of SGLN, GRAI of a
+ * padding zero, the 12 digits of company prefix and asset type, check digit
+ * and serial, and GIAI. The indicator digit of SGTIN and the extension digit
+ * of SSCC, which lead the reference in EPCs, lead the key.
+ *
+ * @param tag A tag.
+ * @return A pair of a status and a key.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the tag is of TagType::kUnknown or its fields
+ * don't make a key.
+ */
+std::pair<Status, std::string> get_gs1_key(const Tag &tag);
+std::pair<Status, std::string> get_gs1_key(const SGTIN &sgtin);
+std::pair<Status, std::string> get_gs1_key(const SSCC &sscc);
+std::pair<Status, std::string> get_gs1_key(const SGLN &sgln);
+std::pair<Status, std::string> get_gs1_key(const GRAI &grai);
+std::pair<Status, std::string> get_gs1_key(const GIAI &giai);
+std::pair<Status, std::string> get_gs1_key(const EpcView &view);
+std::pair<Status, std::string> get_gs1_key(const Epc96 &epc);
+
+/**
+ * A function returning the GS1 element string of a tag, with application
+ * identifiers in parentheses.
+ *
+ * The element string is "(01)" GTIN "(21)" serial of SGTIN, "(00)" SSCC of
+ * SSCC, "(414)" GLN of SGLN followed by "(254)" extension unless the
+ * extension is "0", "(8003)" GRAI of GRAI and "(8004)" GIAI of GIAI.
+ *
+ * @param tag A tag.
+ * @return A pair of a status and an element string.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the tag is of TagType::kUnknown or its fields
+ * don't make a key.
+ */
+std::pair<Status, std::string> get_element_string(const Tag &tag);
+std::pair<Status, std::string> get_element_string(const SGTIN &sgtin);
+std::pair<Status, std::string> get_element_string(const SSCC &sscc);
+std::pair<Status, std::string> get_element_string(const SGLN &sgln);
+std::pair<Status, std::string> get_element_string(const GRAI &grai);
+std::pair<Status, std::string> get_element_string(const GIAI &giai);
+std::pair<Status, std::string> get_element_string(const EpcView &view);
+std::pair<Status, std::string> get_element_string(const Epc96 &epc);
+
+/**
+ * A function writing GS1 keys of 96-bit EPCs one after another.
+ *
+ * Fields are formatted from the bits straight into the buffer, without
+ * decoding the EPCs into strings.
+ *
+ * @param epcs EPCs.
+ * @param n The number of EPCs.
+ * @param buffer A buffer replaced by the keys.
+ * @param offsets An array of n + 1 offsets, where the key of the EPC i is
+ * from offsets[i] to offsets[i + 1] of the buffer, and empty if the EPC
+ * doesn't make a key.
+ * @return The number of EPCs making keys.
+ */
+size_t get_gs1_keys(const Epc96 *epcs, size_t n, std::string &buffer,
+                    size_t *offsets);
+/**
+ * A function writing GS1 element strings of 96-bit EPCs one after another.
+ *
+ * The same as get_gs1_keys() but of element strings.
+ *
+ * @param epcs EPCs.
+ * @param n The number of EPCs.
+ * @param buffer A buffer replaced by the element strings.
+ * @param offsets An array of n + 1 offsets, where the element string of
+ * the EPC i is from offsets[i] to offsets[i + 1] of the buffer, and empty
+ * if the EPC doesn't make a key.
+ * @return The number of EPCs making element strings.
+ */
+size_t get_element_strings(const Epc96 *epcs, size_t n, std::string &buffer,
+                           size_t *offsets);
+
+/**
+ * A lookup returning the number of digits of the company prefix at the
+ * start of digits of a GS1 key, from 6 to 12, or 0 if it's unknown.
+ *
+ * The digits start at the company prefix, i.e. after the indicator digit of
+ * GTIN, the extension digit of SSCC and the padding zero of GRAI, and run
+ * to the end of the key without the check digit, or of the GIAI.
+ */
+using CompanyPrefixLength =
+    std::function<unsigned int(const char *digits, size_t n)>;
+
+/**
+ * A function parsing a GS1 element string into a tag.
+ *
+ * Both the form with application identifiers in parentheses and the raw
+ * form of barcode data are accepted. In the raw form, a leading symbology
+ * identifier, e.g. "]C1", and FNC1 are skipped, and variable-length fields
+ * are terminated by GS (0x1D) or the end. In the parenthesized form, a
+ * field runs to the next "(".
+ *
+ * The element string must be exactly one of (00), (01) with (21), (414)
+ * optionally with (254), (8003) with a serial, and (8004), and check
+ * digits must be valid. The tag is of the 96-bit scheme if its fields fit
+ * in 96 bits, or otherwise of the longer scheme.
+ *
+ * @param element_string A GS1 element string.
+ * @param company_prefix_length A lookup of lengths of company prefix.
+ * @param filter A filter value of the tag.
+ * @return A pair of a status and a tag.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the element string is malformed, of other
+ * identifiers, has an invalid check digit, or the company prefix is
+ * unknown, or the error factor of the scheme class on error.
+ */
+std::pair<Status, Tag> parse_element_string(
+    const std::string &element_string,
+    const CompanyPrefixLength &company_prefix_length,
+    unsigned int filter = 0);
+/**
+ * A function parsing a GS1 element string into a 96-bit EPC.
+ *
+ * The same as parse_element_string() but packs the fields into bits
+ * without creating scheme classes.
+ *
+ * @param element_string A GS1 element string.
+ * @param company_prefix_length A lookup of lengths of company prefix.
+ * @param filter A filter value of the tag.
+ * @return A pair of a status and an EPC.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if parse_element_string() would fail, the
+ * filter is over 7, or the fields don't fit in 96 bits.
+ */
+std::pair<Status, Epc96> parse_element_string_to_epc96(
+    const std::string &element_string,
+    const CompanyPrefixLength &company_prefix_length,
+    unsigned int filter = 0);
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef LIBEPC_EPC_LAYOUT_H_
+#define LIBEPC_EPC_LAYOUT_H_
+
+#include "epc96.h"
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * Bit offsets of the fields every scheme starts with, counted from the most
+ * significant bit of an EPC binary.
+ */
+constexpr unsigned int LAYOUT_FILTER_OFFSET = 8;
+constexpr unsigned int LAYOUT_PARTITION_OFFSET = 11;
+constexpr unsigned int LAYOUT_COMPANY_PREFIX_OFFSET = 14;
+
+constexpr unsigned int LAYOUT_MAX_PARTITION = 6;
+/** Company prefixes of the partition p are of 12 - p digits. */
+constexpr unsigned int LAYOUT_MIN_COMPANY_PREFIX_DIGITS = 6;
+constexpr unsigned int LAYOUT_MAX_COMPANY_PREFIX_DIGITS = 12;
+/** The number of bits of a character of alphanumeric fields */
+constexpr unsigned int LAYOUT_CHAR_BITS = 7;
+
+/**
+ * The layout of the fields of an EPC binary of a scheme and partition.
+ *
+ * Every scheme lays out header, filter, partition, company prefix,
+ * reference and serial in this order, where the reference is the item
+ * reference and indicator of SGTIN, the serial reference of SSCC, the
+ * location reference of SGLN, the asset type of GRAI and the asset
+ * reference of GIAI, and the serial is the extension of SGLN. SSCC and GIAI
+ * have no serial.
+ */
+using Layout = struct LayoutStruct {
+    uint8_t header_;
+    /** The number of bits of the binary */
+    unsigned int bits_;
+    unsigned int partition_;
+    unsigned int company_prefix_bits_;
+    unsigned int company_prefix_digits_;
+    unsigned int reference_bits_;
+    /** The number of digits, or the maximum number for GIAI */
+    unsigned int reference_digits_;
+    unsigned int serial_bits_;
+
+    unsigned int getReferenceOffset() const {
+        return LAYOUT_COMPANY_PREFIX_OFFSET + company_prefix_bits_;
+    }
+    unsigned int getSerialOffset() const {
+        return getReferenceOffset() + reference_bits_;
+    }
+};
+
+/**
+ * A function returning the layout of a scheme and partition.
+ *
+ * @param header The first 8 bits of an EPC binary.
+ * @param partition A partition value.
+ * @return A pair of a status and a layout.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument for unsupported headers or partitions.
+ */
+std::pair<Status, Layout> get_layout(uint8_t header, unsigned int partition);
+/**
+ * A function returning the layout of a scheme for a company prefix.
+ *
+ * @param header The first 8 bits of an EPC binary.
+ * @param company_prefix A company prefix.
+ * @return A pair of a status and a layout.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument for unsupported headers or lengths of company
+ * prefix.
+ */
+std::pair<Status, Layout> get_layout(uint8_t header,
+                                     const std::string &company_prefix);
+/**
+ * A function returning the layout of a 96-bit EPC binary.
+ *
+ * @param epc An EPC.
+ * @return A pair of a status and a layout.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the header isn't of a 96-bit scheme or the
+ * partition is invalid.
+ */
+std::pair<Status, Layout> get_layout(const Epc96 &epc);
+
+}
+
+#endif
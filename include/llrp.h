@@ -0,0 +1,116 @@
+#ifndef LIBEPC_EPC_LLRP_H_
+#define LIBEPC_EPC_LLRP_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace epc {
+
+/** Message type of RO_ACCESS_REPORT */
+constexpr uint16_t LLRP_RO_ACCESS_REPORT = 61;
+/** Length of the header of LLRP messages in bytes */
+constexpr size_t LLRP_MESSAGE_HEADER_LENGTH = 10;
+
+/**
+ * A header of an LLRP message.
+ */
+using LLRPMessageHeader = struct LLRPMessageHeaderStruct {
+    uint8_t version_;
+    uint16_t type_;
+    /** Length of the message in bytes including the header */
+    uint32_t length_;
+    uint32_t id_;
+};
+
+/**
+ * A TagReportData parameter of an RO_ACCESS_REPORT message.
+ *
+ * The EPC points into the message buffer, so it's valid only as long as
+ * the buffer is.
+ */
+using LLRPTagReport = struct LLRPTagReportStruct {
+    /** EPC binary, most significant byte first, from EPC-96 or EPCData */
+    const uint8_t *epc_;
+    /** Length of the EPC in bits */
+    size_t epc_bits_;
+    bool has_antenna_;
+    uint16_t antenna_;
+    bool has_peak_rssi_;
+    /** Peak RSSI in dBm */
+    int8_t peak_rssi_;
+    bool has_first_seen_utc_;
+    /** FirstSeenTimestampUTC in microseconds since the Unix epoch */
+    uint64_t first_seen_utc_;
+    bool has_first_seen_uptime_;
+    /** FirstSeenTimestampUptime in microseconds since the reader booted */
+    uint64_t first_seen_uptime_;
+};
+
+/**
+ * A function parsing the header of an LLRP message.
+ *
+ * @param data A buffer starting with a message.
+ * @param size The size of the buffer, which may be shorter than the
+ * message.
+ * @return A pair of a status and a header.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the buffer is shorter than the header or the
+ * length is shorter than the header.
+ */
+std::pair<Status, LLRPMessageHeader> parse_llrp_message_header(
+    const uint8_t *data, size_t size);
+
+/**
+ * A function walking the messages in a buffer of LLRP messages, e.g.
+ * received from a reader or read from a recording of it.
+ *
+ * @param data A buffer of messages.
+ * @param size The size of the buffer.
+ * @param callback A callback invoked on every complete message with its
+ * header and the whole message including the header.
+ * @return A pair of a status and the number of bytes of the complete
+ * messages walked. The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument on a malformed header. The bytes after the
+ * complete messages are the beginning of an incomplete message.
+ */
+std::pair<Status, size_t> walk_llrp_messages(
+    const uint8_t *data, size_t size,
+    const std::function<void(const LLRPMessageHeader &header,
+                             const uint8_t *message)> &callback);
+
+/**
+ * A function walking the TagReportData parameters of an RO_ACCESS_REPORT
+ * message without copying them.
+ *
+ * EPCs, AntennaID, PeakRSSI, FirstSeenTimestampUTC and
+ * FirstSeenTimestampUptime are extracted; other parameters are skipped.
+ *
+ * @param message A buffer starting with a message.
+ * @param size The size of the buffer.
+ * @param callback A callback invoked on every TagReportData parameter.
+ * @return Status::kOk on normal completion or Status::kInvalidArgument if
+ * the message isn't an RO_ACCESS_REPORT or is malformed, in which case the
+ * callback may have been invoked on the parameters before the malformed
+ * one.
+ */
+Status walk_llrp_tag_reports(
+    const uint8_t *message, size_t size,
+    const std::function<void(const LLRPTagReport &report)> &callback);
+
+/**
+ * A function decoding the EPC of a TagReportData parameter.
+ *
+ * @param report A TagReportData parameter.
+ * @return A pair of a status and a Tag instance.
+ * The status is Status::kOk on normal completion or the error factor
+ * on error.
+ */
+std::pair<Status, Tag> decode_llrp_tag_report(const LLRPTagReport &report);
+
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef LIBEPC_EPC_MEMBERSHIP_FILTER_H_
+#define LIBEPC_EPC_MEMBERSHIP_FILTER_H_
+
+#include "epc96.h"
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A Bloom filter of 96-bit EPCs.
+ *
+ * The filter is split into blocks of a cache line, and all bits of a key
+ * are set in a single block, so a test costs one cache miss. Blocks get
+ * uneven numbers of keys, which is accounted for when the filter is sized
+ * for a false positive rate.
+ *
+ * A filter can be written to a file and opened by mapping the file, e.g.
+ * to build an expected set centrally and load it at sites. Keys inserted
+ * into an opened filter aren't written back to the file.
+ */
+class BloomFilter {
+public:
+    BloomFilter() = default;
+    BloomFilter(BloomFilter &&other);
+    BloomFilter &operator=(BloomFilter &&other);
+    BloomFilter(const BloomFilter &) = delete;
+    BloomFilter &operator=(const BloomFilter &) = delete;
+    ~BloomFilter();
+
+    /**
+     * A static method creating a filter sized for a number of keys.
+     *
+     * @param expected The expected number of keys.
+     * @param false_positive_rate A false positive rate at the expected
+     * number of keys, between 0 and 1 exclusive.
+     * @return A pair of a status and a BloomFilter instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the false positive rate is out of range.
+     */
+    static std::pair<Status, BloomFilter> create(size_t expected,
+                                                 double false_positive_rate);
+    /**
+     * A static method opening a filter written by write().
+     *
+     * @param path A path of the file.
+     * @return A pair of a status and a BloomFilter instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be read or is malformed.
+     */
+    static std::pair<Status, BloomFilter> open(const std::string &path);
+    /**
+     * A static method returning the number of bytes of a filter created
+     * for a number of keys.
+     *
+     * @param expected The expected number of keys.
+     * @param false_positive_rate A false positive rate.
+     * @return The number of bytes, or 0 if the false positive rate is out
+     * of range.
+     */
+    static size_t estimateBytes(size_t expected, double false_positive_rate);
+
+    /**
+     * A method inserting a key, which does nothing if the filter has no
+     * blocks, i.e. it's default-constructed, moved from or failed to open.
+     * @param epc A key.
+     */
+    void insert(const Epc96 &epc);
+    /**
+     * A method testing whether a key may have been inserted.
+     * @param epc A key.
+     * @return false if the key hasn't been inserted or the filter has no
+     * blocks.
+     */
+    bool mayContain(const Epc96 &epc) const;
+    /**
+     * A method testing keys.
+     *
+     * @param epcs Keys.
+     * @param n The number of keys.
+     * @param mask A bitmask of at least (n + 63) / 64 words, whose bit
+     * i % 64 of word i / 64 is set if the key i may have been inserted.
+     * @return The number of keys that may have been inserted.
+     */
+    size_t mayContain(const Epc96 *epcs, size_t n, uint64_t *mask) const;
+    /**
+     * A method writing the filter.
+     *
+     * @param path A path of the file.
+     * @return Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be written.
+     */
+    Status write(const std::string &path) const;
+
+    /**
+     * A method returning the number of keys inserted, including duplicates.
+     * @return The number of keys.
+     */
+    size_t size() const { return size_; }
+    /**
+     * A method returning the number of bytes of the bits.
+     * @return The number of bytes.
+     */
+    size_t getBytes() const { return block_count_ * BLOCK_BYTES; }
+    unsigned int getHashCount() const { return hash_count_; }
+    /**
+     * A method returning the expected false positive rate at the number of
+     * keys inserted.
+     * @return A false positive rate.
+     */
+    double getFalsePositiveRate() const;
+
+private:
+    static constexpr size_t BLOCK_BYTES = 64;
+    static constexpr size_t BLOCK_WORDS = BLOCK_BYTES / sizeof(uint64_t);
+
+    void close();
+
+    uint64_t *words_ = nullptr;
+    size_t block_count_ = 0;
+    unsigned int hash_count_ = 0;
+    size_t size_ = 0;
+    std::vector<uint64_t> storage_;
+    void *mapping_ = nullptr;
+    size_t mapping_length_ = 0;
+};
+
+/**
+ * A cuckoo filter of 96-bit EPCs, from which keys can be removed.
+ *
+ * Each key is stored as a 16-bit fingerprint in one of two buckets of 4
+ * fingerprints, so a test reads two words. The false positive rate is
+ * about 8 / 2^16 regardless of the number of keys. Inserting the same key
+ * twice stores it twice, and it must be removed twice.
+ *
+ * A filter can be written to a file and opened by mapping the file. Changes
+ * to an opened filter aren't written back to the file.
+ */
+class CuckooFilter {
+public:
+    static constexpr double FALSE_POSITIVE_RATE = 8.0 / 65536;
+
+    CuckooFilter() = default;
+    CuckooFilter(CuckooFilter &&other);
+    CuckooFilter &operator=(CuckooFilter &&other);
+    CuckooFilter(const CuckooFilter &) = delete;
+    CuckooFilter &operator=(const CuckooFilter &) = delete;
+    ~CuckooFilter();
+
+    /**
+     * A static method creating a filter sized for a number of keys.
+     *
+     * @param capacity The number of keys to be held.
+     * @return A filter.
+     */
+    static CuckooFilter create(size_t capacity);
+    /**
+     * A static method opening a filter written by write().
+     *
+     * @param path A path of the file.
+     * @return A pair of a status and a CuckooFilter instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be read or is malformed.
+     */
+    static std::pair<Status, CuckooFilter> open(const std::string &path);
+    /**
+     * A static method returning the number of bytes of a filter created
+     * for a number of keys.
+     *
+     * @param capacity The number of keys to be held.
+     * @return The number of bytes.
+     */
+    static size_t estimateBytes(size_t capacity);
+
+    /**
+     * A method inserting a key.
+     * @param epc A key.
+     * @return false if the filter is full.
+     */
+    bool insert(const Epc96 &epc);
+    /**
+     * A method removing a key inserted before. Removing keys not inserted
+     * may remove other keys.
+     *
+     * @param epc A key.
+     * @return false if the key isn't found.
+     */
+    bool remove(const Epc96 &epc);
+    /**
+     * A method testing whether a key may have been inserted.
+     * @param epc A key.
+     * @return false if the key hasn't been inserted.
+     */
+    bool mayContain(const Epc96 &epc) const;
+    /**
+     * A method testing keys.
+     *
+     * @param epcs Keys.
+     * @param n The number of keys.
+     * @param mask A bitmask of at least (n + 63) / 64 words, whose bit
+     * i % 64 of word i / 64 is set if the key i may have been inserted.
+     * @return The number of keys that may have been inserted.
+     */
+    size_t mayContain(const Epc96 *epcs, size_t n, uint64_t *mask) const;
+    /**
+     * A method writing the filter.
+     *
+     * @param path A path of the file.
+     * @return Status::kOk on normal completion or
+     * Status::kInvalidArgument if the file can't be written.
+     */
+    Status write(const std::string &path) const;
+
+    size_t size() const { return size_; }
+    /**
+     * A method returning the number of fingerprints the filter has room
+     * for. Inserts usually start failing at 95% of it.
+     * @return The number of fingerprints.
+     */
+    size_t capacity() const { return (mask_ + 1) * BUCKET_SIZE; }
+    /**
+     * A method returning the number of bytes of the buckets.
+     * @return The number of bytes.
+     */
+    size_t getBytes() const { return (mask_ + 1) * sizeof(uint64_t); }
+
+private:
+    static constexpr unsigned int BUCKET_SIZE = 4;
+    static constexpr unsigned int MAX_KICKS = 500;
+
+    bool insert(size_t index, uint16_t fingerprint);
+    void close();
+
+    /** Buckets of 4 fingerprints in 16-bit lanes, 0 for empty lanes */
+    uint64_t *buckets_ = nullptr;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    /** A fingerprint failing to be placed, which makes the filter full */
+    uint16_t victim_ = 0;
+    size_t victim_index_ = 0;
+    uint64_t random_ = 0x9E3779B97F4A7C15;
+    std::vector<uint64_t> storage_;
+    void *mapping_ = nullptr;
+    size_t mapping_length_ = 0;
+};
+
+}
+
+#endif
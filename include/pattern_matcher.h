@@ -0,0 +1,89 @@
+#ifndef LIBEPC_EPC_PATTERN_MATCHER_H_
+#define LIBEPC_EPC_PATTERN_MATCHER_H_
+
+#include "epc96.h"
+#include "epc_index.h"
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A function returning the ranges of 96-bit binaries matching an EPC Pure
+ * Identity Pattern URI or an EPC Tag Pattern URI of SGTIN, SSCC, SGLN,
+ * GRAI or GIAI.
+ *
+ * Fields of a pattern are a value, "*" for any, or, in the filter and the
+ * last field of tag patterns, i.e. the serial, the serial reference of SSCC
+ * or the asset reference of GIAI, "[lo-hi]" for an inclusive range, e.g.
+ * "urn:epc:idpat:sgtin:0614141.*.*" or
+ * "urn:epc:pat:sgtin-96:3.0614141.812345.[100-9999]". Fields following a
+ * "*" must be "*". A serial which isn't encoded in 96 bits, e.g. of
+ * letters, matches no binary.
+ *
+ * @param pattern A pattern URI.
+ * @return A pair of a status and ranges in ascending order.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the pattern is malformed or of a scheme
+ * other than 96 bits.
+ */
+std::pair<Status, std::vector<EpcRange>> get_pattern_ranges(
+    const std::string &pattern);
+
+/**
+ * A matcher testing 96-bit binaries against a union of pattern URIs.
+ *
+ * Patterns are compiled into sorted disjoint ranges of binaries, so a test
+ * is a binary search over the ranges and doesn't decode tags.
+ */
+class PatternMatcher {
+public:
+    PatternMatcher() = default;
+
+    /**
+     * A static method creating a matcher of any of patterns.
+     *
+     * @param patterns Pattern URIs.
+     * @return A pair of a status and a PatternMatcher instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * of get_pattern_ranges for the first pattern failing to be parsed.
+     */
+    static std::pair<Status, PatternMatcher> create(
+        const std::vector<std::string> &patterns);
+
+    /**
+     * A method testing whether an EPC matches any of the patterns.
+     * @param epc An EPC.
+     * @return true if the EPC matches.
+     */
+    bool matches(const Epc96 &epc) const;
+    /**
+     * A method testing EPCs.
+     *
+     * @param epcs EPCs.
+     * @param n The number of EPCs.
+     * @param mask A bitmask of at least (n + 63) / 64 words, whose bit
+     * i % 64 of word i / 64 is set if the EPC i matches.
+     * @return The number of EPCs matching.
+     */
+    size_t matches(const Epc96 *epcs, size_t n, uint64_t *mask) const;
+
+    /**
+     * A method returning the ranges the patterns are compiled into.
+     * @return Disjoint ranges in ascending order.
+     */
+    const std::vector<EpcRange> &getRanges() const { return ranges_; }
+
+private:
+    std::vector<EpcRange> ranges_;
+    /** The last EPCs of ranges_, searched for the range of an EPC */
+    std::vector<Epc96> lasts_;
+};
+
+}
+
+#endif
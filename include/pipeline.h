@@ -0,0 +1,490 @@
+#ifndef LIBEPC_EPC_PIPELINE_H_
+#define LIBEPC_EPC_PIPELINE_H_
+
+#if __cplusplus < 202002L
+#error "pipeline.h requires C++20"
+#endif
+
+#include "deduplicator.h"
+#include "epc96.h"
+#include "status.h"
+#include "tag.h"
+#include "tag_writer.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * Batches of values passed between pipeline stages.
+ */
+template <typename T>
+using Batch = std::vector<T>;
+
+/**
+ * A pipeline stage running as a coroutine.
+ *
+ * A task doesn't start until it's spawned on a Scheduler. Exceptions
+ * escaping a task terminate the program.
+ */
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() {
+            return Task(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task() = default;
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+private:
+    friend class Scheduler;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * A single-threaded scheduler of tasks.
+ *
+ * Tasks run on the thread calling run() and switch only when they wait on
+ * a channel or yield, so stages of a pipeline never race with each other.
+ * Run a scheduler per thread to use multiple cores.
+ */
+class Scheduler {
+public:
+    Scheduler() = default;
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+    ~Scheduler() {
+        for (auto handle : tasks_) handle.destroy();
+    }
+
+    /**
+     * A method spawning a task. The task starts on the next run().
+     * @param task A task.
+     */
+    void spawn(Task task) {
+        auto handle = std::exchange(task.handle_, {});
+        if (!handle) return;
+        tasks_.push_back(handle);
+        schedule(handle);
+    }
+    /**
+     * A method running tasks until none of them can make progress.
+     * @return true if all tasks have completed, or false if some of them
+     * are still waiting, e.g. on a channel nobody closes.
+     */
+    bool run() {
+        while (!ready_.empty()) {
+            auto handle = ready_.front();
+            ready_.pop_front();
+            handle.resume();
+        }
+        size_t n = 0;
+        for (auto handle : tasks_) {
+            if (handle.done()) {
+                handle.destroy();
+            } else {
+                tasks_[n++] = handle;
+            }
+        }
+        tasks_.resize(n);
+        return tasks_.empty();
+    }
+    /**
+     * A method making a suspended coroutine ready to run.
+     * @param handle A coroutine handle.
+     */
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    /**
+     * A method returning an awaitable letting other ready tasks run
+     * before the current task continues.
+     */
+    auto yield() {
+        struct Awaiter {
+            Scheduler &scheduler_;
+            bool await_ready() const noexcept {
+                return scheduler_.ready_.empty();
+            }
+            void await_suspend(std::coroutine_handle<> handle) {
+                scheduler_.schedule(handle);
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    std::deque<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> tasks_;
+};
+
+/**
+ * A bounded channel between tasks of a scheduler.
+ *
+ * A sender waits while the channel holds capacity values, which applies
+ * backpressure to upstream stages. A channel of capacity 0 hands values
+ * over directly from a sender to a receiver.
+ */
+template <typename T>
+class Channel {
+public:
+    /**
+     * @param scheduler A scheduler running the tasks using the channel.
+     * @param capacity The number of values buffered in the channel.
+     */
+    Channel(Scheduler &scheduler, size_t capacity)
+        : scheduler_(scheduler), capacity_(capacity) {}
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    class SendAwaiter {
+    public:
+        SendAwaiter(Channel &channel, T &&value)
+            : channel_(channel), value_(std::move(value)) {}
+        bool await_ready() {
+            Channel &c = channel_;
+            if (c.closed_) {
+                ok_ = false;
+                return true;
+            }
+            if (!c.receivers_.empty()) {
+                ReceiveAwaiter *receiver = c.receivers_.front();
+                c.receivers_.pop_front();
+                receiver->value_ = std::move(value_);
+                c.scheduler_.schedule(receiver->handle_);
+                return true;
+            }
+            if (c.buffer_.size() < c.capacity_) {
+                c.buffer_.push_back(std::move(value_));
+                return true;
+            }
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            channel_.senders_.push_back(this);
+        }
+        bool await_resume() const noexcept { return ok_; }
+
+    private:
+        friend class Channel;
+
+        Channel &channel_;
+        T value_;
+        bool ok_ = true;
+        std::coroutine_handle<> handle_;
+    };
+
+    class ReceiveAwaiter {
+    public:
+        explicit ReceiveAwaiter(Channel &channel) : channel_(channel) {}
+        bool await_ready() {
+            Channel &c = channel_;
+            if (!c.buffer_.empty()) {
+                value_ = std::move(c.buffer_.front());
+                c.buffer_.pop_front();
+                if (!c.senders_.empty()) {
+                    SendAwaiter *sender = c.senders_.front();
+                    c.senders_.pop_front();
+                    c.buffer_.push_back(std::move(sender->value_));
+                    c.scheduler_.schedule(sender->handle_);
+                }
+                return true;
+            }
+            if (!c.senders_.empty()) {
+                SendAwaiter *sender = c.senders_.front();
+                c.senders_.pop_front();
+                value_ = std::move(sender->value_);
+                c.scheduler_.schedule(sender->handle_);
+                return true;
+            }
+            return c.closed_;
+        }
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            channel_.receivers_.push_back(this);
+        }
+        std::optional<T> await_resume() { return std::move(value_); }
+
+    private:
+        friend class Channel;
+
+        Channel &channel_;
+        std::optional<T> value_;
+        std::coroutine_handle<> handle_;
+    };
+
+    /**
+     * A method returning an awaitable sending a value. co_await on it
+     * returns true on normal completion or false if the channel is closed,
+     * in which case the value is discarded.
+     * @param value A value.
+     */
+    SendAwaiter send(T value) { return SendAwaiter(*this, std::move(value)); }
+    /**
+     * A method returning an awaitable receiving a value. co_await on it
+     * returns the value, or std::nullopt once the channel is closed and
+     * drained.
+     */
+    ReceiveAwaiter receive() { return ReceiveAwaiter(*this); }
+    /**
+     * A method closing the channel. Values already buffered can still be
+     * received.
+     */
+    void close() {
+        closed_ = true;
+        while (!receivers_.empty()) {
+            scheduler_.schedule(receivers_.front()->handle_);
+            receivers_.pop_front();
+        }
+        while (!senders_.empty()) {
+            senders_.front()->ok_ = false;
+            scheduler_.schedule(senders_.front()->handle_);
+            senders_.pop_front();
+        }
+    }
+
+    bool isClosed() const { return closed_; }
+    Scheduler &getScheduler() const { return scheduler_; }
+
+private:
+    Scheduler &scheduler_;
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> buffer_;
+    std::deque<SendAwaiter *> senders_;
+    std::deque<ReceiveAwaiter *> receivers_;
+};
+
+/*
+ * Stages of a pipeline. Each stage receives batches from its input
+ * channel, if any, and closes its output channel, if any, when the input
+ * is closed and drained. Channels passed to stages must outlive them.
+ */
+
+/**
+ * A stage reading values from a source and sending them in batches.
+ *
+ * The stage yields after each batch so that downstream stages process it
+ * before the next one is read.
+ *
+ * @param next A function storing the next value in its argument and
+ * returning true, or returning false at the end of the input.
+ * @param out An output channel.
+ * @param batch_size The maximum number of values in a batch.
+ */
+template <typename T, typename Source>
+Task source_stage(Source next, Channel<Batch<T>> &out, size_t batch_size) {
+    Batch<T> batch;
+    batch.reserve(batch_size);
+    T value;
+    while (next(value)) {
+        batch.push_back(std::move(value));
+        if (batch.size() < batch_size) continue;
+        if (!co_await out.send(std::move(batch))) co_return;
+        batch = Batch<T>();
+        batch.reserve(batch_size);
+        co_await out.getScheduler().yield();
+    }
+    if (!batch.empty()) co_await out.send(std::move(batch));
+    out.close();
+}
+
+/**
+ * A stage transforming batches.
+ *
+ * @param in An input channel.
+ * @param out An output channel.
+ * @param fn A function taking Batch<In> & and returning Batch<Out>. Empty
+ * batches returned aren't sent.
+ */
+template <typename In, typename Out, typename Fn>
+Task map_stage(Channel<Batch<In>> &in, Channel<Batch<Out>> &out, Fn fn) {
+    while (auto batch = co_await in.receive()) {
+        Batch<Out> result = fn(*batch);
+        if (result.empty()) continue;
+        if (!co_await out.send(std::move(result))) break;
+    }
+    out.close();
+}
+
+/**
+ * A stage decoding EPC binaries in hex string format.
+ *
+ * @param in An input channel of EPC binaries.
+ * @param out An output channel of tags.
+ * @param errors A counter incremented for each binary failing to be
+ * decoded, or nullptr.
+ */
+inline Task decode_stage(Channel<Batch<std::string>> &in,
+                         Channel<Batch<Tag>> &out, size_t *errors = nullptr) {
+    return map_stage(in, out, [errors](Batch<std::string> &hexes) {
+        Batch<Tag> tags;
+        tags.reserve(hexes.size());
+        for (const auto &hex : hexes) {
+            auto result = Tag::createFromBinary(hex);
+            if (result.first == Status::kOk) {
+                tags.push_back(std::move(result.second));
+            } else if (errors) {
+                (*errors)++;
+            }
+        }
+        return tags;
+    });
+}
+
+/**
+ * A stage rendering EPC URIs of tags.
+ *
+ * @param in An input channel of tags.
+ * @param out An output channel of EPC URIs.
+ */
+inline Task uri_stage(Channel<Batch<Tag>> &in,
+                      Channel<Batch<std::string>> &out) {
+    return map_stage(in, out, [](Batch<Tag> &tags) {
+        Batch<std::string> uris;
+        uris.reserve(tags.size());
+        for (const auto &tag : tags) uris.push_back(tag.getURI());
+        return uris;
+    });
+}
+
+/**
+ * The default number of reads a dedupe stage drops repeats of an EPC over.
+ */
+constexpr uint64_t DEFAULT_DEDUPE_WINDOW = 1 << 16;
+
+/**
+ * A stage dropping values whose EPCs have been passed within a window of
+ * the preceding reads.
+ *
+ * Reads are deduplicated by a Deduplicator counting time in reads, so an
+ * EPC is passed at most once per window reads and the stage holds about a
+ * window of EPCs however long the stream runs. Values without a 96-bit EPC,
+ * e.g. of 198-bit schemes, are passed through.
+ *
+ * @param in An input channel.
+ * @param out An output channel.
+ * @param window The number of reads, which must be positive.
+ * @param key A function returning a pair of a status and an Epc96 of a
+ * value.
+ */
+template <typename T, typename KeyFn>
+Task dedupe_stage(Channel<Batch<T>> &in, Channel<Batch<T>> &out,
+                  uint64_t window, KeyFn key) {
+    Deduplicator deduplicator(window);
+    uint64_t reads = 0;
+    while (auto batch = co_await in.receive()) {
+        size_t n = 0;
+        for (size_t i = 0; i < batch->size(); i++) {
+            std::pair<Status, Epc96> epc = key((*batch)[i]);
+            if (epc.first == Status::kOk
+                && !deduplicator.offer(epc.second, 0, reads++)) {
+                continue;
+            }
+            if (n != i) (*batch)[n] = std::move((*batch)[i]);
+            n++;
+        }
+        batch->resize(n);
+        if (n == 0) continue;
+        if (!co_await out.send(std::move(*batch))) break;
+    }
+    out.close();
+}
+
+/**
+ * A stage dropping EPC binaries in hex string format whose EPCs have been
+ * passed within a window of reads. Deduplicating binaries before
+ * decode_stage() spares decoding repeats.
+ *
+ * @param in An input channel of EPC binaries.
+ * @param out An output channel of EPC binaries.
+ * @param window The number of reads, which must be positive.
+ */
+inline Task dedupe_stage(Channel<Batch<std::string>> &in,
+                         Channel<Batch<std::string>> &out,
+                         uint64_t window = DEFAULT_DEDUPE_WINDOW) {
+    return dedupe_stage(in, out, window, [](const std::string &hex) {
+        return Epc96::createFromBinary(hex);
+    });
+}
+
+/**
+ * A stage dropping tags whose EPCs have been passed within a window of
+ * reads.
+ *
+ * @param in An input channel of tags.
+ * @param out An output channel of tags.
+ * @param window The number of reads, which must be positive.
+ */
+inline Task dedupe_stage(Channel<Batch<Tag>> &in, Channel<Batch<Tag>> &out,
+                         uint64_t window = DEFAULT_DEDUPE_WINDOW) {
+    return dedupe_stage(in, out, window,
+                        [](const Tag &tag) { return tag.getEpc96(); });
+}
+
+/**
+ * A stage passing batches to a function.
+ *
+ * @param in An input channel.
+ * @param sink A function taking Batch<T> &.
+ */
+template <typename T, typename Sink>
+Task sink_stage(Channel<Batch<T>> &in, Sink sink) {
+    while (auto batch = co_await in.receive()) sink(*batch);
+}
+
+/**
+ * A stage serializing tags with a TagWriter, flushing it at the end of the
+ * input.
+ *
+ * @param in An input channel of tags.
+ * @param writer A writer, which must outlive the stage.
+ * @param status Set to the first error of the writer, or nullptr.
+ */
+inline Task writer_stage(Channel<Batch<Tag>> &in, TagWriter &writer,
+                         Status *status = nullptr) {
+    Status result = Status::kOk;
+    while (auto batch = co_await in.receive()) {
+        Status s = writer.write(*batch);
+        if (result == Status::kOk) result = s;
+    }
+    Status s = writer.flush();
+    if (result == Status::kOk) result = s;
+    if (status) *status = result;
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef LIBEPC_EPC_READER_LOG_H_
+#define LIBEPC_EPC_READER_LOG_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A record of a reader log.
+ */
+using ReaderLogRecord = struct ReaderLogRecordStruct {
+    /** 1-based line number of the record. */
+    size_t line_;
+    /** Status::kOk if the record has been decoded successfully. */
+    Status status_;
+    Tag tag_;
+    bool has_timestamp_;
+    uint64_t timestamp_;
+    bool has_antenna_;
+    unsigned int antenna_;
+};
+
+/**
+ * A streaming decoder of reader logs.
+ *
+ * A reader log is newline-delimited text whose lines are an EPC binary in
+ * hex string format optionally followed by a timestamp and an antenna
+ * number, separated by commas, tabs or spaces:
+ *
+ * ```
+ * 3074257BF7194E4000001A85,1633046400000,2
+ * ```
+ *
+ * The input is read in chunks of a fixed size, so the memory used doesn't
+ * depend on the size of the input. Lines longer than a chunk are reported
+ * as Status::kInvalidArgument and skipped. Empty lines are skipped.
+ */
+class ReaderLogDecoder {
+public:
+    using Callback = std::function<void(const ReaderLogRecord &record)>;
+    using BatchCallback = std::function<
+        void(const std::vector<ReaderLogRecord> &records)>;
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    /**
+     * @param chunk_size The size of the read buffer in bytes.
+     */
+    explicit ReaderLogDecoder(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    /**
+     * A method decoding all records read from a file descriptor.
+     *
+     * @param fd A file descriptor to read from.
+     * @param callback A callback invoked on every record, including records
+     * which failed to be decoded.
+     * @return Status::kOk on normal completion or Status::kInvalidArgument
+     * on a read error.
+     */
+    Status decode(int fd, const Callback &callback);
+    /**
+     * A method decoding all records read from a stream.
+     *
+     * @param is A stream to read from.
+     * @param callback A callback invoked on every record, including records
+     * which failed to be decoded.
+     * @return Status::kOk on normal completion or Status::kInvalidArgument
+     * on a read error.
+     */
+    Status decode(std::istream &is, const Callback &callback);
+    /**
+     * A method decoding all records read from a file descriptor and passing
+     * them to a callback in batches.
+     *
+     * @param fd A file descriptor to read from.
+     * @param batch_size The maximum number of records in a batch.
+     * @param callback A callback invoked on every batch. The batch is only
+     * valid until the callback returns.
+     * @return Status::kOk on normal completion or Status::kInvalidArgument
+     * on a read error or a zero batch size.
+     */
+    Status decodeBatches(int fd, size_t batch_size,
+                         const BatchCallback &callback);
+    /**
+     * A method decoding all records read from a stream and passing them to
+     * a callback in batches.
+     *
+     * @param is A stream to read from.
+     * @param batch_size The maximum number of records in a batch.
+     * @param callback A callback invoked on every batch. The batch is only
+     * valid until the callback returns.
+     * @return Status::kOk on normal completion or Status::kInvalidArgument
+     * on a read error or a zero batch size.
+     */
+    Status decodeBatches(std::istream &is, size_t batch_size,
+                         const BatchCallback &callback);
+
+private:
+    using ReadFunction = std::function<long(char *buf, size_t n)>;
+
+    Status run(const ReadFunction &read, const Callback &callback);
+    Status runBatches(const ReadFunction &read, size_t batch_size,
+                      const BatchCallback &callback);
+    bool decodeLine(const char *begin, const char *end,
+                    ReaderLogRecord &record);
+
+    std::vector<char> buffer_;
+    std::string hex_;
+};
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef LIBEPC_EPC_RULE_MATCHER_H_
+#define LIBEPC_EPC_RULE_MATCHER_H_
+
+#include "epc96.h"
+#include "epc_index.h"
+#include "status.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A matcher testing 96-bit EPCs against up to 64 rules at once.
+ *
+ * A rule matches an EPC if any of its terms does, and a term matches if
+ * the bits of the EPC under its mask equal its value. Rules are usually
+ * added as queries, whose terms are derived from the layout of the scheme.
+ *
+ * Batches are matched with AVX-512 or AVX2 where the CPU supports them,
+ * comparing 4 or 2 EPCs with a term, or an EPC with 4 or 2 terms, per
+ * instruction. Vectors match batches term by term over blocks of EPCs
+ * unless there are hundreds of terms, and scalar code matches them EPC by
+ * EPC.
+ */
+class RuleMatcher {
+public:
+    static constexpr size_t MAX_RULES = 64;
+
+    /**
+     * Sets of instructions matching batches.
+     */
+    enum class InstructionSet {
+        kScalar,
+        kAVX2,
+        kAVX512,
+    };
+
+    /**
+     * Orders of the loops over terms and EPCs of a batch.
+     */
+    enum class LoopOrder {
+        kAuto,
+        /** Each term is compared with a block of EPCs in turn. */
+        kRuleMajor,
+        /** Each EPC is compared with all terms in turn. */
+        kTagMajor,
+    };
+
+    RuleMatcher();
+
+    /**
+     * A static method returning the best set of instructions supported by
+     * the CPU.
+     * @return A set of instructions.
+     */
+    static InstructionSet getSupportedInstructionSet();
+
+    /**
+     * A method adding a rule of a term.
+     *
+     * @param mask The bits compared.
+     * @param value The bits of matching EPCs.
+     * @return A pair of a status and the index of the rule, which is the
+     * bit of the rule in the results of match().
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if there're already MAX_RULES rules.
+     */
+    std::pair<Status, size_t> addRule(const Epc96 &mask, const Epc96 &value);
+    /**
+     * A method adding a rule of the EPCs matching a query.
+     *
+     * @param query A query, the same as that of EpcIndex.
+     * @return A pair of a status and the index of the rule, which is the
+     * bit of the rule in the results of match().
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if there're already MAX_RULES rules or the
+     * query doesn't fit the layout of the scheme.
+     */
+    std::pair<Status, size_t> addRule(const EpcIndexQuery &query);
+    /**
+     * A method setting the set of instructions used to match batches.
+     *
+     * @param instruction_set A set of instructions.
+     * @return false if the CPU doesn't support the instructions, in which
+     * case the set isn't changed.
+     */
+    bool setInstructionSet(InstructionSet instruction_set);
+    InstructionSet getInstructionSet() const { return instruction_set_; }
+
+    /**
+     * A method matching an EPC.
+     * @param epc An EPC.
+     * @return A bitmap whose bit i is set if the rule i matches.
+     */
+    uint64_t match(const Epc96 &epc) const;
+    /**
+     * A method matching EPCs.
+     *
+     * @param epcs EPCs.
+     * @param n The number of EPCs.
+     * @param rules An array of n bitmaps, whose bit j of bitmap i is set if
+     * the rule j matches the EPC i.
+     * @param order The order of the loops over terms and EPCs.
+     * @return The number of EPCs matched by any rule.
+     */
+    size_t match(const Epc96 *epcs, size_t n, uint64_t *rules,
+                 LoopOrder order = LoopOrder::kAuto) const;
+
+    size_t getRuleCount() const { return rule_count_; }
+    /**
+     * A method returning the number of terms of all rules.
+     * @return The number of terms.
+     */
+    size_t getTermCount() const { return term_count_; }
+
+private:
+    void addTerm(const Epc96 &mask, const Epc96 &value, size_t rule);
+
+    size_t rule_count_ = 0;
+    size_t term_count_ = 0;
+    /**
+     * Masks and masked values of terms as pairs of the lower and the upper
+     * 64 bits, padded with terms matching nothing to a multiple of 32.
+     */
+    std::vector<uint64_t> masks_;
+    std::vector<uint64_t> values_;
+    /** The bit of the rule of each term */
+    std::vector<uint64_t> rule_bits_;
+    /** true if the term i is the only term of the rule i */
+    bool one_term_per_rule_ = true;
+    InstructionSet instruction_set_;
+};
+
+}
+
+#endif
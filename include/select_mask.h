@@ -0,0 +1,114 @@
+#ifndef LIBEPC_EPC_SELECT_MASK_H_
+#define LIBEPC_EPC_SELECT_MASK_H_
+
+#include "epc96.h"
+#include "epc_index.h"
+#include "status.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * The bit address of the EPC in the EPC bank, following the StoredCRC and
+ * StoredPC words.
+ */
+constexpr uint32_t SELECT_EPC_POINTER = 0x20;
+
+/**
+ * Values of the Action field of the Gen2 Select command, named after their
+ * effect on the SL flag of matching and non-matching tags.
+ */
+constexpr uint8_t SELECT_ACTION_ASSERT_DEASSERT = 0;
+constexpr uint8_t SELECT_ACTION_ASSERT_NOTHING = 1;
+constexpr uint8_t SELECT_ACTION_NOTHING_DEASSERT = 2;
+constexpr uint8_t SELECT_ACTION_NEGATE_NOTHING = 3;
+constexpr uint8_t SELECT_ACTION_DEASSERT_ASSERT = 4;
+constexpr uint8_t SELECT_ACTION_DEASSERT_NOTHING = 5;
+constexpr uint8_t SELECT_ACTION_NOTHING_ASSERT = 6;
+constexpr uint8_t SELECT_ACTION_NOTHING_NEGATE = 7;
+
+/**
+ * A Gen2 Select command over the EPC bank with the SL flag as its target.
+ */
+using SelectMask = struct SelectMaskStruct {
+    uint8_t action_;
+    /** The bit address of the mask in the EPC bank */
+    uint32_t pointer_;
+    /** The number of bits of the mask */
+    uint32_t length_;
+    /** The bits of the mask, most significant first, padded with zeros */
+    std::vector<uint8_t> mask_;
+};
+
+/**
+ * A function compiling a query into Select commands asserting the SL flag
+ * of exactly the tags matching the query.
+ *
+ * The commands are to be sent in order. The serial range of the query is
+ * split into the fewest aligned blocks, each of which is the mask of a
+ * common prefix. The first command asserts the flag of tags in its block
+ * and deasserts the others, and the rest assert the flag of tags in their
+ * blocks. A query of any filter value skips the filter in the masks and
+ * checks the header with a last command deasserting the others, rather than
+ * repeating the masks for each filter value.
+ *
+ * @param query A query, the same as that of EpcIndex.
+ * @return A pair of a status and commands.
+ * The status is Status::kOk on normal completion or
+ * Status::kInvalidArgument if the query doesn't fit the layout of the
+ * scheme or matches no EPC.
+ */
+std::pair<Status, std::vector<SelectMask>> compile_select_masks(
+    const EpcIndexQuery &query);
+
+/**
+ * A matcher applying Select commands to 96-bit EPCs in software, e.g. to
+ * verify commands before pushing them to readers.
+ *
+ * The SL flag is deasserted before the first command. Masks outside the
+ * EPC, e.g. over the StoredPC word, don't match since the PC of a packed
+ * EPC isn't known.
+ */
+class SelectMatcher {
+public:
+    /**
+     * @param masks Select commands in the order they're sent.
+     */
+    explicit SelectMatcher(const std::vector<SelectMask> &masks);
+
+    /**
+     * A method testing whether a tag would be selected.
+     * @param epc An EPC.
+     * @return true if the SL flag of the tag is asserted.
+     */
+    bool matches(const Epc96 &epc) const;
+    /**
+     * A method testing tags.
+     *
+     * @param epcs EPCs.
+     * @param n The number of EPCs.
+     * @param mask A bitmask of at least (n + 63) / 64 words, whose bit
+     * i % 64 of word i / 64 is set if the tag i would be selected.
+     * @return The number of tags selected.
+     */
+    size_t matches(const Epc96 *epcs, size_t n, uint64_t *mask) const;
+
+private:
+    using Command = struct CommandStruct {
+        uint8_t action_;
+        /** false if the mask is outside the EPC */
+        bool valid_;
+        Epc96 value_;
+        /** The bits compared with value_ */
+        Epc96 care_;
+    };
+
+    std::vector<Command> commands_;
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define LIBEPC_EPC_SGLN_H_
 
 #include "epc.h"
+#include "layout.h"
 
 #include <utility>
 
@@ -68,17 +69,17 @@ public:
      * A method returning company prefix of the SGLN.
      * @return A company prefix in string.
      */
-    std::string getCompanyPrefix() const { return company_prefix_; }
+    const std::string &getCompanyPrefix() const { return company_prefix_; }
     /**
      * A method returning asset reference of the SGLN.
      * @return A location reference in string.
      */
-    std::string getLocationReference() const { return location_ref_; }
+    const std::string &getLocationReference() const { return location_ref_; }
     /**
      * A method returning extension of the SGLN.
      * @return An extension in string.
      */
-    std::string getExtension() const { return extension_; }
+    const std::string &getExtension() const { return extension_; }
 
     /**
      * A method setting SGLN encoding scheme.
@@ -93,6 +94,9 @@ public:
     Scheme getSGLNScheme() const { return scheme_; }
 
 private:
+    friend std::pair<Status, Layout> get_layout(uint8_t header,
+                                                unsigned int partition);
+
     using PartitionTable = struct PartitionTableStruct {
         unsigned int partition_;
         unsigned int company_prefix_bits_;
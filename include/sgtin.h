@@ -2,6 +2,7 @@
 #define LIBEPC_EPC_SGTIN_H_
 
 #include "epc.h"
+#include "layout.h"
 #include "status.h"
 
 #include <regex>
@@ -68,17 +69,19 @@ public:
      * A method returning company prefix of the SGTIN.
      * @return A company prefix in string.
      */
-    std::string getCompanyPrefix() const { return company_prefix_; }
+    const std::string &getCompanyPrefix() const { return company_prefix_; }
     /**
      * A method returning item reference and indicator of the SGTIN.
      * @return Item reference and indicator in string.
      */
-    std::string getItemReferenceAndIndicator() const { return itemref_indicator_; }
+    const std::string &getItemReferenceAndIndicator() const {
+        return itemref_indicator_;
+    }
     /**
      * A method returning serial string of the SGTIN.
      * @return A serial string.
      */
-    std::string getSerial() const { return serial_; }
+    const std::string &getSerial() const { return serial_; }
 
     /**
      * A method setting SGTIN encoding scheme.
@@ -93,6 +96,9 @@ public:
     Scheme getSGTINScheme() const { return scheme_; }
 
 private:
+    friend std::pair<Status, Layout> get_layout(uint8_t header,
+                                                unsigned int partition);
+
     using PartitionTable = struct PartitionTableStruct {
         unsigned int partition_;
         unsigned int company_prefix_bits_;
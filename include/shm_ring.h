@@ -0,0 +1,192 @@
+#ifndef LIBEPC_EPC_SHM_RING_H_
+#define LIBEPC_EPC_SHM_RING_H_
+
+#include "status.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * A slot of ShmRing holding a single read.
+ */
+using ShmRingRecord = struct ShmRingRecordStruct {
+    /** Timestamp of the read in any unit agreed by the processes */
+    uint64_t timestamp_;
+    /** Antenna ID */
+    uint16_t antenna_;
+    /** The number of bytes of EPC binary in epc_ */
+    uint8_t size_;
+    uint8_t reserved_[5];
+    /** EPC binary, most significant byte first */
+    uint8_t epc_[32];
+};
+
+/**
+ * A single-producer/single-consumer ring of reads in shared memory.
+ *
+ * The ring lives in a memfd or a POSIX shared memory object, so that a
+ * process receiving reads from readers can hand them off to a decoding
+ * process without a syscall per read. Records are passed through
+ * fixed-size slots, and the positions of the producer and the consumer are
+ * published with atomic stores on separate cache lines.
+ *
+ * One process calls only the producer methods and the other only the
+ * consumer methods. The ring doesn't block; callers poll it when it's
+ * full or empty.
+ */
+class ShmRing {
+public:
+    static constexpr size_t MAX_EPC_BYTES = sizeof(ShmRingRecord::epc_);
+
+    /**
+     * A function receiving records consumed from the ring. The records
+     * point into the shared memory and are valid only during the call.
+     */
+    using Consumer = std::function<void(const ShmRingRecord *records,
+                                        size_t n)>;
+
+    ShmRing() = default;
+    ShmRing(ShmRing &&other);
+    ShmRing &operator=(ShmRing &&other);
+    ShmRing(const ShmRing &) = delete;
+    ShmRing &operator=(const ShmRing &) = delete;
+    ~ShmRing();
+
+    /**
+     * A static method creating a ring in an anonymous memfd. The file
+     * descriptor returned by getFd() can be inherited by a child process
+     * or sent over a Unix domain socket, and opened with open(int).
+     * It's close-on-exec.
+     *
+     * @param capacity The number of slots, rounded up to a power of 2.
+     * @return A pair of a status and a ShmRing instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the ring can't be created.
+     */
+    static std::pair<Status, ShmRing> create(size_t capacity);
+    /**
+     * A static method creating a ring in a new POSIX shared memory object.
+     *
+     * @param name A name of the shared memory object, e.g. "/epc-ring".
+     * @param capacity The number of slots, rounded up to a power of 2.
+     * @return A pair of a status and a ShmRing instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the ring can't be created, e.g. the
+     * object already exists.
+     */
+    static std::pair<Status, ShmRing> create(const std::string &name,
+                                             size_t capacity);
+    /**
+     * A static method opening a ring created by another ShmRing instance.
+     *
+     * @param fd A file descriptor of the memfd or the shared memory object.
+     * It's duplicated, so the caller keeps its ownership.
+     * @return A pair of a status and a ShmRing instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the ring can't be mapped or is malformed.
+     */
+    static std::pair<Status, ShmRing> open(int fd);
+    /**
+     * A static method opening a ring in a POSIX shared memory object.
+     *
+     * @param name A name of the shared memory object.
+     * @return A pair of a status and a ShmRing instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the ring can't be opened or is malformed.
+     */
+    static std::pair<Status, ShmRing> open(const std::string &name);
+    /**
+     * A static method removing the name of a POSIX shared memory object.
+     * Rings already opened stay valid.
+     *
+     * @param name A name of the shared memory object.
+     * @return Status::kOk on normal completion or Status::kInvalidArgument
+     * if the name can't be removed.
+     */
+    static Status unlink(const std::string &name);
+
+    /**
+     * A method returning the file descriptor of the shared memory.
+     * @return A file descriptor, or -1 if the ring isn't opened.
+     */
+    int getFd() const { return fd_; }
+    /**
+     * A method returning the number of slots.
+     * @return The capacity.
+     */
+    size_t capacity() const { return mask_ + 1; }
+    /**
+     * A method returning the number of records in the ring, which may be
+     * stale by the time it returns.
+     * @return The number of records.
+     */
+    size_t size() const;
+
+    /**
+     * A method pushing a record. Producer only.
+     *
+     * @param epc EPC binary, most significant byte first.
+     * @param size The number of bytes of the EPC binary.
+     * @param timestamp Timestamp of the read.
+     * @param antenna Antenna ID.
+     * @return true on normal completion, or false if the ring is full or
+     * size exceeds MAX_EPC_BYTES.
+     */
+    bool push(const uint8_t *epc, size_t size, uint64_t timestamp,
+              uint16_t antenna);
+    /**
+     * A method pushing records as many as the ring can hold. Producer only.
+     *
+     * @param records Records.
+     * @param n The number of records.
+     * @return The number of records pushed.
+     */
+    size_t push(const ShmRingRecord *records, size_t n);
+
+    /**
+     * A method popping records into a buffer. Consumer only.
+     *
+     * @param records A buffer of records.
+     * @param n The maximum number of records.
+     * @return The number of records popped.
+     */
+    size_t pop(ShmRingRecord *records, size_t n);
+    /**
+     * A method consuming records in place. Consumer only.
+     *
+     * The consumer is called with contiguous runs of records, at most twice
+     * when the records wrap around the end of the ring. Their slots are
+     * released to the producer after the calls.
+     *
+     * @param max The maximum number of records.
+     * @param consumer A function receiving the records.
+     * @return The number of records consumed.
+     */
+    size_t consume(size_t max, const Consumer &consumer);
+
+private:
+    struct Header;
+
+    static std::pair<Status, ShmRing> initialize(int fd, size_t capacity);
+    static std::pair<Status, ShmRing> map(int fd);
+    void close();
+
+    int fd_ = -1;
+    void *data_ = nullptr;
+    size_t length_ = 0;
+    Header *header_ = nullptr;
+    ShmRingRecord *records_ = nullptr;
+    uint64_t mask_ = static_cast<uint64_t>(-1);
+    // Positions last read from the other side, so that the shared cache
+    // line of the other side is read only when the ring looks full or empty.
+    uint64_t cached_head_ = 0;
+    uint64_t cached_tail_ = 0;
+};
+
+}
+
+#endif
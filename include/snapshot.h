@@ -0,0 +1,111 @@
+#ifndef LIBEPC_EPC_SNAPSHOT_H_
+#define LIBEPC_EPC_SNAPSHOT_H_
+
+#include "epc96.h"
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A compressed snapshot of a set of 96-bit EPCs.
+ *
+ * EPCs are sorted and split into blocks. A block stores its first EPC as
+ * is and every following EPC as the difference from the previous one.
+ * EPCs read at a site share long prefixes, so the differences are
+ * usually a few bits wide. The differences are bit-packed with a width
+ * chosen per block, and the few wider ones, e.g. between two items, are
+ * stored in full as exceptions. A block index of the first EPCs provides
+ * random access and membership tests without decoding the whole snapshot.
+ */
+class Snapshot {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 128;
+
+    Snapshot() = default;
+
+    /**
+     * A static method creating a snapshot of EPCs. Duplicated EPCs are
+     * stored once.
+     *
+     * @param epcs EPCs in any order.
+     * @param block_size The number of EPCs in a block.
+     * @return A snapshot.
+     */
+    static Snapshot create(std::vector<Epc96> epcs,
+                           size_t block_size = DEFAULT_BLOCK_SIZE);
+    /**
+     * A static method creating a snapshot from its serialized form.
+     *
+     * @param bytes A serialized snapshot returned by getBytes().
+     * @return A pair of a status and a Snapshot instance.
+     * The status is Status::kOk on normal completion or
+     * Status::kInvalidArgument if the bytes are malformed.
+     */
+    static std::pair<Status, Snapshot> createFromBytes(std::string bytes);
+
+    /**
+     * A method returning the serialized form of the snapshot.
+     * @return Serialized snapshot.
+     */
+    const std::string &getBytes() const { return bytes_; }
+    /**
+     * A method returning the number of EPCs in the snapshot.
+     * @return The number of EPCs.
+     */
+    size_t size() const { return size_; }
+    /**
+     * A method returning the number of blocks in the snapshot.
+     * @return The number of blocks.
+     */
+    size_t getBlockCount() const { return index_.size(); }
+
+    /**
+     * A method returning the i-th smallest EPC.
+     * @param i An index less than size().
+     * @return An EPC.
+     */
+    Epc96 get(size_t i) const;
+    /**
+     * A method testing whether the snapshot contains an EPC.
+     * @param epc An EPC.
+     * @return true if the snapshot contains the EPC.
+     */
+    bool contains(const Epc96 &epc) const;
+    /**
+     * A method decoding a block.
+     * @param block A block number less than getBlockCount().
+     * @param out A buffer of at least the block size.
+     * @return The number of EPCs written.
+     */
+    size_t decodeBlock(size_t block, Epc96 *out) const;
+    /**
+     * A method decoding all EPCs in ascending order.
+     * @return EPCs.
+     */
+    std::vector<Epc96> decode() const;
+
+private:
+    using IndexEntry = struct IndexEntryStruct {
+        Epc96 first_;
+        uint32_t width_;
+        uint32_t count_;
+        uint32_t exception_count_;
+        uint64_t offset_;
+    };
+
+    static bool isValidExceptions(const char *bytes, const IndexEntry &entry);
+
+    std::string bytes_;
+    std::vector<IndexEntry> index_;
+    size_t size_ = 0;
+    size_t block_size_ = 0;
+};
+
+}
+
+#endif
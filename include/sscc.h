@@ -2,6 +2,7 @@
 #define LIBEPC_EPC_SSCC_H_
 
 #include "epc.h"
+#include "layout.h"
 
 #include <regex>
 #include <vector>
@@ -65,12 +66,12 @@ public:
      * A method returning company prefix of the SSCC.
      * @return A company prefix in string.
      */
-    std::string getCompanyPrefix() const { return company_prefix_; }
+    const std::string &getCompanyPrefix() const { return company_prefix_; }
     /**
      * A method returning serial reference of the SSCC.
      * @return A serial reference in string.
      */
-    std::string getSerialReference() const { return serial_ref_; }
+    const std::string &getSerialReference() const { return serial_ref_; }
 
     /**
      * A method setting SSCC encoding scheme.
@@ -85,6 +86,9 @@ public:
     Scheme getSSCCScheme() const { return scheme_; }
 
 private:
+    friend std::pair<Status, Layout> get_layout(uint8_t header,
+                                                unsigned int partition);
+
     using PartitionTable = struct PartitionTableStruct {
         unsigned int partition_;
         unsigned int company_prefix_bits_;
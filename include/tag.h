@@ -0,0 +1,208 @@
+#ifndef LIBEPC_EPC_TAG_H_
+#define LIBEPC_EPC_TAG_H_
+
+#include "epc.h"
+#include "epc96.h"
+#include "sgtin.h"
+#include "sscc.h"
+#include "sgln.h"
+#include "grai.h"
+#include "giai.h"
+#include "status.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace epc {
+
+/**
+ * Kinds of EPC supported by the library.
+ */
+enum class TagType {
+    kUnknown,
+    kSGTIN,
+    kSSCC,
+    kSGLN,
+    kGRAI,
+    kGIAI,
+};
+
+/**
+ * An EPC binary encoding scheme.
+ */
+using SchemeInfo = struct SchemeInfoStruct {
+    /** The first 8 bits of EPC binaries of the scheme */
+    uint8_t header_;
+    TagType type_;
+    /** The number of bits of the binary, e.g. 96 */
+    unsigned int bits_;
+    /** The number of hex digits of the binary */
+    size_t hex_length_;
+    /** The name in EPC Tag URIs, e.g. "sgtin-96" */
+    const char *name_;
+};
+
+/**
+ * A function returning the encoding scheme identified by a binary header.
+ *
+ * @param header The first 8 bits of an EPC binary.
+ * @return The scheme, or nullptr for unsupported headers.
+ */
+const SchemeInfo *get_scheme_info(uint8_t header);
+/**
+ * A function returning the encoding scheme of a kind of EPC and a bit
+ * length.
+ *
+ * @param type A kind of EPC.
+ * @param bits The number of bits of the binary, e.g. 96.
+ * @return The scheme, or nullptr if there's no such scheme.
+ */
+const SchemeInfo *get_scheme_info(TagType type, unsigned int bits);
+/**
+ * A function returning the name of a kind of EPC in EPC URIs.
+ *
+ * @param type A kind of EPC.
+ * @return A name, e.g. "sgtin", or an empty string for TagType::kUnknown.
+ */
+const char *get_tag_type_name(TagType type);
+
+/**
+ * A function returning the kind of EPC identified by a binary header.
+ *
+ * @param header The first 8 bits of an EPC binary.
+ * @return A kind of EPC, or TagType::kUnknown for unsupported headers.
+ */
+TagType get_tag_type(uint8_t header);
+
+/**
+ * A function returning the length of the hex string form of an EPC binary.
+ *
+ * @param header The first 8 bits of an EPC binary.
+ * @return The number of hex digits, or 0 for unsupported headers.
+ */
+size_t get_hex_length(uint8_t header);
+
+/**
+ * A decoded tag holding any of the supported EPCs.
+ *
+ * The header byte of an EPC binary selects the scheme class that decodes
+ * the rest of it, so callers handling mixed reads don't have to know the
+ * scheme in advance.
+ */
+class Tag {
+public:
+    Tag() = default;
+    explicit Tag(const SGTIN &sgtin) : type_(TagType::kSGTIN), sgtin_(sgtin) {}
+    explicit Tag(const SSCC &sscc) : type_(TagType::kSSCC), sscc_(sscc) {}
+    explicit Tag(const SGLN &sgln) : type_(TagType::kSGLN), sgln_(sgln) {}
+    explicit Tag(const GRAI &grai) : type_(TagType::kGRAI), grai_(grai) {}
+    explicit Tag(const GIAI &giai) : type_(TagType::kGIAI), giai_(giai) {}
+    /**
+     * A static method creating a Tag instance from EPC Binary.
+     *
+     * @param hex EPC Binary in hex string format.
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    static std::pair<Status, Tag> createFromBinary(const std::string &hex);
+    /**
+     * A static method creating a Tag instance from EPC Binary in bytes.
+     *
+     * Bytes following the EPC, e.g. padding to a word boundary of the EPC
+     * bank, are ignored.
+     *
+     * @param bytes EPC Binary, most significant byte first.
+     * @param size The number of bytes.
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    static std::pair<Status, Tag> createFromBytes(const uint8_t *bytes,
+                                                  size_t size);
+    /**
+     * A static method creating a Tag instance from a 96-bit EPC binary.
+     *
+     * @param epc EPC Binary.
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    static std::pair<Status, Tag> createFromEpc96(const Epc96 &epc);
+    /**
+     * A static method creating a Tag instance from EPC URI.
+     *
+     * @param uri EPC URI
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    static std::pair<Status, Tag> createFromURI(const std::string &uri);
+    /**
+     * A static method creating a Tag instance from EPC Tag URI.
+     *
+     * @param tag_uri EPC Tag URI.
+     * @return A pair of a status and a Tag instance.
+     * The status is Status::kOk on normal completion or the error factor
+     * on error.
+     */
+    static std::pair<Status, Tag> createFromTagURI(const std::string &tag_uri);
+
+    /**
+     * A method returning the kind of EPC held by the tag.
+     * @return A kind of EPC (default: TagType::kUnknown)
+     */
+    TagType getType() const { return type_; }
+    /**
+     * A method returning the binary header of the EPC held by the tag, which
+     * identifies both the kind of EPC and its encoding scheme.
+     * @return A binary header, or 0 for a tag of TagType::kUnknown.
+     */
+    uint8_t getHeader() const;
+    /**
+     * A method returning the EPC held by the tag.
+     * Must not be called on a tag of TagType::kUnknown.
+     * @return The EPC.
+     */
+    const EPC &getEPC() const;
+    /**
+     * A method setting filter value for the EPC held by the tag.
+     * @param value filter value.
+     * @return Status::kOk on normal completion or the error factor on error.
+     */
+    Status setFilterValue(unsigned int value);
+
+    const SGTIN &getSGTIN() const { return sgtin_; }
+    const SSCC &getSSCC() const { return sscc_; }
+    const SGLN &getSGLN() const { return sgln_; }
+    const GRAI &getGRAI() const { return grai_; }
+    const GIAI &getGIAI() const { return giai_; }
+
+    std::string getURI() const { return getEPC().getURI(); }
+    std::string getTagURI() const { return getEPC().getTagURI(); }
+    std::pair<Status, std::string> getBinary() const {
+        return getEPC().getBinary();
+    }
+    /**
+     * A method returning the EPC binary of the tag packed in 96 bits.
+     *
+     * @return A pair of a status and an Epc96 instance.
+     * The status is Status::kOk on normal completion,
+     * Status::kInvalidArgument if the encoding scheme isn't of 96 bits, or
+     * the error factor of getBinary() on error.
+     */
+    std::pair<Status, Epc96> getEpc96() const;
+
+private:
+    TagType type_ = TagType::kUnknown;
+    SGTIN sgtin_;
+    SSCC sscc_;
+    SGLN sgln_;
+    GRAI grai_;
+    GIAI giai_;
+};
+
+}
+
+#endif
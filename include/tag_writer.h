@@ -0,0 +1,134 @@
+#ifndef LIBEPC_EPC_TAG_WRITER_H_
+#define LIBEPC_EPC_TAG_WRITER_H_
+
+#include "status.h"
+#include "tag.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace epc {
+
+/**
+ * A streaming writer of tags in NDJSON or CSV.
+ *
+ * Records are rendered directly from the fields of tags into an output
+ * buffer, which is passed to a sink whenever it exceeds the buffer size and
+ * on flush(). The buffer and scratch space are reused across records.
+ */
+class TagWriter {
+public:
+    enum class Format {
+        kNDJSON,
+        kCSV,
+    };
+
+    enum class Column {
+        /** EPC URI */
+        kURI,
+        /** EPC Tag URI */
+        kTagURI,
+        /** EPC binary in hex string format */
+        kBinary,
+        /** Kind of EPC, e.g. "sgtin" */
+        kType,
+        /** Encoding scheme, e.g. "sgtin-96" */
+        kScheme,
+        /** Filter value */
+        kFilter,
+        /** Company prefix */
+        kCompanyPrefix,
+        /** Item reference and indicator, serial reference, location
+         *  reference or asset type. Empty for GIAI. */
+        kReference,
+        /** Serial, extension or asset reference. Empty for SSCC. */
+        kSerial,
+    };
+
+    /**
+     * A sink receiving the contents of the output buffer.
+     * Returns Status::kOk on normal completion or the error factor on error.
+     */
+    using Sink = std::function<Status(const char *data, size_t size)>;
+
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+    /**
+     * @param format An output format.
+     * @param columns Columns of the records in order.
+     * @param sink A sink receiving the output.
+     * @param buffer_size The size of output buffered before it's passed to
+     * the sink.
+     */
+    TagWriter(Format format, const std::vector<Column> &columns,
+              const Sink &sink, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    /**
+     * @param format An output format.
+     * @param columns Columns of the records in order.
+     * @param fd A file descriptor the output is written to.
+     * @param buffer_size The size of output buffered before it's written.
+     */
+    TagWriter(Format format, const std::vector<Column> &columns, int fd,
+              size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    TagWriter(const TagWriter &) = delete;
+    TagWriter &operator=(const TagWriter &) = delete;
+    /**
+     * Flushes the output buffer, ignoring errors. Call flush() to handle
+     * them.
+     */
+    ~TagWriter();
+
+    /**
+     * A method writing the header line of CSV. Does nothing for NDJSON.
+     * @return Status::kOk on normal completion or the error factor on error.
+     */
+    Status writeHeader();
+    /**
+     * A method writing a record of a tag.
+     *
+     * Columns which can't be rendered, e.g. the EPC binary of a tag whose
+     * serial can't be encoded, are written as null in NDJSON and empty
+     * in CSV.
+     *
+     * @param tag A tag.
+     * @return Status::kOk on normal completion, Status::kInvalidArgument if
+     * the tag is of TagType::kUnknown, or the error factor of the sink.
+     */
+    Status write(const Tag &tag);
+    /**
+     * A method writing records of tags. Tags of TagType::kUnknown are
+     * skipped.
+     *
+     * @param tags Tags.
+     * @param n The number of tags.
+     * @return Status::kOk on normal completion or the error factor of the
+     * sink.
+     */
+    Status write(const Tag *tags, size_t n);
+    Status write(const std::vector<Tag> &tags) {
+        return write(tags.data(), tags.size());
+    }
+    /**
+     * A method passing the buffered output to the sink.
+     * @return Status::kOk on normal completion or the error factor of the
+     * sink.
+     */
+    Status flush();
+
+private:
+    void writeRecord(const Tag &tag);
+    void writeValue(const std::string &value);
+    void writeNull();
+
+    Format format_;
+    std::vector<Column> columns_;
+    Sink sink_;
+    size_t buffer_size_;
+    std::string buffer_;
+    std::string field_;
+};
+
+}
+
+#endif
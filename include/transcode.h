@@ -0,0 +1,129 @@
+#ifndef LIBEPC_EPC_TRANSCODE_H_
+#define LIBEPC_EPC_TRANSCODE_H_
+
+#include "status.h"
+
+#include <cstddef>
+#include <string>
+
+namespace epc {
+
+/*
+ * Functions transcoding between EPC binaries in hex, EPC URIs and EPC Tag
+ * URIs of every scheme.
+ *
+ * Fields are read from the source and written to the buffer in one pass,
+ * without creating a Tag or strings of the fields, so a buffer reused
+ * across calls allocates only when it grows. The results, including the
+ * statuses on error, are the same as of the Tag methods, e.g.
+ * Tag::createFromBinary() followed by Tag::getURI(). The buffer is replaced
+ * by the result, or cleared on error.
+ */
+
+/**
+ * A function transcoding an EPC binary to EPC URI.
+ *
+ * @param hex EPC binary in upper case hex.
+ * @param n The number of hex digits.
+ * @param buffer A buffer replaced by the EPC URI.
+ * @return Status::kOk on normal completion or Status::kInvalidArgument if
+ * Tag::createFromBinary() would fail.
+ */
+Status transcode_binary_to_uri(const char *hex, size_t n,
+                               std::string &buffer);
+inline Status transcode_binary_to_uri(const std::string &hex,
+                                      std::string &buffer) {
+    return transcode_binary_to_uri(hex.data(), hex.length(), buffer);
+}
+/**
+ * A function transcoding an EPC binary to EPC Tag URI.
+ *
+ * @param hex EPC binary in upper case hex.
+ * @param n The number of hex digits.
+ * @param buffer A buffer replaced by the EPC Tag URI.
+ * @return Status::kOk on normal completion or Status::kInvalidArgument if
+ * Tag::createFromBinary() would fail.
+ */
+Status transcode_binary_to_tag_uri(const char *hex, size_t n,
+                                   std::string &buffer);
+inline Status transcode_binary_to_tag_uri(const std::string &hex,
+                                          std::string &buffer) {
+    return transcode_binary_to_tag_uri(hex.data(), hex.length(), buffer);
+}
+
+/**
+ * A function transcoding an EPC Tag URI to EPC binary.
+ *
+ * @param tag_uri EPC Tag URI.
+ * @param n The length of the EPC Tag URI.
+ * @param buffer A buffer replaced by the EPC binary in upper case hex.
+ * @return Status::kOk on normal completion or the error factor of
+ * Tag::createFromTagURI() or Tag::getBinary() on error.
+ */
+Status transcode_tag_uri_to_binary(const char *tag_uri, size_t n,
+                                   std::string &buffer);
+inline Status transcode_tag_uri_to_binary(const std::string &tag_uri,
+                                          std::string &buffer) {
+    return transcode_tag_uri_to_binary(tag_uri.data(), tag_uri.length(),
+                                       buffer);
+}
+/**
+ * A function transcoding an EPC URI to EPC binary.
+ *
+ * @param uri EPC URI.
+ * @param n The length of the EPC URI.
+ * @param bits The bit length of the scheme, e.g. 96 or 198 for SGTIN.
+ * @param filter A filter value.
+ * @param buffer A buffer replaced by the EPC binary in upper case hex.
+ * @return Status::kOk on normal completion, Status::kInvalidArgument if
+ * the bit length isn't of the scheme or the filter value is over 7, or the
+ * error factor of Tag::createFromURI() or Tag::getBinary() on error.
+ */
+Status transcode_uri_to_binary(const char *uri, size_t n, unsigned int bits,
+                               unsigned int filter, std::string &buffer);
+inline Status transcode_uri_to_binary(const std::string &uri,
+                                      unsigned int bits, unsigned int filter,
+                                      std::string &buffer) {
+    return transcode_uri_to_binary(uri.data(), uri.length(), bits, filter,
+                                   buffer);
+}
+
+/**
+ * A function transcoding an EPC Tag URI to EPC URI.
+ *
+ * @param tag_uri EPC Tag URI.
+ * @param n The length of the EPC Tag URI.
+ * @param buffer A buffer replaced by the EPC URI.
+ * @return Status::kOk on normal completion or the error factor of
+ * Tag::createFromTagURI() on error.
+ */
+Status transcode_tag_uri_to_uri(const char *tag_uri, size_t n,
+                                std::string &buffer);
+inline Status transcode_tag_uri_to_uri(const std::string &tag_uri,
+                                       std::string &buffer) {
+    return transcode_tag_uri_to_uri(tag_uri.data(), tag_uri.length(), buffer);
+}
+/**
+ * A function transcoding an EPC URI to EPC Tag URI.
+ *
+ * @param uri EPC URI.
+ * @param n The length of the EPC URI.
+ * @param bits The bit length of the scheme, e.g. 96 or 198 for SGTIN.
+ * @param filter A filter value.
+ * @param buffer A buffer replaced by the EPC Tag URI.
+ * @return Status::kOk on normal completion, Status::kInvalidArgument if
+ * the bit length isn't of the scheme or the filter value is over 7, or the
+ * error factor of Tag::createFromURI() on error.
+ */
+Status transcode_uri_to_tag_uri(const char *uri, size_t n, unsigned int bits,
+                                unsigned int filter, std::string &buffer);
+inline Status transcode_uri_to_tag_uri(const std::string &uri,
+                                       unsigned int bits, unsigned int filter,
+                                       std::string &buffer) {
+    return transcode_uri_to_tag_uri(uri.data(), uri.length(), bits, filter,
+                                    buffer);
+}
+
+}
+
+#endif
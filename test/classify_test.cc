@@ -0,0 +1,90 @@
+#include "classify.h"
+#include "sscc.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+using namespace epc;
+
+TEST(ClassifyTest, Hex) {
+    Status status;
+    Classification c;
+    std::tie(status, c) = classify("3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(TagType::kSGTIN, c.type_);
+    ASSERT_EQ(0x30, c.header_);
+    ASSERT_EQ(96, c.bits_);
+    ASSERT_EQ(3, c.filter_);
+    ASSERT_EQ(5, c.partition_);
+    ASSERT_EQ(0, c.company_prefix_);
+    ASSERT_EQ(0, c.company_prefix_digits_);
+
+    std::tie(status, c) = classify("3074257BF7194E4000001A85", true);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(614141, c.company_prefix_);
+    ASSERT_EQ(7, c.company_prefix_digits_);
+
+    // Only the leading digits are read.
+    std::tie(status, c) = classify("3074");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(3, c.filter_);
+    std::tie(status, c) = classify("3074257BF7", true);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(614141, c.company_prefix_);
+    std::tie(status, c) = classify("3074ZZZZ");
+    ASSERT_EQ(Status::kOk, status);
+
+    // SSCC of 12 digits of company prefix.
+    std::string hex = SSCC::createFromTagURI(
+        "urn:epc:tag:sscc-96:6.061414112345.12345").second.getBinary().second;
+    std::tie(status, c) = classify(hex, true);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(TagType::kSSCC, c.type_);
+    ASSERT_EQ(6, c.filter_);
+    ASSERT_EQ(0, c.partition_);
+    ASSERT_EQ(61414112345, c.company_prefix_);
+    ASSERT_EQ(12, c.company_prefix_digits_);
+
+    std::tie(status, c) = classify("3614257BF7194E40");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(198, c.bits_);
+    ASSERT_EQ(0, c.filter_);
+}
+
+TEST(ClassifyTest, Bytes) {
+    const uint8_t bytes[] = {
+        0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19, 0x4E, 0x40, 0x00, 0x00, 0x1A, 0x85,
+    };
+    Status status;
+    Classification c;
+    std::tie(status, c) = classify(bytes, sizeof(bytes), true);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(TagType::kSGTIN, c.type_);
+    ASSERT_EQ(3, c.filter_);
+    ASSERT_EQ(5, c.partition_);
+    ASSERT_EQ(614141, c.company_prefix_);
+    ASSERT_EQ(7, c.company_prefix_digits_);
+
+    std::tie(status, c) = classify(bytes, 2);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(3, c.filter_);
+    ASSERT_EQ(Status::kInvalidArgument, classify(bytes, 1).first);
+    ASSERT_EQ(Status::kInvalidArgument, classify(bytes, 4, true).first);
+}
+
+TEST(ClassifyTest, Invalid) {
+    ASSERT_EQ(Status::kInvalidArgument, classify("").first);
+    ASSERT_EQ(Status::kInvalidArgument, classify("307").first);
+    ASSERT_EQ(Status::kInvalidArgument, classify("30G4").first);
+    ASSERT_EQ(Status::kInvalidArgument, classify("3574257BF7").first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              classify("3074257BF", true).first);
+    // Partition 7 is invalid only if the company prefix is read.
+    ASSERT_EQ(Status::kOk, classify("307C257BF7194E40").first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              classify("307C257BF7194E40", true).first);
+}
@@ -0,0 +1,183 @@
+#include "column_file.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace epc;
+
+namespace {
+    std::string temp_path(const char *name) {
+        return std::string(::testing::TempDir()) + name;
+    }
+
+    Tag tag_from_tag_uri(const std::string &tag_uri) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromTagURI(tag_uri);
+        EXPECT_EQ(Status::kOk, status);
+        return tag;
+    }
+}
+
+TEST(ColumnFileTest, WriteAndOpen) {
+    const std::vector<std::string> tag_uris = {
+        "urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+        "urn:epc:tag:sgtin-96:1.0614141.012345.6790",
+        "urn:epc:tag:sgtin-96:3.061414.1812345.0",
+        "urn:epc:tag:sgtin-198:3.0614141.712345.32a%2Fb",
+        "urn:epc:tag:sgtin-198:0.0614141.712345.A%25",
+        "urn:epc:tag:sscc-96:3.0614141.1234567890",
+        "urn:epc:tag:sgln-195:3.0614141.12345.32a%2Fb",
+        "urn:epc:tag:grai-96:3.0614141.12345.5678",
+        "urn:epc:tag:giai-96:3.0614141.5678",
+        "urn:epc:tag:giai-202:3.0614141.32a%2Fb",
+    };
+    ColumnFileWriter writer;
+    for (auto &tag_uri : tag_uris) {
+        ASSERT_EQ(Status::kOk, writer.add(tag_from_tag_uri(tag_uri)));
+    }
+    ASSERT_EQ(tag_uris.size(), writer.size());
+    std::string path = temp_path("column_file_test.epccol");
+    ASSERT_EQ(Status::kOk, writer.write(path));
+
+    Status status;
+    ColumnFile file;
+    std::tie(status, file) = ColumnFile::open(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(tag_uris.size(), file.size());
+
+    auto &blocks = file.getBlocks();
+    ASSERT_EQ(7, blocks.size());
+    const ColumnBlock &sgtin96 = blocks[0];
+    ASSERT_EQ(0x30, sgtin96.getHeader());
+    ASSERT_EQ(3, sgtin96.size());
+    ASSERT_EQ(3, sgtin96.getFilterValues()[0]);
+    ASSERT_EQ(1, sgtin96.getFilterValues()[1]);
+    ASSERT_EQ(2, sgtin96.getCompanyPrefixes().size());
+    ASSERT_EQ(614141, sgtin96.getCompanyPrefixes()[0].value_);
+    ASSERT_EQ(7, sgtin96.getCompanyPrefixes()[0].digits_);
+    ASSERT_EQ(0, sgtin96.getCompanyPrefixIndices()[1]);
+    ASSERT_EQ(1, sgtin96.getCompanyPrefixIndices()[2]);
+    ASSERT_EQ(12345, sgtin96.getReferences()[1]);
+    ASSERT_EQ(6790, sgtin96.getSerials()[1]);
+    ASSERT_TRUE(sgtin96.getSerialOffsets().empty());
+    // Columns of integers are of the width of their largest element.
+    ASSERT_EQ(1, sgtin96.getCompanyPrefixIndices().getWidth());
+    ASSERT_EQ(4, sgtin96.getReferences().getWidth());
+    ASSERT_EQ(2, sgtin96.getSerials().getWidth());
+    ASSERT_EQ(3, sgtin96.getSerials().getSpan<uint16_t>().size());
+    ASSERT_EQ(6790, sgtin96.getSerials().getSpan<uint16_t>()[1]);
+    ASSERT_TRUE(sgtin96.getSerials().getSpan<uint64_t>().empty());
+    ASSERT_EQ("0614141", sgtin96.getCompanyPrefix(1));
+
+    const ColumnBlock &sgtin198 = blocks[4];
+    ASSERT_EQ(0x36, sgtin198.getHeader());
+    ASSERT_TRUE(sgtin198.getSerials().empty());
+    ASSERT_EQ(3, sgtin198.getSerialOffsets().size());
+    ASSERT_EQ(1, sgtin198.getSerialOffsets().getWidth());
+    ASSERT_EQ("32a/b", sgtin198.getSerial(0));
+    ASSERT_EQ("A%", sgtin198.getSerial(1));
+
+    const ColumnBlock &giai96 = blocks[3];
+    ASSERT_EQ(0x34, giai96.getHeader());
+    ASSERT_TRUE(giai96.getReferences().empty());
+    ASSERT_EQ(5678, giai96.getSerials()[0]);
+
+    std::vector<std::string> actual;
+    for (auto &block : blocks) {
+        for (size_t row = 0; row < block.size(); row++) {
+            Tag tag;
+            std::tie(status, tag) = block.getTag(row);
+            ASSERT_EQ(Status::kOk, status);
+            actual.push_back(tag.getTagURI());
+        }
+    }
+    std::vector<std::string> expected = tag_uris;
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(expected, actual);
+
+    // A moved file keeps its mapping.
+    ColumnFile moved = std::move(file);
+    ASSERT_EQ(0, file.size());
+    ASSERT_EQ(tag_uris.size(), moved.size());
+    ASSERT_EQ("0614141", moved.getBlocks()[0].getCompanyPrefix(0));
+    std::remove(path.c_str());
+}
+
+TEST(ColumnFileTest, Widths) {
+    const std::vector<std::string> tag_uris = {
+        "urn:epc:tag:sgtin-96:3.0614141.812345.0",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.255",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.65535",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.4294967295",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.274877906943",
+    };
+    std::string path = temp_path("column_file_test_widths.epccol");
+    const unsigned int widths[] = {1, 1, 2, 4, 8};
+    for (size_t n = 1; n <= tag_uris.size(); n++) {
+        ColumnFileWriter writer;
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(Status::kOk, writer.add(tag_from_tag_uri(tag_uris[i])));
+        }
+        ASSERT_EQ(Status::kOk, writer.write(path));
+        Status status;
+        ColumnFile file;
+        std::tie(status, file) = ColumnFile::open(path);
+        ASSERT_EQ(Status::kOk, status);
+        ColumnIntegers serials = file.getBlocks()[0].getSerials();
+        ASSERT_EQ(widths[n - 1], serials.getWidth());
+        ASSERT_EQ(n, serials.size());
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(tag_uris[i], file.getBlocks()[0].getTag(i).second
+                      .getTagURI());
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(ColumnFileTest, Add) {
+    ColumnFileWriter writer;
+    ASSERT_EQ(Status::kInvalidArgument, writer.add(Tag()));
+
+    // Serials of SGTIN-96 must be integers without leading zeros.
+    SGTIN sgtin;
+    Status status;
+    std::tie(status, sgtin) = SGTIN::create("0614141", "812345", "0123");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(Status::kInvalidSerial, writer.add(Tag(sgtin)));
+    std::tie(status, sgtin) = SGTIN::create("0614141", "812345", "32a");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(Status::kInvalidSerial, writer.add(Tag(sgtin)));
+    ASSERT_EQ(0, writer.size());
+}
+
+TEST(ColumnFileTest, OpenInvalidFile) {
+    Status status;
+    ColumnFile file;
+    std::tie(status, file) = ColumnFile::open(temp_path("does-not-exist"));
+    ASSERT_EQ(Status::kInvalidArgument, status);
+
+    std::string path = temp_path("column_file_test_invalid.epccol");
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << "EPCCOL not really a column file";
+    }
+    std::tie(status, file) = ColumnFile::open(path);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+
+    // Truncated file
+    ColumnFileWriter writer;
+    ASSERT_EQ(Status::kOk, writer.add(
+                  tag_from_tag_uri("urn:epc:tag:sgtin-96:3.0614141.812345.6789")));
+    ASSERT_EQ(Status::kOk, writer.write(path));
+    std::tie(status, file) = ColumnFile::open(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(0, ::truncate(path.c_str(), 120));
+    std::tie(status, file) = ColumnFile::open(path);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    std::remove(path.c_str());
+}
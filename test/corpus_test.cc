@@ -0,0 +1,211 @@
+#include "corpus.h"
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    const uint8_t HEADERS[] = {
+        0x30, 0x36, 0x31, 0x32, 0x39, 0x33, 0x37, 0x34, 0x38,
+    };
+
+    CorpusConfig get_mixed_config(SerialMode mode) {
+        CorpusConfig config;
+        config.seed_ = 42;
+        config.schemes_.clear();
+        for (uint8_t header : HEADERS) config.schemes_.push_back({header, 1});
+        config.filter_ = 3;
+        config.serial_mode_ = mode;
+        return config;
+    }
+
+    CorpusGenerator create(const CorpusConfig &config) {
+        Status status;
+        CorpusGenerator generator;
+        std::tie(status, generator) = CorpusGenerator::create(config);
+        EXPECT_EQ(Status::kOk, status);
+        return generator;
+    }
+
+    std::vector<std::string> generate(const CorpusGenerator &generator,
+                                      uint64_t first, size_t n,
+                                      CorpusFormat format) {
+        std::string buffer;
+        std::vector<size_t> offsets(n + 1);
+        generator.generate(first, n, format, buffer, offsets.data());
+        std::vector<std::string> records;
+        for (size_t i = 0; i < n; i++) {
+            records.push_back(buffer.substr(offsets[i],
+                                            offsets[i + 1] - offsets[i]));
+        }
+        return records;
+    }
+}
+
+TEST(CorpusTest, Valid) {
+    const size_t n = 2000;
+    for (SerialMode mode : {SerialMode::kSequential, SerialMode::kRandom,
+                            SerialMode::kAlphanumeric}) {
+        CorpusGenerator generator = create(get_mixed_config(mode));
+        auto hexes = generate(generator, 0, n, CorpusFormat::kHex);
+        auto bytes = generate(generator, 0, n, CorpusFormat::kBytes);
+        auto uris = generate(generator, 0, n, CorpusFormat::kURI);
+        auto tag_uris = generate(generator, 0, n, CorpusFormat::kTagURI);
+        std::set<uint8_t> headers;
+        for (size_t i = 0; i < n; i++) {
+            Status status;
+            Tag tag;
+            std::tie(status, tag) = Tag::createFromBinary(hexes[i]);
+            ASSERT_EQ(Status::kOk, status) << hexes[i];
+            headers.insert(tag.getHeader());
+            EXPECT_EQ(3u, tag.getEPC().getFilterValue());
+            std::string hex;
+            std::tie(status, hex) = tag.getBinary();
+            EXPECT_EQ(Status::kOk, status);
+            EXPECT_EQ(hexes[i], hex);
+            EXPECT_EQ(uris[i], tag.getURI());
+            EXPECT_EQ(tag_uris[i], tag.getTagURI());
+
+            std::tie(status, tag) = Tag::createFromTagURI(tag_uris[i]);
+            ASSERT_EQ(Status::kOk, status) << tag_uris[i];
+            std::tie(status, hex) = tag.getBinary();
+            EXPECT_EQ(hexes[i], hex);
+
+            std::tie(status, tag) = Tag::createFromBytes(
+                reinterpret_cast<const uint8_t *>(bytes[i].data()),
+                bytes[i].size());
+            ASSERT_EQ(Status::kOk, status);
+            EXPECT_EQ(uris[i], tag.getURI());
+        }
+        EXPECT_EQ(sizeof(HEADERS), headers.size());
+    }
+}
+
+TEST(CorpusTest, Deterministic) {
+    CorpusConfig config = get_mixed_config(SerialMode::kAlphanumeric);
+    config.repeat_rate_ = 0.3;
+    auto records = generate(create(config), 0, 1000, CorpusFormat::kTagURI);
+    EXPECT_EQ(records,
+              generate(create(config), 0, 1000, CorpusFormat::kTagURI));
+
+    // Any range of records is the same as of the whole.
+    CorpusGenerator generator = create(config);
+    EXPECT_EQ(std::vector<std::string>(records.begin() + 500, records.end()),
+              generate(generator, 500, 500, CorpusFormat::kTagURI));
+    std::string buffer;
+    generator.append(999, CorpusFormat::kTagURI, buffer);
+    EXPECT_EQ(records[999], buffer);
+
+    config.seed_++;
+    EXPECT_NE(records,
+              generate(create(config), 0, 1000, CorpusFormat::kTagURI));
+}
+
+TEST(CorpusTest, Distributions) {
+    const size_t n = 20000;
+    CorpusConfig config;
+    config.schemes_ = {{0x30, 3}, {0x31, 1}, {0x34, 0}};
+    config.partition_weights_ = {0, 0, 0, 0, 0, 1, 0};
+    config.company_prefixes_ = 10;
+    config.company_prefix_skew_ = 2;
+    CorpusGenerator generator = create(config);
+    std::map<std::string, size_t> schemes;
+    std::map<std::string, size_t> company_prefixes;
+    for (const std::string &uri :
+         generate(generator, 0, n, CorpusFormat::kURI)) {
+        size_t colon = uri.rfind(':');
+        size_t dot = uri.find('.', colon);
+        schemes[uri.substr(0, colon)]++;
+        // 7 digits of partition 5.
+        EXPECT_EQ(7u, dot - colon - 1) << uri;
+        company_prefixes[uri.substr(colon + 1, dot - colon - 1)]++;
+    }
+    EXPECT_EQ(2u, schemes.size());
+    EXPECT_NEAR(0.75, schemes["urn:epc:id:sgtin"] / double(n), 0.02);
+    EXPECT_NEAR(0.25, schemes["urn:epc:id:sscc"] / double(n), 0.02);
+    EXPECT_GE(10u, company_prefixes.size());
+    // The most frequent one of 1 / i^2 is taken about 65% of the time.
+    size_t most = 0;
+    for (const auto &entry : company_prefixes) {
+        most = std::max(most, entry.second);
+    }
+    EXPECT_NEAR(0.65, most / double(n), 0.02);
+}
+
+TEST(CorpusTest, Serial) {
+    CorpusConfig config;
+    config.serial_mode_ = SerialMode::kSequential;
+    config.first_serial_ = 100;
+    auto uris = generate(create(config), 0, 10, CorpusFormat::kURI);
+    for (size_t i = 0; i < uris.size(); i++) {
+        EXPECT_EQ(std::to_string(100 + i),
+                  uris[i].substr(uris[i].rfind('.') + 1));
+    }
+
+    // Alphanumerics reach the maximum length of the scheme.
+    config.schemes_ = {{0x37, 1}};
+    config.serial_mode_ = SerialMode::kAlphanumeric;
+    size_t longest = 0;
+    for (const std::string &uri :
+         generate(create(config), 0, 1000, CorpusFormat::kURI)) {
+        longest = std::max(longest, uri.length() - uri.rfind('.') - 1);
+    }
+    EXPECT_EQ(16u, longest);
+}
+
+TEST(CorpusTest, Repeat) {
+    const size_t n = 20000;
+    CorpusConfig config;
+    config.serial_mode_ = SerialMode::kSequential;
+    auto hexes = generate(create(config), 0, n, CorpusFormat::kHex);
+    EXPECT_EQ(n, std::set<std::string>(hexes.begin(), hexes.end()).size());
+
+    config.repeat_rate_ = 0.5;
+    config.repeat_window_ = 8;
+    hexes = generate(create(config), 0, n, CorpusFormat::kHex);
+    size_t repeats = 0;
+    for (size_t i = 1; i < n; i++) {
+        for (size_t age = 1; age <= config.repeat_window_ && age <= i;
+             age++) {
+            if (hexes[i] == hexes[i - age]) {
+                repeats++;
+                break;
+            }
+        }
+    }
+    EXPECT_NEAR(0.5, repeats / double(n), 0.02);
+}
+
+TEST(CorpusTest, Invalid) {
+    std::vector<CorpusConfig> configs(13);
+    configs[0].schemes_.clear();
+    configs[1].schemes_ = {{0x35, 1}};
+    configs[2].schemes_ = {{0x30, -1}};
+    configs[3].schemes_ = {{0x30, 0}};
+    // SGLN of partition 0 has no digits of reference.
+    configs[4].schemes_ = {{0x32, 1}};
+    configs[4].partition_weights_ = {1, 0, 0, 0, 0, 0, 0};
+    configs[5].partition_weights_ = {1, 1, 1};
+    configs[6].filter_ = 8;
+    configs[7].company_prefixes_ = 0;
+    configs[8].repeat_rate_ = 1;
+    configs[9].repeat_window_ = 0;
+    configs[10].company_prefixes_ = CorpusGenerator::MAX_COMPANY_PREFIXES + 1;
+    configs[11].company_prefixes_ = ~size_t(0);
+    configs[12].repeat_window_ = CorpusGenerator::MAX_REPEAT_WINDOW + 1;
+    for (const CorpusConfig &config : configs) {
+        EXPECT_EQ(Status::kInvalidArgument,
+                  CorpusGenerator::create(config).first);
+    }
+}
@@ -0,0 +1,156 @@
+#include "decode_cache.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    std::string sgtin96(unsigned int serial) {
+        // 3074257BF7194E4 followed by 38 bits of serial
+        static const char digits[] = "0123456789ABCDEF";
+        std::string hex = "3074257BF7194E4000000000";
+        uint64_t value = serial;
+        for (size_t i = hex.length(); value > 0 && i > 14; i--) {
+            hex[i - 1] = digits[value & 0xF];
+            value >>= 4;
+        }
+        return hex;
+    }
+}
+
+TEST(DecodeCacheTest, Get) {
+    DecodeCache cache(16, 4);
+    Status status;
+    std::shared_ptr<const DecodeCacheEntry> entry;
+    std::tie(status, entry) = cache.get("3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", entry->uri_);
+    ASSERT_EQ("urn:epc:tag:sgtin-96:3.0614141.812345.6789", entry->tag_uri_);
+    ASSERT_EQ("6789", entry->tag_.getSGTIN().getSerial());
+    ASSERT_EQ(0, cache.getHits());
+    ASSERT_EQ(1, cache.getMisses());
+
+    std::shared_ptr<const DecodeCacheEntry> hit;
+    std::tie(status, hit) = cache.get("3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(entry, hit);
+    ASSERT_EQ(1, cache.getHits());
+    ASSERT_EQ(1, cache.size());
+
+    // The same binary in bytes, padded to a word boundary
+    const uint8_t bytes[] = {0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19, 0x4E,
+                             0x40, 0x00, 0x00, 0x1A, 0x85, 0xFF, 0xFF};
+    std::tie(status, hit) = cache.get(bytes, sizeof(bytes));
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(entry, hit);
+    ASSERT_EQ(2, cache.getHits());
+}
+
+TEST(DecodeCacheTest, LongBinaries) {
+    DecodeCache cache(16);
+    const std::vector<std::string> hexes = {
+        "3874257BF59B2C2BF10000000000000000000000000000000000",
+        "3674257BF6B7A659B2C2BF100000000000000000000000000000",
+        "3974257BF46072CD9615F8800000000000000000000000000",
+    };
+    for (const auto &hex : hexes) {
+        Status status;
+        std::shared_ptr<const DecodeCacheEntry> entry;
+        std::tie(status, entry) = cache.get(hex);
+        ASSERT_EQ(Status::kOk, status) << hex;
+        std::tie(status, entry) = cache.get(hex);
+        ASSERT_EQ(Status::kOk, status) << hex;
+    }
+    ASSERT_EQ(3, cache.getHits());
+    ASSERT_EQ(3, cache.size());
+}
+
+TEST(DecodeCacheTest, Invalid) {
+    DecodeCache cache(16);
+    Status status;
+    std::shared_ptr<const DecodeCacheEntry> entry;
+    for (const std::string hex : {"", "3", "3074257BF7194E4000001A8",
+                                  "3074257bf7194e4000001a85",
+                                  "3574257BF40000000000162E",
+                                  "3074257BF7194E400000XA85"}) {
+        std::tie(status, entry) = cache.get(hex);
+        ASSERT_EQ(Status::kInvalidArgument, status) << hex;
+        ASSERT_EQ(nullptr, entry);
+        std::tie(status, entry) = cache.get(hex);
+        ASSERT_EQ(Status::kInvalidArgument, status) << hex;
+    }
+    const uint8_t bytes[] = {0x30, 0x74};
+    std::tie(status, entry) = cache.get(bytes, sizeof(bytes));
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.getHits());
+}
+
+TEST(DecodeCacheTest, Evict) {
+    DecodeCache cache(4, 1);
+    Status status;
+    std::shared_ptr<const DecodeCacheEntry> entry;
+    for (unsigned int i = 0; i < 4; i++) {
+        std::tie(status, entry) = cache.get(sgtin96(i));
+        ASSERT_EQ(Status::kOk, status);
+    }
+    // Reference 0 and 2 so that they survive the next insertion.
+    cache.get(sgtin96(0));
+    cache.get(sgtin96(2));
+    std::shared_ptr<const DecodeCacheEntry> evicted;
+    std::tie(status, evicted) = cache.get(sgtin96(1));
+    std::tie(status, entry) = cache.get(sgtin96(4));
+    ASSERT_EQ(4, cache.size());
+    uint64_t hits = cache.getHits();
+    cache.get(sgtin96(0));
+    cache.get(sgtin96(2));
+    cache.get(sgtin96(4));
+    ASSERT_EQ(hits + 3, cache.getHits());
+    // Evicted entries stay valid.
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.1", evicted->uri_);
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST(DecodeCacheTest, ZeroCapacity) {
+    DecodeCache cache(0);
+    Status status;
+    std::shared_ptr<const DecodeCacheEntry> entry;
+    std::tie(status, entry) = cache.get("3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", entry->uri_);
+    std::tie(status, entry) = cache.get("3074257BF7194E4000001A85");
+    ASSERT_EQ(0, cache.getHits());
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST(DecodeCacheTest, Threads) {
+    DecodeCache cache(64, 8);
+    std::vector<std::thread> threads;
+    std::vector<int> errors(4);
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, &errors, t] {
+            for (unsigned int i = 0; i < 2000; i++) {
+                unsigned int serial = (i * 7 + t) % 100;
+                Status status;
+                std::shared_ptr<const DecodeCacheEntry> entry;
+                std::tie(status, entry) = cache.get(sgtin96(serial));
+                if (status != Status::kOk
+                    || entry->uri_ != "urn:epc:id:sgtin:0614141.812345."
+                                      + std::to_string(serial)) {
+                    errors[t]++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    for (int t = 0; t < 4; t++) ASSERT_EQ(0, errors[t]);
+    ASSERT_EQ(8000, cache.getHits() + cache.getMisses());
+    ASSERT_GE(64, cache.size());
+}
@@ -0,0 +1,123 @@
+#include "deduplicator.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(uint64_t serial) {
+        return Epc96(0x3074257B, 0xF7194E4000000000 | serial);
+    }
+}
+
+TEST(DeduplicatorTest, Offer) {
+    Deduplicator dedup(10);
+    ASSERT_EQ(10, dedup.getWindow());
+    ASSERT_TRUE(dedup.offer(sgtin96(1), 0, 100));
+    ASSERT_FALSE(dedup.offer(sgtin96(1), 0, 100));
+    ASSERT_FALSE(dedup.offer(sgtin96(1), 0, 109));
+    // Other zones and EPCs are independent.
+    ASSERT_TRUE(dedup.offer(sgtin96(1), 1, 105));
+    ASSERT_TRUE(dedup.offer(sgtin96(2), 0, 105));
+    // The window restarts at the read emitted again.
+    ASSERT_TRUE(dedup.offer(sgtin96(1), 0, 110));
+    ASSERT_FALSE(dedup.offer(sgtin96(1), 0, 119));
+    ASSERT_TRUE(dedup.offer(sgtin96(1), 0, 120));
+    // Late reads are duplicates.
+    ASSERT_FALSE(dedup.offer(sgtin96(1), 1, 100));
+    ASSERT_EQ(3, dedup.size());
+}
+
+TEST(DeduplicatorTest, OfferBatch) {
+    Deduplicator dedup(10);
+    std::vector<Epc96> epcs;
+    std::vector<uint32_t> zones;
+    std::vector<uint64_t> timestamps;
+    // 100 reads of 40 EPCs, each read once in zone 0 and 1, in rows of
+    // the same timestamp
+    for (uint64_t i = 0; i < 100; i++) {
+        epcs.push_back(sgtin96(i % 40));
+        zones.push_back(i / 40 % 2);
+        timestamps.push_back(i / 50);
+    }
+    std::vector<uint64_t> mask(2);
+    ASSERT_EQ(80, dedup.offer(epcs.data(), zones.data(), timestamps.data(),
+                              epcs.size(), mask.data()));
+    for (size_t i = 0; i < epcs.size(); i++) {
+        ASSERT_EQ(i < 80, (mask[i / 64] >> (i % 64) & 1) == 1) << i;
+    }
+
+    // Without zones
+    Deduplicator other(10);
+    ASSERT_EQ(40, other.offer(epcs.data(), nullptr, timestamps.data(),
+                              epcs.size(), mask.data()));
+    ASSERT_EQ(0xFFFFFFFFFF, mask[0]);
+    ASSERT_EQ(0, mask[1]);
+}
+
+TEST(DeduplicatorTest, Expire) {
+    Deduplicator dedup(10, 16);
+    for (uint64_t i = 0; i < 1000; i++) {
+        ASSERT_TRUE(dedup.offer(sgtin96(i), 0, i));
+    }
+    // Expired entries are swept as reads are offered.
+    ASSERT_GE(64, dedup.size());
+    for (uint64_t i = 990; i < 1000; i++) {
+        ASSERT_FALSE(dedup.offer(sgtin96(i), 0, 999));
+    }
+    dedup.expire(1005);
+    ASSERT_EQ(4, dedup.size());
+    dedup.expire(2000);
+    ASSERT_EQ(0, dedup.size());
+    ASSERT_TRUE(dedup.offer(sgtin96(999), 0, 2000));
+
+    dedup.clear();
+    ASSERT_EQ(0, dedup.size());
+    ASSERT_TRUE(dedup.offer(sgtin96(999), 0, 2000));
+}
+
+TEST(DeduplicatorTest, MaxTimestamp) {
+    const uint64_t max = ~0ULL;
+    Deduplicator dedup(10, 16);
+    ASSERT_TRUE(dedup.offer(sgtin96(1), 0, max - 5));
+    ASSERT_FALSE(dedup.offer(sgtin96(1), 0, max - 1));
+    // Entries are kept in the table as more are inserted around them.
+    for (uint64_t i = 2; i < 100; i++) {
+        ASSERT_TRUE(dedup.offer(sgtin96(i), 0, max - 1));
+    }
+    for (uint64_t i = 1; i < 100; i++) {
+        ASSERT_FALSE(dedup.offer(sgtin96(i), 0, max - 1)) << i;
+    }
+    ASSERT_EQ(99, dedup.size());
+}
+
+TEST(DeduplicatorTest, Grow) {
+    Deduplicator dedup(1000, 16);
+    for (uint64_t i = 0; i < 10000; i++) {
+        ASSERT_TRUE(dedup.offer(sgtin96(i * 7919), i % 3, 0));
+    }
+    ASSERT_EQ(10000, dedup.size());
+    for (uint64_t i = 0; i < 10000; i++) {
+        ASSERT_FALSE(dedup.offer(sgtin96(i * 7919), i % 3, 999));
+    }
+}
+
+TEST(DeduplicatorTest, Random) {
+    // Compare with a naive model while entries are expired and moved.
+    Deduplicator dedup(50, 16);
+    std::map<std::pair<uint64_t, uint32_t>, uint64_t> emitted;
+    uint64_t state = 1;
+    for (uint64_t t = 0; t < 20000; t++) {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        uint64_t serial = state >> 54;
+        uint32_t zone = state >> 40 & 1;
+        auto it = emitted.find(std::make_pair(serial, zone));
+        bool expected = it == emitted.end() || t >= it->second + 50;
+        if (expected) emitted[std::make_pair(serial, zone)] = t;
+        ASSERT_EQ(expected, dedup.offer(sgtin96(serial), zone, t)) << t;
+    }
+}
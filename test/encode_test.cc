@@ -52,12 +52,22 @@ TEST(EncodeTest, URIEncode) {
     ASSERT_EQ("%22%25%26%2F%3C%3E%3F", uri_encode("\"%&/<>?"));
     ASSERT_EQ("%22%25%26%2F%3C%3E%3Ftest%22%25%26%2F%3C%3E%3F",
               uri_encode("\"%&/<>?test\"%&/<>?"));
+    std::string buffer = "x";
+    append_uri_encoded(buffer, "a/b", 3);
+    append_uri_encoded(buffer, '?');
+    ASSERT_EQ("xa%2Fb%3F", buffer);
 }
 
 TEST(EncodeTest, URIDecode) {
     ASSERT_EQ("\"%&/<>?", uri_decode("%22%25%26%2F%3C%3E%3F"));
     ASSERT_EQ("\"%&/<>?test\"%&/<>?",
               uri_decode("%22%25%26%2F%3C%3E%3Ftest%22%25%26%2F%3C%3E%3F"));
+    // Escapes are decoded once, and others are kept.
+    ASSERT_EQ("%2F", uri_decode("%252F"));
+    ASSERT_EQ("%/%41%2", uri_decode("%%2F%41%2"));
+    std::string buffer = "x";
+    append_uri_decoded(buffer, "a%2Fb", 5);
+    ASSERT_EQ("xa/b", buffer);
 }
 
 TEST(EncodeTest, ReadString) {
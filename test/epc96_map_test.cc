@@ -0,0 +1,135 @@
+#include "epc96_map.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(uint64_t serial) {
+        return Epc96(0x3074257B, 0xF7194E4000000000 | serial);
+    }
+
+    template <typename Map>
+    void test_random() {
+        // Compare with std::map through inserts, erases and growth.
+        Map map;
+        std::map<Epc96, uint64_t> expected;
+        uint64_t state = 1;
+        for (int i = 0; i < 50000; i++) {
+            state = state * 6364136223846793005 + 1442695040888963407;
+            Epc96 key = sgtin96(state >> 52);
+            if (state >> 40 & 1) {
+                ASSERT_EQ(expected.erase(key) == 1, map.erase(key)) << i;
+            } else {
+                ASSERT_EQ(expected.emplace(key, i).second,
+                          map.insert(key, i).second) << i;
+            }
+            ASSERT_EQ(expected.size(), map.size());
+        }
+        for (uint64_t serial = 0; serial < 4096; serial++) {
+            auto it = expected.find(sgtin96(serial));
+            const uint64_t *value = map.find(sgtin96(serial));
+            if (it == expected.end()) {
+                ASSERT_EQ(nullptr, value) << serial;
+            } else {
+                ASSERT_NE(nullptr, value) << serial;
+                ASSERT_EQ(it->second, *value);
+            }
+        }
+        size_t count = 0;
+        map.forEach([&](const Epc96 &key, const uint64_t &value) {
+            EXPECT_EQ(expected[key], value);
+            count++;
+        });
+        ASSERT_EQ(expected.size(), count);
+    }
+}
+
+TEST(Epc96MapTest, InsertFindErase) {
+    Epc96Map<std::string> map;
+    ASSERT_EQ(nullptr, map.find(sgtin96(1)));
+    ASSERT_TRUE(map.insert(sgtin96(1), "a").second);
+    auto inserted = map.insert(sgtin96(1), "b");
+    ASSERT_FALSE(inserted.second);
+    ASSERT_EQ("a", *inserted.first);
+    map[sgtin96(2)] = "c";
+    ASSERT_EQ("c", *map.find(sgtin96(2)));
+    ASSERT_EQ("", map[sgtin96(3)]);
+    ASSERT_EQ(3, map.size());
+    // Keys differing in the upper bits only
+    ASSERT_TRUE(map.insert(Epc96(0x3174257B, 0xF7194E4000000001), "d")
+                .second);
+    ASSERT_EQ("a", *map.find(sgtin96(1)));
+
+    ASSERT_TRUE(map.erase(sgtin96(1)));
+    ASSERT_FALSE(map.erase(sgtin96(1)));
+    ASSERT_FALSE(map.contains(sgtin96(1)));
+    ASSERT_TRUE(map.contains(sgtin96(2)));
+    ASSERT_EQ(3, map.size());
+
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_FALSE(map.contains(sgtin96(2)));
+}
+
+TEST(Epc96MapTest, Grow) {
+    Epc96Map<std::unique_ptr<int>> map;
+    for (int i = 0; i < 10000; i++) {
+        map[sgtin96(i)].reset(new int(i));
+    }
+    ASSERT_EQ(10000, map.size());
+    ASSERT_LE(10000 * 8 / 7, map.capacity());
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(i, **map.find(sgtin96(i)));
+    }
+
+    Epc96Map<std::unique_ptr<int>> moved(std::move(map));
+    ASSERT_EQ(0, map.size());
+    ASSERT_EQ(10000, moved.size());
+    ASSERT_EQ(5, **moved.find(sgtin96(5)));
+}
+
+TEST(Epc96MapTest, Reserve) {
+    Epc96Map<int> map(1000);
+    size_t capacity = map.capacity();
+    ASSERT_LE(1000 * 8 / 7, capacity);
+    // Erasing and inserting reuses the room without growing.
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 1000; i++) map.insert(sgtin96(round * 1000 + i), i);
+        for (int i = 0; i < 1000; i++) map.erase(sgtin96(round * 1000 + i));
+    }
+    ASSERT_EQ(capacity, map.capacity());
+    ASSERT_EQ(0, map.size());
+}
+
+TEST(Epc96MapTest, FindBatch) {
+    Epc96Map<int> map;
+    for (int i = 0; i < 100; i += 2) map.insert(sgtin96(i), i);
+    std::vector<Epc96> keys;
+    for (int i = 0; i < 100; i++) keys.push_back(sgtin96(i));
+    std::vector<const int *> values(keys.size());
+    ASSERT_EQ(50, map.find(keys.data(), keys.size(), values.data()));
+    for (int i = 0; i < 100; i++) {
+        if (i % 2 == 0) {
+            ASSERT_EQ(i, *values[i]);
+        } else {
+            ASSERT_EQ(nullptr, values[i]);
+        }
+    }
+    Epc96Map<int> empty;
+    ASSERT_EQ(0, empty.find(keys.data(), keys.size(), values.data()));
+    ASSERT_EQ(nullptr, values[0]);
+}
+
+TEST(Epc96MapTest, Random) {
+    test_random<Epc96Map<uint64_t>>();
+}
+
+TEST(Epc96MapTest, PortableGroup) {
+    test_random<Epc96Map<uint64_t, Epc96MapPortableGroup>>();
+}
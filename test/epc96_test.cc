@@ -0,0 +1,72 @@
+#include "epc96.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+using namespace epc;
+
+TEST(Epc96Test, CreateFromBinary) {
+    Epc96 epc;
+    Status status;
+    {
+        std::tie(status, epc) = Epc96::createFromBinary(
+            "3074257BF7194E4000001A85");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(0x3074257BU, epc.getHigh());
+        ASSERT_EQ(0xF7194E4000001A85ULL, epc.getLow());
+        ASSERT_EQ(0x30, epc.getHeader());
+        ASSERT_EQ("3074257BF7194E4000001A85", epc.getBinary());
+    }
+    {
+        std::tie(status, epc) = Epc96::createFromBinary(
+            "3074257bf7194e4000001a85");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("3074257BF7194E4000001A85", epc.getBinary());
+    }
+    // Check for invalid binary
+    {
+        std::tie(status, epc) = Epc96::createFromBinary(
+            "3074257BF7194E4000001A8");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        std::tie(status, epc) = Epc96::createFromBinary(
+            "3074257BF7194E4000001A8G");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
+}
+
+TEST(Epc96Test, Bytes) {
+    const uint8_t bytes[] = {0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19,
+                             0x4E, 0x40, 0x00, 0x00, 0x1A, 0x85};
+    Epc96 epc = Epc96::createFromBytes(bytes);
+    ASSERT_EQ("3074257BF7194E4000001A85", epc.getBinary());
+    uint8_t out[Epc96::BYTES];
+    epc.getBytes(out);
+    ASSERT_EQ(0, std::memcmp(bytes, out, sizeof(out)));
+}
+
+TEST(Epc96Test, GetBits) {
+    Epc96 epc;
+    Status status;
+    std::tie(status, epc) = Epc96::createFromBinary(
+        "3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(0x30, epc.getBits(0, 8));       // Header
+    ASSERT_EQ(3, epc.getBits(8, 3));          // Filter
+    ASSERT_EQ(5, epc.getBits(11, 3));         // Partition
+    ASSERT_EQ(614141, epc.getBits(14, 24));   // Company prefix
+    ASSERT_EQ(812345, epc.getBits(38, 20));   // Item reference
+    ASSERT_EQ(6789, epc.getBits(58, 38));     // Serial
+    ASSERT_EQ(0xF7194E4000001A85ULL, epc.getBits(32, 64));
+    ASSERT_EQ(0, epc.getBits(0, 0));
+}
+
+TEST(Epc96Test, Compare) {
+    ASSERT_TRUE(Epc96(1, 0) == Epc96(1, 0));
+    ASSERT_TRUE(Epc96(1, 0) != Epc96(1, 1));
+    ASSERT_TRUE(Epc96(0, ~0ULL) < Epc96(1, 0));
+    ASSERT_TRUE(Epc96(1, 1) > Epc96(1, 0));
+    ASSERT_TRUE(Epc96(1, 1) <= Epc96(1, 1));
+    ASSERT_TRUE(Epc96(1, 1) >= Epc96(1, 0));
+}
@@ -0,0 +1,216 @@
+#include "epc_index.h"
+#include "layout.h"
+#include "sgtin.h"
+#include "grai.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(unsigned int filter, const std::string &company_prefix,
+                  const std::string &itemref, uint64_t serial) {
+        SGTIN sgtin = SGTIN::create(company_prefix, itemref,
+                                    std::to_string(serial)).second;
+        sgtin.setFilterValue(filter);
+        return Epc96::createFromBinary(sgtin.getBinary().second).second;
+    }
+
+    Epc96 grai96(const std::string &asset_type, uint64_t serial) {
+        GRAI grai = GRAI::create("0614141", asset_type,
+                                 std::to_string(serial)).second;
+        return Epc96::createFromBinary(grai.getBinary().second).second;
+    }
+
+    std::vector<Epc96> collect(const EpcIndex &index, const EpcRange &range) {
+        std::vector<Epc96> epcs;
+        index.scan(range, [&epcs](const Epc96 &epc, uint64_t) {
+            epcs.push_back(epc);
+            return true;
+        });
+        return epcs;
+    }
+}
+
+TEST(EpcIndexTest, InsertAndFind) {
+    EpcIndex index;
+    Epc96 epc = sgtin96(3, "0614141", "812345", 6789);
+    ASSERT_EQ("3074257BF7194E4000001A85", epc.getBinary());
+    ASSERT_FALSE(index.find(epc, nullptr));
+    ASSERT_TRUE(index.insert(epc, 1));
+    ASSERT_TRUE(index.insert(sgtin96(3, "0614141", "812345", 6790), 2));
+    ASSERT_FALSE(index.insert(epc, 3));
+    ASSERT_EQ(2, index.size());
+    uint64_t value;
+    ASSERT_TRUE(index.find(epc, &value));
+    ASSERT_EQ(3, value);
+    ASSERT_FALSE(index.find(sgtin96(3, "0614141", "812345", 6791), &value));
+
+    index.clear();
+    ASSERT_EQ(0, index.size());
+    ASSERT_FALSE(index.find(epc, &value));
+}
+
+TEST(EpcIndexTest, Query) {
+    EpcIndex index;
+    for (uint64_t serial = 0; serial < 100; serial++) {
+        index.insert(sgtin96(1, "0614141", "812345", serial), serial);
+        index.insert(sgtin96(3, "0614141", "812345", serial), serial);
+        index.insert(sgtin96(3, "0614141", "812346", serial), serial);
+        index.insert(sgtin96(3, "0614142", "812345", serial), serial);
+        index.insert(grai96("12345", serial), serial);
+    }
+
+    Status status;
+    size_t count;
+    std::vector<Epc96> epcs;
+    auto visitor = [&epcs](const Epc96 &epc, uint64_t) {
+        epcs.push_back(epc);
+        return true;
+    };
+    std::tie(status, count) = index.scan(
+        make_index_query(0x30, "0614141", "812345"), visitor);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(200, count);
+    // In the order of filter and serial
+    ASSERT_EQ(sgtin96(1, "0614141", "812345", 0), epcs.front());
+    ASSERT_EQ(sgtin96(3, "0614141", "812345", 99), epcs.back());
+    ASSERT_TRUE(std::is_sorted(epcs.begin(), epcs.end()));
+
+    EpcIndexQuery query = make_index_query(0x30, "0614141");
+    query.filter_ = 3;
+    std::tie(status, count) = index.scan(query, visitor);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(200, count);
+
+    query = make_index_query(0x33, "0614141", "12345");
+    query.first_serial_ = 10;
+    query.last_serial_ = 19;
+    epcs.clear();
+    std::tie(status, count) = index.scan(query, visitor);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(10, count);
+    ASSERT_EQ(grai96("12345", 10), epcs.front());
+    ASSERT_EQ(grai96("12345", 19), epcs.back());
+
+    // Stop in the middle
+    std::tie(status, count) = index.scan(
+        make_index_query(0x30, "0614141"),
+        [](const Epc96 &, uint64_t value) { return value < 4; });
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(5, count);
+}
+
+TEST(EpcIndexTest, InvalidQuery) {
+    EpcIndex index;
+    auto visitor = [](const Epc96 &, uint64_t) { return true; };
+    ASSERT_EQ(Status::kInvalidArgument,
+              index.scan(make_index_query(0x36, "0614141"), visitor).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              index.scan(make_index_query(0x30, "06141x1"), visitor).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              index.scan(make_index_query(0x30, "0614141", "81234"),
+                         visitor).first);
+    EpcIndexQuery query = make_index_query(0x30, "0614141");
+    query.filter_ = 8;
+    ASSERT_EQ(Status::kInvalidArgument, index.scan(query, visitor).first);
+}
+
+TEST(EpcIndexTest, ScanPrefix) {
+    EpcIndex index;
+    std::vector<Epc96> epcs;
+    for (uint64_t i = 0; i < 64; i++) {
+        epcs.push_back(Epc96(0x30000000 | static_cast<uint32_t>(i >> 4),
+                             i & 0xF));
+    }
+    index.load(epcs.data(), nullptr, epcs.size());
+    size_t count = index.scanPrefix(Epc96(0x30000002, 0), 32,
+                                    [](const Epc96 &epc, uint64_t value) {
+        EXPECT_EQ(0x30000002, epc.getHigh());
+        EXPECT_EQ(32 + epc.getLow(), value);
+        return true;
+    });
+    ASSERT_EQ(16, count);
+    ASSERT_EQ(64, index.scanPrefix(Epc96(0x30000000, 0), 8,
+                                   [](const Epc96 &, uint64_t) {
+        return true;
+    }));
+    ASSERT_EQ(1, index.scanPrefix(Epc96(0x30000003, 0xF), 96,
+                                  [](const Epc96 &, uint64_t) {
+        return true;
+    }));
+    ASSERT_EQ(0, index.scanPrefix(Epc96(0x31000000, 0), 8,
+                                  [](const Epc96 &, uint64_t) {
+        return true;
+    }));
+}
+
+TEST(EpcIndexTest, Random) {
+    // Compare scans with a sorted set after bulk and incremental inserts.
+    std::set<Epc96> expected;
+    std::vector<Epc96> loaded;
+    uint64_t state = 1;
+    auto next = [&state] {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        // Cluster keys to make long common prefixes.
+        return Epc96(0x30740000 | static_cast<uint32_t>(state >> 62),
+                     state >> 40);
+    };
+    for (int i = 0; i < 2000; i++) loaded.push_back(next());
+    EpcIndex index;
+    index.load(loaded.data(), nullptr, loaded.size());
+    expected.insert(loaded.begin(), loaded.end());
+    for (int i = 0; i < 2000; i++) {
+        Epc96 epc = next();
+        ASSERT_EQ(expected.insert(epc).second, index.insert(epc, i));
+    }
+    loaded.clear();
+    for (int i = 0; i < 500; i++) loaded.push_back(next());
+    index.load(loaded.data(), nullptr, loaded.size());
+    expected.insert(loaded.begin(), loaded.end());
+    ASSERT_EQ(expected.size(), index.size());
+
+    for (int i = 0; i < 200; i++) {
+        EpcRange range = {next(), next()};
+        if (range.last_ < range.first_) std::swap(range.first_, range.last_);
+        std::vector<Epc96> epcs = collect(index, range);
+        std::vector<Epc96> want(expected.lower_bound(range.first_),
+                                expected.upper_bound(range.last_));
+        ASSERT_EQ(want, epcs) << i;
+    }
+    // Bounds hitting keys
+    Epc96 first = *std::next(expected.begin(), 100);
+    Epc96 last = *std::next(expected.begin(), 199);
+    ASSERT_EQ(100, collect(index, EpcRange{first, last}).size());
+}
+
+TEST(EpcIndexTest, RangePrefixes) {
+    std::vector<EpcPrefix> prefixes =
+        get_range_prefixes(EpcRange{Epc96(0x30, 1), Epc96(0x30, 6)});
+    ASSERT_EQ(4, prefixes.size());
+    ASSERT_EQ(Epc96(0x30, 1), prefixes[0].value_);
+    ASSERT_EQ(96, prefixes[0].bits_);
+    ASSERT_EQ(Epc96(0x30, 2), prefixes[1].value_);
+    ASSERT_EQ(95, prefixes[1].bits_);
+    ASSERT_EQ(Epc96(0x30, 4), prefixes[2].value_);
+    ASSERT_EQ(95, prefixes[2].bits_);
+    ASSERT_EQ(Epc96(0x30, 6), prefixes[3].value_);
+    ASSERT_EQ(96, prefixes[3].bits_);
+
+    // A range across the upper and lower words.
+    prefixes = get_range_prefixes(
+        EpcRange{Epc96(0x30, 0), Epc96(0x31, ~0ULL)});
+    ASSERT_EQ(1, prefixes.size());
+    ASSERT_EQ(31, prefixes[0].bits_);
+    prefixes = get_range_prefixes(
+        EpcRange{Epc96(0, 0), Epc96(~0U, ~0ULL)});
+    ASSERT_EQ(1, prefixes.size());
+    ASSERT_EQ(0, prefixes[0].bits_);
+    ASSERT_TRUE(get_range_prefixes(
+        EpcRange{Epc96(0x30, 1), Epc96(0x30, 0)}).empty());
+}
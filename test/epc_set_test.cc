@@ -0,0 +1,137 @@
+#include "epc_set.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(uint64_t serial) {
+        return Epc96(0x3074257B, 0xF7194E4000000000 | serial);
+    }
+
+    std::vector<Epc96> random_epcs(size_t n, uint64_t seed) {
+        std::vector<Epc96> epcs;
+        uint64_t state = seed;
+        for (size_t i = 0; i < n; i++) {
+            state = state * 6364136223846793005 + 1442695040888963407;
+            // Vary the item reference and the serial.
+            epcs.push_back(Epc96(0x3074257B, 0xF700000000000000
+                                 | (state >> 8 & 0xFFFFFFFFFFFFFF)));
+        }
+        return epcs;
+    }
+
+    std::vector<Epc96> sorted(std::vector<Epc96> epcs) {
+        std::sort(epcs.begin(), epcs.end());
+        epcs.erase(std::unique(epcs.begin(), epcs.end()), epcs.end());
+        return epcs;
+    }
+
+    void test_operations(const std::vector<Epc96> &a,
+                         const std::vector<Epc96> &b,
+                         unsigned int thread_count) {
+        EpcSet x = EpcSet::create(a);
+        EpcSet y = EpcSet::create(b);
+        std::vector<Epc96> sa = sorted(a);
+        std::vector<Epc96> sb = sorted(b);
+        std::vector<Epc96> expected;
+        std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                       std::back_inserter(expected));
+        ASSERT_EQ(expected, x.unite(y, thread_count).getEpcs());
+        ASSERT_EQ(expected, y.unite(x, thread_count).getEpcs());
+        expected.clear();
+        std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                              std::back_inserter(expected));
+        ASSERT_EQ(expected, x.intersect(y, thread_count).getEpcs());
+        ASSERT_EQ(expected, y.intersect(x, thread_count).getEpcs());
+        expected.clear();
+        std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                            std::back_inserter(expected));
+        ASSERT_EQ(expected, x.subtract(y, thread_count).getEpcs());
+        expected.clear();
+        std::set_difference(sb.begin(), sb.end(), sa.begin(), sa.end(),
+                            std::back_inserter(expected));
+        ASSERT_EQ(expected, y.subtract(x, thread_count).getEpcs());
+    }
+}
+
+TEST(EpcSetTest, Create) {
+    EpcSet set = EpcSet::create(
+        {sgtin96(3), sgtin96(1), sgtin96(2), sgtin96(1), Epc96(0x34, 0)});
+    ASSERT_EQ(4, set.size());
+    ASSERT_EQ(Epc96(0x34, 0), set[0]);
+    ASSERT_EQ(sgtin96(1), set[1]);
+    ASSERT_EQ(sgtin96(3), set[3]);
+    ASSERT_TRUE(set.contains(sgtin96(2)));
+    ASSERT_FALSE(set.contains(sgtin96(4)));
+    ASSERT_TRUE(EpcSet().empty());
+    ASSERT_TRUE(EpcSet::create(nullptr, 0).empty());
+}
+
+TEST(EpcSetTest, RadixSort) {
+    std::vector<Epc96> epcs = random_epcs(100000, 1);
+    // Duplicates and EPCs differing in the upper bits.
+    epcs.insert(epcs.end(), epcs.begin(), epcs.begin() + 1000);
+    epcs.push_back(Epc96(0x3174257B, 0));
+    epcs.push_back(Epc96(0x3000000, 0));
+    ASSERT_EQ(sorted(epcs), EpcSet::create(epcs).getEpcs());
+    ASSERT_EQ(sorted(epcs),
+              EpcSet::create(epcs.data(), epcs.size()).getEpcs());
+}
+
+TEST(EpcSetTest, Operations) {
+    std::vector<Epc96> a;
+    std::vector<Epc96> b;
+    for (uint64_t serial = 0; serial < 1000; serial++) {
+        if (serial % 2 == 0) a.push_back(sgtin96(serial));
+        if (serial % 3 == 0) b.push_back(sgtin96(serial));
+    }
+    test_operations(a, b, 1);
+    test_operations(a, {}, 1);
+    test_operations({}, {}, 1);
+}
+
+TEST(EpcSetTest, Galloping) {
+    std::vector<Epc96> a = random_epcs(100000, 1);
+    std::vector<Epc96> b = random_epcs(100, 2);
+    b.insert(b.end(), a.begin(), a.begin() + 100);
+    b.push_back(Epc96(0x3074257B, 0xFFFFFFFFFFFFFFFF));
+    b.push_back(Epc96(0x3074257B, 0));
+    test_operations(a, b, 1);
+}
+
+TEST(EpcSetTest, Parallel) {
+    std::vector<Epc96> a = random_epcs(300000, 1);
+    std::vector<Epc96> b = random_epcs(200000, 2);
+    b.insert(b.end(), a.begin(), a.begin() + 100000);
+    test_operations(a, b, 4);
+
+    std::vector<Epc96> c(a.begin(), a.begin() + 1000);
+    c.push_back(Epc96(0x3074257B, 0));
+    test_operations(a, c, 4);
+}
+
+TEST(EpcSetTest, GetURIs) {
+    EpcSet set = EpcSet::create({sgtin96(6789), Epc96(0xFF, 0)});
+    std::vector<std::string> uris = set.getURIs();
+    ASSERT_EQ(2, uris.size());
+    // The unknown header sorts first.
+    ASSERT_EQ("", uris[0]);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", uris[1]);
+    std::vector<std::string> tag_uris = set.getTagURIs();
+    ASSERT_EQ("urn:epc:tag:sgtin-96:3.0614141.812345.6789", tag_uris[1]);
+
+    std::vector<Epc96> epcs;
+    for (uint64_t serial = 0; serial < 200000; serial++) {
+        epcs.push_back(sgtin96(serial));
+    }
+    EpcSet large = EpcSet::create(epcs);
+    std::vector<std::string> parallel = large.getURIs(4);
+    ASSERT_EQ(large.getURIs(), parallel);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.199999", parallel.back());
+}
@@ -0,0 +1,94 @@
+#include "epc_view.h"
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    // Converts hex to bytes, padding odd digits with a zero.
+    std::vector<uint8_t> to_bytes(std::string hex) {
+        if (hex.length() % 2 != 0) hex.push_back('0');
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < hex.length(); i += 2) {
+            bytes.push_back(
+                static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        }
+        return bytes;
+    }
+}
+
+TEST(EpcViewTest, Fields) {
+    std::vector<uint8_t> bytes = to_bytes("3074257BF7194E4000001A85");
+    EpcView view(bytes.data(), bytes.size());
+    ASSERT_EQ(TagType::kSGTIN, view.getType());
+    ASSERT_EQ(0x30, view.getHeader());
+    ASSERT_EQ(96, view.getBitLength());
+    ASSERT_EQ(3, view.getFilterValue());
+    ASSERT_EQ(5, view.getPartition());
+    ASSERT_EQ("0614141", view.getCompanyPrefix());
+    ASSERT_EQ("812345", view.getReference());
+    ASSERT_EQ("6789", view.getSerial());
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", view.getURI());
+    ASSERT_EQ("urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+              view.getTagURI());
+
+    // The fields are cached on first access.
+    bytes[11] = 0;
+    ASSERT_EQ("6789", view.getSerial());
+    EpcView fresh(bytes.data(), bytes.size());
+    ASSERT_EQ("6656", fresh.getSerial());
+}
+
+TEST(EpcViewTest, AllSchemes) {
+    const char *tag_uris[] = {
+        "urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+        "urn:epc:tag:sgtin-198:3.0614141.812345.mW%3Fx%2Fn",
+        "urn:epc:tag:sscc-96:5.0614141.1234567890",
+        "urn:epc:tag:sgln-96:3.0614141.12345.400",
+        "urn:epc:tag:sgln-195:3.0614141.12345.32a%2Fb",
+        "urn:epc:tag:grai-96:3.0614141.12345.5678",
+        "urn:epc:tag:grai-170:3.0614141.12345.32a%2Fb",
+        "urn:epc:tag:giai-96:3.0614141.5678",
+        "urn:epc:tag:giai-202:3.0614141.12345400%3C%3E",
+    };
+    for (const char *tag_uri : tag_uris) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromTagURI(tag_uri);
+        ASSERT_EQ(Status::kOk, status) << tag_uri;
+        std::string hex;
+        std::tie(status, hex) = tag.getBinary();
+        ASSERT_EQ(Status::kOk, status) << tag_uri;
+        std::vector<uint8_t> bytes = to_bytes(hex);
+        EpcView view(bytes.data(), bytes.size());
+        ASSERT_EQ(tag.getType(), view.getType()) << tag_uri;
+        ASSERT_EQ(tag.getURI(), view.getURI()) << tag_uri;
+        ASSERT_EQ(tag.getTagURI(), view.getTagURI()) << tag_uri;
+    }
+}
+
+TEST(EpcViewTest, Unknown) {
+    ASSERT_EQ(TagType::kUnknown, EpcView().getType());
+    ASSERT_EQ("", EpcView().getURI());
+
+    std::vector<uint8_t> bytes = to_bytes("3574257BF7194E4000001A85");
+    EpcView header(bytes.data(), bytes.size());
+    ASSERT_EQ(TagType::kUnknown, header.getType());
+    ASSERT_EQ(0, header.getBitLength());
+    ASSERT_EQ("", header.getCompanyPrefix());
+    ASSERT_EQ("", header.getTagURI());
+
+    bytes = to_bytes("307C257BF7194E4000001A85");
+    ASSERT_EQ(TagType::kUnknown, EpcView(bytes.data(), bytes.size()).getType());
+
+    bytes = to_bytes("3074257BF7194E4000001A85");
+    EpcView truncated(bytes.data(), 11);
+    ASSERT_EQ(TagType::kUnknown, truncated.getType());
+    ASSERT_EQ("", truncated.getSerial());
+}
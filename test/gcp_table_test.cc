@@ -0,0 +1,174 @@
+#include "gcp_table.h"
+#include "gs1.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    std::string temp_path(const char *name) {
+        return std::string(::testing::TempDir()) + name;
+    }
+
+    GcpLengthTable create(const std::vector<GcpLengthTable::Entry> &entries) {
+        return GcpLengthTable::create(entries).second;
+    }
+
+    const std::vector<GcpLengthTable::Entry> ENTRIES = {
+        {"0", 7},
+        {"061", 9},
+        {"0614141", 7},
+        {"020", 0},
+        {"45", 8},
+        {"123456789012", 12},
+    };
+}
+
+TEST(GcpLengthTableTest, Lookup) {
+    GcpLengthTable table = create(ENTRIES);
+    ASSERT_EQ(7, table.lookup("0614141123452"));
+    ASSERT_EQ(9, table.lookup("0615000000000"));
+    ASSERT_EQ(7, table.lookup("0700000000000"));
+    ASSERT_EQ(0, table.lookup("0200000000000"));
+    ASSERT_EQ(8, table.lookup("4512345678901"));
+    ASSERT_EQ(0, table.lookup("4612345678901"));
+    ASSERT_EQ(12, table.lookup("1234567890123"));
+    ASSERT_EQ(0, table.lookup("12345678901"));
+    // Digits end the lookup.
+    ASSERT_EQ(9, table.lookup("061"));
+    ASSERT_EQ(7, table.lookup("06A4141"));
+    ASSERT_EQ(0, table.lookup(""));
+    ASSERT_EQ(0, GcpLengthTable().lookup("0614141"));
+
+    // The last entry wins.
+    table = create({{"0614141", 7}, {"0614141", 8}});
+    ASSERT_EQ(8, table.lookup("0614141"));
+
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::create({{"", 7}}).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::create({{"0614A", 7}}).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::create({{"1234567890123", 7}}).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::create({{"0614141", 13}}).first);
+}
+
+TEST(GcpLengthTableTest, FormatList) {
+    std::string path = temp_path("gcp_table_test.xml");
+    {
+        std::ofstream os(path);
+        os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           << "<GCPPrefixFormatList date=\"2024-01-01T00:00:00Z\">\n"
+           << "  <entry prefix=\"0\" gcpLength=\"7\"/>\n"
+           << "  <entry prefix=\"0614141\" gcpLength=\"7\" />\n"
+           << "  <entry gcpLength=\"12\" prefix=\"123456789012\"/>\n"
+           << "  <entry prefix=\"020\" gcpLength=\"0\"/>\n"
+           << "</GCPPrefixFormatList>\n";
+    }
+    Status status;
+    GcpLengthTable table;
+    std::tie(status, table) = GcpLengthTable::createFromFormatList(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(7, table.lookup("0614141123452"));
+    ASSERT_EQ(12, table.lookup("123456789012"));
+    ASSERT_EQ(0, table.lookup("0200000000000"));
+
+    {
+        std::ofstream os(path);
+        os << "<entry prefix=\"0614141\"/>\n";
+    }
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::createFromFormatList(path).first);
+    std::remove(path.c_str());
+    ASSERT_EQ(Status::kInvalidArgument,
+              GcpLengthTable::createFromFormatList(path).first);
+}
+
+TEST(GcpLengthTableTest, WriteAndOpen) {
+    GcpLengthTable table = create(ENTRIES);
+    std::string path = temp_path("gcp_table_test.epcgcp");
+    ASSERT_EQ(Status::kOk, table.write(path));
+
+    Status status;
+    GcpLengthTable opened;
+    std::tie(status, opened) = GcpLengthTable::open(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(table.getNodeCount(), opened.getNodeCount());
+    for (const char *key : {"0614141123452", "0615000000000", "0200000000000",
+                            "4512345678901", "1234567890123"}) {
+        ASSERT_EQ(table.lookup(key), opened.lookup(key)) << key;
+    }
+
+    // A next node out of the trie.
+    {
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(-4, std::ios::end);
+        uint32_t word = 0xFFFFFFF0;
+        fs.write(reinterpret_cast<const char *>(&word), sizeof(word));
+    }
+    ASSERT_EQ(Status::kInvalidArgument, GcpLengthTable::open(path).first);
+    std::remove(path.c_str());
+    ASSERT_EQ(Status::kInvalidArgument, GcpLengthTable::open(path).first);
+}
+
+TEST(GcpLengthTableTest, Reload) {
+    AtomicGcpLengthTable atomic_table;
+    ASSERT_EQ(nullptr, atomic_table.get());
+    ASSERT_EQ(0, atomic_table.lookup("0614141", 7));
+
+    std::string path = temp_path("gcp_table_test_reload.epcgcp");
+    ASSERT_EQ(Status::kOk, create({{"0614141", 7}}).write(path));
+    ASSERT_EQ(Status::kOk, atomic_table.reload(path));
+    std::shared_ptr<const GcpLengthTable> taken = atomic_table.get();
+    ASSERT_EQ(7, atomic_table.lookup("0614141", 7));
+
+    // Lookups race with reloads.
+    std::thread reader([&atomic_table]() {
+        for (int i = 0; i < 10000; i++) {
+            unsigned int length = atomic_table.lookup("0614141", 7);
+            ASSERT_TRUE(length == 7 || length == 8);
+        }
+    });
+    for (int i = 0; i < 100; i++) {
+        atomic_table.set(std::make_shared<const GcpLengthTable>(
+            create({{"0614141", i % 2 == 0 ? 8U : 7U}})));
+    }
+    reader.join();
+    ASSERT_EQ(7, atomic_table.lookup("0614141", 7));
+    // Tables taken stay valid.
+    ASSERT_EQ(7, taken->lookup("0614141"));
+
+    ASSERT_EQ(Status::kInvalidArgument,
+              atomic_table.reload(temp_path("does-not-exist")));
+    ASSERT_EQ(7, atomic_table.lookup("0614141", 7));
+
+    // Writing a smaller table over the file leaves the mapping of the table
+    // taken intact.
+    ASSERT_EQ(Status::kOk, create({{"1", 8}}).write(path));
+    ASSERT_EQ(Status::kOk, atomic_table.reload(path));
+    ASSERT_EQ(8, atomic_table.lookup("1234567", 7));
+    ASSERT_EQ(7, taken->lookup("0614141"));
+    std::remove(path.c_str());
+}
+
+TEST(GcpLengthTableTest, ParseElementString) {
+    GcpLengthTable table = create(ENTRIES);
+    auto lookup = [&table](const char *digits, size_t n) {
+        return table.lookup(digits, n);
+    };
+    auto tag = parse_element_string("(01)80614141123458(21)6789", lookup);
+    ASSERT_EQ(Status::kOk, tag.first);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", tag.second.getURI());
+    ASSERT_EQ(Status::kInvalidArgument,
+              parse_element_string("(414)0200000000008", lookup).first);
+}
@@ -44,6 +44,12 @@ TEST(GIAITest, CreateFromURI) {
         ASSERT_EQ("0614141", giai.getCompanyPrefix());
         ASSERT_EQ("12345400", giai.getAssetReference());
     }
+    {
+        std::tie(status, giai) = GIAI::createFromURI(
+            "urn:epc:id:giai:0614141.32a%2Fb");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("32a/b", giai.getAssetReference());
+    }
     // Check for invalid uri
     {
         std::tie(status, giai) = GIAI::createFromURI(
@@ -104,6 +110,13 @@ TEST(GIAITest, createFromBinary) {
         ASSERT_EQ(3, giai.getFilterValue());
         ASSERT_EQ(GIAI::Scheme::kGIAI202, giai.getGIAIScheme());
     }
+    // GIAI202 of an asset reference over 8 characters
+    {
+        std::tie(status, giai) = GIAI::createFromBinary(
+            "3874257BF58B266D1AB460C1E3E0000000000000000000000000");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("12345400<>", giai.getAssetReference());
+    }
     // Check for invalid GIAI96
     {
         std::tie(status, giai) = GIAI::createFromBinary(
@@ -116,6 +129,18 @@ TEST(GIAITest, createFromBinary) {
             "3974257BF59B2C2BF10000000000000000000000000000000000");
         ASSERT_EQ(Status::kInvalidArgument, status);
     }
+    // A company prefix of more digits than the partition
+    {
+        std::tie(status, giai) = GIAI::createFromBinary(
+            "341BD0900000000000000001");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
+    // Check for invalid partition
+    {
+        std::tie(status, giai) = GIAI::createFromBinary(
+            "343C00000000000000000000");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
 }
 
 TEST(GIAITest, GetterSetters) {
@@ -212,4 +237,38 @@ TEST(GIAITest, GetBinary) {
         std::tie(status, bin) = giai.getBinary();
         ASSERT_EQ(Status::kInvalidSerial, status);
     }
+    // Test validation for company prefix
+    {
+        std::tie(status, giai) = GIAI::create("06141", "5678");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = giai.getBinary();
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
+    // A GIAI-96 asset reference over the range of int
+    {
+        std::tie(status, giai) = GIAI::create("0614141", "12345678901");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = giai.getBinary();
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, giai) = GIAI::createFromBinary(bin);
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("12345678901", giai.getAssetReference());
+    }
+    // Over the 58 bits of a 7-digit company prefix
+    {
+        std::tie(status, giai) = GIAI::create("0614141", "288230376151711744");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = giai.getBinary();
+        ASSERT_EQ(Status::kInvalidSerial, status);
+    }
+    // Test validation for GIAI202, of 21 characters of a 12-digit company
+    // prefix
+    {
+        std::tie(status, giai) = GIAI::create("061414112345",
+                                              "1234567890123456789012");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(Status::kOk, giai.setGIAIScheme(GIAI::Scheme::kGIAI202));
+        std::tie(status, bin) = giai.getBinary();
+        ASSERT_EQ(Status::kInvalidSerial, status);
+    }
 }
@@ -143,6 +143,12 @@ TEST(GRAITest, createFromBinary) {
             "3774257BF40C0E59B2C2BF10000000000000000000");
         ASSERT_EQ(Status::kInvalidArgument, status);
     }
+    // Check for invalid partition
+    {
+        std::tie(status, grai) = GRAI::createFromBinary(
+            "333C00000000000000000000");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
 }
 
 TEST(GRAITest, GetterSetters) {
@@ -0,0 +1,204 @@
+#include "gs1.h"
+#include "epc96.h"
+#include "epc_view.h"
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Tag from_tag_uri(const std::string &tag_uri) {
+        return Tag::createFromTagURI(tag_uri).second;
+    }
+
+    Epc96 to_epc96(const Tag &tag) {
+        return Epc96::createFromBinary(tag.getBinary().second).second;
+    }
+
+    unsigned int company_prefix_length(const char *digits, size_t n) {
+        return n >= 7 && std::string(digits, 7) == "0614141" ? 7 : 0;
+    }
+
+    // Tag URIs, keys and element strings.
+    const char *CASES[][3] = {
+        {"urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+         "80614141123458", "(01)80614141123458(21)6789"},
+        {"urn:epc:tag:sgtin-198:3.0614141.812345.mW%3Fx",
+         "80614141123458", "(01)80614141123458(21)mW?x"},
+        {"urn:epc:tag:sscc-96:5.0614141.1234567890",
+         "106141412345678908", "(00)106141412345678908"},
+        {"urn:epc:tag:sgln-96:3.0614141.12345.400",
+         "0614141123452", "(414)0614141123452(254)400"},
+        {"urn:epc:tag:sgln-96:3.0614141.12345.0",
+         "0614141123452", "(414)0614141123452"},
+        {"urn:epc:tag:grai-96:3.0614141.12345.400",
+         "00614141123452400", "(8003)00614141123452400"},
+        {"urn:epc:tag:grai-170:3.0614141.12345.32a%2Fb",
+         "0061414112345232a/b", "(8003)0061414112345232a/b"},
+        {"urn:epc:tag:giai-96:3.0614141.12345400",
+         "061414112345400", "(8004)061414112345400"},
+        {"urn:epc:tag:giai-202:3.0614141.12345400%3C",
+         "061414112345400<", "(8004)061414112345400<"},
+    };
+}
+
+TEST(GS1Test, CheckDigit) {
+    ASSERT_EQ(8, get_check_digit("8061414112345", 13));
+    ASSERT_EQ(8, get_check_digit("10614141234567890", 17));
+    ASSERT_EQ(2, get_check_digit("061414112345", 12));
+    ASSERT_EQ(0, get_check_digit("", 0));
+    ASSERT_EQ(7, get_check_digit("1", 1));
+    ASSERT_EQ(0, get_check_digit("000000000000000000000000", 24));
+    ASSERT_EQ(8, get_check_digit("999999999999999999999999", 24));
+
+    // Compared with the weighted sum digit by digit.
+    std::string digits;
+    for (size_t n = 0; n <= MAX_CHECK_DIGIT_DIGITS; n++) {
+        unsigned int sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += (digits[n - 1 - i] - '0') * (i % 2 == 0 ? 3 : 1);
+        }
+        ASSERT_EQ((10 - sum % 10) % 10, get_check_digit(digits.data(), n))
+            << digits;
+        digits.push_back(static_cast<char>('0' + (n * 7 + 3) % 10));
+    }
+}
+
+TEST(GS1Test, ElementString) {
+    for (const auto &c : CASES) {
+        Tag tag = from_tag_uri(c[0]);
+        ASSERT_EQ(std::make_pair(Status::kOk, std::string(c[1])),
+                  get_gs1_key(tag)) << c[0];
+        ASSERT_EQ(std::make_pair(Status::kOk, std::string(c[2])),
+                  get_element_string(tag)) << c[0];
+
+        std::string hex = tag.getBinary().second;
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i + 1 < hex.length(); i += 2) {
+            bytes.push_back(static_cast<uint8_t>(
+                std::stoi(hex.substr(i, 2), nullptr, 16)));
+        }
+        bytes.push_back(0);
+        EpcView view(bytes.data(), bytes.size());
+        ASSERT_EQ(std::string(c[1]), get_gs1_key(view).second) << c[0];
+        ASSERT_EQ(std::string(c[2]), get_element_string(view).second)
+            << c[0];
+
+        if (hex.length() == 24) {
+            Epc96 epc = to_epc96(tag);
+            ASSERT_EQ(std::string(c[1]), get_gs1_key(epc).second) << c[0];
+            ASSERT_EQ(std::string(c[2]), get_element_string(epc).second)
+                << c[0];
+        }
+    }
+
+    ASSERT_EQ(Status::kInvalidArgument, get_gs1_key(Tag()).first);
+    ASSERT_EQ(Status::kInvalidArgument, get_element_string(SGTIN()).first);
+    ASSERT_EQ(Status::kInvalidArgument, get_element_string(Epc96()).first);
+    // A company prefix of more digits than its partition.
+    ASSERT_EQ(Status::kInvalidArgument,
+              get_gs1_key(Epc96(0x3074FFFF, ~0ULL)).first);
+}
+
+TEST(GS1Test, Batch) {
+    std::vector<Epc96> epcs;
+    epcs.push_back(to_epc96(
+        from_tag_uri("urn:epc:tag:sgtin-96:3.0614141.812345.6789")));
+    epcs.push_back(Epc96());
+    epcs.push_back(to_epc96(
+        from_tag_uri("urn:epc:tag:sscc-96:5.0614141.1234567890")));
+
+    std::string buffer = "stale";
+    std::vector<size_t> offsets(epcs.size() + 1);
+    ASSERT_EQ(2, get_element_strings(epcs.data(), epcs.size(), buffer,
+                                     offsets.data()));
+    ASSERT_EQ("(01)80614141123458(21)6789(00)106141412345678908", buffer);
+    ASSERT_EQ(std::vector<size_t>({0, 26, 26, 48}), offsets);
+
+    ASSERT_EQ(2, get_gs1_keys(epcs.data(), epcs.size(), buffer,
+                              offsets.data()));
+    ASSERT_EQ("80614141123458106141412345678908", buffer);
+    ASSERT_EQ(std::vector<size_t>({0, 14, 14, 32}), offsets);
+}
+
+TEST(GS1Test, ParseElementString) {
+    for (const auto &c : CASES) {
+        // Element strings have no filter values; the one of the tag is
+        // given.
+        unsigned int filter = from_tag_uri(c[0]).getEPC().getFilterValue();
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = parse_element_string(
+            c[2], company_prefix_length, filter);
+        ASSERT_EQ(Status::kOk, status) << c[2];
+        ASSERT_EQ(c[0], tag.getTagURI());
+
+        Epc96 epc;
+        std::tie(status, epc) = parse_element_string_to_epc96(
+            c[2], company_prefix_length, filter);
+        if (tag.getBinary().second.length() == 24) {
+            ASSERT_EQ(Status::kOk, status) << c[2];
+            ASSERT_EQ(to_epc96(tag), epc) << c[2];
+        } else {
+            ASSERT_EQ(Status::kInvalidArgument, status) << c[2];
+        }
+    }
+
+    // The raw form.
+    const char *raw[] = {
+        "0180614141123458216789",
+        "]C10180614141123458216789",
+        "]d2\x1D" "0180614141123458\x1D" "216789",
+        "216789\x1D" "0180614141123458",
+    };
+    for (const char *s : raw) {
+        auto tag = parse_element_string(s, company_prefix_length);
+        ASSERT_EQ(Status::kOk, tag.first) << s;
+        ASSERT_EQ("urn:epc:tag:sgtin-96:0.0614141.812345.6789",
+                  tag.second.getTagURI());
+    }
+    ASSERT_EQ("urn:epc:tag:sgln-96:0.0614141.12345.400",
+              parse_element_string("4140614141123452\x1D" "254400",
+                                   company_prefix_length)
+                  .second.getTagURI());
+
+    const char *invalid[] = {
+        "",
+        "(01)80614141123457(21)6789",
+        "(01)80614141123458",
+        "(21)6789",
+        "(01)80614141123458(21)6789(21)6790",
+        "(00)106141412345678908(01)80614141123458",
+        "(10)ABC",
+        "(01)8061414112345(21)6789",
+        "(01)80614141123458(21)",
+        "(01)80614141123458(21)123456789012345678901",
+        "(8003)10614141123452400",
+        "(8003)00614141123452",
+        "(01)80614151123457(21)6789",
+        "(01)80614141123458)21(6789",
+        "01806141411234",
+        "0180614141123458\x1D\x1D" "216789",
+    };
+    for (const char *s : invalid) {
+        ASSERT_EQ(Status::kInvalidArgument,
+                  parse_element_string(s, company_prefix_length).first) << s;
+        ASSERT_EQ(Status::kInvalidArgument,
+                  parse_element_string_to_epc96(s, company_prefix_length)
+                      .first) << s;
+    }
+    ASSERT_EQ(Status::kInvalidArgument,
+              parse_element_string("(01)80614141123458(21)6789",
+                                   company_prefix_length, 8).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              parse_element_string_to_epc96("(01)80614141123458(21)6789",
+                                            company_prefix_length, 8).first);
+}
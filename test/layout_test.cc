@@ -0,0 +1,67 @@
+#include "layout.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+using namespace epc;
+
+TEST(LayoutTest, GetLayout) {
+    Status status;
+    Layout layout;
+    std::tie(status, layout) = get_layout(0x30, 5);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(96, layout.bits_);
+    ASSERT_EQ(24, layout.company_prefix_bits_);
+    ASSERT_EQ(7, layout.company_prefix_digits_);
+    ASSERT_EQ(20, layout.reference_bits_);
+    ASSERT_EQ(6, layout.reference_digits_);
+    ASSERT_EQ(38, layout.serial_bits_);
+    ASSERT_EQ(38, layout.getReferenceOffset());
+    ASSERT_EQ(58, layout.getSerialOffset());
+
+    std::tie(status, layout) = get_layout(0x32, "0614141");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(5, layout.partition_);
+    ASSERT_EQ(96, layout.getSerialOffset() + layout.serial_bits_);
+
+    std::tie(status, layout) = get_layout(0x31, "061414112");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(3, layout.partition_);
+    ASSERT_EQ(0, layout.serial_bits_);
+
+    std::tie(status, layout) = get_layout(0x38, 0);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(202, layout.bits_);
+    ASSERT_EQ(148, layout.reference_bits_);
+}
+
+TEST(LayoutTest, GetLayoutOfEpc) {
+    Status status;
+    Epc96 epc;
+    Layout layout;
+    std::tie(status, epc) = Epc96::createFromBinary("3074257BF7194E4000001A85");
+    ASSERT_EQ(Status::kOk, status);
+    std::tie(status, layout) = get_layout(epc);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(0x30, layout.header_);
+    ASSERT_EQ(5, layout.partition_);
+    ASSERT_EQ(614141, epc.getBits(LAYOUT_COMPANY_PREFIX_OFFSET,
+                                  layout.company_prefix_bits_));
+    ASSERT_EQ(812345, epc.getBits(layout.getReferenceOffset(),
+                                  layout.reference_bits_));
+    ASSERT_EQ(6789, epc.getBits(layout.getSerialOffset(),
+                                layout.serial_bits_));
+}
+
+TEST(LayoutTest, Invalid) {
+    ASSERT_EQ(Status::kInvalidArgument, get_layout(0x35, 0).first);
+    ASSERT_EQ(Status::kInvalidArgument, get_layout(0x30, 7).first);
+    ASSERT_EQ(Status::kInvalidArgument, get_layout(0x30, "06141").first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              get_layout(0x30, "0614141123456").first);
+    // 96-bit schemes only
+    ASSERT_EQ(Status::kInvalidArgument,
+              get_layout(Epc96(0x3674257B, 0)).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              get_layout(Epc96(0x307C257B, 0)).first);
+}
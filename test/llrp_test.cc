@@ -0,0 +1,277 @@
+#include "llrp.h"
+#include "status.h"
+#include "tag.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    using Bytes = std::vector<uint8_t>;
+
+    const Bytes SGTIN96 = {0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19,
+                           0x4E, 0x40, 0x00, 0x00, 0x1A, 0x85};
+    const Bytes GIAI202 = {0x38, 0x74, 0x25, 0x7B, 0xF5, 0x9B, 0x2C,
+                           0x2B, 0xF1, 0x00, 0x00, 0x00, 0x00, 0x00,
+                           0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                           0x00, 0x00, 0x00, 0x00, 0x00};
+
+    void append_u16(Bytes &out, uint16_t value) {
+        out.push_back(value >> 8);
+        out.push_back(value & 0xFF);
+    }
+
+    void append_u32(Bytes &out, uint32_t value) {
+        append_u16(out, value >> 16);
+        append_u16(out, value & 0xFFFF);
+    }
+
+    void append_u64(Bytes &out, uint64_t value) {
+        append_u32(out, value >> 32);
+        append_u32(out, value & 0xFFFFFFFF);
+    }
+
+    Bytes tlv(uint16_t type, const Bytes &value) {
+        Bytes out;
+        append_u16(out, type);
+        append_u16(out, 4 + value.size());
+        out.insert(out.end(), value.begin(), value.end());
+        return out;
+    }
+
+    Bytes tv(uint8_t type, const Bytes &value) {
+        Bytes out(1 + value.size());
+        out[0] = static_cast<uint8_t>(0x80 | type);
+        std::copy(value.begin(), value.end(), out.begin() + 1);
+        return out;
+    }
+
+    Bytes concat(const std::vector<Bytes> &parts) {
+        Bytes out;
+        for (const auto &part : parts) {
+            out.insert(out.end(), part.begin(), part.end());
+        }
+        return out;
+    }
+
+    Bytes message(uint16_t type, uint32_t id, const Bytes &body) {
+        Bytes out;
+        append_u16(out, 1 << 10 | type);
+        append_u32(out, 10 + body.size());
+        append_u32(out, id);
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+    Bytes epc96(const Bytes &epc) {
+        return tv(13, epc);
+    }
+
+    Bytes epc_data(const Bytes &epc, uint16_t bits) {
+        Bytes value;
+        append_u16(value, bits);
+        value.insert(value.end(), epc.begin(), epc.end());
+        return tlv(241, value);
+    }
+
+    Bytes antenna(uint16_t id) {
+        Bytes value;
+        append_u16(value, id);
+        return tv(1, value);
+    }
+
+    Bytes timestamp(uint8_t type, uint64_t us) {
+        Bytes value;
+        append_u64(value, us);
+        return tv(type, value);
+    }
+
+    Bytes report_message(uint32_t id) {
+        return message(61, id, concat({
+            tlv(240, concat({
+                epc96(SGTIN96),
+                tv(9, {0, 0, 0, 1}),           // ROSpecID
+                tv(14, {0, 1}),                // SpecIndex
+                antenna(2),
+                tv(6, {0xC4}),                 // PeakRSSI -60
+                tv(7, {0, 5}),                 // ChannelIndex
+                timestamp(2, 1633046400000000),
+                timestamp(4, 1633046400500000),
+                tv(8, {0, 3}),                 // TagSeenCount
+                tlv(1023, {0, 0, 0x6A, 0x1B}), // Custom
+            })),
+            tlv(240, concat({
+                epc_data(GIAI202, 202),
+                tv(12, {0x34, 0x00}),          // C1G2PC
+                antenna(1),
+                timestamp(3, 123456),
+            })),
+        }));
+    }
+
+    std::vector<LLRPTagReport> walk(const Bytes &message) {
+        std::vector<LLRPTagReport> reports;
+        EXPECT_EQ(Status::kOk,
+                  walk_llrp_tag_reports(
+                      message.data(), message.size(),
+                      [&reports](const LLRPTagReport &report) {
+                          reports.push_back(report);
+                      }));
+        return reports;
+    }
+}
+
+TEST(LLRPTest, ParseMessageHeader) {
+    Bytes m = message(62, 0x12345678, {});
+    Status status;
+    LLRPMessageHeader header;
+    std::tie(status, header) = parse_llrp_message_header(m.data(), m.size());
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(1, header.version_);
+    ASSERT_EQ(62, header.type_);
+    ASSERT_EQ(10, header.length_);
+    ASSERT_EQ(0x12345678, header.id_);
+
+    std::tie(status, header) = parse_llrp_message_header(m.data(), 9);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    m[5] = 9;
+    std::tie(status, header) = parse_llrp_message_header(m.data(), m.size());
+    ASSERT_EQ(Status::kInvalidArgument, status);
+}
+
+TEST(LLRPTest, WalkTagReports) {
+    Bytes m = report_message(1);
+    std::vector<LLRPTagReport> reports = walk(m);
+    ASSERT_EQ(2, reports.size());
+
+    const LLRPTagReport &first = reports[0];
+    ASSERT_EQ(96, first.epc_bits_);
+    // EPCs point into the message.
+    ASSERT_LE(m.data(), first.epc_);
+    ASSERT_GT(m.data() + m.size(), first.epc_);
+    ASSERT_EQ(SGTIN96, Bytes(first.epc_, first.epc_ + 12));
+    ASSERT_TRUE(first.has_antenna_);
+    ASSERT_EQ(2, first.antenna_);
+    ASSERT_TRUE(first.has_peak_rssi_);
+    ASSERT_EQ(-60, first.peak_rssi_);
+    ASSERT_TRUE(first.has_first_seen_utc_);
+    ASSERT_EQ(1633046400000000, first.first_seen_utc_);
+    ASSERT_FALSE(first.has_first_seen_uptime_);
+
+    const LLRPTagReport &second = reports[1];
+    ASSERT_EQ(202, second.epc_bits_);
+    ASSERT_EQ(GIAI202, Bytes(second.epc_, second.epc_ + 26));
+    ASSERT_EQ(1, second.antenna_);
+    ASSERT_FALSE(second.has_peak_rssi_);
+    ASSERT_FALSE(second.has_first_seen_utc_);
+    ASSERT_TRUE(second.has_first_seen_uptime_);
+    ASSERT_EQ(123456, second.first_seen_uptime_);
+}
+
+TEST(LLRPTest, DecodeTagReport) {
+    Bytes m = report_message(1);
+    std::vector<LLRPTagReport> reports = walk(m);
+    ASSERT_EQ(2, reports.size());
+    Status status;
+    Tag tag;
+    std::tie(status, tag) = decode_llrp_tag_report(reports[0]);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", tag.getURI());
+    std::tie(status, tag) = decode_llrp_tag_report(reports[1]);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:id:giai:0614141.32a%2Fb", tag.getURI());
+
+    std::tie(status, tag) = decode_llrp_tag_report(LLRPTagReport());
+    ASSERT_EQ(Status::kInvalidArgument, status);
+}
+
+TEST(LLRPTest, WalkMalformed) {
+    auto noop = [](const LLRPTagReport &) {};
+    // Not an RO_ACCESS_REPORT
+    Bytes keepalive = message(62, 1, {});
+    ASSERT_EQ(Status::kInvalidArgument,
+              walk_llrp_tag_reports(keepalive.data(), keepalive.size(), noop));
+    // Truncated
+    Bytes m = report_message(1);
+    ASSERT_EQ(Status::kInvalidArgument,
+              walk_llrp_tag_reports(m.data(), m.size() - 1, noop));
+    // Unknown TV parameter
+    Bytes unknown_tv = message(61, 1, tlv(240, concat({
+        epc96(SGTIN96), Bytes{0x80 | 100, 0, 0}})));
+    ASSERT_EQ(Status::kInvalidArgument,
+              walk_llrp_tag_reports(unknown_tv.data(), unknown_tv.size(),
+                                    noop));
+    // EPCData longer than the parameter
+    Bytes long_epc = message(61, 1, tlv(240, epc_data(SGTIN96, 104)));
+    ASSERT_EQ(Status::kInvalidArgument,
+              walk_llrp_tag_reports(long_epc.data(), long_epc.size(), noop));
+    // TagReportData without EPC
+    Bytes no_epc = message(61, 1, tlv(240, antenna(1)));
+    ASSERT_EQ(Status::kInvalidArgument,
+              walk_llrp_tag_reports(no_epc.data(), no_epc.size(), noop));
+    // Empty report
+    Bytes empty = message(61, 1, {});
+    ASSERT_EQ(0, walk(empty).size());
+}
+
+TEST(LLRPTest, ReplayFile) {
+    // A recording of a reader connection: reports and keepalives
+    // interleaved.
+    Bytes recording = concat({
+        message(62, 100, {}),
+        report_message(101),
+        report_message(102),
+        message(62, 103, {}),
+        report_message(104),
+    });
+    std::string path = std::string(::testing::TempDir()) + "llrp_replay.bin";
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char *>(recording.data()),
+                  recording.size());
+    }
+
+    // Replay the file in small reads, carrying incomplete messages over to
+    // the next read as a client of a live reader does.
+    std::ifstream ifs(path, std::ios::binary);
+    Bytes buffer;
+    std::vector<uint32_t> ids;
+    std::vector<std::string> uris;
+    char chunk[7];
+    while (ifs.read(chunk, sizeof(chunk)) || ifs.gcount() > 0) {
+        buffer.insert(buffer.end(), chunk, chunk + ifs.gcount());
+        Status status;
+        size_t consumed;
+        std::tie(status, consumed) = walk_llrp_messages(
+            buffer.data(), buffer.size(),
+            [&](const LLRPMessageHeader &header, const uint8_t *message) {
+                ids.push_back(header.id_);
+                if (header.type_ != LLRP_RO_ACCESS_REPORT) return;
+                Status s = walk_llrp_tag_reports(
+                    message, header.length_,
+                    [&](const LLRPTagReport &report) {
+                        Status status;
+                        Tag tag;
+                        std::tie(status, tag) = decode_llrp_tag_report(report);
+                        ASSERT_EQ(Status::kOk, status);
+                        uris.push_back(tag.getURI());
+                    });
+                ASSERT_EQ(Status::kOk, s);
+            });
+        ASSERT_EQ(Status::kOk, status);
+        buffer.erase(buffer.begin(), buffer.begin() + consumed);
+    }
+    std::remove(path.c_str());
+
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ((std::vector<uint32_t>{100, 101, 102, 103, 104}), ids);
+    ASSERT_EQ(6, uris.size());
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", uris[4]);
+    ASSERT_EQ("urn:epc:id:giai:0614141.32a%2Fb", uris[5]);
+}
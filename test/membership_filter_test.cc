@@ -0,0 +1,210 @@
+#include "membership_filter.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    std::string temp_path(const char *name) {
+        return std::string(::testing::TempDir()) + name;
+    }
+
+    Epc96 sgtin96(uint64_t serial) {
+        return Epc96(0x3074257B, 0xF7194E4000000000 | serial);
+    }
+
+    std::vector<Epc96> sgtin96s(uint64_t first, size_t n) {
+        std::vector<Epc96> epcs;
+        for (size_t i = 0; i < n; i++) epcs.push_back(sgtin96(first + i));
+        return epcs;
+    }
+}
+
+TEST(BloomFilterTest, MayContain) {
+    Status status;
+    BloomFilter filter;
+    std::tie(status, filter) = BloomFilter::create(10000, 0.01);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(BloomFilter::estimateBytes(10000, 0.01), filter.getBytes());
+    for (uint64_t i = 0; i < 10000; i++) filter.insert(sgtin96(i));
+    ASSERT_EQ(10000, filter.size());
+    ASSERT_GE(0.01, filter.getFalsePositiveRate());
+
+    for (uint64_t i = 0; i < 10000; i++) {
+        ASSERT_TRUE(filter.mayContain(sgtin96(i))) << i;
+    }
+    size_t false_positives = 0;
+    for (uint64_t i = 10000; i < 110000; i++) {
+        if (filter.mayContain(sgtin96(i))) false_positives++;
+    }
+    ASSERT_GT(1500, false_positives);
+
+    std::vector<Epc96> epcs = sgtin96s(9900, 200);
+    std::vector<uint64_t> mask(4);
+    size_t count = filter.mayContain(epcs.data(), epcs.size(), mask.data());
+    ASSERT_LE(100, count);
+    for (size_t i = 0; i < epcs.size(); i++) {
+        bool bit = (mask[i / 64] >> (i % 64) & 1) == 1;
+        ASSERT_EQ(filter.mayContain(epcs[i]), bit) << i;
+    }
+}
+
+TEST(BloomFilterTest, Sizing) {
+    ASSERT_EQ(0, BloomFilter::estimateBytes(100, 0));
+    ASSERT_EQ(0, BloomFilter::estimateBytes(100, 1));
+    ASSERT_EQ(Status::kInvalidArgument, BloomFilter::create(100, 2).first);
+    // About 10 bits per key for 1%, and more for blocks
+    size_t bytes = BloomFilter::estimateBytes(1000000, 0.01);
+    ASSERT_LT(1200000, bytes);
+    ASSERT_GT(1600000, bytes);
+    ASSERT_LT(bytes, BloomFilter::estimateBytes(1000000, 0.001));
+    ASSERT_EQ(64, BloomFilter::estimateBytes(0, 0.01));
+}
+
+TEST(BloomFilterTest, WriteAndOpen) {
+    Status status;
+    BloomFilter filter;
+    std::tie(status, filter) = BloomFilter::create(1000, 0.01);
+    for (uint64_t i = 0; i < 1000; i++) filter.insert(sgtin96(i));
+    std::string path = temp_path("bloom_filter_test.epcbloom");
+    ASSERT_EQ(Status::kOk, filter.write(path));
+
+    BloomFilter opened;
+    std::tie(status, opened) = BloomFilter::open(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(1000, opened.size());
+    ASSERT_EQ(filter.getBytes(), opened.getBytes());
+    ASSERT_EQ(filter.getHashCount(), opened.getHashCount());
+    for (uint64_t i = 0; i < 5000; i++) {
+        ASSERT_EQ(filter.mayContain(sgtin96(i)), opened.mayContain(sgtin96(i)));
+    }
+    // Inserts aren't written back.
+    BloomFilter moved = std::move(opened);
+    moved.insert(sgtin96(5000));
+    ASSERT_TRUE(moved.mayContain(sgtin96(5000)));
+    std::tie(status, opened) = BloomFilter::open(path);
+    ASSERT_EQ(1000, opened.size());
+    std::remove(path.c_str());
+}
+
+TEST(BloomFilterTest, OpenInvalid) {
+    ASSERT_EQ(Status::kInvalidArgument,
+              BloomFilter::open(temp_path("does-not-exist")).first);
+    std::string path = temp_path("bloom_filter_test_invalid.epcbloom");
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << "EPCBLOOM";
+    }
+    ASSERT_EQ(Status::kInvalidArgument, BloomFilter::open(path).first);
+    // Truncated
+    BloomFilter filter = BloomFilter::create(1000, 0.01).second;
+    ASSERT_EQ(Status::kOk, filter.write(path));
+    {
+        std::ifstream is(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(is)),
+                          std::istreambuf_iterator<char>());
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        os.write(bytes.data(), bytes.size() - 8);
+    }
+    ASSERT_EQ(Status::kInvalidArgument, BloomFilter::open(path).first);
+    // Of another kind
+    ASSERT_EQ(Status::kOk, CuckooFilter::create(1000).write(path));
+    ASSERT_EQ(Status::kInvalidArgument, BloomFilter::open(path).first);
+    std::remove(path.c_str());
+}
+
+TEST(BloomFilterTest, Empty) {
+    std::vector<Epc96> epcs = sgtin96s(0, 10);
+    std::vector<uint64_t> mask(1, ~0ULL);
+    std::vector<BloomFilter> filters(3);
+    filters[1] = BloomFilter::open(temp_path("does-not-exist")).second;
+    filters[2] = BloomFilter::create(1000, 0.01).second;
+    filters[2].insert(epcs[0]);
+    BloomFilter moved = std::move(filters[2]);
+    ASSERT_TRUE(moved.mayContain(epcs[0]));
+    for (BloomFilter &filter : filters) {
+        filter.insert(epcs[0]);
+        ASSERT_EQ(0, filter.size());
+        ASSERT_EQ(0, filter.getBytes());
+        ASSERT_FALSE(filter.mayContain(epcs[0]));
+        ASSERT_EQ(0, filter.mayContain(epcs.data(), epcs.size(),
+                                       mask.data()));
+        ASSERT_EQ(0, mask[0]);
+    }
+}
+
+TEST(CuckooFilterTest, InsertAndRemove) {
+    CuckooFilter filter = CuckooFilter::create(10000);
+    ASSERT_EQ(CuckooFilter::estimateBytes(10000), filter.getBytes());
+    ASSERT_LE(10000, filter.capacity());
+    for (uint64_t i = 0; i < 10000; i++) {
+        ASSERT_TRUE(filter.insert(sgtin96(i))) << i;
+    }
+    ASSERT_EQ(10000, filter.size());
+    for (uint64_t i = 0; i < 10000; i++) {
+        ASSERT_TRUE(filter.mayContain(sgtin96(i))) << i;
+    }
+    size_t false_positives = 0;
+    for (uint64_t i = 10000; i < 110000; i++) {
+        if (filter.mayContain(sgtin96(i))) false_positives++;
+    }
+    ASSERT_GT(100000 * CuckooFilter::FALSE_POSITIVE_RATE * 2,
+              false_positives);
+
+    for (uint64_t i = 0; i < 10000; i += 2) {
+        ASSERT_TRUE(filter.remove(sgtin96(i))) << i;
+    }
+    ASSERT_EQ(5000, filter.size());
+    for (uint64_t i = 1; i < 10000; i += 2) {
+        ASSERT_TRUE(filter.mayContain(sgtin96(i))) << i;
+    }
+    std::vector<Epc96> epcs = sgtin96s(0, 100);
+    std::vector<uint64_t> mask(2);
+    ASSERT_LE(50, filter.mayContain(epcs.data(), epcs.size(), mask.data()));
+    for (size_t i = 0; i < epcs.size(); i++) {
+        bool bit = (mask[i / 64] >> (i % 64) & 1) == 1;
+        ASSERT_EQ(filter.mayContain(epcs[i]), bit) << i;
+    }
+}
+
+TEST(CuckooFilterTest, Full) {
+    CuckooFilter filter = CuckooFilter::create(100);
+    uint64_t i = 0;
+    while (filter.insert(sgtin96(i))) i++;
+    ASSERT_LE(filter.capacity() * 0.9, i);
+    ASSERT_EQ(i, filter.size());
+    // All inserted keys are held, including the one left as the victim.
+    for (uint64_t j = 0; j < i; j++) {
+        ASSERT_TRUE(filter.mayContain(sgtin96(j))) << j;
+    }
+    // Removing a key makes room.
+    ASSERT_TRUE(filter.remove(sgtin96(0)));
+    for (uint64_t j = 1; j < i; j++) {
+        ASSERT_TRUE(filter.mayContain(sgtin96(j))) << j;
+    }
+}
+
+TEST(CuckooFilterTest, WriteAndOpen) {
+    CuckooFilter filter = CuckooFilter::create(1000);
+    for (uint64_t i = 0; i < 1000; i++) filter.insert(sgtin96(i));
+    std::string path = temp_path("cuckoo_filter_test.epccuckoo");
+    ASSERT_EQ(Status::kOk, filter.write(path));
+
+    Status status;
+    CuckooFilter opened;
+    std::tie(status, opened) = CuckooFilter::open(path);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(1000, opened.size());
+    ASSERT_EQ(filter.capacity(), opened.capacity());
+    for (uint64_t i = 0; i < 5000; i++) {
+        ASSERT_EQ(filter.mayContain(sgtin96(i)), opened.mayContain(sgtin96(i)));
+    }
+    ASSERT_TRUE(opened.remove(sgtin96(0)));
+    ASSERT_EQ(Status::kInvalidArgument, BloomFilter::open(path).first);
+    std::remove(path.c_str());
+}
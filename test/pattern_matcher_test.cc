@@ -0,0 +1,169 @@
+#include "pattern_matcher.h"
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 from_tag_uri(const std::string &tag_uri) {
+        Tag tag = Tag::createFromTagURI(tag_uri).second;
+        return Epc96::createFromBinary(tag.getBinary().second).second;
+    }
+
+    bool matches(const std::string &pattern, const std::string &tag_uri) {
+        PatternMatcher matcher = PatternMatcher::create({pattern}).second;
+        return matcher.matches(from_tag_uri(tag_uri));
+    }
+}
+
+TEST(PatternMatcherTest, PureIdentityPattern) {
+    std::string tag = "urn:epc:tag:sgtin-96:3.0614141.812345.6789";
+    ASSERT_TRUE(matches("urn:epc:idpat:sgtin:0614141.812345.6789", tag));
+    ASSERT_TRUE(matches("urn:epc:idpat:sgtin:0614141.812345.*", tag));
+    ASSERT_TRUE(matches("urn:epc:idpat:sgtin:0614141.*.*", tag));
+    ASSERT_TRUE(matches("urn:epc:idpat:sgtin:*.*.*", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:0614141.812345.6790", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:0614141.812346.*", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:0614142.*.*", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:061414.*.*", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sscc:*.*", tag));
+    // Not encoded in 96 bits.
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:0614141.812345.06789", tag));
+    ASSERT_FALSE(matches("urn:epc:idpat:sgtin:0614141.812345.A", tag));
+
+    ASSERT_TRUE(matches("urn:epc:idpat:sscc:0614141.1234567890",
+                        "urn:epc:tag:sscc-96:0.0614141.1234567890"));
+    ASSERT_TRUE(matches("urn:epc:idpat:sgln:0614141.12345.*",
+                        "urn:epc:tag:sgln-96:1.0614141.12345.400"));
+    ASSERT_TRUE(matches("urn:epc:idpat:grai:0614141.12345.400",
+                        "urn:epc:tag:grai-96:2.0614141.12345.400"));
+    ASSERT_TRUE(matches("urn:epc:idpat:giai:0614141.*",
+                        "urn:epc:tag:giai-96:3.0614141.12345400"));
+    ASSERT_FALSE(matches("urn:epc:idpat:giai:0614141.12345401",
+                         "urn:epc:tag:giai-96:3.0614141.12345400"));
+    // Not encoded in 96 bits.
+    ASSERT_FALSE(matches("urn:epc:idpat:giai:0614141.0123",
+                         "urn:epc:tag:giai-96:3.0614141.123"));
+    ASSERT_FALSE(matches("urn:epc:idpat:giai:0614141.A",
+                         "urn:epc:tag:giai-96:3.0614141.123"));
+    ASSERT_TRUE(matches("urn:epc:idpat:giai:0614141.123",
+                        "urn:epc:tag:giai-96:3.0614141.123"));
+}
+
+TEST(PatternMatcherTest, TagPattern) {
+    std::string tag = "urn:epc:tag:sgtin-96:3.0614141.812345.6789";
+    ASSERT_TRUE(matches("urn:epc:pat:sgtin-96:3.0614141.812345.6789", tag));
+    ASSERT_TRUE(matches("urn:epc:pat:sgtin-96:*.0614141.812345.*", tag));
+    ASSERT_TRUE(matches("urn:epc:pat:sgtin-96:[2-4].*.*.*", tag));
+    ASSERT_TRUE(
+        matches("urn:epc:pat:sgtin-96:3.0614141.812345.[100-9999]", tag));
+    ASSERT_TRUE(
+        matches("urn:epc:pat:sgtin-96:3.0614141.812345.[6789-6789]", tag));
+    ASSERT_FALSE(
+        matches("urn:epc:pat:sgtin-96:3.0614141.812345.[6790-9999]", tag));
+    ASSERT_FALSE(matches("urn:epc:pat:sgtin-96:1.0614141.812345.*", tag));
+    ASSERT_FALSE(matches("urn:epc:pat:sgtin-96:[4-7].*.*.*", tag));
+    ASSERT_FALSE(matches("urn:epc:pat:grai-96:*.*.*.*", tag));
+
+    // Ranges of the last fields of SSCC and GIAI
+    std::string sscc = "urn:epc:tag:sscc-96:3.0614141.1234567890";
+    ASSERT_TRUE(
+        matches("urn:epc:pat:sscc-96:3.0614141.[1234567890-1234567899]",
+                sscc));
+    ASSERT_TRUE(matches("urn:epc:pat:sscc-96:3.0614141.[0-9999999999]",
+                        sscc));
+    ASSERT_FALSE(matches("urn:epc:pat:sscc-96:3.0614141.[0-1234567889]",
+                         sscc));
+    ASSERT_TRUE(matches("urn:epc:pat:sscc-96:3.0614141.[0-99999999999]",
+                        "urn:epc:tag:sscc-96:3.0614141.9999999999"));
+    ASSERT_FALSE(matches("urn:epc:pat:sscc-96:3.0614141.[0-99]",
+                         "urn:epc:tag:sscc-96:3.0614142.0000000001"));
+    std::string giai = "urn:epc:tag:giai-96:3.0614141.123";
+    ASSERT_TRUE(matches("urn:epc:pat:giai-96:3.0614141.[100-199]", giai));
+    ASSERT_TRUE(matches("urn:epc:pat:giai-96:3.0614141.[123-123]", giai));
+    ASSERT_FALSE(matches("urn:epc:pat:giai-96:3.0614141.[124-999]", giai));
+    ASSERT_FALSE(matches("urn:epc:pat:giai-96:3.0614141.[0-122]", giai));
+}
+
+TEST(PatternMatcherTest, MalformedPattern) {
+    const char *patterns[] = {
+        "urn:epc:idpat:sgtin:0614141.*",
+        "urn:epc:idpat:sgtin:0614141.*.6789",
+        "urn:epc:idpat:sgtin:*.812345.*",
+        "urn:epc:idpat:sgtin-96:0614141.*.*",
+        "urn:epc:idpat:sgtin:06141A1.*.*",
+        "urn:epc:idpat:giai:06141A1.0123",
+        "urn:epc:idpat:sgtin:0614141.81234.*",
+        "urn:epc:idpat:sgtn:0614141.*.*",
+        "urn:epc:pat:sgtin:3.0614141.*.*",
+        "urn:epc:pat:sgtin-198:3.0614141.*.*",
+        "urn:epc:pat:sgtin-96:8.0614141.*.*",
+        "urn:epc:pat:sgtin-96:[3-8].0614141.*.*",
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[9-1]",
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[1-]",
+        "urn:epc:pat:sscc-96:0.0614141.1234567890.*",
+        "urn:epc:pat:sscc-96:3.0614141.[9-1]",
+        "urn:epc:pat:giai-96:3.0614141.[1-]",
+        "urn:epc:idpat:giai:0614141.[1-9]",
+        "urn:epc:idpat:sscc:0614141.[1-9]",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+    };
+    for (const char *pattern : patterns) {
+        ASSERT_EQ(Status::kInvalidArgument,
+                  get_pattern_ranges(pattern).first) << pattern;
+    }
+    Status status;
+    PatternMatcher matcher;
+    std::tie(status, matcher) = PatternMatcher::create(
+        {"urn:epc:idpat:sgtin:0614141.*.*", patterns[0]});
+    ASSERT_EQ(Status::kInvalidArgument, status);
+}
+
+TEST(PatternMatcherTest, Union) {
+    Status status;
+    PatternMatcher matcher;
+    std::tie(status, matcher) = PatternMatcher::create({
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[0-99]",
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[100-199]",
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[150-299]",
+        "urn:epc:pat:sgtin-96:3.0614141.812345.[1000-1999]",
+        "urn:epc:idpat:sscc:0614141.*",
+        "urn:epc:pat:sscc-96:0.0614141.*",
+    });
+    ASSERT_EQ(Status::kOk, status);
+    // Merged into [0-299] and [1000-1999] of the SGTIN, and the SSCC of
+    // each filter value.
+    ASSERT_EQ(2 + 8, matcher.getRanges().size());
+
+    std::vector<Epc96> epcs;
+    std::vector<bool> expected;
+    for (uint64_t serial = 0; serial < 2500; serial += 50) {
+        epcs.push_back(from_tag_uri("urn:epc:tag:sgtin-96:3.0614141.812345."
+                                    + std::to_string(serial)));
+        expected.push_back(serial < 300 || (serial >= 1000 && serial < 2000));
+    }
+    epcs.push_back(from_tag_uri("urn:epc:tag:sscc-96:5.0614141.1234567890"));
+    expected.push_back(true);
+    epcs.push_back(from_tag_uri("urn:epc:tag:sscc-96:5.0614142.1234567890"));
+    expected.push_back(false);
+    epcs.push_back(Epc96());
+    expected.push_back(false);
+
+    std::vector<uint64_t> mask((epcs.size() + 63) / 64);
+    size_t count = matcher.matches(epcs.data(), epcs.size(), mask.data());
+    size_t expected_count = 0;
+    for (size_t i = 0; i < epcs.size(); i++) {
+        ASSERT_EQ(expected[i], matcher.matches(epcs[i])) << i;
+        ASSERT_EQ(expected[i], (mask[i / 64] >> (i % 64) & 1) != 0) << i;
+        if (expected[i]) expected_count++;
+    }
+    ASSERT_EQ(expected_count, count);
+
+    ASSERT_FALSE(PatternMatcher().matches(epcs[0]));
+}
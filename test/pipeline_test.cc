@@ -0,0 +1,225 @@
+#include "pipeline.h"
+#include "status.h"
+#include "tag.h"
+#include "tag_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    template <typename T>
+    auto vector_source(const std::vector<T> &values) {
+        size_t i = 0;
+        return [&values, i](T &value) mutable {
+            if (i == values.size()) return false;
+            value = values[i++];
+            return true;
+        };
+    }
+}
+
+TEST(PipelineTest, Channel) {
+    Scheduler scheduler;
+    Channel<int> channel(scheduler, 2);
+    std::vector<int> received;
+    std::vector<std::string> events;
+    auto producer = [&]() -> Task {
+        for (int i = 0; i < 5; i++) {
+            bool ok = co_await channel.send(i);
+            EXPECT_TRUE(ok);
+            events.push_back("sent " + std::to_string(i));
+        }
+        channel.close();
+    };
+    auto consumer = [&]() -> Task {
+        while (auto value = co_await channel.receive()) {
+            received.push_back(*value);
+            events.push_back("received " + std::to_string(*value));
+        }
+    };
+    scheduler.spawn(producer());
+    scheduler.spawn(consumer());
+    ASSERT_TRUE(scheduler.run());
+    ASSERT_EQ((std::vector<int>{0, 1, 2, 3, 4}), received);
+    // The producer waits once two values are buffered.
+    ASSERT_EQ("sent 0", events[0]);
+    ASSERT_EQ("sent 1", events[1]);
+    ASSERT_EQ("received 0", events[2]);
+}
+
+TEST(PipelineTest, Rendezvous) {
+    Scheduler scheduler;
+    Channel<int> channel(scheduler, 0);
+    std::vector<int> received;
+    auto producer = [&]() -> Task {
+        for (int i = 0; i < 3; i++) co_await channel.send(i);
+        channel.close();
+    };
+    auto consumer = [&]() -> Task {
+        while (auto value = co_await channel.receive()) {
+            received.push_back(*value);
+        }
+    };
+    scheduler.spawn(consumer());
+    scheduler.spawn(producer());
+    ASSERT_TRUE(scheduler.run());
+    ASSERT_EQ((std::vector<int>{0, 1, 2}), received);
+}
+
+TEST(PipelineTest, SendToClosedChannel) {
+    Scheduler scheduler;
+    Channel<int> channel(scheduler, 1);
+    std::vector<bool> results;
+    auto producer = [&]() -> Task {
+        for (int i = 0; i < 3; i++) results.push_back(co_await channel.send(i));
+    };
+    auto closer = [&]() -> Task {
+        channel.close();
+        co_return;
+    };
+    scheduler.spawn(producer());
+    scheduler.spawn(closer());
+    ASSERT_TRUE(scheduler.run());
+    ASSERT_EQ((std::vector<bool>{true, false, false}), results);
+}
+
+TEST(PipelineTest, Deadlock) {
+    Scheduler scheduler;
+    Channel<int> channel(scheduler, 1);
+    auto consumer = [&]() -> Task {
+        co_await channel.receive();
+    };
+    scheduler.spawn(consumer());
+    ASSERT_FALSE(scheduler.run());
+}
+
+TEST(PipelineTest, DecodeDedupeURI) {
+    const std::vector<std::string> hexes = {
+        "3074257BF7194E4000001A85",
+        "3074257BF7194E4000001A86",
+        "invalid",
+        "3074257BF7194E4000001A85",
+        "3474257BF400000000001A85",
+    };
+    Scheduler scheduler;
+    Channel<Batch<std::string>> input(scheduler, 1);
+    Channel<Batch<Tag>> decoded(scheduler, 1);
+    Channel<Batch<Tag>> deduped(scheduler, 1);
+    Channel<Batch<std::string>> uris(scheduler, 1);
+    size_t errors = 0;
+    std::vector<std::string> out;
+    std::vector<size_t> batch_sizes;
+
+    scheduler.spawn(source_stage(vector_source(hexes), input, 2));
+    scheduler.spawn(decode_stage(input, decoded, &errors));
+    scheduler.spawn(dedupe_stage(decoded, deduped));
+    scheduler.spawn(uri_stage(deduped, uris));
+    scheduler.spawn(sink_stage(uris, [&](Batch<std::string> &batch) {
+        batch_sizes.push_back(batch.size());
+        out.insert(out.end(), batch.begin(), batch.end());
+    }));
+    ASSERT_TRUE(scheduler.run());
+
+    ASSERT_EQ(1, errors);
+    ASSERT_EQ((std::vector<std::string>{
+                  "urn:epc:id:sgtin:0614141.812345.6789",
+                  "urn:epc:id:sgtin:0614141.812345.6790",
+                  "urn:epc:id:giai:0614141.6789",
+              }),
+              out);
+    ASSERT_EQ((std::vector<size_t>{2, 1}), batch_sizes);
+}
+
+TEST(PipelineTest, DedupeWindow) {
+    const std::vector<std::string> hexes = {
+        "3074257BF7194E4000001A85",
+        "3074257bf7194e4000001a85",
+        "3074257BF7194E4000001A86",
+        "3074257BF7194E4000001A87",
+        // A repeat after the window of 3 reads
+        "3074257BF7194E4000001A85",
+        "3074257BF7194E4000001A87",
+        // Not of 96 bits
+        "invalid",
+        "invalid",
+    };
+    Scheduler scheduler;
+    Channel<Batch<std::string>> input(scheduler, 1);
+    Channel<Batch<std::string>> deduped(scheduler, 1);
+    std::vector<std::string> out;
+
+    scheduler.spawn(source_stage(vector_source(hexes), input, 3));
+    scheduler.spawn(dedupe_stage(input, deduped, 3));
+    scheduler.spawn(sink_stage(deduped, [&](Batch<std::string> &batch) {
+        out.insert(out.end(), batch.begin(), batch.end());
+    }));
+    ASSERT_TRUE(scheduler.run());
+
+    ASSERT_EQ((std::vector<std::string>{
+                  "3074257BF7194E4000001A85",
+                  "3074257BF7194E4000001A86",
+                  "3074257BF7194E4000001A87",
+                  "3074257BF7194E4000001A85",
+                  "invalid",
+                  "invalid",
+              }),
+              out);
+}
+
+TEST(PipelineTest, Writer) {
+    const std::vector<std::string> hexes = {
+        "3074257BF7194E4000001A85",
+        "3074257BF7194E4000001A86",
+    };
+    std::string out;
+    TagWriter writer(TagWriter::Format::kCSV, {TagWriter::Column::kSerial},
+                     [&out](const char *data, size_t size) {
+                         out.append(data, size);
+                         return Status::kOk;
+                     });
+    Scheduler scheduler;
+    Channel<Batch<std::string>> input(scheduler, 4);
+    Channel<Batch<Tag>> decoded(scheduler, 4);
+    Status status = Status::kInvalidArgument;
+    scheduler.spawn(source_stage(vector_source(hexes), input, 1));
+    scheduler.spawn(decode_stage(input, decoded));
+    scheduler.spawn(writer_stage(decoded, writer, &status));
+    ASSERT_TRUE(scheduler.run());
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("6789\n6790\n", out);
+}
+
+TEST(PipelineTest, Backpressure) {
+    // The source never runs ahead of the sink by more than the batches
+    // buffered in the channels and held by the stages.
+    const size_t count = 1000;
+    Scheduler scheduler;
+    Channel<Batch<int>> input(scheduler, 1);
+    Channel<Batch<int>> mapped(scheduler, 1);
+    size_t produced = 0;
+    size_t consumed = 0;
+    size_t max_in_flight = 0;
+    scheduler.spawn(source_stage<int>(
+        [&](int &value) {
+            if (produced == count) return false;
+            value = static_cast<int>(produced++);
+            max_in_flight = std::max(max_in_flight, produced - consumed);
+            return true;
+        },
+        input, 10));
+    scheduler.spawn(map_stage(input, mapped, [](Batch<int> &batch) {
+        for (auto &value : batch) value *= 2;
+        return batch;
+    }));
+    scheduler.spawn(sink_stage(mapped, [&](Batch<int> &batch) {
+        consumed += batch.size();
+    }));
+    ASSERT_TRUE(scheduler.run());
+    ASSERT_EQ(count, consumed);
+    ASSERT_GE(50, max_in_flight);
+}
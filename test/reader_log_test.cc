@@ -0,0 +1,117 @@
+#include "reader_log.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+
+using namespace epc;
+
+TEST(ReaderLogTest, Decode) {
+    std::stringstream ss(
+        "3074257BF7194E4000001A85\n"
+        "3474257bf40000000000162e,1633046400000,2\r\n"
+        "\n"
+        "3574257BF40000000000162E\n"
+        "3074257BF7194E4000001A85\t1633046400001\n"
+        "3074257BF7194E4000001A85 x\n"
+        "3174257BF4499602D2000000 1633046400002 3");
+    ReaderLogDecoder decoder;
+    std::vector<ReaderLogRecord> records;
+    Status status = decoder.decode(ss, [&](const ReaderLogRecord &record) {
+        records.push_back(record);
+    });
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(6, records.size());
+
+    ASSERT_EQ(1, records[0].line_);
+    ASSERT_EQ(Status::kOk, records[0].status_);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789",
+              records[0].tag_.getURI());
+    ASSERT_FALSE(records[0].has_timestamp_);
+    ASSERT_FALSE(records[0].has_antenna_);
+
+    ASSERT_EQ(2, records[1].line_);
+    ASSERT_EQ(Status::kOk, records[1].status_);
+    ASSERT_EQ(TagType::kGIAI, records[1].tag_.getType());
+    ASSERT_TRUE(records[1].has_timestamp_);
+    ASSERT_EQ(1633046400000ULL, records[1].timestamp_);
+    ASSERT_TRUE(records[1].has_antenna_);
+    ASSERT_EQ(2, records[1].antenna_);
+
+    ASSERT_EQ(4, records[2].line_);
+    ASSERT_EQ(Status::kInvalidArgument, records[2].status_);
+
+    ASSERT_EQ(5, records[3].line_);
+    ASSERT_EQ(Status::kOk, records[3].status_);
+    ASSERT_EQ(1633046400001ULL, records[3].timestamp_);
+    ASSERT_FALSE(records[3].has_antenna_);
+
+    ASSERT_EQ(6, records[4].line_);
+    ASSERT_EQ(Status::kInvalidArgument, records[4].status_);
+
+    ASSERT_EQ(7, records[5].line_);
+    ASSERT_EQ(Status::kOk, records[5].status_);
+    ASSERT_EQ(TagType::kSSCC, records[5].tag_.getType());
+    ASSERT_EQ(3, records[5].antenna_);
+}
+
+TEST(ReaderLogTest, DecodeWithSmallChunks) {
+    std::string log;
+    for (int i = 0; i < 100; i++) {
+        log += "3074257BF7194E4000001A85,";
+        log += std::to_string(i);
+        log += "\n";
+    }
+    // A line longer than a chunk is reported and skipped.
+    log += std::string(64, 'A') + "\n";
+    log += "3074257BF7194E4000001A85\n";
+
+    std::stringstream ss(log);
+    ReaderLogDecoder decoder(40);
+    std::vector<ReaderLogRecord> records;
+    Status status = decoder.decode(ss, [&](const ReaderLogRecord &record) {
+        records.push_back(record);
+    });
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(102, records.size());
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(Status::kOk, records[i].status_);
+        ASSERT_EQ(i, records[i].timestamp_);
+    }
+    ASSERT_EQ(101, records[100].line_);
+    ASSERT_EQ(Status::kInvalidArgument, records[100].status_);
+    ASSERT_EQ(102, records[101].line_);
+    ASSERT_EQ(Status::kOk, records[101].status_);
+}
+
+TEST(ReaderLogTest, DecodeBatchesFromFileDescriptor) {
+    FILE *fp = std::tmpfile();
+    ASSERT_NE(nullptr, fp);
+    for (int i = 0; i < 10; i++) {
+        std::fputs("3074257BF7194E4000001A85\n", fp);
+    }
+    std::fflush(fp);
+    std::rewind(fp);
+
+    ReaderLogDecoder decoder(64);
+    std::vector<size_t> sizes;
+    size_t lines = 0;
+    Status status = decoder.decodeBatches(
+        fileno(fp), 4, [&](const std::vector<ReaderLogRecord> &records) {
+            sizes.push_back(records.size());
+            for (auto &record : records) {
+                ASSERT_EQ(++lines, record.line_);
+                ASSERT_EQ(Status::kOk, record.status_);
+            }
+        });
+    std::fclose(fp);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ((std::vector<size_t>{4, 4, 2}), sizes);
+
+    std::stringstream ss;
+    ASSERT_EQ(Status::kInvalidArgument,
+              decoder.decodeBatches(ss, 0,
+                                    [](const std::vector<ReaderLogRecord> &) {}));
+}
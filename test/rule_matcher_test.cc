@@ -0,0 +1,145 @@
+#include "rule_matcher.h"
+#include "epc_index.h"
+#include "sgtin.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(unsigned int filter, const std::string &company_prefix,
+                  const std::string &itemref, uint64_t serial) {
+        SGTIN sgtin = SGTIN::create(company_prefix, itemref,
+                                    std::to_string(serial)).second;
+        sgtin.setFilterValue(filter);
+        return Epc96::createFromBinary(sgtin.getBinary().second).second;
+    }
+
+    std::vector<Epc96> sample() {
+        std::vector<Epc96> epcs;
+        for (uint64_t serial = 0; serial < 50; serial++) {
+            for (unsigned int filter = 1; filter < 4; filter++) {
+                epcs.push_back(sgtin96(filter, "0614141", "812345", serial));
+                epcs.push_back(sgtin96(filter, "0614141", "812346", serial));
+                epcs.push_back(sgtin96(filter, "0614142", "812345", serial));
+            }
+        }
+        epcs.push_back(Epc96());
+        return epcs;
+    }
+
+    // Compares batches of all instruction sets and loop orders with
+    // matching EPCs one by one.
+    void test_batches(RuleMatcher matcher, const std::vector<Epc96> &epcs) {
+        std::vector<uint64_t> expected;
+        size_t expected_count = 0;
+        for (const Epc96 &epc : epcs) {
+            expected.push_back(matcher.match(epc));
+            if (expected.back() != 0) expected_count++;
+        }
+        RuleMatcher::InstructionSet sets[] = {
+            RuleMatcher::InstructionSet::kScalar,
+            RuleMatcher::InstructionSet::kAVX2,
+            RuleMatcher::InstructionSet::kAVX512,
+        };
+        RuleMatcher::LoopOrder orders[] = {
+            RuleMatcher::LoopOrder::kAuto,
+            RuleMatcher::LoopOrder::kRuleMajor,
+            RuleMatcher::LoopOrder::kTagMajor,
+        };
+        for (RuleMatcher::InstructionSet set : sets) {
+            if (!matcher.setInstructionSet(set)) continue;
+            for (RuleMatcher::LoopOrder order : orders) {
+                // Lengths not divisible by blocks or registers.
+                for (size_t n : {epcs.size(), size_t(1), size_t(67)}) {
+                    std::vector<uint64_t> rules(n, ~0ULL);
+                    size_t count = matcher.match(epcs.data(), n,
+                                                 rules.data(), order);
+                    std::vector<uint64_t> want(expected.begin(),
+                                               expected.begin() + n);
+                    ASSERT_EQ(want, rules)
+                        << static_cast<int>(set) << static_cast<int>(order);
+                    if (n == epcs.size()) {
+                        ASSERT_EQ(expected_count, count);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(RuleMatcherTest, MaskAndValue) {
+    RuleMatcher matcher;
+    Epc96 epc = sgtin96(3, "0614141", "812345", 6789);
+    // The header and the filter.
+    ASSERT_EQ(0, matcher.addRule(Epc96(0xFFE00000, 0),
+                                 Epc96(0x30600000, 0)).second);
+    ASSERT_EQ(1, matcher.addRule(Epc96(0xFF000000, 0),
+                                 Epc96(0x31000000, 0)).second);
+    ASSERT_EQ(2, matcher.addRule(Epc96(), Epc96()).second);
+    ASSERT_EQ(3, matcher.getRuleCount());
+    ASSERT_EQ(0x5, matcher.match(epc));
+    ASSERT_EQ(0x4, matcher.match(sgtin96(1, "0614141", "812345", 6789)));
+    test_batches(matcher, sample());
+
+    ASSERT_EQ(0, RuleMatcher().match(epc));
+    uint64_t rules = ~0ULL;
+    ASSERT_EQ(0, RuleMatcher().match(&epc, 1, &rules));
+    ASSERT_EQ(0, rules);
+}
+
+TEST(RuleMatcherTest, Query) {
+    RuleMatcher matcher;
+    EpcIndexQuery company = make_index_query(0x30, "0614141");
+    EpcIndexQuery item = make_index_query(0x30, "0614141", "812345");
+    item.filter_ = 3;
+    EpcIndexQuery serials = make_index_query(0x30, "0614141", "812346");
+    serials.first_serial_ = 10;
+    serials.last_serial_ = 20;
+    ASSERT_EQ(0, matcher.addRule(company).second);
+    ASSERT_EQ(1, matcher.addRule(item).second);
+    ASSERT_EQ(2, matcher.addRule(serials).second);
+    // 8 filter values of a prefix, a prefix, and 8 filter values of 4
+    // prefixes for 10-11, 12-15, 16-19 and 20.
+    ASSERT_EQ(8 + 1 + 8 * 4, matcher.getTermCount());
+
+    ASSERT_EQ(0x3, matcher.match(sgtin96(3, "0614141", "812345", 1)));
+    ASSERT_EQ(0x1, matcher.match(sgtin96(2, "0614141", "812345", 1)));
+    ASSERT_EQ(0x5, matcher.match(sgtin96(2, "0614141", "812346", 15)));
+    ASSERT_EQ(0x1, matcher.match(sgtin96(2, "0614141", "812346", 21)));
+    ASSERT_EQ(0x0, matcher.match(sgtin96(2, "0614142", "812346", 15)));
+    test_batches(matcher, sample());
+
+    ASSERT_EQ(Status::kInvalidArgument,
+              matcher.addRule(make_index_query(0x36, "0614141")).first);
+}
+
+TEST(RuleMatcherTest, ManyRules) {
+    RuleMatcher matcher;
+    std::vector<Epc96> epcs = sample();
+    for (size_t i = 0; i < RuleMatcher::MAX_RULES; i++) {
+        // Each rule matches a serial.
+        ASSERT_EQ(i, matcher.addRule(Epc96(~0U, 0xFFFFFFFFFF),
+                                     epcs[i * 2]).second);
+    }
+    ASSERT_EQ(Status::kInvalidArgument,
+              matcher.addRule(Epc96(), Epc96()).first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              matcher.addRule(make_index_query(0x30, "0614141")).first);
+    test_batches(matcher, epcs);
+
+    // Rules of many terms.
+    RuleMatcher ranges;
+    for (uint64_t serial = 0; serial < 10; serial++) {
+        EpcIndexQuery query = make_index_query(0x30, "0614141", "812345");
+        query.first_serial_ = serial;
+        query.last_serial_ = serial * 3 + 7;
+        ranges.addRule(query);
+    }
+    ASSERT_LT(64, ranges.getTermCount());
+    test_batches(ranges, epcs);
+}
@@ -0,0 +1,146 @@
+#include "select_mask.h"
+#include "epc_index.h"
+#include "sgtin.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    Epc96 sgtin96(unsigned int filter, const std::string &company_prefix,
+                  const std::string &itemref, uint64_t serial) {
+        SGTIN sgtin = SGTIN::create(company_prefix, itemref,
+                                    std::to_string(serial)).second;
+        sgtin.setFilterValue(filter);
+        return Epc96::createFromBinary(sgtin.getBinary().second).second;
+    }
+
+    bool in_ranges(const std::vector<EpcRange> &ranges, const Epc96 &epc) {
+        for (const EpcRange &range : ranges) {
+            if (range.first_ <= epc && epc <= range.last_) return true;
+        }
+        return false;
+    }
+
+    // Compares the matcher with the ranges of the query.
+    void test_query(const EpcIndexQuery &query,
+                    const std::vector<Epc96> &epcs) {
+        std::vector<SelectMask> masks = compile_select_masks(query).second;
+        std::vector<EpcRange> ranges = get_index_ranges(query).second;
+        SelectMatcher matcher(masks);
+        for (const Epc96 &epc : epcs) {
+            ASSERT_EQ(in_ranges(ranges, epc), matcher.matches(epc))
+                << epc.getBinary();
+        }
+    }
+
+    std::vector<Epc96> sample() {
+        std::vector<Epc96> epcs;
+        for (unsigned int filter = 0; filter < 8; filter++) {
+            for (uint64_t serial = 0; serial < 40; serial++) {
+                epcs.push_back(sgtin96(filter, "0614141", "812345", serial));
+                epcs.push_back(sgtin96(filter, "0614141", "812346", serial));
+                epcs.push_back(sgtin96(filter, "0614142", "812345", serial));
+            }
+        }
+        // Another scheme with the same bits after the header.
+        Epc96 epc = sgtin96(3, "0614141", "812345", 10);
+        epcs.push_back(Epc96(epc.getHigh() ^ 0x04000000, epc.getLow()));
+        return epcs;
+    }
+}
+
+TEST(SelectMaskTest, CompanyPrefix) {
+    EpcIndexQuery query = make_index_query(0x30, "0614141");
+    query.filter_ = 3;
+    std::vector<SelectMask> masks;
+    Status status;
+    std::tie(status, masks) = compile_select_masks(query);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(1, masks.size());
+    ASSERT_EQ(SELECT_ACTION_ASSERT_DEASSERT, masks[0].action_);
+    ASSERT_EQ(0x20, masks[0].pointer_);
+    // Header, filter, partition and 24 bits of company prefix.
+    ASSERT_EQ(38, masks[0].length_);
+    ASSERT_EQ(std::vector<uint8_t>({0x30, 0x74, 0x25, 0x7B, 0xF4}),
+              masks[0].mask_);
+    test_query(query, sample());
+}
+
+TEST(SelectMaskTest, AnyFilter) {
+    EpcIndexQuery query = make_index_query(0x30, "0614141", "812345");
+    std::vector<SelectMask> masks = compile_select_masks(query).second;
+    ASSERT_EQ(2, masks.size());
+    ASSERT_EQ(0x20 + 11, masks[0].pointer_);
+    ASSERT_EQ(3 + 24 + 20, masks[0].length_);
+    ASSERT_EQ(SELECT_ACTION_NOTHING_DEASSERT, masks[1].action_);
+    ASSERT_EQ(0x20, masks[1].pointer_);
+    ASSERT_EQ(8, masks[1].length_);
+    ASSERT_EQ(std::vector<uint8_t>({0x30}), masks[1].mask_);
+    test_query(query, sample());
+}
+
+TEST(SelectMaskTest, SerialRange) {
+    EpcIndexQuery query = make_index_query(0x30, "0614141", "812345");
+    query.filter_ = 3;
+    query.first_serial_ = 1;
+    query.last_serial_ = 6;
+    std::vector<SelectMask> masks = compile_select_masks(query).second;
+    // 1, 2-3, 4-5 and 6.
+    ASSERT_EQ(4, masks.size());
+    ASSERT_EQ(96, masks[0].length_);
+    ASSERT_EQ(95, masks[1].length_);
+    ASSERT_EQ(SELECT_ACTION_ASSERT_NOTHING, masks[1].action_);
+    ASSERT_EQ(95, masks[2].length_);
+    ASSERT_EQ(96, masks[3].length_);
+    test_query(query, sample());
+
+    query.first_serial_ = 0;
+    query.last_serial_ = 31;
+    ASSERT_EQ(1, compile_select_masks(query).second.size());
+    test_query(query, sample());
+
+    query.filter_ = -1;
+    query.first_serial_ = 5;
+    query.last_serial_ = 37;
+    test_query(query, sample());
+}
+
+TEST(SelectMaskTest, InvalidQuery) {
+    EpcIndexQuery query = make_index_query(0x30, "0614141", "812345");
+    query.first_serial_ = 2;
+    query.last_serial_ = 1;
+    ASSERT_EQ(Status::kInvalidArgument, compile_select_masks(query).first);
+    query = make_index_query(0x36, "0614141");
+    ASSERT_EQ(Status::kInvalidArgument, compile_select_masks(query).first);
+    query = make_index_query(0x30, "061414");
+    query.filter_ = 8;
+    ASSERT_EQ(Status::kInvalidArgument, compile_select_masks(query).first);
+}
+
+TEST(SelectMaskTest, Matcher) {
+    Epc96 epc = sgtin96(3, "0614141", "812345", 6789);
+    SelectMask header = {SELECT_ACTION_ASSERT_DEASSERT, 0x20, 8, {0x30}};
+    SelectMask pc = {SELECT_ACTION_ASSERT_DEASSERT, 0x10, 8, {0x30}};
+    SelectMask negate = {SELECT_ACTION_NOTHING_NEGATE, 0x20, 8, {0x31}};
+    ASSERT_TRUE(SelectMatcher({header}).matches(epc));
+    ASSERT_FALSE(SelectMatcher({pc}).matches(epc));
+    ASSERT_FALSE(SelectMatcher({header, negate}).matches(epc));
+    ASSERT_FALSE(SelectMatcher({}).matches(epc));
+
+    std::vector<Epc96> epcs = sample();
+    EpcIndexQuery query = make_index_query(0x30, "0614141", "812345");
+    SelectMatcher matcher(compile_select_masks(query).second);
+    std::vector<uint64_t> mask((epcs.size() + 63) / 64);
+    size_t count = matcher.matches(epcs.data(), epcs.size(), mask.data());
+    ASSERT_EQ(8 * 40, count);
+    for (size_t i = 0; i < epcs.size(); i++) {
+        ASSERT_EQ(matcher.matches(epcs[i]),
+                  (mask[i / 64] >> (i % 64) & 1) != 0);
+    }
+}
@@ -143,6 +143,12 @@ TEST(SGLNTest, createFromBinary) {
             "3974257BF46072CD9615F880000000000000000000000000");
         ASSERT_EQ(Status::kInvalidArgument, status);
     }
+    // Check for invalid partition
+    {
+        std::tie(status, sgln) = SGLN::createFromBinary(
+            "323C00000000000000000000");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
 }
 
 TEST(SGLNTest, GetterSetters) {
@@ -144,6 +144,12 @@ TEST(SGTINTest, createFromBinary) {
             "3674257BF6B7A659B2C2BF10000000000000000000000000000");
         ASSERT_EQ(Status::kInvalidArgument, status);
     }
+    // Check for invalid partition
+    {
+        std::tie(status, sgtin) = SGTIN::createFromBinary(
+            "303C00000000000000000000");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
 }
 
 TEST(SGTINTest, GetterSetters) {
@@ -265,4 +271,29 @@ TEST(SGTINTest, GetBinary) {
         std::tie(status, bin) = sgtin.getBinary();
         ASSERT_EQ(Status::kInvalidSerial, status);
     }
+    // Test validation for company prefix
+    {
+        std::tie(status, sgtin) = SGTIN::create("06141", "12345678", "1");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = sgtin.getBinary();
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
+    // A 12-digit company prefix, over the range of int
+    {
+        std::tie(status, sgtin) = SGTIN::create("061414112345", "1", "5");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = sgtin.getBinary();
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, sgtin) = SGTIN::createFromBinary(bin);
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("061414112345", sgtin.getCompanyPrefix());
+    }
+    // A serial over the range of long long
+    {
+        std::tie(status, sgtin) = SGTIN::create(
+            "0614141", "712345", "99999999999999999999");
+        ASSERT_EQ(Status::kOk, status);
+        std::tie(status, bin) = sgtin.getBinary();
+        ASSERT_EQ(Status::kInvalidSerial, status);
+    }
 }
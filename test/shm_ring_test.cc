@@ -0,0 +1,227 @@
+#include "shm_ring.h"
+#include "status.h"
+#include "tag.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace epc;
+
+namespace {
+    const uint8_t SGTIN96[] = {0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19,
+                               0x4E, 0x40, 0x00, 0x00, 0x1A, 0x85};
+
+    ShmRing create_ring(size_t capacity) {
+        Status status;
+        ShmRing ring;
+        std::tie(status, ring) = ShmRing::create(capacity);
+        EXPECT_EQ(Status::kOk, status);
+        return ring;
+    }
+}
+
+TEST(ShmRingTest, Create) {
+    ShmRing ring = create_ring(5);
+    ASSERT_LE(0, ring.getFd());
+    ASSERT_EQ(8, ring.capacity());
+    ASSERT_EQ(0, ring.size());
+
+    Status status;
+    std::tie(status, ring) = ShmRing::create(0);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    ASSERT_EQ(-1, ring.getFd());
+    ASSERT_EQ(0, ring.capacity());
+}
+
+TEST(ShmRingTest, PushAndPop) {
+    ShmRing ring = create_ring(4);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(ring.push(SGTIN96, sizeof(SGTIN96), 100 + i, i));
+    }
+    ASSERT_FALSE(ring.push(SGTIN96, sizeof(SGTIN96), 0, 0));
+    ASSERT_EQ(4, ring.size());
+
+    ShmRingRecord records[8];
+    ASSERT_EQ(3, ring.pop(records, 3));
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(100 + i, records[i].timestamp_);
+        ASSERT_EQ(i, records[i].antenna_);
+        ASSERT_EQ(sizeof(SGTIN96), records[i].size_);
+        ASSERT_EQ(0, std::memcmp(SGTIN96, records[i].epc_, sizeof(SGTIN96)));
+    }
+    ASSERT_EQ(1, ring.size());
+
+    // Wrap around the end of the ring.
+    ASSERT_EQ(3, ring.push(records, 5));
+    ASSERT_EQ(4, ring.pop(records, 8));
+    ASSERT_EQ(103, records[0].timestamp_);
+    ASSERT_EQ(100, records[1].timestamp_);
+    ASSERT_EQ(102, records[3].timestamp_);
+    ASSERT_EQ(0, ring.pop(records, 8));
+}
+
+TEST(ShmRingTest, PushTooLong) {
+    ShmRing ring = create_ring(4);
+    uint8_t epc[ShmRing::MAX_EPC_BYTES + 1] = {};
+    ASSERT_TRUE(ring.push(epc, ShmRing::MAX_EPC_BYTES, 0, 0));
+    ASSERT_FALSE(ring.push(epc, sizeof(epc), 0, 0));
+}
+
+TEST(ShmRingTest, Consume) {
+    ShmRing ring = create_ring(4);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(ring.push(SGTIN96, sizeof(SGTIN96), i, 1));
+    }
+    ShmRingRecord records[2];
+    ASSERT_EQ(2, ring.pop(records, 2));
+    for (int i = 3; i < 6; i++) {
+        ASSERT_TRUE(ring.push(SGTIN96, sizeof(SGTIN96), i, 1));
+    }
+
+    std::vector<size_t> runs;
+    std::vector<std::string> uris;
+    size_t n = ring.consume(8, [&](const ShmRingRecord *records, size_t n) {
+        runs.push_back(n);
+        for (size_t i = 0; i < n; i++) {
+            Status status;
+            Tag tag;
+            std::tie(status, tag) = Tag::createFromBytes(records[i].epc_,
+                                                         records[i].size_);
+            ASSERT_EQ(Status::kOk, status);
+            uris.push_back(tag.getURI());
+        }
+    });
+    ASSERT_EQ(4, n);
+    ASSERT_EQ((std::vector<size_t>{2, 2}), runs);
+    ASSERT_EQ(4, uris.size());
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", uris[0]);
+    ASSERT_EQ(0, ring.size());
+}
+
+TEST(ShmRingTest, OpenFd) {
+    ShmRing producer = create_ring(16);
+    Status status;
+    ShmRing consumer;
+    std::tie(status, consumer) = ShmRing::open(producer.getFd());
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(16, consumer.capacity());
+
+    ASSERT_TRUE(producer.push(SGTIN96, sizeof(SGTIN96), 42, 3));
+    ShmRingRecord record;
+    ASSERT_EQ(1, consumer.pop(&record, 1));
+    ASSERT_EQ(42, record.timestamp_);
+    ASSERT_EQ(0, producer.size());
+}
+
+TEST(ShmRingTest, OpenMalformed) {
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    Status status;
+    ShmRing ring;
+    std::tie(status, ring) = ShmRing::open(fds[0]);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ShmRingTest, Named) {
+    std::string name = "/libepc-test-" + std::to_string(::getpid());
+    Status status;
+    ShmRing producer;
+    std::tie(status, producer) = ShmRing::create(name, 8);
+    ASSERT_EQ(Status::kOk, status);
+    ShmRing other;
+    std::tie(status, other) = ShmRing::create(name, 8);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+
+    ShmRing consumer;
+    std::tie(status, consumer) = ShmRing::open(name);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(Status::kOk, ShmRing::unlink(name));
+    ASSERT_EQ(Status::kInvalidArgument, ShmRing::unlink(name));
+
+    ASSERT_TRUE(producer.push(SGTIN96, sizeof(SGTIN96), 7, 2));
+    ShmRingRecord record;
+    ASSERT_EQ(1, consumer.pop(&record, 1));
+    ASSERT_EQ(7, record.timestamp_);
+    ASSERT_EQ(2, record.antenna_);
+}
+
+TEST(ShmRingTest, Threads) {
+    const uint64_t count = 200000;
+    ShmRing producer = create_ring(64);
+    Status status;
+    ShmRing consumer;
+    std::tie(status, consumer) = ShmRing::open(producer.getFd());
+    ASSERT_EQ(Status::kOk, status);
+
+    std::thread thread([&producer, count] {
+        for (uint64_t i = 0; i < count;) {
+            uint8_t epc[12] = {};
+            std::memcpy(epc + 4, &i, sizeof(i));
+            if (producer.push(epc, sizeof(epc), i, i & 3)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        auto check = [&](const ShmRingRecord *records, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                uint64_t value;
+                std::memcpy(&value, records[i].epc_ + 4, sizeof(value));
+                if (records[i].timestamp_ != expected || value != expected) {
+                    ordered = false;
+                }
+                expected++;
+            }
+        };
+        size_t consumed = consumer.consume(32, check);
+        if (consumed == 0) std::this_thread::yield();
+    }
+    thread.join();
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(0, consumer.size());
+}
+
+TEST(ShmRingTest, Fork) {
+    const uint64_t count = 10000;
+    ShmRing ring = create_ring(128);
+    pid_t pid = ::fork();
+    ASSERT_LE(0, pid);
+    if (pid == 0) {
+        for (uint64_t i = 0; i < count;) {
+            if (ring.push(SGTIN96, sizeof(SGTIN96), i, 1)) {
+                i++;
+            } else {
+                ::sched_yield();
+            }
+        }
+        ::_exit(0);
+    }
+    uint64_t expected = 0;
+    bool ordered = true;
+    ShmRingRecord records[64];
+    while (expected < count) {
+        size_t n = ring.pop(records, 64);
+        if (n == 0) ::sched_yield();
+        for (size_t i = 0; i < n; i++) {
+            if (records[i].timestamp_ != expected++) ordered = false;
+        }
+    }
+    int wstatus;
+    ASSERT_EQ(pid, ::waitpid(pid, &wstatus, 0));
+    ASSERT_TRUE(WIFEXITED(wstatus));
+    ASSERT_TRUE(ordered);
+}
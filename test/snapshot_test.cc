@@ -0,0 +1,98 @@
+#include "snapshot.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace epc;
+
+namespace {
+    std::vector<Epc96> make_inventory() {
+        // SGTIN-96 EPCs of a few items with clustered serials.
+        std::mt19937_64 rng(42);
+        std::vector<Epc96> epcs;
+        for (uint64_t item = 0; item < 20; item++) {
+            uint64_t serial = rng() % 1000000;
+            for (int i = 0; i < 300; i++) {
+                serial += 1 + rng() % 4;
+                uint64_t low = (812345 + item) << 38 | serial;
+                epcs.push_back(Epc96(0x3074257B, 0xF000000000000000ULL | low));
+            }
+        }
+        std::shuffle(epcs.begin(), epcs.end(), rng);
+        return epcs;
+    }
+}
+
+TEST(SnapshotTest, Create) {
+    std::vector<Epc96> epcs = make_inventory();
+    epcs.push_back(epcs[0]);  // Duplicated EPC
+    Snapshot snapshot = Snapshot::create(epcs);
+
+    std::vector<Epc96> expected = epcs;
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()),
+                   expected.end());
+    ASSERT_EQ(expected.size(), snapshot.size());
+    ASSERT_EQ((expected.size() + 127) / 128, snapshot.getBlockCount());
+    ASSERT_EQ(expected, snapshot.decode());
+    // Far smaller than 12 bytes per EPC.
+    ASSERT_LT(snapshot.getBytes().size(), expected.size() * 2);
+
+    for (size_t i = 0; i < expected.size(); i += 37) {
+        ASSERT_EQ(expected[i], snapshot.get(i));
+        ASSERT_TRUE(snapshot.contains(expected[i]));
+    }
+    ASSERT_EQ(expected.back(), snapshot.get(expected.size() - 1));
+    ASSERT_FALSE(snapshot.contains(Epc96(0, 0)));
+    ASSERT_FALSE(snapshot.contains(Epc96(0xFFFFFFFF, ~0ULL)));
+    Epc96 missing(expected[10].getHigh(), expected[10].getLow() + 1);
+    ASSERT_EQ(std::binary_search(expected.begin(), expected.end(), missing),
+              snapshot.contains(missing));
+}
+
+TEST(SnapshotTest, WideDifferences) {
+    // Differences wider than 64 bits.
+    std::vector<Epc96> epcs = {
+        Epc96(0x30000000, 5),
+        Epc96(0x31000000, 1),
+        Epc96(0x31000000, ~0ULL),
+        Epc96(0x34FFFFFF, 0),
+        Epc96(0xFFFFFFFF, ~0ULL),
+    };
+    Snapshot snapshot = Snapshot::create(epcs, 3);
+    ASSERT_EQ(2, snapshot.getBlockCount());
+    ASSERT_EQ(epcs, snapshot.decode());
+    for (size_t i = 0; i < epcs.size(); i++) {
+        ASSERT_EQ(epcs[i], snapshot.get(i));
+        ASSERT_TRUE(snapshot.contains(epcs[i]));
+    }
+}
+
+TEST(SnapshotTest, CreateFromBytes) {
+    Snapshot snapshot = Snapshot::create(make_inventory(), 64);
+    Status status;
+    Snapshot loaded;
+    std::tie(status, loaded) = Snapshot::createFromBytes(snapshot.getBytes());
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(snapshot.size(), loaded.size());
+    ASSERT_EQ(snapshot.decode(), loaded.decode());
+
+    // Empty snapshot
+    std::tie(status, loaded) = Snapshot::createFromBytes(
+        Snapshot::create({}).getBytes());
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(0, loaded.size());
+    ASSERT_FALSE(loaded.contains(Epc96()));
+
+    // Check for malformed bytes
+    std::string bytes = snapshot.getBytes();
+    std::tie(status, loaded) = Snapshot::createFromBytes(
+        bytes.substr(0, bytes.size() - 8));
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    bytes[0] = 'X';
+    std::tie(status, loaded) = Snapshot::createFromBytes(bytes);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+}
@@ -84,12 +84,25 @@ TEST(SSCCTest, CreateFromBinary) {
         ASSERT_EQ(3, sscc.getFilterValue());
         ASSERT_EQ(SSCC::Scheme::kSSCC96, sscc.getSSCCScheme());
     }
+    // A serial reference with leading zeros
+    {
+        std::tie(status, sscc) = SSCC::createFromBinary(
+            "3174257BF40DFB38D2000000");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("0234567890", sscc.getSerialReference());
+    }
     // Check for invalid SSCC96
     {
         std::tie(status, sscc) = SSCC::createFromBinary(
             "3174257BF4499602D20000000");
         ASSERT_EQ(Status::kInvalidArgument, status);
     }
+    // Check for invalid partition
+    {
+        std::tie(status, sscc) = SSCC::createFromBinary(
+            "313C00000000000000000000");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
 }
 
 TEST(SSCCTest, GetURI) {
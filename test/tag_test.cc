@@ -0,0 +1,224 @@
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+
+using namespace epc;
+
+TEST(TagTest, GetTagType) {
+    ASSERT_EQ(TagType::kSGTIN, get_tag_type(0x30));
+    ASSERT_EQ(TagType::kSGTIN, get_tag_type(0x36));
+    ASSERT_EQ(TagType::kSSCC, get_tag_type(0x31));
+    ASSERT_EQ(TagType::kSGLN, get_tag_type(0x32));
+    ASSERT_EQ(TagType::kSGLN, get_tag_type(0x39));
+    ASSERT_EQ(TagType::kGRAI, get_tag_type(0x33));
+    ASSERT_EQ(TagType::kGRAI, get_tag_type(0x37));
+    ASSERT_EQ(TagType::kGIAI, get_tag_type(0x34));
+    ASSERT_EQ(TagType::kGIAI, get_tag_type(0x38));
+    ASSERT_EQ(TagType::kUnknown, get_tag_type(0x35));
+    ASSERT_EQ(TagType::kUnknown, get_tag_type(0x00));
+}
+
+TEST(TagTest, GetHexLength) {
+    ASSERT_EQ(24, get_hex_length(0x30));
+    ASSERT_EQ(52, get_hex_length(0x36));
+    ASSERT_EQ(49, get_hex_length(0x39));
+    ASSERT_EQ(43, get_hex_length(0x37));
+    ASSERT_EQ(52, get_hex_length(0x38));
+    ASSERT_EQ(0, get_hex_length(0x35));
+}
+
+TEST(TagTest, CreateFromBinary) {
+    Tag tag;
+    Status status;
+    {
+        std::tie(status, tag) = Tag::createFromBinary(
+            "3074257BF7194E4000001A85");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(TagType::kSGTIN, tag.getType());
+        ASSERT_EQ("6789", tag.getSGTIN().getSerial());
+        ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", tag.getURI());
+        ASSERT_EQ("urn:epc:tag:sgtin-96:3.0614141.812345.6789",
+                  tag.getTagURI());
+    }
+    {
+        std::tie(status, tag) = Tag::createFromBinary(
+            "3874257BF59B2C2BF10000000000000000000000000000000000");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(TagType::kGIAI, tag.getType());
+        ASSERT_EQ("urn:epc:id:giai:0614141.32a%2Fb", tag.getURI());
+        std::string bin;
+        std::tie(status, bin) = tag.getBinary();
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ("3874257BF59B2C2BF10000000000000000000000000000000000", bin);
+    }
+    // Check for unsupported header
+    {
+        std::tie(status, tag) = Tag::createFromBinary(
+            "3574257BF40000000000162E");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        ASSERT_EQ(TagType::kUnknown, tag.getType());
+    }
+    // Check for invalid binary
+    {
+        std::tie(status, tag) = Tag::createFromBinary("3");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        std::tie(status, tag) = Tag::createFromBinary(
+            "3074257BF7194E4000001A8");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        ASSERT_EQ(TagType::kUnknown, tag.getType());
+    }
+}
+
+TEST(TagTest, GetSchemeInfo) {
+    const SchemeInfo *scheme = get_scheme_info(0x36);
+    ASSERT_NE(nullptr, scheme);
+    ASSERT_EQ(0x36, scheme->header_);
+    ASSERT_EQ(TagType::kSGTIN, scheme->type_);
+    ASSERT_EQ(198u, scheme->bits_);
+    ASSERT_EQ(52u, scheme->hex_length_);
+    ASSERT_STREQ("sgtin-198", scheme->name_);
+    ASSERT_EQ(scheme, get_scheme_info(TagType::kSGTIN, 198));
+    ASSERT_EQ(0x39, get_scheme_info(TagType::kSGLN, 195)->header_);
+    ASSERT_EQ(0x31, get_scheme_info(TagType::kSSCC, 96)->header_);
+    ASSERT_EQ(nullptr, get_scheme_info(0x35));
+    ASSERT_EQ(nullptr, get_scheme_info(0x00));
+    ASSERT_EQ(nullptr, get_scheme_info(0xFF));
+    ASSERT_EQ(nullptr, get_scheme_info(TagType::kSSCC, 198));
+    ASSERT_EQ(nullptr, get_scheme_info(TagType::kUnknown, 0));
+
+    ASSERT_STREQ("sgtin", get_tag_type_name(TagType::kSGTIN));
+    ASSERT_STREQ("giai", get_tag_type_name(TagType::kGIAI));
+    ASSERT_STREQ("", get_tag_type_name(TagType::kUnknown));
+}
+
+TEST(TagTest, CreateFromBytes) {
+    Tag tag;
+    Status status;
+    // SGTIN-96 padded to 14 bytes
+    const uint8_t sgtin96[] = {0x30, 0x74, 0x25, 0x7B, 0xF7, 0x19, 0x4E,
+                               0x40, 0x00, 0x00, 0x1A, 0x85, 0x00, 0x00};
+    std::tie(status, tag) = Tag::createFromBytes(sgtin96, sizeof(sgtin96));
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", tag.getURI());
+    std::tie(status, tag) = Tag::createFromBytes(sgtin96, 12);
+    ASSERT_EQ(Status::kOk, status);
+    std::tie(status, tag) = Tag::createFromBytes(sgtin96, 11);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    std::tie(status, tag) = Tag::createFromBytes(sgtin96, 0);
+    ASSERT_EQ(Status::kInvalidArgument, status);
+    const uint8_t unknown[12] = {0x35};
+    std::tie(status, tag) = Tag::createFromBytes(unknown, sizeof(unknown));
+    ASSERT_EQ(Status::kInvalidArgument, status);
+}
+
+TEST(TagTest, CreateFromBytesSameAsBinary) {
+    static const char digits[] = "0123456789ABCDEF";
+    const uint8_t headers[] = {
+        0x30, 0x36, 0x31, 0x32, 0x39, 0x33, 0x37, 0x34, 0x38,
+    };
+    std::mt19937_64 random(1);
+    for (uint8_t header : headers) {
+        size_t length = get_hex_length(header);
+        for (int i = 0; i < 2000; i++) {
+            uint8_t bytes[26];
+            for (uint8_t &b : bytes) b = static_cast<uint8_t>(random());
+            bytes[0] = header;
+            // Half of the binaries have small company prefixes, which are
+            // mostly valid.
+            if (i % 2 == 0) bytes[2] = bytes[3] = bytes[4] = 0;
+            std::string hex(length, '0');
+            for (size_t j = 0; j < length; j++) {
+                uint8_t b = bytes[j / 2];
+                hex[j] = digits[j % 2 == 0 ? b >> 4 : b & 0xF];
+            }
+            Status status, expected_status;
+            Tag tag, expected;
+            std::tie(expected_status, expected) = Tag::createFromBinary(hex);
+            std::tie(status, tag) = Tag::createFromBytes(bytes,
+                                                         sizeof(bytes));
+            ASSERT_EQ(expected_status, status) << hex;
+            if (status != Status::kOk) continue;
+            ASSERT_EQ(expected.getTagURI(), tag.getTagURI()) << hex;
+            ASSERT_EQ(expected.getBinary(), tag.getBinary()) << hex;
+        }
+    }
+}
+
+TEST(TagTest, Epc96) {
+    Tag tag;
+    Status status;
+    Epc96 epc;
+    std::tie(status, tag) = Tag::createFromTagURI(
+        "urn:epc:tag:sgtin-96:3.0614141.812345.6789");
+    ASSERT_EQ(Status::kOk, status);
+    std::tie(status, epc) = tag.getEpc96();
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("3074257BF7194E4000001A85", epc.getBinary());
+    std::tie(status, tag) = Tag::createFromEpc96(epc);
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ("urn:epc:tag:sgtin-96:3.0614141.812345.6789", tag.getTagURI());
+
+    std::tie(status, tag) = Tag::createFromTagURI(
+        "urn:epc:tag:sgtin-198:3.0614141.812345.32a%2Fb");
+    ASSERT_EQ(Status::kOk, status);
+    ASSERT_EQ(Status::kInvalidArgument, tag.getEpc96().first);
+    ASSERT_EQ(Status::kInvalidArgument, Tag().getEpc96().first);
+    ASSERT_EQ(Status::kInvalidArgument,
+              Tag::createFromEpc96(Epc96(0x35000000, 0)).first);
+}
+
+TEST(TagTest, CreateFromURI) {
+    Tag tag;
+    Status status;
+    {
+        std::tie(status, tag) = Tag::createFromURI(
+            "urn:epc:id:sgln:0614141.12345.400");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(TagType::kSGLN, tag.getType());
+        ASSERT_EQ("400", tag.getSGLN().getExtension());
+    }
+    {
+        std::tie(status, tag) = Tag::createFromURI(
+            "urn:epc:id:sscc:0614141.1234567890");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(TagType::kSSCC, tag.getType());
+        ASSERT_EQ(Status::kOk, tag.setFilterValue(3));
+        ASSERT_EQ("urn:epc:tag:sscc-96:3.0614141.1234567890", tag.getTagURI());
+    }
+    // Check for invalid uri
+    {
+        std::tie(status, tag) = Tag::createFromURI(
+            "urn:epc:id:usdod:CAGEY.5678");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        std::tie(status, tag) = Tag::createFromURI(
+            "urn:epc:id:grai:0614141.12345");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+        ASSERT_EQ(TagType::kUnknown, tag.getType());
+        ASSERT_EQ(Status::kInvalidArgument, tag.setFilterValue(3));
+    }
+}
+
+TEST(TagTest, CreateFromTagURI) {
+    Tag tag;
+    Status status;
+    {
+        std::tie(status, tag) = Tag::createFromTagURI(
+            "urn:epc:tag:grai-170:3.0614141.12345.32a%2Fb");
+        ASSERT_EQ(Status::kOk, status);
+        ASSERT_EQ(TagType::kGRAI, tag.getType());
+        ASSERT_EQ(GRAI::Scheme::kGRAI170, tag.getGRAI().getGRAIScheme());
+        ASSERT_EQ("urn:epc:id:grai:0614141.12345.32a%2Fb", tag.getURI());
+    }
+    // Check for invalid tag uri
+    {
+        std::tie(status, tag) = Tag::createFromTagURI(
+            "urn:epc:id:grai:0614141.12345.32a%2Fb");
+        ASSERT_EQ(Status::kInvalidArgument, status);
+    }
+}
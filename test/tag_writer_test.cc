@@ -0,0 +1,214 @@
+#include "tag_writer.h"
+#include "status.h"
+#include "tag.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace epc;
+
+namespace {
+    TagWriter::Sink string_sink(std::string &out) {
+        return [&out](const char *data, size_t size) {
+            out.append(data, size);
+            return Status::kOk;
+        };
+    }
+
+    Tag create_tag(const std::string &hex) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromBinary(hex);
+        EXPECT_EQ(Status::kOk, status);
+        return tag;
+    }
+
+    Tag create_tag_from_uri(const std::string &uri) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromURI(uri);
+        EXPECT_EQ(Status::kOk, status);
+        return tag;
+    }
+
+    const std::vector<TagWriter::Column> ALL_COLUMNS = {
+        TagWriter::Column::kURI,
+        TagWriter::Column::kTagURI,
+        TagWriter::Column::kBinary,
+        TagWriter::Column::kType,
+        TagWriter::Column::kScheme,
+        TagWriter::Column::kFilter,
+        TagWriter::Column::kCompanyPrefix,
+        TagWriter::Column::kReference,
+        TagWriter::Column::kSerial,
+    };
+}
+
+TEST(TagWriterTest, WriteNDJSON) {
+    std::string out;
+    {
+        TagWriter writer(TagWriter::Format::kNDJSON, ALL_COLUMNS,
+                         string_sink(out));
+        ASSERT_EQ(Status::kOk, writer.writeHeader());
+        ASSERT_EQ(Status::kOk,
+                  writer.write(create_tag("3074257BF7194E4000001A85")));
+        ASSERT_EQ(Status::kOk, writer.flush());
+    }
+    ASSERT_EQ("{\"uri\":\"urn:epc:id:sgtin:0614141.812345.6789\","
+              "\"tag_uri\":\"urn:epc:tag:sgtin-96:3.0614141.812345.6789\","
+              "\"binary\":\"3074257BF7194E4000001A85\","
+              "\"type\":\"sgtin\",\"scheme\":\"sgtin-96\",\"filter\":3,"
+              "\"company_prefix\":\"0614141\",\"reference\":\"812345\","
+              "\"serial\":\"6789\"}\n",
+              out);
+}
+
+TEST(TagWriterTest, WriteCSV) {
+    std::string out;
+    TagWriter writer(TagWriter::Format::kCSV,
+                     {TagWriter::Column::kScheme, TagWriter::Column::kFilter,
+                      TagWriter::Column::kReference,
+                      TagWriter::Column::kSerial},
+                     string_sink(out));
+    ASSERT_EQ(Status::kOk, writer.writeHeader());
+    ASSERT_EQ(Status::kOk,
+              writer.write(create_tag("3074257BF7194E4000001A85")));
+    ASSERT_EQ(Status::kOk,
+              writer.write(create_tag_from_uri(
+                  "urn:epc:id:sscc:0614141.1234567890")));
+    ASSERT_EQ(Status::kOk, writer.flush());
+    ASSERT_EQ("scheme,filter,reference,serial\n"
+              "sgtin-96,3,812345,6789\n"
+              "sscc-96,0,1234567890,\n",
+              out);
+}
+
+TEST(TagWriterTest, MatchesObjectPath) {
+    std::vector<Tag> tags = {
+        create_tag("3074257BF7194E4000001A85"),
+        create_tag_from_uri("urn:epc:id:sscc:0614141.1234567890"),
+        create_tag_from_uri("urn:epc:id:sgln:0614141.12345.400"),
+        create_tag_from_uri("urn:epc:id:grai:0614141.12345.5678"),
+        create_tag_from_uri("urn:epc:id:giai:0614141.12345400"),
+        create_tag_from_uri("urn:epc:id:grai:0614141.12345.32a%2Fb"),
+        create_tag_from_uri("urn:epc:id:sgtin:0614141.712345.32a%2Fb"),
+        create_tag_from_uri("urn:epc:id:giai:0614141.32a%2Fb"),
+    };
+    std::string out;
+    TagWriter writer(TagWriter::Format::kCSV,
+                     {TagWriter::Column::kURI, TagWriter::Column::kTagURI},
+                     string_sink(out));
+    ASSERT_EQ(Status::kOk, writer.write(tags));
+    ASSERT_EQ(Status::kOk, writer.flush());
+
+    std::string expected;
+    for (const auto &tag : tags) {
+        expected += tag.getURI() + "," + tag.getTagURI() + "\n";
+    }
+    ASSERT_EQ(expected, out);
+}
+
+TEST(TagWriterTest, Escape) {
+    Tag tag = create_tag_from_uri("urn:epc:id:sgtin:0614141.712345.a%22b,c");
+    ASSERT_EQ("a\"b,c", tag.getSGTIN().getSerial());
+    {
+        std::string out;
+        TagWriter writer(TagWriter::Format::kNDJSON,
+                         {TagWriter::Column::kURI, TagWriter::Column::kSerial},
+                         string_sink(out));
+        ASSERT_EQ(Status::kOk, writer.write(tag));
+        ASSERT_EQ(Status::kOk, writer.flush());
+        ASSERT_EQ("{\"uri\":\"urn:epc:id:sgtin:0614141.712345.a%22b,c\","
+                  "\"serial\":\"a\\\"b,c\"}\n",
+                  out);
+    }
+    {
+        std::string out;
+        TagWriter writer(TagWriter::Format::kCSV,
+                         {TagWriter::Column::kURI, TagWriter::Column::kSerial},
+                         string_sink(out));
+        ASSERT_EQ(Status::kOk, writer.write(tag));
+        ASSERT_EQ(Status::kOk, writer.flush());
+        ASSERT_EQ("\"urn:epc:id:sgtin:0614141.712345.a%22b,c\","
+                  "\"a\"\"b,c\"\n",
+                  out);
+    }
+}
+
+TEST(TagWriterTest, MissingFields) {
+    std::string out;
+    TagWriter writer(TagWriter::Format::kNDJSON,
+                     {TagWriter::Column::kReference,
+                      TagWriter::Column::kSerial},
+                     string_sink(out));
+    ASSERT_EQ(Status::kOk,
+              writer.write(create_tag_from_uri(
+                  "urn:epc:id:sscc:0614141.1234567890")));
+    ASSERT_EQ(Status::kOk,
+              writer.write(create_tag_from_uri(
+                  "urn:epc:id:giai:0614141.12345400")));
+    ASSERT_EQ(Status::kOk, writer.flush());
+    ASSERT_EQ("{\"reference\":\"1234567890\",\"serial\":null}\n"
+              "{\"reference\":null,\"serial\":\"12345400\"}\n",
+              out);
+}
+
+TEST(TagWriterTest, UnknownTag) {
+    std::string out;
+    TagWriter writer(TagWriter::Format::kNDJSON, ALL_COLUMNS,
+                     string_sink(out));
+    ASSERT_EQ(Status::kInvalidArgument, writer.write(Tag()));
+    std::vector<Tag> tags = {Tag(), create_tag("3074257BF7194E4000001A85")};
+    ASSERT_EQ(Status::kOk, writer.write(tags));
+    ASSERT_EQ(Status::kOk, writer.flush());
+    ASSERT_EQ(1, std::count(out.begin(), out.end(), '\n'));
+}
+
+TEST(TagWriterTest, FlushOnBufferSize) {
+    std::vector<size_t> sizes;
+    TagWriter writer(TagWriter::Format::kCSV, {TagWriter::Column::kSerial},
+                     [&sizes](const char *, size_t size) {
+                         sizes.push_back(size);
+                         return Status::kOk;
+                     },
+                     10);
+    Tag tag = create_tag("3074257BF7194E4000001A85");
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(Status::kOk, writer.write(tag));
+    }
+    ASSERT_EQ(Status::kOk, writer.flush());
+    ASSERT_EQ((std::vector<size_t>{10, 10, 5}), sizes);
+}
+
+TEST(TagWriterTest, SinkError) {
+    TagWriter writer(TagWriter::Format::kCSV, {TagWriter::Column::kSerial},
+                     [](const char *, size_t) {
+                         return Status::kInvalidArgument;
+                     },
+                     1);
+    ASSERT_EQ(Status::kInvalidArgument,
+              writer.write(create_tag("3074257BF7194E4000001A85")));
+}
+
+TEST(TagWriterTest, WriteToFd) {
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    {
+        TagWriter writer(TagWriter::Format::kCSV, {TagWriter::Column::kURI},
+                         fds[1]);
+        ASSERT_EQ(Status::kOk,
+                  writer.write(create_tag("3074257BF7194E4000001A85")));
+    }
+    ::close(fds[1]);
+    char buf[128];
+    ssize_t n = ::read(fds[0], buf, sizeof(buf));
+    ::close(fds[0]);
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789\n",
+              std::string(buf, n > 0 ? n : 0));
+}
@@ -0,0 +1,320 @@
+#include "transcode.h"
+#include "tag.h"
+#include "status.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace epc;
+
+namespace {
+    const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    // The object path of each transcoder.
+    std::pair<Status, std::string> binary_to_uri(const std::string &hex,
+                                                 bool tag_uri) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromBinary(hex);
+        if (status != Status::kOk) return std::make_pair(status, "");
+        return std::make_pair(Status::kOk,
+                              tag_uri ? tag.getTagURI() : tag.getURI());
+    }
+
+    Status set_scheme(Tag &tag, unsigned int bits, unsigned int filter) {
+        bool is96 = bits == 96;
+        switch (tag.getType()) {
+        case TagType::kSGTIN: {
+            if (!is96 && bits != 198) return Status::kInvalidArgument;
+            SGTIN sgtin = tag.getSGTIN();
+            sgtin.setSGTINScheme(is96 ? SGTIN::Scheme::kSGTIN96
+                                 : SGTIN::Scheme::kSGTIN198);
+            tag = Tag(sgtin);
+            break;
+        }
+        case TagType::kSSCC:
+            if (!is96) return Status::kInvalidArgument;
+            break;
+        case TagType::kSGLN: {
+            if (!is96 && bits != 195) return Status::kInvalidArgument;
+            SGLN sgln = tag.getSGLN();
+            sgln.setSGLNScheme(is96 ? SGLN::Scheme::kSGLN96
+                               : SGLN::Scheme::kSGLN195);
+            tag = Tag(sgln);
+            break;
+        }
+        case TagType::kGRAI: {
+            if (!is96 && bits != 170) return Status::kInvalidArgument;
+            GRAI grai = tag.getGRAI();
+            grai.setGRAIScheme(is96 ? GRAI::Scheme::kGRAI96
+                               : GRAI::Scheme::kGRAI170);
+            tag = Tag(grai);
+            break;
+        }
+        default: {
+            if (!is96 && bits != 202) return Status::kInvalidArgument;
+            GIAI giai = tag.getGIAI();
+            giai.setGIAIScheme(is96 ? GIAI::Scheme::kGIAI96
+                               : GIAI::Scheme::kGIAI202);
+            tag = Tag(giai);
+            break;
+        }
+        }
+        return tag.setFilterValue(filter);
+    }
+
+    std::pair<Status, std::string> uri_to(const std::string &uri,
+                                          unsigned int bits,
+                                          unsigned int filter, bool binary) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromURI(uri);
+        if (status != Status::kOk) return std::make_pair(status, "");
+        status = set_scheme(tag, bits, filter);
+        if (status != Status::kOk) return std::make_pair(status, "");
+        if (binary) return tag.getBinary();
+        return std::make_pair(Status::kOk, tag.getTagURI());
+    }
+
+    std::pair<Status, std::string> tag_uri_to(const std::string &tag_uri,
+                                              bool binary) {
+        Status status;
+        Tag tag;
+        std::tie(status, tag) = Tag::createFromTagURI(tag_uri);
+        if (status != Status::kOk) return std::make_pair(status, "");
+        if (binary) return tag.getBinary();
+        return std::make_pair(Status::kOk, tag.getURI());
+    }
+
+    using Transcoded = std::pair<Status, std::string>;
+
+    Transcoded transcoded(Status status, const std::string &buffer) {
+        return std::make_pair(status, buffer);
+    }
+
+    void expect_binary_same(const std::string &hex) {
+        std::string buffer = "stale";
+        Status status = transcode_binary_to_uri(hex, buffer);
+        ASSERT_EQ(binary_to_uri(hex, false), transcoded(status, buffer))
+            << hex;
+        status = transcode_binary_to_tag_uri(hex, buffer);
+        ASSERT_EQ(binary_to_uri(hex, true), transcoded(status, buffer))
+            << hex;
+    }
+
+    void expect_tag_uri_same(const std::string &tag_uri) {
+        std::string buffer = "stale";
+        Status status = transcode_tag_uri_to_binary(tag_uri, buffer);
+        ASSERT_EQ(tag_uri_to(tag_uri, true), transcoded(status, buffer))
+            << tag_uri;
+        status = transcode_tag_uri_to_uri(tag_uri, buffer);
+        ASSERT_EQ(tag_uri_to(tag_uri, false), transcoded(status, buffer))
+            << tag_uri;
+    }
+
+    void expect_uri_same(const std::string &uri, unsigned int bits,
+                         unsigned int filter) {
+        std::string buffer = "stale";
+        Status status = transcode_uri_to_binary(uri, bits, filter, buffer);
+        ASSERT_EQ(uri_to(uri, bits, filter, true), transcoded(status, buffer))
+            << uri << " " << bits;
+        status = transcode_uri_to_tag_uri(uri, bits, filter, buffer);
+        ASSERT_EQ(uri_to(uri, bits, filter, false),
+                  transcoded(status, buffer)) << uri << " " << bits;
+    }
+
+    // Tag URIs of every scheme and bit length, and of each partition but
+    // partition 0 of SGLN and GRAI, of which the reference has no digits.
+    std::vector<std::string> make_tag_uris() {
+        const char *digits = "0614141812345678";
+        std::vector<std::string> tag_uris;
+        for (unsigned int length = 6; length <= 12; length++) {
+            std::string cp = std::string(digits, length);
+            auto ref = [length, digits](unsigned int total) {
+                return std::string(digits + 3, total - length);
+            };
+            tag_uris.push_back("urn:epc:tag:sgtin-96:3." + cp + "."
+                               + ref(13) + ".274877906943");
+            tag_uris.push_back("urn:epc:tag:sgtin-198:0." + cp + "."
+                               + ref(13) + ".mW%3Fx%2F%25z_%22");
+            tag_uris.push_back("urn:epc:tag:sscc-96:5." + cp + "."
+                               + ref(17));
+            tag_uris.push_back("urn:epc:tag:giai-96:6." + cp + ".4611686");
+            tag_uris.push_back("urn:epc:tag:giai-202:3." + cp
+                               + ".x%26y=1:2;3,4'5(6)7*8");
+            if (length == 12) continue;
+            tag_uris.push_back("urn:epc:tag:sgln-96:1." + cp + "."
+                               + ref(12) + ".2199023255551");
+            tag_uris.push_back("urn:epc:tag:sgln-195:7." + cp + "."
+                               + ref(12) + ".ABCDEFGHIJabcdefghij");
+            tag_uris.push_back("urn:epc:tag:grai-96:2." + cp + "."
+                               + ref(12) + ".0");
+            tag_uris.push_back("urn:epc:tag:grai-170:4." + cp + "."
+                               + ref(12) + ".%3C0123456789abc%3E");
+        }
+        tag_uris.push_back("urn:epc:tag:sgtin-96:3.0614141.812345.6789");
+        tag_uris.push_back("urn:epc:tag:sscc-96:3.0614141.0234567890");
+        tag_uris.push_back("urn:epc:tag:sgtin-198:3.0614141.812345.0");
+        return tag_uris;
+    }
+}
+
+TEST(TranscodeTest, Valid) {
+    std::string hex, uri, tag_uri;
+    for (const std::string &t : make_tag_uris()) {
+        ASSERT_EQ(Status::kOk, transcode_tag_uri_to_binary(t, hex)) << t;
+        ASSERT_EQ(Status::kOk, transcode_binary_to_tag_uri(hex, tag_uri))
+            << t;
+        ASSERT_EQ(t, tag_uri);
+        ASSERT_EQ(Status::kOk, transcode_binary_to_uri(hex, uri)) << t;
+        ASSERT_EQ(Status::kOk, transcode_tag_uri_to_uri(t, tag_uri)) << t;
+        ASSERT_EQ(uri, tag_uri);
+
+        expect_tag_uri_same(t);
+        expect_binary_same(hex);
+        for (unsigned int bits : {96, 170, 195, 198, 202, 197}) {
+            expect_uri_same(uri, bits, 5);
+        }
+    }
+
+    std::string buffer;
+    ASSERT_EQ(Status::kOk,
+              transcode_binary_to_uri("3074257BF7194E4000001A85", buffer));
+    ASSERT_EQ("urn:epc:id:sgtin:0614141.812345.6789", buffer);
+    ASSERT_EQ(Status::kOk,
+              transcode_uri_to_binary("urn:epc:id:sgtin:0614141.812345.6789",
+                                      96, 3, buffer));
+    ASSERT_EQ("3074257BF7194E4000001A85", buffer);
+    ASSERT_EQ(Status::kOk,
+              transcode_uri_to_tag_uri("urn:epc:id:sscc:0614141.1234567890",
+                                       96, 2, buffer));
+    ASSERT_EQ("urn:epc:tag:sscc-96:2.0614141.1234567890", buffer);
+}
+
+TEST(TranscodeTest, InvalidBinary) {
+    const char *hexes[] = {
+        "",
+        "3",
+        "3074257BF7194E4000001A8",
+        "3074257BF7194E4000001A855",
+        "3074257bf7194e4000001a85",
+        "3074257BF7194E4000001AG5",
+        "FF74257BF7194E4000001A85",
+        // A partition of 7.
+        "307C257BF7194E4000001A85",
+        // A company prefix of more digits than its partition.
+        "3074FFFFFF194E4000001A85",
+        // An item reference of more digits than its partition.
+        "3074257BF7FFFFC000001A85",
+        // A character which isn't of serials.
+        "3674257BF7194E51800000000000000000000000000000000000"
+    };
+    std::string buffer = "stale";
+    for (const char *hex : hexes) {
+        expect_binary_same(hex);
+    }
+    ASSERT_EQ(Status::kInvalidArgument,
+              transcode_binary_to_uri("307C257BF7194E4000001A85", buffer));
+    ASSERT_EQ("", buffer);
+
+    // Random binaries of every scheme, most of which fail.
+    std::mt19937 random(5489);
+    std::vector<std::string> prefixes = {"30", "31", "32", "33", "34",
+                                         "36", "37", "38", "39"};
+    for (int i = 0; i < 2000; i++) {
+        const std::string &prefix = prefixes[i % prefixes.size()];
+        size_t n = get_hex_length(static_cast<uint8_t>(
+            std::stoi(prefix, nullptr, 16)));
+        std::string hex = prefix;
+        while (hex.length() < n) hex += HEX_DIGITS[random() % 16];
+        // Company prefixes of the leading zero to fit more often.
+        if (i % 2 == 0) hex[3] = static_cast<char>('0' + random() % 2 * 8);
+        expect_binary_same(hex);
+    }
+}
+
+TEST(TranscodeTest, InvalidURI) {
+    const char *tag_uris[] = {
+        "",
+        "urn:epc:tag:sgtin-96:3.0614141.812345",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.",
+        "urn:epc:tag:sgtin-97:3.0614141.812345.6789",
+        "urn:epc:tag:sgtin-096:3.0614141.812345.6789",
+        "urn:epc:tag:sgtin-96:8.0614141.812345.6789",
+        "urn:epc:tag:sgtin-96:13.0614141.812345.6789",
+        "urn:epc:tag:sgtin-96:3.0614141.8123456.6789",
+        "urn:epc:tag:sgtin-96:3.061414A.812345.6789",
+        "urn:epc:tag:sgtin-96:3.06141.8123456.6789",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.274877906944",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.6789A",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.00000000000000000000000001",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.99999999999999999999999999",
+        "urn:epc:tag:sgtin-96:3.0614141.812345.67#9",
+        "urn:epc:tag:sgtin-198:3.0614141.812345.123456789012345678901",
+        "urn:epc:tag:sgtin-198:3.0614141.812345.%2f%2",
+        "urn:epc:tag:sscc-96:3.0614141.123456789",
+        "urn:epc:tag:sscc-96:3.0614141.1234567890.1",
+        "urn:epc:tag:sscc-198:3.0614141.1234567890",
+        "urn:epc:tag:sgln-96:3.0614141.12345.2199023255552",
+        "urn:epc:tag:sgln-195:3.0614141.12345.%3C%3E%3C%3E%3C%3E%3C%3E%3C%3E"
+        "%3C%3E%3C%3E%3C%3E%3C%3E%3C%3E%3C",
+        "urn:epc:tag:grai-96:3.0614141.12345.-1",
+        "urn:epc:tag:grai-170:3.0614141.12345.12345678901234567",
+        "urn:epc:tag:giai-96:3.0614141.4398046511104",
+        "urn:epc:tag:giai-96:3.061414112345.2199023255552",
+        "urn:epc:tag:giai-96:3.0614141.abc",
+        "urn:epc:tag:giai-202:3.0614141.",
+        "urn:epc:tag:giai-202:3.061414112345.1234567890123456789012",
+        "urn:epc:tag:giai-202:3.0614141.1234567890123456789012345",
+        "urn:epc:tag:giai-202:3.0614141.12 4",
+        "urn:epc:id:sgtin:0614141.812345.6789",
+    };
+    for (const char *tag_uri : tag_uris) {
+        expect_tag_uri_same(tag_uri);
+    }
+    const char *uris[] = {
+        "urn:epc:id:sgtin:0614141.812345",
+        "urn:epc:id:sgtin:0614141.812345.67%3F9",
+        "urn:epc:id:sgtin:06141.81234567.6789",
+        "urn:epc:id:sscc:0614141.1234567890",
+        "urn:epc:id:sscc:0614141.1234567890.",
+        "urn:epc:id:giai:0614141.%2F%25",
+        "urn:epc:id:giai:0614141",
+        "urn:epc:id:grai:0614141.12345.%",
+        "urn:epc:id:sgln:0614141.12345.0",
+        "urn:epc:tag:sgln-96:3.0614141.12345.0",
+        "urn:epc:id:ssc:0614141.1234567890",
+    };
+    for (const char *uri : uris) {
+        for (unsigned int bits : {96, 195, 198}) {
+            for (unsigned int filter : {0, 7, 8}) {
+                expect_uri_same(uri, bits, filter);
+            }
+        }
+    }
+
+    // Valid URIs with a character replaced.
+    std::mt19937 random(5489);
+    const char replacements[] = ".%9a/#:-";
+    std::string uri;
+    for (const std::string &t : make_tag_uris()) {
+        ASSERT_EQ(Status::kOk, transcode_tag_uri_to_uri(t, uri));
+        for (int i = 0; i < 20; i++) {
+            std::string mutated = t;
+            mutated[random() % mutated.length()] =
+                replacements[random() % (sizeof(replacements) - 1)];
+            expect_tag_uri_same(mutated);
+            mutated = uri;
+            mutated[random() % mutated.length()] =
+                replacements[random() % (sizeof(replacements) - 1)];
+            expect_uri_same(mutated, 96, 1);
+        }
+    }
+}
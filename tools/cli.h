@@ -0,0 +1,101 @@
+#ifndef LIBEPC_TOOLS_CLI_H_
+#define LIBEPC_TOOLS_CLI_H_
+
+// Helpers shared by the command line tools.
+
+#include "epc.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace epc {
+namespace cli {
+
+const unsigned int MAX_THREADS = 1024;
+
+/**
+ * A function parsing an option of an unsigned integer.
+ *
+ * Unlike strtoull(), it takes neither signs nor spaces, so "-1" is
+ * rejected instead of wrapping around.
+ *
+ * @param s A string of decimal digits.
+ * @param min The smallest value taken.
+ * @param max The largest value taken.
+ * @param value An integer set on success, of a type holding max.
+ * @return true if s is an integer in [min, max].
+ */
+template <typename T>
+inline bool parse_unsigned(const char *s, uint64_t min, uint64_t max,
+                           T &value) {
+    if (*s < '0' || '9' < *s) return false;
+    char *end;
+    errno = 0;
+    unsigned long long n = std::strtoull(s, &end, 10);
+    if (*end != '\0' || errno == ERANGE || n < min || max < n) return false;
+    value = static_cast<T>(n);
+    return true;
+}
+
+/**
+ * A function parsing an option of a finite real number.
+ *
+ * @param s A string of a number as strtod() takes it.
+ * @param value A number set on success.
+ * @return true if all of s is a finite number.
+ */
+inline bool parse_double(const char *s, double &value) {
+    char *end;
+    errno = 0;
+    double d = std::strtod(s, &end);
+    if (end == s || *end != '\0' || errno == ERANGE || !std::isfinite(d)) {
+        return false;
+    }
+    value = d;
+    return true;
+}
+
+/**
+ * A function parsing an option of the number of threads, from 1 to
+ * MAX_THREADS.
+ */
+inline bool parse_threads(const char *s, unsigned int &threads) {
+    return parse_unsigned(s, 1, MAX_THREADS, threads);
+}
+
+/**
+ * A function parsing an option of a filter value, from 0 to
+ * EPC::MAX_FILTER_VALUE.
+ */
+inline bool parse_filter(const char *s, unsigned int &filter) {
+    return parse_unsigned(s, 0, EPC::MAX_FILTER_VALUE, filter);
+}
+
+/**
+ * A function writing all of a buffer, retrying on interrupts and short
+ * writes.
+ *
+ * @return false on errors, which are left in errno.
+ */
+inline bool write_all(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t r = ::write(fd, p, n);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+}
+}
+
+#endif
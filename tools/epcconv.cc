@@ -0,0 +1,290 @@
+// epcconv converts a file of EPCs into another representation.
+//
+// Each line of the input is an EPC binary in hex string format of either
+// case, an EPC URI or an EPC Tag URI. The input is memory-mapped and
+// converted in chunks by a pool of threads, and the output keeps the order
+// of the input with one line per non-empty input line. Lines failing to be
+// converted are written as empty lines so that the output stays aligned
+// with the input.
+
+#include "cli.h"
+#include "status.h"
+#include "tag.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace epc;
+using namespace epc::cli;
+
+namespace {
+    enum class Format {
+        kHex,
+        kURI,
+        kTagURI,
+    };
+
+    struct Options {
+        Format to = Format::kURI;
+        int filter = -1;
+        unsigned int threads = 0;
+        size_t chunk_size = 4 << 20;
+        bool stats = false;
+        const char *input = nullptr;
+        const char *output = nullptr;
+    };
+
+    struct Chunk {
+        const char *begin;
+        const char *end;
+        std::string out;
+        size_t records;
+        size_t errors;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+                     "usage: epcconv [-t hex|uri|tag-uri] [-f filter] "
+                     "[-j threads] [-c chunk-size] [-o output] [-s] input\n"
+                     "\n"
+                     "  -t  Output representation (default: uri)\n"
+                     "  -f  Filter value, 0 to 7, set on EPCs read from "
+                     "EPC URIs\n"
+                     "  -j  Number of threads, 1 to 1024 "
+                     "(default: number of CPUs)\n"
+                     "  -c  Bytes of input converted by a thread at once\n"
+                     "  -o  Output file (default: stdout)\n"
+                     "  -s  Print throughput statistics to stderr\n");
+    }
+
+    bool starts_with(const char *p, const char *end, const char *prefix) {
+        size_t n = std::strlen(prefix);
+        return static_cast<size_t>(end - p) >= n
+            && std::memcmp(p, prefix, n) == 0;
+    }
+
+    bool convert(const char *begin, const char *end, const Options &options,
+                 std::string &line, std::string &out) {
+        line.assign(begin, end);
+        Status status;
+        Tag tag;
+        if (starts_with(begin, end, "urn:epc:id:")) {
+            std::tie(status, tag) = Tag::createFromURI(line);
+            if (status == Status::kOk && options.filter >= 0) {
+                status = tag.setFilterValue(options.filter);
+            }
+        } else if (starts_with(begin, end, "urn:epc:tag:")) {
+            std::tie(status, tag) = Tag::createFromTagURI(line);
+        } else {
+            // Binaries are taken in either case, as ReaderLogDecoder does.
+            for (char &c : line) {
+                if ('a' <= c && c <= 'z') c -= 'a' - 'A';
+            }
+            std::tie(status, tag) = Tag::createFromBinary(line);
+        }
+        if (status != Status::kOk) return false;
+
+        switch (options.to) {
+        case Format::kHex: {
+            std::string hex;
+            std::tie(status, hex) = tag.getBinary();
+            if (status != Status::kOk) return false;
+            out += hex;
+            break;
+        }
+        case Format::kURI:
+            out += tag.getURI();
+            break;
+        case Format::kTagURI:
+            out += tag.getTagURI();
+            break;
+        }
+        return true;
+    }
+
+    void convert_chunk(Chunk &chunk, const Options &options) {
+        std::string line;
+        const char *p = chunk.begin;
+        while (p != chunk.end) {
+            const char *nl = static_cast<const char *>(
+                std::memchr(p, '\n', chunk.end - p));
+            const char *eol = nl ? nl : chunk.end;
+            const char *end = eol;
+            if (end != p && end[-1] == '\r') end--;
+            if (end != p) {
+                chunk.records++;
+                if (!convert(p, end, options, line, chunk.out)) {
+                    chunk.errors++;
+                }
+                chunk.out += '\n';
+            }
+            p = nl ? nl + 1 : chunk.end;
+        }
+    }
+
+    bool parse_options(int argc, char **argv, Options &options) {
+        int c;
+        while ((c = getopt(argc, argv, "t:f:j:c:o:sh")) != -1) {
+            switch (c) {
+            case 't':
+                if (std::strcmp(optarg, "hex") == 0) {
+                    options.to = Format::kHex;
+                } else if (std::strcmp(optarg, "uri") == 0) {
+                    options.to = Format::kURI;
+                } else if (std::strcmp(optarg, "tag-uri") == 0) {
+                    options.to = Format::kTagURI;
+                } else {
+                    return false;
+                }
+                break;
+            case 'f': {
+                unsigned int filter;
+                if (!parse_filter(optarg, filter)) return false;
+                options.filter = filter;
+                break;
+            }
+            case 'j':
+                if (!parse_threads(optarg, options.threads)) return false;
+                break;
+            case 'c': {
+                uint64_t chunk_size;
+                if (!parse_unsigned(optarg, 1, SIZE_MAX, chunk_size)) {
+                    return false;
+                }
+                options.chunk_size = chunk_size;
+                break;
+            }
+            case 'o':
+                options.output = optarg;
+                break;
+            case 's':
+                options.stats = true;
+                break;
+            default:
+                return false;
+            }
+        }
+        if (optind + 1 != argc) return false;
+        options.input = argv[optind];
+        if (options.threads == 0) {
+            options.threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    int in = ::open(options.input, O_RDONLY);
+    if (in < 0) {
+        std::perror(options.input);
+        return 1;
+    }
+    struct stat st;
+    if (::fstat(in, &st) < 0) {
+        std::perror(options.input);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const char *data = nullptr;
+    if (size > 0) {
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in, 0);
+        if (p == MAP_FAILED) {
+            std::perror(options.input);
+            return 1;
+        }
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(p);
+    }
+
+    int out = STDOUT_FILENO;
+    if (options.output) {
+        out = ::open(options.output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            std::perror(options.output);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t records = 0;
+    size_t errors = 0;
+    size_t written = 0;
+    const char *p = data;
+    const char *end = data + size;
+    std::vector<Chunk> chunks(options.threads);
+    while (p != end) {
+        // Split the next part of the input into chunks ending at newlines.
+        size_t n = 0;
+        for (; n < chunks.size() && p != end; n++) {
+            const char *q = p + std::min(options.chunk_size,
+                                         static_cast<size_t>(end - p));
+            if (q != end) {
+                const char *nl = static_cast<const char *>(
+                    std::memchr(q, '\n', end - q));
+                q = nl ? nl + 1 : end;
+            }
+            Chunk &chunk = chunks[n];
+            chunk.begin = p;
+            chunk.end = q;
+            chunk.out.clear();
+            chunk.records = 0;
+            chunk.errors = 0;
+            p = q;
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < n; i++) {
+            threads.emplace_back(convert_chunk, std::ref(chunks[i]),
+                                 std::cref(options));
+        }
+        convert_chunk(chunks[0], options);
+        for (auto &thread : threads) thread.join();
+
+        for (size_t i = 0; i < n; i++) {
+            if (!write_all(out, chunks[i].out.data(), chunks[i].out.size())) {
+                std::perror(options.output ? options.output : "stdout");
+                return 1;
+            }
+            written += chunks[i].out.size();
+            records += chunks[i].records;
+            errors += chunks[i].errors;
+        }
+    }
+
+    if (options.stats) {
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        double seconds = elapsed.count();
+        std::fprintf(stderr,
+                     "records: %zu\nerrors: %zu\nseconds: %.3f\n"
+                     "records/s: %.0f\ninput MB/s: %.1f\noutput MB/s: %.1f\n",
+                     records, errors, seconds,
+                     seconds > 0 ? records / seconds : 0.0,
+                     seconds > 0 ? size / seconds / 1e6 : 0.0,
+                     seconds > 0 ? written / seconds / 1e6 : 0.0);
+    }
+
+    if (data) ::munmap(const_cast<char *>(data), size);
+    ::close(in);
+    if (out != STDOUT_FILENO) ::close(out);
+    return errors == 0 ? 0 : 1;
+}
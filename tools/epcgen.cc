@@ -0,0 +1,305 @@
+// epcgen generates a deterministic synthetic corpus of EPCs.
+//
+// Records are generated by CorpusGenerator of corpus.h in chunks by a pool
+// of threads and written in the order of their indices, one per line, or
+// back to back in bytes. The corpus depends only on the options, not on
+// the number of threads or the chunk size.
+
+#include "cli.h"
+#include "corpus.h"
+#include "status.h"
+#include "tag.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace epc;
+using namespace epc::cli;
+
+namespace {
+    struct Options {
+        CorpusConfig config;
+        CorpusFormat to = CorpusFormat::kHex;
+        uint64_t count = 0;
+        unsigned int threads = 0;
+        size_t chunk_size = 1 << 16;
+        bool stats = false;
+        const char *output = nullptr;
+    };
+
+    struct Chunk {
+        uint64_t first;
+        size_t n;
+        std::string out;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+                     "usage: epcgen [-t hex|bytes|uri|tag-uri] [-m mix] "
+                     "[-p weights] [-f filter]\n"
+                     "              [-S seed] [-P prefixes] [-k skew] "
+                     "[-e sequential|random|alnum]\n"
+                     "              [-F first-serial] [-r rate] [-w window] "
+                     "[-K skew] [-j threads]\n"
+                     "              [-c chunk-size] [-o output] [-s] count\n"
+                     "\n"
+                     "  -t  Output representation (default: hex)\n"
+                     "  -m  Scheme mix, e.g. sgtin-96:8,sscc-96:1 "
+                     "(default: sgtin-96)\n"
+                     "  -p  Weights of partitions 0 to 6, e.g. "
+                     "0,0,1,2,4,2,1 (default: uniform)\n"
+                     "  -f  Filter value, 0 to 7 (default: 0)\n"
+                     "  -S  Seed (default: 0)\n"
+                     "  -P  Company prefixes per partition, up to 1048576 "
+                     "(default: 1000)\n"
+                     "  -k  Zipf skew of company prefixes (default: 1)\n"
+                     "  -e  Serials (default: random)\n"
+                     "  -F  First serial of sequential serials "
+                     "(default: 0)\n"
+                     "  -r  Rate of re-reads in [0, 1) (default: 0)\n"
+                     "  -w  Records a re-read is of, up to 1048576 "
+                     "(default: 64)\n"
+                     "  -K  Zipf skew of re-reads by age (default: 1)\n"
+                     "  -j  Number of threads, 1 to 1024 "
+                     "(default: number of CPUs)\n"
+                     "  -c  Records generated by a thread at once\n"
+                     "  -o  Output file (default: stdout)\n"
+                     "  -s  Print throughput statistics to stderr\n");
+    }
+
+    bool parse_mix(const char *s, std::vector<CorpusScheme> &schemes) {
+        schemes.clear();
+        std::string mix(s);
+        size_t begin = 0;
+        while (begin <= mix.length()) {
+            size_t end = std::min(mix.find(',', begin), mix.length());
+            std::string entry = mix.substr(begin, end - begin);
+            size_t colon = entry.find(':');
+            std::string name = entry.substr(0, colon);
+            double weight = 1;
+            if (colon != std::string::npos
+                && !parse_double(entry.c_str() + colon + 1, weight)) {
+                return false;
+            }
+            const SchemeInfo *scheme = nullptr;
+            for (unsigned int header = 0; header <= 0xFF; header++) {
+                const SchemeInfo *candidate = get_scheme_info(
+                    static_cast<uint8_t>(header));
+                if (candidate && name == candidate->name_) scheme = candidate;
+            }
+            if (!scheme) return false;
+            schemes.push_back({scheme->header_, weight});
+            begin = end + 1;
+        }
+        return true;
+    }
+
+    bool parse_weights(const char *s, std::vector<double> &weights) {
+        weights.clear();
+        const char *p = s;
+        while (true) {
+            char *end;
+            weights.push_back(std::strtod(p, &end));
+            if (end == p) return false;
+            if (*end == '\0') return true;
+            if (*end != ',') return false;
+            p = end + 1;
+        }
+    }
+
+    void generate_chunk(Chunk &chunk, const CorpusGenerator &generator,
+                        const Options &options) {
+        chunk.out.clear();
+        for (size_t i = 0; i < chunk.n; i++) {
+            generator.append(chunk.first + i, options.to, chunk.out);
+            if (options.to != CorpusFormat::kBytes) chunk.out += '\n';
+        }
+    }
+
+    bool parse_options(int argc, char **argv, Options &options) {
+        CorpusConfig &config = options.config;
+        int c;
+        while ((c = getopt(argc, argv, "t:m:p:f:S:P:k:e:F:r:w:K:j:c:o:sh"))
+               != -1) {
+            switch (c) {
+            case 't':
+                if (std::strcmp(optarg, "hex") == 0) {
+                    options.to = CorpusFormat::kHex;
+                } else if (std::strcmp(optarg, "bytes") == 0) {
+                    options.to = CorpusFormat::kBytes;
+                } else if (std::strcmp(optarg, "uri") == 0) {
+                    options.to = CorpusFormat::kURI;
+                } else if (std::strcmp(optarg, "tag-uri") == 0) {
+                    options.to = CorpusFormat::kTagURI;
+                } else {
+                    return false;
+                }
+                break;
+            case 'm':
+                if (!parse_mix(optarg, config.schemes_)) return false;
+                break;
+            case 'p':
+                if (!parse_weights(optarg, config.partition_weights_)) {
+                    return false;
+                }
+                break;
+            case 'f':
+                if (!parse_filter(optarg, config.filter_)) return false;
+                break;
+            case 'S':
+                if (!parse_unsigned(optarg, 0, UINT64_MAX, config.seed_)) {
+                    return false;
+                }
+                break;
+            case 'P':
+                if (!parse_unsigned(optarg, 1,
+                                    CorpusGenerator::MAX_COMPANY_PREFIXES,
+                                    config.company_prefixes_)) {
+                    return false;
+                }
+                break;
+            case 'k':
+                if (!parse_double(optarg, config.company_prefix_skew_)) {
+                    return false;
+                }
+                break;
+            case 'e':
+                if (std::strcmp(optarg, "sequential") == 0) {
+                    config.serial_mode_ = SerialMode::kSequential;
+                } else if (std::strcmp(optarg, "random") == 0) {
+                    config.serial_mode_ = SerialMode::kRandom;
+                } else if (std::strcmp(optarg, "alnum") == 0) {
+                    config.serial_mode_ = SerialMode::kAlphanumeric;
+                } else {
+                    return false;
+                }
+                break;
+            case 'F':
+                if (!parse_unsigned(optarg, 0, UINT64_MAX,
+                                    config.first_serial_)) {
+                    return false;
+                }
+                break;
+            case 'r':
+                if (!parse_double(optarg, config.repeat_rate_)) return false;
+                break;
+            case 'w':
+                if (!parse_unsigned(optarg, 1,
+                                    CorpusGenerator::MAX_REPEAT_WINDOW,
+                                    config.repeat_window_)) {
+                    return false;
+                }
+                break;
+            case 'K':
+                if (!parse_double(optarg, config.repeat_skew_)) return false;
+                break;
+            case 'j':
+                if (!parse_threads(optarg, options.threads)) return false;
+                break;
+            case 'c':
+                if (!parse_unsigned(optarg, 1, SIZE_MAX, options.chunk_size)) {
+                    return false;
+                }
+                break;
+            case 'o':
+                options.output = optarg;
+                break;
+            case 's':
+                options.stats = true;
+                break;
+            default:
+                return false;
+            }
+        }
+        if (optind + 1 != argc) return false;
+        if (!parse_unsigned(argv[optind], 0, UINT64_MAX, options.count)) {
+            return false;
+        }
+        if (options.threads == 0) {
+            options.threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    Status status;
+    CorpusGenerator generator;
+    std::tie(status, generator) = CorpusGenerator::create(options.config);
+    if (status != Status::kOk) {
+        std::fprintf(stderr, "epcgen: invalid corpus configuration\n");
+        return 2;
+    }
+
+    int out = STDOUT_FILENO;
+    if (options.output) {
+        out = ::open(options.output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            std::perror(options.output);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t written = 0;
+    uint64_t next = 0;
+    std::vector<Chunk> chunks(options.threads);
+    while (next != options.count) {
+        size_t n = 0;
+        for (; n < chunks.size() && next != options.count; n++) {
+            chunks[n].first = next;
+            chunks[n].n = std::min<uint64_t>(options.chunk_size,
+                                             options.count - next);
+            next += chunks[n].n;
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < n; i++) {
+            threads.emplace_back(generate_chunk, std::ref(chunks[i]),
+                                 std::cref(generator), std::cref(options));
+        }
+        generate_chunk(chunks[0], generator, options);
+        for (auto &thread : threads) thread.join();
+
+        for (size_t i = 0; i < n; i++) {
+            if (!write_all(out, chunks[i].out.data(), chunks[i].out.size())) {
+                std::perror(options.output ? options.output : "stdout");
+                return 1;
+            }
+            written += chunks[i].out.size();
+        }
+    }
+
+    if (options.stats) {
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        double seconds = elapsed.count();
+        std::fprintf(stderr,
+                     "records: %llu\nseconds: %.3f\nrecords/s: %.0f\n"
+                     "output MB/s: %.1f\n",
+                     static_cast<unsigned long long>(options.count), seconds,
+                     seconds > 0 ? options.count / seconds : 0.0,
+                     seconds > 0 ? written / seconds / 1e6 : 0.0);
+    }
+
+    if (out != STDOUT_FILENO) ::close(out);
+    return 0;
+}